@@ -0,0 +1,102 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include <soralog/impl/line_pattern.hpp>
+
+using namespace soralog;
+using namespace std::chrono_literals;
+
+namespace {
+
+  constexpr size_t events_count = 1000;
+
+  /**
+   * @returns typical events logged by different threads with {@param step}
+   * between their timestamps
+   */
+  std::vector<std::unique_ptr<Event>> makeEvents(
+      std::chrono::microseconds step) {
+    const auto levels = {Level::INFO, Level::DEBUG, Level::WARN, Level::TRACE};
+    std::vector<std::unique_ptr<Event>> events;
+    auto time = std::chrono::system_clock::time_point(1700000000s);
+    for (size_t i = 0; i < events_count; ++i, time += step) {
+      events.emplace_back(std::make_unique<Event>(
+          time, 1 + i % 8, "worker", "block_executor",
+          *(levels.begin() + i % levels.size()),
+          fmt::format("Imported block #{} with hash 0x{:016x}; peers: {}",
+                      1000000 + i, i * 0x9E3779B97F4A7C15ull, i % 50)));
+    }
+    return events;
+  }
+
+  /**
+   * Renders events by {@param patterns} one by one, as sinks with these
+   * patterns do
+   */
+  void render(benchmark::State &state, std::vector<LinePattern> &patterns,
+              std::chrono::microseconds step) {
+    const auto events = makeEvents(step);
+    size_t max_size = 0;
+    for (const auto &pattern : patterns) {
+      max_size = std::max(max_size, pattern.maxSize());
+    }
+    std::vector<char> buffer(max_size);
+
+    for (auto _ : state) {
+      for (const auto &event : events) {
+        for (auto &pattern : patterns) {
+          char *ptr = buffer.data();
+          pattern.render(ptr, *event);
+          benchmark::DoNotOptimize(ptr);
+        }
+      }
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * events.size()
+                            * patterns.size());
+  }
+
+  std::vector<LinePattern> defaultPatterns(Sink::ThreadInfoType type,
+                                           bool with_color, size_t count) {
+    std::vector<LinePattern> patterns;
+    for (size_t i = 0; i < count; ++i) {
+      patterns.emplace_back(LinePattern::defaultPattern(type), type,
+                            with_color);
+    }
+    return patterns;
+  }
+
+  /// Default layout of file; events are 1ms apart
+  void BM_RenderDefault(benchmark::State &state) {
+    auto patterns = defaultPatterns(Sink::ThreadInfoType::ID, false, 1);
+    render(state, patterns, 1ms);
+  }
+
+  /// Default layout of console with colors; events are 1ms apart
+  void BM_RenderColor(benchmark::State &state) {
+    auto patterns = defaultPatterns(Sink::ThreadInfoType::NAME, true, 1);
+    render(state, patterns, 1ms);
+  }
+
+  /// Each event is in new second, and it is rendered by several sinks
+  /// (number of them is given by argument)
+  void BM_RenderNewSecond(benchmark::State &state) {
+    auto patterns = defaultPatterns(Sink::ThreadInfoType::NONE, false,
+                                    static_cast<size_t>(state.range(0)));
+    render(state, patterns, 1s);
+  }
+
+}  // namespace
+
+BENCHMARK(BM_RenderDefault);
+BENCHMARK(BM_RenderColor);
+BENCHMARK(BM_RenderNewSecond)->Arg(1)->Arg(4);
+
+BENCHMARK_MAIN();
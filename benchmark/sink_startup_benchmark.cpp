@@ -0,0 +1,104 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <soralog/impl/configurator_from_yaml.hpp>
+#include <soralog/logging_system.hpp>
+
+using namespace soralog;
+
+namespace {
+
+  std::filesystem::path tmp_dir() {
+    return std::filesystem::temp_directory_path()
+        / ("soralog_benchmark_" + std::to_string(::getpid()));
+  }
+
+  /**
+   * @returns bytes of heap in use, or 0 if it's unknown
+   */
+  size_t heap_size() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    const auto info = ::mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * @returns config of {@param count} file sinks in {@param dir} and as many
+   * console ones, each used by own group
+   */
+  std::string makeConfig(const std::filesystem::path &dir, size_t count) {
+    std::string sinks = "sinks:\n";
+    std::string groups =
+        "groups:\n  - name: main\n    sink: console0\n    level: info\n"
+        "    children:\n";
+    for (size_t i = 0; i < count; ++i) {
+      const auto n = std::to_string(i);
+      sinks += "  - name: console" + n + "\n    type: console\n";
+      sinks += "  - name: file" + n + "\n    type: file\n    path: "
+             + (dir / ("file" + n + ".log")).string() + "\n";
+      groups += "      - name: group" + n + "\n        sink: file" + n + "\n";
+    }
+    return sinks + groups;
+  }
+
+  /**
+   * Configures system of many sinks (number of pairs of file and console
+   * sinks is given by argument) per iteration, while no event is logged.
+   * Counter 'heap_per_sink' is heap taken by configured system, divided by
+   * number of sinks
+   */
+  void BM_ConfigureSinks(benchmark::State &state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto dir = tmp_dir();
+    std::filesystem::create_directories(dir);
+    const auto config = makeConfig(dir, count);
+    size_t heap = 0;
+
+    for (auto _ : state) {
+      state.PauseTiming();
+      const auto heap_before = heap_size();
+      state.ResumeTiming();
+
+      auto system = std::make_unique<LoggingSystem>(
+          std::make_shared<ConfiguratorFromYAML>(config));
+      auto result = system->configure();
+      if (result.has_error) {
+        state.SkipWithError(result.message.c_str());
+        break;
+      }
+
+      state.PauseTiming();
+      heap += heap_size() - heap_before;
+      system.reset();
+      state.ResumeTiming();
+    }
+
+    std::filesystem::remove_all(dir);
+    state.counters["heap_per_sink"] =
+        benchmark::Counter(static_cast<double>(heap) / (count * 2),
+                           benchmark::Counter::kAvgIterations);
+  }
+
+}  // namespace
+
+BENCHMARK(BM_ConfigureSinks)
+    ->Arg(10)
+    ->Arg(100)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
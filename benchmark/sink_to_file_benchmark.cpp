@@ -0,0 +1,145 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+#include <unistd.h>
+
+#include <soralog/impl/json_escape.hpp>
+#include <soralog/impl/sink_to_file.hpp>
+
+using namespace soralog;
+
+namespace {
+
+  constexpr size_t events_per_iteration = 10000;
+
+  std::filesystem::path tmp_path() {
+    return std::filesystem::temp_directory_path()
+        / ("soralog_benchmark_" + std::to_string(::getpid()) + ".log");
+  }
+
+  /**
+   * Writes batch of typical events through sink with {@param compression}
+   * and {@param layout} per iteration. CPU time is of whole process, so it
+   * includes work of sink worker (rendering, compression and writing)
+   */
+  void writeEvents(benchmark::State &state,
+                   std::optional<SinkToFile::Compression> compression,
+                   SinkToFile::Layout layout = SinkToFile::Layout::TEXT) {
+    auto path = tmp_path();
+    size_t bytes = 0;
+
+    for (auto _ : state) {
+      {
+        SinkToFile sink("file", path, Sink::ThreadInfoType::NAME, 1u << 11,
+                        1u << 22, 100, {}, compression, layout);
+        for (size_t i = 0; i < events_per_iteration; ++i) {
+          sink.push("block_executor", Level::INFO,
+                    "Imported block #{} with hash 0x{:016x}; peers: {}",
+                    1000000 + i, i * 0x9E3779B97F4A7C15ull, i % 50);
+        }
+      }  // all events are written here
+
+      state.PauseTiming();
+      bytes += std::filesystem::file_size(path);
+      std::filesystem::remove(path);
+      state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * events_per_iteration);
+    state.counters["bytes_per_event"] = benchmark::Counter(
+        static_cast<double>(bytes)
+        / static_cast<double>(state.iterations() * events_per_iteration));
+  }
+
+  void BM_PlainFile(benchmark::State &state) {
+    writeEvents(state, std::nullopt);
+  }
+
+  void BM_JsonFile(benchmark::State &state) {
+    writeEvents(state, std::nullopt, SinkToFile::Layout::JSON);
+  }
+
+  /**
+   * Escapes message of typical size (with one quoted word) by instruction
+   * set given by argument
+   */
+  void BM_JsonEscape(benchmark::State &state) {
+    const auto isa = static_cast<json::Isa>(state.range(0));
+    const std::string message =
+        "Imported block #1000042 with hash 0x9e3779b97f4a7c15 from peer "
+        "\"12D3KooWDpJ7As7BWAwRMfu1VU2WCqNjvq387JEYKDBj4kx6nXTN\"; peers: 42";
+    std::vector<char> buffer(json::maxEscapedSize(message.size()));
+    for (auto _ : state) {
+      auto end = json::escape(buffer.data(), message, isa);
+      benchmark::DoNotOptimize(end);
+      benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * message.size());
+  }
+
+  void BM_GzipFile(benchmark::State &state) {
+    SinkToFile::Compression compression;
+    compression.codec = SinkToFile::Compression::Codec::GZIP;
+    compression.level = static_cast<int>(state.range(0));
+    writeEvents(state, compression);
+  }
+
+  /**
+   * Writes batch of events with long message (e.g. dump of block) per
+   * iteration; argument is message size, and zero-copy mode is on for
+   * second argument equal to 1
+   */
+  void BM_LongMessages(benchmark::State &state) {
+    auto path = tmp_path();
+    const std::string dump(state.range(0), 'x');
+    const bool zero_copy = state.range(1) != 0;
+
+    for (auto _ : state) {
+      {
+        SinkToFile sink("file", path, Sink::ThreadInfoType::NAME, 1u << 11,
+                        1u << 22, 100, {}, {}, {}, {}, zero_copy);
+        for (size_t i = 0; i < events_per_iteration; ++i) {
+          sink.push("block_executor", Level::DEBUG, "Block #{}: {}",
+                    1000000 + i, dump);
+        }
+      }  // all events are written here
+
+      state.PauseTiming();
+      std::filesystem::remove(path);
+      state.ResumeTiming();
+    }
+
+    state.SetItemsProcessed(state.iterations() * events_per_iteration);
+    state.SetBytesProcessed(state.iterations() * events_per_iteration
+                            * dump.size());
+  }
+
+}  // namespace
+
+BENCHMARK(BM_PlainFile)->MeasureProcessCPUTime()->UseRealTime();
+BENCHMARK(BM_JsonFile)->MeasureProcessCPUTime()->UseRealTime();
+BENCHMARK(BM_JsonEscape)
+    ->Arg(static_cast<int>(json::Isa::SCALAR))
+    ->Arg(static_cast<int>(json::Isa::SSE2))
+    ->Arg(static_cast<int>(json::Isa::AVX2));
+BENCHMARK(BM_LongMessages)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime()
+    ->Args({64, 0})
+    ->Args({64, 1})
+    ->Args({2048, 0})
+    ->Args({2048, 1});
+BENCHMARK(BM_GzipFile)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(6)
+    ->Arg(9);
+
+BENCHMARK_MAIN();
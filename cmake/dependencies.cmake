@@ -9,6 +9,11 @@ if (TESTING OR COVERAGE)
   find_package(GMock CONFIG REQUIRED)
 endif()
 
+if (BENCHMARKS)
+  hunter_add_package(benchmark)
+  find_package(benchmark CONFIG REQUIRED)
+endif()
+
 hunter_add_package(yaml-cpp)
 find_package(yaml-cpp CONFIG REQUIRED)
 if (NOT TARGET yaml-cpp::yaml-cpp)
@@ -18,3 +23,6 @@ endif()
 
 hunter_add_package(fmt)
 find_package(fmt CONFIG REQUIRED)
+
+hunter_add_package(ZLIB)
+find_package(ZLIB REQUIRED)
@@ -59,3 +59,14 @@ function(addtest_part test_name)
         GTest::gtest
     )
 endfunction()
+
+function(addbenchmark benchmark_name)
+    add_executable(${benchmark_name} ${ARGN})
+    target_link_libraries(${benchmark_name}
+        benchmark::benchmark
+    )
+    set_target_properties(${benchmark_name} PROPERTIES
+        RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/benchmark_bin
+    )
+    disable_clang_tidy(${benchmark_name})
+endfunction()
@@ -49,7 +49,6 @@ namespace soralog {
 
      public:
       NodeRef() noexcept = default;
-      NodeRef(NodeRef &&) noexcept = delete;
       NodeRef(const NodeRef &) = delete;
       NodeRef &operator=(NodeRef &&) noexcept = delete;
       NodeRef &operator=(NodeRef const &) = delete;
@@ -58,6 +57,13 @@ namespace soralog {
           : node_opt(std::ref(node)),
             ready_after_release(ready_after_release) {}
 
+      /// Consumer might hold several nodes (e.g. till they are written)
+      NodeRef(NodeRef &&other) noexcept
+          : node_opt(other.node_opt),
+            ready_after_release(other.ready_after_release) {
+        other.node_opt.reset();
+      }
+
       ~NodeRef() noexcept(IF_RELEASE) {
         if (node_opt.has_value()) {
           release();
@@ -93,10 +99,44 @@ namespace soralog {
     CircularBuffer &operator=(CircularBuffer &&) noexcept = delete;
     CircularBuffer &operator=(CircularBuffer const &) = delete;
 
-    explicit CircularBuffer(size_t capacity) : data_(capacity){};
+    /**
+     * Makes buffer of {@param capacity} nodes. If {@param lazy}, memory of
+     * nodes isn't allocated till allocate() is called; nothing might be put
+     * before that
+     */
+    explicit CircularBuffer(size_t capacity, bool lazy = false)
+        : capacity_(capacity) {
+      if (!lazy) {
+        allocate();
+      }
+    };
+
+    /**
+     * Allocates memory of nodes, if it's not done yet. Must be called before
+     * buffer is shared with other threads
+     */
+    void allocate() {
+      if (data_.empty()) {
+        data_ = std::vector<Node>(capacity_);
+      }
+    }
+
+    /**
+     * @returns memory of nodes, or nullptr if it's not allocated yet
+     */
+    const void *memory() const noexcept {
+      return data_.data();
+    }
+
+    /**
+     * @returns size of memory of nodes in bytes
+     */
+    size_t memorySize() const noexcept {
+      return data_.size() * sizeof(Node);
+    }
 
     size_t capacity() const noexcept {
-      return data_.size();
+      return capacity_;
     }
 
     size_t size() const noexcept {
@@ -104,44 +144,56 @@ namespace soralog {
     }
 
     size_t avail() const noexcept {
-      return data_.size() - size_;
+      return capacity_ - size_;
     }
 
     template <typename... Args>
     [[nodiscard]] NodeRef put(const Args &... args) noexcept(IF_RELEASE) {
-      while (true) {
-        auto push_index = push_index_.load(std::memory_order_acquire);
-        auto next_index = (push_index + 1) % data_.size();
-
-        // Tail is caught up - queue is full
-        auto pop_index = pop_index_.load(std::memory_order_acquire);
-        if (pop_index == next_index) {
-          return {};
-        }
-
-        auto &node = data_[push_index];
-
-        // Item has not consumed yet
-        if (node.ready.load(std::memory_order_acquire)) {
-          continue;
-        }
-
-        // Go to next item place
-        if (!push_index_.compare_exchange_weak(push_index, next_index,
-                                                  std::memory_order_release)) {
-          continue;
-        }
+      return emplace<true>(args...);
+    }
 
-        size_ = ((next_index < pop_index) ? data_.size() : 0)
-            + (next_index - pop_index);
+    /**
+     * Same as put(), but doesn't wait for consumer to free place, so never
+     * spins (e.g. in signal handler, which might interrupt the consumer)
+     */
+    template <typename... Args>
+    [[nodiscard]] NodeRef tryPut(const Args &... args) noexcept(IF_RELEASE) {
+      return emplace<false>(args...);
+    }
 
-        // Emplace item
-        new (&node) Node(args...);
-        return NodeRef{node, true};
+    /**
+     * Drops all items. Must be called when nobody else uses buffer (e.g. in
+     * child process after fork(), where threads of parent don't exist)
+     */
+    void clear() noexcept {
+      for (auto &node : data_) {
+        node.ready.store(false, std::memory_order_relaxed);
       }
+      push_index_.store(0, std::memory_order_relaxed);
+      pop_index_.store(0, std::memory_order_relaxed);
+      size_.store(0, std::memory_order_release);
     }
 
     NodeRef get() noexcept(IF_RELEASE) {
+      return pop<true>();
+    }
+
+    /**
+     * Same as get(), but doesn't wait for item which is still being
+     * constructed, so never spins (e.g. in signal handler, which might
+     * interrupt the producer, or crash it)
+     */
+    NodeRef tryGet() noexcept(IF_RELEASE) {
+      return pop<false>();
+    }
+
+   private:
+    /**
+     * Takes the oldest item; if {@tparam wait} is false, doesn't wait for
+     * item which is still being constructed
+     */
+    template <bool wait>
+    NodeRef pop() noexcept(IF_RELEASE) {
       while (true) {
         auto pop_index = pop_index_.load(std::memory_order_acquire);
 
@@ -153,27 +205,72 @@ namespace soralog {
 
         auto &node = data_[pop_index];
 
-        // Item is already consumed
+        // Item is already consumed, or is not constructed yet
         if (!node.ready.load(std::memory_order_acquire)) {
+          if constexpr (!wait) {
+            return {};
+          }
           continue;
         }
 
         // Go to next item
-        auto next_index = (pop_index + 1) % data_.size();
+        auto next_index = (pop_index + 1) % capacity_;
         if (!pop_index_.compare_exchange_weak(pop_index, next_index,
                                                  std::memory_order_release)) {
           continue;
         }
 
-        size_ = ((push_index < next_index) ? data_.size() : 0)
+        size_ = ((push_index < next_index) ? capacity_ : 0)
             + (push_index - next_index);
 
         return NodeRef{node, false};
       }
     }
 
-   private:
+    /**
+     * Emplaces item; if {@tparam wait} is false, doesn't wait for slot which
+     * is still being consumed
+     */
+    template <bool wait, typename... Args>
+    NodeRef emplace(const Args &... args) noexcept(IF_RELEASE) {
+      assert(!data_.empty());
+      while (true) {
+        auto push_index = push_index_.load(std::memory_order_acquire);
+        auto next_index = (push_index + 1) % capacity_;
+
+        // Tail is caught up - queue is full
+        auto pop_index = pop_index_.load(std::memory_order_acquire);
+        if (pop_index == next_index) {
+          return {};
+        }
+
+        auto &node = data_[push_index];
+
+        // Item has not consumed yet
+        if (node.ready.load(std::memory_order_acquire)) {
+          if constexpr (!wait) {
+            return {};
+          }
+          continue;
+        }
+
+        // Go to next item place
+        if (!push_index_.compare_exchange_weak(push_index, next_index,
+                                                  std::memory_order_release)) {
+          continue;
+        }
+
+        size_ = ((next_index < pop_index) ? capacity_ : 0)
+            + (next_index - pop_index);
+
+        // Emplace item
+        new (&node) Node(args...);
+        return NodeRef{node, true};
+      }
+    }
+
     std::atomic_size_t size_ = 0;
+    const size_t capacity_;
     std::vector<Node> data_;
     std::atomic_size_t push_index_ = 0;
     std::atomic_size_t pop_index_ = 0;
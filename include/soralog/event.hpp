@@ -6,19 +6,35 @@
 #ifndef SORALOG_EVENT
 #define SORALOG_EVENT
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <string_view>
+#include <tuple>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#include <soralog/field.hpp>
 #include <soralog/level.hpp>
 #include <soralog/sink.hpp>
 #include <soralog/util.hpp>
 
 namespace soralog {
 
+  namespace detail {
+
+    template <typename Arg>
+    auto unlessField(const Arg &arg) {
+      if constexpr (IsField<Arg>::value) {
+        return std::tuple<>{};
+      } else {
+        return std::tuple<const Arg &>{arg};
+      }
+    }
+
+  }  // namespace detail
+
   /**
    * @class Event
    * Data of logging event
@@ -34,10 +50,15 @@ namespace soralog {
     Event &operator=(Event &&) noexcept = delete;
     Event &operator=(Event const &) = delete;
 
+    /// Max size of encoded fields of event. Fields take the beginning of
+    /// buffer of message, so event without fields doesn't pay for them
+    static constexpr size_t max_fields_size = 512;
+
     /**
      * @param name of logger
      * @param level of event
-     * @param format and @param args defines message of event
+     * @param format and @param args defines message of event; arguments
+     * made by kv() are not used by format, but kept as fields of event
      */
     template <typename ThreadInfoType, typename... Args>
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
@@ -57,11 +78,26 @@ namespace soralog {
       }
 
       try {
-        message_size_ =
-            fmt::format_to_n(message_.begin(), message_.size(), format, args...)
-                .size;
+        if constexpr ((IsField<Args>::value || ...)) {
+          char *ptr = data_.data();
+          const char *end = data_.data() + max_fields_size;  // NOLINT
+          (putField(ptr, end, args), ...);
+          fields_size_ = ptr - data_.data();
+
+          message_size_ = std::apply(
+              [&](const auto &... format_args) {
+                return fmt::format_to_n(messageBegin(), maxMessageSize(),
+                                        format, format_args...)
+                    .size;
+              },
+              std::tuple_cat(detail::unlessField(args)...));
+        } else {
+          message_size_ = fmt::format_to_n(messageBegin(), maxMessageSize(),
+                                           format, args...)
+                              .size;
+        }
       } catch (const std::exception &exception) {
-        message_size_ = fmt::format_to_n(message_.begin(), message_.size(),
+        message_size_ = fmt::format_to_n(messageBegin(), maxMessageSize(),
                                          "Format error: {}; Format: {}",
                                          exception.what(), format)
                             .size;
@@ -69,11 +105,41 @@ namespace soralog {
         level_ = Level::ERROR_;
       }
 
-      message_size_ = std::min(message_.size(), message_size_);
+      message_size_ = std::min(maxMessageSize(), message_size_);
       name_size_ = std::min(name.size(), name_.size());
       std::copy_n(name.begin(), name_size_, name_.begin());
     }
 
+    /**
+     * Makes copy of event happened elsewhere (e.g. in other process)
+     * @param timestamp is time when event was happened
+     * @param thread_number and @param thread_name define origin thread
+     * @param name of logger
+     * @param level of event
+     * @param message of event
+     * @param fields are encoded fields of event (see Fields)
+     */
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    Event(std::chrono::system_clock::time_point timestamp,
+          size_t thread_number, std::string_view thread_name,
+          std::string_view name, Level level, std::string_view message,
+          std::string_view fields = {})
+        : timestamp_(timestamp),
+          thread_number_(thread_number),
+          thread_name_size_(std::min(thread_name.size(), size_t(15))),
+          name_size_(std::min(name.size(), name_.size())),
+          level_(level),
+          // Fields are cut only if they are corrupted anyway
+          fields_size_(fields.size() <= max_fields_size ? fields.size() : 0) {
+      message_size_ = std::min(message.size(), maxMessageSize());
+      std::copy_n(thread_name.begin(), thread_name_size_,
+                  thread_name_.begin());
+      thread_name_[thread_name_size_] = '\0';  // NOLINT
+      std::copy_n(name.begin(), name_size_, name_.begin());
+      std::copy_n(fields.begin(), fields_size_, data_.begin());
+      std::copy_n(message.begin(), message_size_, messageBegin());
+    }
+
     /**
      * @returns time when event is happened
      */
@@ -113,10 +179,32 @@ namespace soralog {
      * @returns message of event
      */
     std::string_view message() const noexcept {
-      return {message_.data(), message_size_};
+      return {data_.data() + fields_size_, message_size_};  // NOLINT
+    }
+
+    /**
+     * @returns fields of event
+     */
+    Fields fields() const noexcept {
+      return Fields({data_.data(), fields_size_});
     }
 
    private:
+    char *messageBegin() noexcept {
+      return data_.data() + fields_size_;  // NOLINT
+    }
+
+    size_t maxMessageSize() const noexcept {
+      return data_.size() - fields_size_;
+    }
+
+    template <typename Arg>
+    static void putField(char *&ptr, const char *end, const Arg &arg) {
+      if constexpr (IsField<Arg>::value) {
+        Fields::put(ptr, end, arg);
+      }
+    }
+
     std::chrono::system_clock::time_point timestamp_;
     size_t thread_number_ = 0;
     std::array<char, 16> thread_name_;
@@ -124,9 +212,17 @@ namespace soralog {
     std::array<char, 32> name_;
     size_t name_size_;
     Level level_ = Level::OFF;
-    std::array<char, 4096> message_;
+    /// Encoded fields followed by message
+    std::array<char, 4096> data_;
+    size_t fields_size_ = 0;
     size_t message_size_;
   };
+
+  /// Max size of event rendered as text: prefix and message take no more
+  /// than event itself, and rendered fields are larger than encoded ones
+  constexpr size_t max_text_event_size = sizeof(Event)
+      + Fields::maxTextSize(Event::max_fields_size) - Event::max_fields_size;
+
 }  // namespace soralog
 
 #endif  // SORALOG_EVENT
@@ -0,0 +1,177 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_FIELD
+#define SORALOG_FIELD
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <fmt/format.h>
+
+namespace soralog {
+
+  /// Type of value of field
+  enum class FieldType : uint8_t {
+    INT = 1,
+    UINT = 2,
+    DOUBLE = 3,
+    BOOL = 4,
+    STRING = 5,
+  };
+
+  /**
+   * Typed key-value field of event, made by kv(). Key must outlive event
+   * construction (normally it's string literal)
+   */
+  template <typename T>
+  struct Field {
+    std::string_view key;
+    T value;
+  };
+
+  template <typename T>
+  struct IsField : std::false_type {};
+
+  template <typename T>
+  struct IsField<Field<T>> : std::true_type {};
+
+  /**
+   * Makes field {@param key} with {@param value} to be passed with arguments
+   * of message, e.g.:
+   *   SL_INFO(log, "Imported block", kv("number", n), kv("hash", h));
+   * Integers, floating point numbers, booleans and strings keep their type;
+   * value of any other type is formatted by fmt and kept as string
+   */
+  template <typename T>
+  auto kv(std::string_view key, T &&value) {
+    using V = std::decay_t<T>;
+    if constexpr (std::is_same_v<V, bool>) {
+      return Field<bool>{key, value};
+    } else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>) {
+      return Field<int64_t>{key, value};
+    } else if constexpr (std::is_integral_v<V>) {
+      return Field<uint64_t>{key, value};
+    } else if constexpr (std::is_floating_point_v<V>) {
+      return Field<double>{key, value};
+    } else if constexpr (std::is_same_v<V, std::string>
+                         && !std::is_lvalue_reference_v<T>) {
+      // Temporary string is kept by field itself
+      return Field<std::string>{key, std::forward<T>(value)};
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      return Field<std::string_view>{key, value};
+    } else {
+      return Field<std::string>{key, fmt::format("{}", value)};
+    }
+  }
+
+  /**
+   * @class Fields
+   * View of fields encoded compactly in event. Each field is:
+   *   1 byte of type, 1 byte of key size, bytes of key, value:
+   *   INT - zigzag varint, UINT - varint, DOUBLE - 8 bytes (little endian),
+   *   BOOL - 1 byte, STRING - varint size and bytes
+   */
+  class Fields final {
+   public:
+    /// Decoded field. Views are valid while encoded data are
+    struct View {
+      std::string_view key;
+      FieldType type = FieldType::INT;
+      int64_t int_value = 0;
+      uint64_t uint_value = 0;
+      double double_value = 0;
+      bool bool_value = false;
+      std::string_view string_value;
+    };
+
+    Fields() = default;
+    explicit Fields(std::string_view data) : data_(data) {}
+
+    /**
+     * Encodes {@param field} at {@param ptr} not further than {@param end}.
+     * String value is cut to fit; field of other type is skipped if there
+     * is no room for it
+     */
+    template <typename T>
+    static void put(char *&ptr, const char *end, const Field<T> &field) {
+      if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, int64_t>
+                    || std::is_same_v<T, uint64_t>
+                    || std::is_same_v<T, double>) {
+        put(ptr, end, field.key, field.value);
+      } else {
+        put(ptr, end, field.key, std::string_view(field.value));
+      }
+    }
+
+    /**
+     * Encodes field {@param key} of {@param value}; see above
+     */
+    static void put(char *&ptr, const char *end, std::string_view key,
+                    int64_t value);
+    static void put(char *&ptr, const char *end, std::string_view key,
+                    uint64_t value);
+    static void put(char *&ptr, const char *end, std::string_view key,
+                    double value);
+    static void put(char *&ptr, const char *end, std::string_view key,
+                    bool value);
+    static void put(char *&ptr, const char *end, std::string_view key,
+                    std::string_view value);
+
+    /**
+     * Calls {@param fn} for each field; malformed tail is ignored
+     */
+    template <typename Fn>
+    void forEach(const Fn &fn) const {
+      const char *ptr = data_.data();
+      const char *const end = data_.data() + data_.size();  // NOLINT
+      View field;
+      while (next(ptr, end, field)) {
+        fn(field);
+      }
+    }
+
+    /**
+     * @returns max size of fields encoded in {@param size} bytes rendered by
+     * putText()
+     */
+    static constexpr size_t maxTextSize(size_t size) {
+      return size * 3;
+    }
+
+    /**
+     * Renders fields as text (` key=value` for each one) at {@param ptr}.
+     * String value is quoted if it's empty or contains space, quote,
+     * backslash or '='
+     */
+    void putText(char *&ptr) const;
+
+    bool empty() const noexcept {
+      return data_.empty();
+    }
+
+    /**
+     * @returns encoded fields
+     */
+    std::string_view data() const noexcept {
+      return data_;
+    }
+
+   private:
+    /**
+     * Decodes field at {@param ptr} not further than {@param end} into
+     * {@param field}
+     * @returns false if there are no more fields, or the rest is malformed
+     */
+    static bool next(const char *&ptr, const char *end, View &field);
+
+    std::string_view data_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_FIELD
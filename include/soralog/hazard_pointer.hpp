@@ -0,0 +1,151 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_HAZARDPOINTER
+#define SORALOG_HAZARDPOINTER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace soralog::hazard {
+
+  /// Number of guards which thread might hold at once (e.g. when message
+  /// formatting logs something itself)
+  constexpr size_t slots_per_thread = 4;
+
+  /**
+   * Hazard pointers of thread. Records are never freed: record of finished
+   * thread is taken by new one
+   */
+  struct Record {
+    std::array<std::atomic<const void *>, slots_per_thread> slots{};
+    /// Number of busy slots; it's changed by owner thread only
+    size_t used = 0;
+    std::atomic_bool active = false;
+    Record *next = nullptr;
+  };
+
+  /**
+   * @returns record of current thread, taking it on first call
+   */
+  Record &acquireRecord();
+
+  /// Record of current thread, or nullptr if it has not taken one yet
+  inline thread_local Record *current_record = nullptr;
+
+  /// Number of readers which protect objects without slot; nothing is
+  /// deleted while there are any
+  inline std::atomic_size_t unslotted_readers = 0;
+
+  /**
+   * Deletes {@param ptr} by {@param deleter} once no reader protects it.
+   * Pointer must be already replaced in its source, so new readers can't
+   * get it
+   */
+  void retire(const void *ptr, void (*deleter)(const void *));
+
+  /**
+   * Deletes retired objects which are not protected anymore
+   */
+  void reclaim();
+
+  /**
+   * Locks list of retired objects before fork(), so that child doesn't get
+   * it locked by thread which doesn't exist there
+   */
+  void prepareFork();
+
+  /**
+   * Unlocks list of retired objects in parent after fork()
+   */
+  void resumeAfterFork();
+
+  /**
+   * Reinitializes lock of list of retired objects in child after fork(),
+   * and drops hazards of threads which don't exist in child
+   */
+  void resetAfterFork();
+
+}  // namespace soralog::hazard
+
+namespace soralog {
+
+  /**
+   * @class HazardGuard
+   * Reads object from atomic pointer, which is replaced by writers, and
+   * protects it against deletion while guard exists, without locks and
+   * counting of references. Writer replaces pointer and passes previous
+   * object to hazard::retire().
+   * Guard takes slot of hazard pointer of its thread; if there is no free
+   * slot (or guard is made in signal handler, where slots can't be used),
+   * it's counted as unslotted reader, which defers all deletions
+   */
+  template <typename T>
+  class HazardGuard final {
+   public:
+    HazardGuard(HazardGuard &&) noexcept = delete;
+    HazardGuard(const HazardGuard &) = delete;
+    HazardGuard &operator=(HazardGuard &&) noexcept = delete;
+    HazardGuard &operator=(HazardGuard const &) = delete;
+
+    /**
+     * Protects object of {@param source}. If {@param in_signal}, guard is
+     * async-signal-safe
+     */
+    explicit HazardGuard(const std::atomic<T *> &source,
+                         bool in_signal = false) noexcept {
+      auto *record = in_signal ? nullptr : hazard::current_record;
+      if (!in_signal && record == nullptr) {
+        record = &hazard::acquireRecord();
+      }
+      if (record != nullptr && record->used < hazard::slots_per_thread) {
+        record_ = record;
+        auto &slot = record->slots[record->used++];  // NOLINT
+        ptr_ = source.load(std::memory_order_acquire);
+        while (true) {
+          slot.store(ptr_, std::memory_order_seq_cst);
+          auto *actual = source.load(std::memory_order_seq_cst);
+          if (actual == ptr_) {
+            break;
+          }
+          ptr_ = actual;
+        }
+      } else {
+        hazard::unslotted_readers.fetch_add(1, std::memory_order_seq_cst);
+        ptr_ = source.load(std::memory_order_seq_cst);
+      }
+    }
+
+    ~HazardGuard() {
+      if (record_ != nullptr) {
+        // Guards are nested, so the last taken slot is released
+        record_->slots[--record_->used].store(  // NOLINT
+            nullptr, std::memory_order_release);
+      } else {
+        hazard::unslotted_readers.fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    T *get() const noexcept {
+      return ptr_;
+    }
+
+    T *operator->() const noexcept {
+      return ptr_;
+    }
+
+    T &operator*() const noexcept {
+      return *ptr_;
+    }
+
+   private:
+    hazard::Record *record_ = nullptr;
+    T *ptr_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_HAZARDPOINTER
@@ -0,0 +1,165 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_BINARYFORMAT
+#define SORALOG_BINARYFORMAT
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * Compact binary log format
+ *
+ * File begins with header: 8 bytes of magic and 1 byte of version.
+ * Then records follow. Each record is:
+ *   varint  - size of body
+ *   body    - 1 byte of type, and fields depending on type
+ *   uint32  - CRC-32 of body (little endian)
+ *
+ * Records of types:
+ *   SESSION - varint microseconds since epoch;
+ *             starts new session: resets dictionaries and time base
+ *   NAME    - varint id, varint size, bytes; defines name of logger
+ *   THREAD  - varint id, varint number, varint size, bytes; defines thread
+ *   EVENT   - zigzag-varint delta of time (in microseconds) from previous
+ *             event (or session start), 1 byte of level, varint id of name,
+ *             varint id of thread (0 - none), varint size, bytes of message,
+ *             and fields of event (see Fields) up to the end of body
+ *
+ * Writer appends new session each time when file is (re)opened, so file is
+ * self-contained and might be appended by several runs. Reader stops at first
+ * broken record (e.g. torn by crash) having all preceding records decoded.
+ */
+
+namespace soralog::binary_format {
+
+  constexpr std::string_view magic = "SORALOGB";
+  constexpr uint8_t version = 1;
+  constexpr size_t header_size = magic.size() + 1;
+
+  /// Max size of varint encoding of 64-bit value
+  constexpr size_t max_varint_size = 10;
+
+  /// Size of checksum following each record
+  constexpr size_t checksum_size = 4;
+
+  enum class RecordType : uint8_t {
+    SESSION = 1,
+    NAME = 2,
+    THREAD = 3,
+    EVENT = 4,
+  };
+
+  constexpr size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      ++size;
+    }
+    return size;
+  }
+
+  inline void putVarint(char *&ptr, uint64_t value) {
+    while (value >= 0x80) {
+      *ptr++ = static_cast<char>((value & 0x7f) | 0x80);  // NOLINT
+      value >>= 7;
+    }
+    *ptr++ = static_cast<char>(value);  // NOLINT
+  }
+
+  /**
+   * Reads varint from {@param ptr} not further than {@param end}
+   * @returns false if data is truncated or malformed
+   */
+  inline bool getVarint(const char *&ptr, const char *end, uint64_t &value) {
+    value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+      if (ptr >= end) {
+        return false;
+      }
+      auto byte = static_cast<uint8_t>(*ptr++);  // NOLINT
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  constexpr uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1)
+        ^ static_cast<uint64_t>(value >> 63);
+  }
+
+  constexpr int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  inline void putString(char *&ptr, std::string_view str) {
+    putVarint(ptr, str.size());
+    std::memcpy(ptr, str.data(), str.size());
+    ptr += str.size();  // NOLINT
+  }
+
+  inline bool getString(const char *&ptr, const char *end,
+                        std::string_view &str) {
+    uint64_t size = 0;
+    if (!getVarint(ptr, end, size) || size > static_cast<size_t>(end - ptr)) {
+      return false;
+    }
+    str = {ptr, size};
+    ptr += size;  // NOLINT
+    return true;
+  }
+
+  namespace detail {
+    constexpr std::array<uint32_t, 256> crc32_table = [] {
+      std::array<uint32_t, 256> table{};
+      for (uint32_t i = 0; i < table.size(); ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+          crc = (crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+        }
+        table[i] = crc;  // NOLINT
+      }
+      return table;
+    }();
+  }  // namespace detail
+
+  /**
+   * @returns CRC-32 (IEEE) of {@param size} bytes of {@param data}
+   */
+  inline uint32_t crc32(const char *data, size_t size) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+      crc = detail::crc32_table[(crc ^ static_cast<uint8_t>(data[i])) & 0xff]
+          ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+  }
+
+  inline void putChecksum(char *&ptr, const char *body, size_t size) {
+    auto crc = crc32(body, size);
+    for (size_t i = 0; i < checksum_size; ++i) {
+      *ptr++ = static_cast<char>(crc >> (i * 8));  // NOLINT
+    }
+  }
+
+  inline uint32_t getChecksum(const char *ptr) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < checksum_size; ++i) {
+      crc |= static_cast<uint32_t>(static_cast<uint8_t>(ptr[i]))  // NOLINT
+          << (i * 8);
+    }
+    return crc;
+  }
+
+}  // namespace soralog::binary_format
+
+#endif  // SORALOG_BINARYFORMAT
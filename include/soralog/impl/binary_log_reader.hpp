@@ -0,0 +1,103 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_BINARYLOGREADER
+#define SORALOG_BINARYLOGREADER
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <soralog/level.hpp>
+
+namespace soralog {
+
+  /**
+   * @class BinaryLogReader
+   * Sequential reader of files written by SinkToBinaryFile
+   */
+  class BinaryLogReader final {
+   public:
+    /**
+     * Decoded event. Views are valid till next call of reader
+     */
+    struct Event {
+      std::chrono::system_clock::time_point timestamp;
+      Level level = Level::OFF;
+      std::string_view name;
+      /// Number of thread; 0 - thread is not recorded
+      size_t thread_number = 0;
+      std::string_view thread_name;
+      std::string_view message;
+      /// Encoded fields (see Fields)
+      std::string_view fields;
+    };
+
+    enum class Status {
+      OK,          //!< Reading is in progress
+      END,         //!< File is read completely
+      TORN,        //!< Last record is incomplete (e.g. writer crashed)
+      CORRUPTED,   //!< Record is broken (checksum or format mismatch)
+      BAD_HEADER,  //!< File is not binary log, or has unsupported version
+      NOT_OPENED,  //!< File can't be opened
+    };
+
+    BinaryLogReader(BinaryLogReader &&) noexcept = delete;
+    BinaryLogReader(const BinaryLogReader &) = delete;
+    BinaryLogReader &operator=(BinaryLogReader &&) noexcept = delete;
+    BinaryLogReader &operator=(BinaryLogReader const &) = delete;
+
+    explicit BinaryLogReader(const std::filesystem::path &path);
+    ~BinaryLogReader() = default;
+
+    /**
+     * @returns next event, or nullopt if there are no more events. In last
+     * case status() explains the reason
+     */
+    std::optional<Event> next();
+
+    /**
+     * @returns status of reading
+     */
+    Status status() const noexcept {
+      return status_;
+    }
+
+    /**
+     * @returns offset in file of end of last successfully decoded record
+     */
+    size_t offset() const noexcept {
+      return offset_;
+    }
+
+   private:
+    /**
+     * Ensures that at least {@param size} bytes are available in buffer
+     * (reading file if needed)
+     * @returns false if file ends earlier
+     */
+    bool fill(size_t size);
+
+    std::ifstream in_;
+    std::vector<char> buff_;
+    size_t begin_ = 0;  // position of unread data in buffer
+    size_t end_ = 0;    // end of data in buffer
+    size_t offset_ = 0;
+    Status status_ = Status::OK;
+
+    // State of current session
+    int64_t prev_time_ = 0;
+    std::unordered_map<uint64_t, std::string> names_;
+    std::unordered_map<uint64_t, std::pair<size_t, std::string>> threads_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_BINARYLOGREADER
@@ -0,0 +1,86 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_CONFIGWATCHER
+#define SORALOG_CONFIGWATCHER
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#include <soralog/logging_system.hpp>
+
+namespace soralog {
+
+  /**
+   * @class ConfigWatcher
+   * Watches config file and reconfigures logging system (see
+   * LoggingSystem::reconfigure) each time file is rewritten or replaced.
+   * Logging system is expected to be configured by ConfiguratorFromYAML with
+   * the same file, so only changed sinks and groups are touched.
+   * On Linux file is watched by inotify; on other systems modification time
+   * of file is polled
+   */
+  class ConfigWatcher final {
+   public:
+    using Callback = std::function<void(const Configurator::Result &)>;
+
+    /// Series of changes made within this time causes single reload
+    static constexpr auto debounce = std::chrono::milliseconds(100);
+
+    /// How often modification time is checked where inotify is unavailable
+    static constexpr auto poll_interval = std::chrono::milliseconds(500);
+
+    ConfigWatcher(ConfigWatcher &&) noexcept = delete;
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(ConfigWatcher &&) noexcept = delete;
+    ConfigWatcher &operator=(ConfigWatcher const &) = delete;
+    ~ConfigWatcher();
+
+    /**
+     * @param system is configured logging system
+     * @param path is config file
+     * @param on_reload is called (in thread of watcher) with result of each
+     * reload; by default problems of config are printed to stderr
+     * @throws std::system_error if file can't be watched
+     */
+    ConfigWatcher(LoggingSystem &system, std::filesystem::path path,
+                  Callback on_reload = {});
+
+    /**
+     * @returns number of done reloads
+     */
+    size_t reloads() const noexcept {
+      return reloads_.load(std::memory_order_acquire);
+    }
+
+   private:
+    void run();
+
+    /**
+     * Waits till config is changed or watcher is stopped
+     * @returns false if watcher is stopped
+     */
+    bool wait();
+
+    void reload();
+
+    LoggingSystem &system_;
+    const std::filesystem::path path_;
+    Callback on_reload_;
+
+    int inotify_fd_ = -1;
+    int stop_fds_[2] = {-1, -1};
+    std::filesystem::file_time_type last_write_time_{};
+
+    std::atomic_size_t reloads_{0};
+    std::thread worker_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_CONFIGWATCHER
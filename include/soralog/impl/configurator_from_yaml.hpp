@@ -9,10 +9,13 @@
 #include <soralog/configurator.hpp>
 
 #include <filesystem>
+#include <map>
+#include <set>
 #include <variant>
 
 #include <yaml-cpp/yaml.h>
 
+#include <soralog/impl/sink_to_file.hpp>
 #include <soralog/logging_system.hpp>
 
 namespace soralog {
@@ -21,6 +24,13 @@ namespace soralog {
    * @class ConfiguratorFromYAML
    * @brief This configurator for set up Logging System in according with
    * config using YAML format.
+   *
+   * Being applied again (see LoggingSystem::reconfigure), it reloads config
+   * and applies only difference with previously applied one: changed and new
+   * sinks are made, sinks with the same properties are kept as is (with
+   * their threads and queues), disappeared sinks are retired, and groups get
+   * actual parents, sinks and levels. Underlying configurator is applied
+   * only once
    */
   class ConfiguratorFromYAML : public Configurator {
    public:
@@ -59,18 +69,24 @@ namespace soralog {
    private:
     std::shared_ptr<Configurator> previous_;
     std::variant<std::filesystem::path, std::string> config_;
+    /// Properties (as YAML-dump) of sinks made by last application
+    mutable std::optional<std::map<std::string, std::string>> applied_sinks_;
 
     /**
      * Helper-class to parse config and create sinks and groups during that
      */
     class Applicator {
      public:
-      Applicator(LoggingSystem &system,
-                 std::variant<std::filesystem::path, std::string> config,
-                 std::shared_ptr<Configurator> previous = {})
+      Applicator(
+          LoggingSystem &system,
+          std::variant<std::filesystem::path, std::string> config,
+          std::shared_ptr<Configurator> previous,
+          std::optional<std::map<std::string, std::string>> &applied_sinks)
           : system_(system),
             previous_(std::move(previous)),
-            config_(std::move(config)) {}
+            config_(std::move(config)),
+            applied_sinks_(applied_sinks),
+            reload_(applied_sinks.has_value()) {}
 
       Result run() &&;
 
@@ -81,12 +97,132 @@ namespace soralog {
 
       void parseSink(int number, const YAML::Node &sink);
 
+      /**
+       * @returns true if sink {@param name} was made by previous application
+       * with the same properties {@param dump}, and sinks it refers to are
+       * kept too
+       */
+      bool isSinkUnchanged(const std::string &name, const std::string &dump,
+                           const YAML::Node &sink_node) const;
+
+      /**
+       * @returns true if sink {@param name} is already defined, so defining
+       * it again overrides previous definition
+       */
+      bool isSinkDefined(const std::string &name) const;
+
+      /**
+       * Retires sinks made by previous application, but absent in config
+       */
+      void retireSinks();
+
+      /**
+       * Makes sink with type {@tparam SinkType} using arguments
+       * {@param args}; filter, fork policy and placement of worker of sink
+       * are set before sink is added to system
+       */
+      template <typename SinkType, typename... Args>
+      void makeFilteredSink(Args &&... args) {
+        auto sink = std::make_shared<SinkType>(std::forward<Args>(args)...);
+        sink->setFilter(filter_);
+        sink->setForkPolicy(fork_policy_);
+        if (!worker_placement_.empty()) {
+          sink->setWorkerPlacement(worker_placement_);
+        }
+        system_.addSink(std::move(sink));
+      }
+
+      /**
+       * @returns true if {@param key} is property common for all sinks
+       */
+      static bool isSinkProperty(const std::string &key);
+
+      /**
+       * Parses properties common for all sinks
+       */
+      void parseSinkProperties(const std::string &name,
+                               const YAML::Node &sink_node,
+                               Sink::ThreadInfoType &thread_info_type,
+                               std::optional<size_t> &capacity,
+                               std::optional<size_t> &buffer_size,
+                               std::optional<size_t> &latency);
+
       void parseSinkToConsole(const std::string &name,
                               const YAML::Node &sink_node);
 
       void parseSinkToFile(const std::string &name,
                            const YAML::Node &sink_node);
 
+      void parseSinkToBinaryFile(const std::string &name,
+                                 const YAML::Node &sink_node);
+
+      void parseSinkToSyslog(const std::string &name,
+                             const YAML::Node &sink_node);
+
+      void parseSinkToSocket(const std::string &name,
+                             const YAML::Node &sink_node);
+
+      void parseSinkToShm(const std::string &name,
+                          const YAML::Node &sink_node);
+
+      void parseSinkToCrashRing(const std::string &name,
+                                const YAML::Node &sink_node);
+
+      void parseSinkToFlightRecorder(const std::string &name,
+                                     const YAML::Node &sink_node);
+
+      std::optional<SinkToFile::RotationPolicy> parseRotation(
+          const std::string &name, const YAML::Node &rotation_node);
+
+      /**
+       * Parses property 'pattern' of text sink; malformed pattern is
+       * reported, and default one is used instead
+       */
+      std::optional<std::string> parsePattern(const std::string &name,
+                                              const YAML::Node &sink_node);
+
+      /**
+       * Parses property 'filter' common for all sinks: rule or sequence of
+       * rules (see SinkFilter::Rule), e.g.
+       *   filter:
+       *     - level: warning
+       *       logger: network.*
+       *     - level: info
+       *       group: [main, consensus]
+       *       contains: imported
+       *       regex: "block #\\d+"
+       * @returns nullptr if there is no filter or it is malformed (that is
+       * reported as error)
+       */
+      std::shared_ptr<const SinkFilter> parseFilter(
+          const std::string &name, const YAML::Node &sink_node);
+
+      /**
+       * Parses property 'at_fork' of sink: 'restart' (default), 'reopen' or
+       * 'disable' (see Sink::ForkPolicy)
+       */
+      Sink::ForkPolicy parseForkPolicy(const std::string &name,
+                                       const YAML::Node &sink_node);
+
+      /**
+       * Parses property 'worker' of sink (see WorkerPlacement), e.g.
+       *   worker:
+       *     cpus: 0-3,8        # or [0, 1, 2, 3, 8]
+       *     numa_node: 0
+       *     policy: idle       # normal (default), batch or idle
+       *     nice: 10
+       */
+      WorkerPlacement parseWorkerPlacement(const std::string &name,
+                                           const YAML::Node &sink_node);
+
+      /**
+       * Parses boolean {@param property} of sink (e.g. 'zero_copy' or 'utc'
+       * of text sink)
+       */
+      std::optional<bool> parseFlag(const std::string &name,
+                                    const YAML::Node &sink_node,
+                                    const char *property);
+
       void parseGroups(const YAML::Node &groups,
                        const std::optional<std::string> &parent);
 
@@ -96,6 +232,19 @@ namespace soralog {
       LoggingSystem &system_;
       std::shared_ptr<Configurator> previous_ = nullptr;
       std::variant<std::filesystem::path, std::string> config_;
+      std::optional<std::map<std::string, std::string>> &applied_sinks_;
+      /// True if config is applied again
+      const bool reload_;
+      /// Properties of sinks of config being applied
+      std::map<std::string, std::string> parsed_sinks_;
+      /// Sinks made anew by this application
+      std::set<std::string> made_sinks_;
+      /// Filter of sink being parsed
+      std::shared_ptr<const SinkFilter> filter_;
+      /// Fork policy of sink being parsed
+      Sink::ForkPolicy fork_policy_ = Sink::ForkPolicy::RESTART;
+      /// Placement of worker of sink being parsed
+      WorkerPlacement worker_placement_;
       bool has_warning_ = false;
       bool has_error_ = false;
       std::ostringstream errors_;
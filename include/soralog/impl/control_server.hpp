@@ -0,0 +1,86 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_CONTROLSERVER
+#define SORALOG_CONTROLSERVER
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <soralog/logging_system.hpp>
+
+namespace soralog {
+
+  /**
+   * @class ControlServer
+   * Control endpoint of running logging system on Unix domain socket. Own
+   * thread serves clients one by one; client which sends nothing for
+   * client_timeout is disconnected. Client sends commands line by line;
+   * reply to each command is several lines of data followed by line 'OK',
+   * or line 'ERROR <reason>'. Commands:
+   *   help                            - list of commands
+   *   groups                          - groups with parent, level and sink
+   *   loggers                         - loggers with group, level and sink
+   *   sinks                           - sinks with statistics of queue
+   *   level group|logger NAME LEVEL   - sets level ('reset' to inherit it)
+   *   flush [SINK]                    - writes queued events of sink (all)
+   *   rotate [SINK]                   - reopens file of sink (all)
+   * See tool soralogctl
+   */
+  class ControlServer final {
+   public:
+    /// Longest accepted command
+    static constexpr size_t max_line_size = 4096;
+
+    /// Default time for which silent client may hold server
+    static constexpr std::chrono::milliseconds default_client_timeout =
+        std::chrono::seconds(10);
+
+    ControlServer(ControlServer &&) noexcept = delete;
+    ControlServer(const ControlServer &) = delete;
+    ControlServer &operator=(ControlServer &&) noexcept = delete;
+    ControlServer &operator=(ControlServer const &) = delete;
+    ~ControlServer();
+
+    /**
+     * Listens socket {@param path} to control {@param system}. Stale socket
+     * file is replaced, but other file is not. Socket is accessible by owner
+     * only since it's created. Client which sends nothing for
+     * {@param client_timeout} is disconnected
+     * @throws std::system_error if socket can't be listened
+     */
+    ControlServer(
+        LoggingSystem &system, std::filesystem::path path,
+        std::chrono::milliseconds client_timeout = default_client_timeout);
+
+    /**
+     * @returns reply to {@param command}, ended by line 'OK' or 'ERROR ...'
+     */
+    std::string execute(std::string_view command);
+
+   private:
+    void run();
+
+    /**
+     * Serves commands of client connected by {@param fd} till it disconnects
+     * or server is stopped
+     */
+    void serve(int fd);
+
+    LoggingSystem &system_;
+    const std::filesystem::path path_;
+    const std::chrono::milliseconds client_timeout_;
+
+    int listen_fd_ = -1;
+    int stop_fds_[2] = {-1, -1};
+    std::thread worker_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_CONTROLSERVER
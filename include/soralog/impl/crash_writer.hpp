@@ -0,0 +1,103 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_CRASHWRITER
+#define SORALOG_CRASHWRITER
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include <soralog/sink.hpp>
+
+namespace soralog {
+
+  class LinePattern;
+
+  /**
+   * @class CrashWriter
+   * Renders events in layout of sink and writes them into file descriptor
+   * from handler of fatal signal. Only async-signal-safe calls are used: no
+   * allocation, no locks, no locale. Text lines are rendered by pattern of
+   * sink, in UTC or local time as sink does; local time is computed by
+   * recent UTC offset instead of time zone (see
+   * LinePattern::renderInSignal).
+   *
+   * Writer stops at deadline; write blocked in kernel is not interrupted by
+   * it, so caller should have a backstop (e.g. alarm)
+   */
+  class CrashWriter final {
+   public:
+    CrashWriter(CrashWriter &&) noexcept = delete;
+    CrashWriter(const CrashWriter &) = delete;
+    CrashWriter &operator=(CrashWriter &&) noexcept = delete;
+    CrashWriter &operator=(CrashWriter const &) = delete;
+
+    /**
+     * @param fd is file descriptor to write into
+     * @param thread_info_type is thread info of layout
+     * @param gzip is true to write data as gzip members (of stored blocks),
+     * so they might be appended to gzip stream
+     * @param deadline is time to stop writing at
+     * @param pattern renders events as text lines; events are rendered in
+     * JSON layout if it's nullptr. Pattern must not be used by others
+     * meanwhile
+     */
+    CrashWriter(int fd, Sink::ThreadInfoType thread_info_type, bool gzip,
+                std::chrono::steady_clock::time_point deadline,
+                LinePattern *pattern) noexcept;
+
+    /**
+     * Writes buffered data
+     */
+    ~CrashWriter();
+
+    /**
+     * Saves current UTC offset of local time, in case no local time has been
+     * rendered yet. Must be called out of signal handler, before it might be
+     * needed
+     */
+    static void prepare();
+
+    /**
+     * Takes flag {@param flag} of flush in progress, waiting till
+     * {@param deadline} for flush by other thread is finished
+     * @returns true if flag is taken
+     */
+    static bool lock(std::atomic_bool &flag,
+                     std::chrono::steady_clock::time_point deadline) noexcept;
+
+    /**
+     * Renders {@param event} and writes it (or buffers)
+     * @returns false if writing is failed or deadline has come
+     */
+    bool put(const Event &event) noexcept;
+
+    /**
+     * Writes buffered data
+     * @returns false if writing is failed or deadline has come
+     */
+    bool flush() noexcept;
+
+   private:
+    void putJson(char *&ptr, const Event &event) noexcept;
+
+    bool writeAll(const char *data, size_t size) noexcept;
+
+    const int fd_;
+    const Sink::ThreadInfoType thread_info_type_;
+    const bool gzip_;
+    LinePattern *const pattern_;
+    const std::chrono::steady_clock::time_point deadline_;
+    bool failed_ = false;
+
+    // Size is less than max size of stored block of deflate
+    std::array<char, 1u << 15> buffer_;
+    size_t size_ = 0;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_CRASHWRITER
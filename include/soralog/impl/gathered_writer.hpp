@@ -0,0 +1,76 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_GATHEREDWRITER
+#define SORALOG_GATHEREDWRITER
+
+#include <soralog/impl/line_pattern.hpp>
+
+#include <sys/uio.h>
+
+#include <vector>
+
+namespace soralog {
+
+  /**
+   * @class GatheredWriter
+   * Batch of lines written by one writev(2). Lines are rendered by
+   * LinePattern into scratch buffer, except long messages, which are
+   * referenced in place, i.e. in slots of queue of events. Such slots are
+   * held till batch is written, so message is never copied
+   */
+  class GatheredWriter final {
+   public:
+    using NodeRef = CircularBuffer<Event>::NodeRef;
+
+    GatheredWriter() = delete;
+    GatheredWriter(GatheredWriter &&) noexcept = delete;
+    GatheredWriter(const GatheredWriter &) = delete;
+    GatheredWriter &operator=(GatheredWriter &&) noexcept = delete;
+    GatheredWriter &operator=(GatheredWriter const &) = delete;
+    ~GatheredWriter() = default;
+
+    /**
+     * @param scratch_size is size of buffer for rendered parts of lines
+     * @param max_held_events is max number of slots of queue held by batch
+     */
+    GatheredWriter(size_t scratch_size, size_t max_held_events);
+
+    /**
+     * Renders event of {@param node} by {@param pattern}. Node is moved into
+     * batch if its message is referenced
+     */
+    void add(LinePattern &pattern, NodeRef &node);
+
+    /**
+     * @returns true if batch might not have room for one more line rendered
+     * by {@param pattern}
+     */
+    bool full(const LinePattern &pattern) const noexcept;
+
+    /**
+     * @returns total size of lines in batch
+     */
+    size_t size() const noexcept;
+
+    /**
+     * Writes batch into {@param fd} (retrying on partial write), releases
+     * held slots of queue and clears batch, even if writing failed
+     * @returns number of bytes written; it's less than size() on error
+     * (errno is set)
+     */
+    size_t write(int fd);
+
+   private:
+    std::vector<char> scratch_;
+    char *ptr_;
+    std::vector<iovec> iov_;
+    const size_t max_held_events_;
+    std::vector<NodeRef> held_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_GATHEREDWRITER
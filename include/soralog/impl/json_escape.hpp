@@ -0,0 +1,62 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_JSONESCAPE
+#define SORALOG_JSONESCAPE
+
+#include <cstddef>
+#include <string_view>
+
+#include <soralog/field.hpp>
+
+namespace soralog::json {
+
+  /// Instruction set used for escaping
+  enum class Isa {
+    SCALAR,  //!< Byte by byte
+    SSE2,    //!< 16 bytes per step
+    AVX2     //!< 32 bytes per step
+  };
+
+  /**
+   * @returns max space needed to escape string of {@param size} bytes:
+   * each byte might become `\u00XX`, and vectorized escaping stores whole
+   * vectors, so some extra space after escaped string might be overwritten
+   */
+  constexpr size_t maxEscapedSize(size_t size) {
+    return size * 6 + 32;
+  }
+
+  /**
+   * @returns the best instruction set supported by CPU
+   */
+  Isa bestIsa() noexcept;
+
+  /**
+   * Writes {@param str} escaped as content of JSON string (without quotes)
+   * into {@param out}, which must have at least maxEscapedSize() bytes.
+   * Quote, backslash and control characters are escaped; other bytes
+   * (including non-ASCII ones) are copied as is. Async-signal-safe
+   * @returns pointer past the last written byte
+   */
+  char *escape(char *out, std::string_view str) noexcept;
+
+  /**
+   * Same as above, but uses instruction set {@param isa} (or the best
+   * supported one, if {@param isa} isn't supported)
+   */
+  char *escape(char *out, std::string_view str, Isa isa) noexcept;
+
+  /**
+   * Writes {@param fields} as members of JSON object (`,"key":value` for
+   * each one) into {@param out}, which must have at least maxEscapedSize()
+   * bytes for size of encoded fields. Non-finite numbers are written as null
+   * @returns pointer past the last written byte
+   */
+  char *putFields(char *out, const Fields &fields) noexcept;
+
+}  // namespace soralog::json
+
+#endif  // SORALOG_JSONESCAPE
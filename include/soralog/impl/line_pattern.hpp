@@ -0,0 +1,181 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_LINEPATTERN
+#define SORALOG_LINEPATTERN
+
+#include <soralog/sink.hpp>
+
+#include <sys/uio.h>
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace soralog {
+
+  /**
+   * @class LinePattern
+   * Layout of text line of event, defined by pattern like
+   * "%Y-%m-%dT%H:%M:%S.%f %l %n [%t] %v". Pattern is compiled once into flat
+   * list of steps, where adjacent literal parts (and constant color styles)
+   * are merged into one run, so rendering of event just executes steps.
+   *
+   * Specifiers:
+   *   %Y - year (4 digits), %y - year (2 digits), %m - month, %d - day,
+   *   %H - hours, %M - minutes, %S - seconds (local time or UTC);
+   *   %F - same as %Y-%m-%d, %T - same as %H:%M:%S;
+   *   %z - offset of time from UTC as "+hh:mm" (or "Z" for UTC), e.g.
+   *   "%FT%T.%f%z" is time in ISO 8601 format;
+   *   %f - microseconds (6 digits), %e - milliseconds (3 digits);
+   *   %l - level padded to 8 chars, %L - level as one char;
+   *   %n - logger name; %t - thread (padded name or `T:<number>`,
+   *   as defined by thread info type; empty if sink has no thread info);
+   *   %v - message with fields; %% - percent sign.
+   * Date and time parts are rendered once per second; broken-down time of
+   * that second is shared by patterns of all sinks.
+   */
+  class LinePattern final {
+   public:
+    LinePattern() = delete;
+    LinePattern(LinePattern &&) noexcept = default;
+    LinePattern(const LinePattern &) = delete;
+    LinePattern &operator=(LinePattern &&) noexcept = default;
+    LinePattern &operator=(LinePattern const &) = delete;
+    ~LinePattern() = default;
+
+    /**
+     * Compiles {@param pattern} for sink with {@param thread_info_type};
+     * {@param with_color} adds styles of console for time, level, name and
+     * message; {@param utc} makes date and time be in UTC instead of local
+     * time.
+     * @throws std::invalid_argument if pattern is malformed
+     */
+    LinePattern(std::string_view pattern,
+                Sink::ThreadInfoType thread_info_type, bool with_color,
+                bool utc = false);
+
+    /**
+     * @returns pattern used by text sinks by default: date, time, thread
+     * (if any), level, name and message separated by couple of spaces
+     */
+    static std::string_view defaultPattern(
+        Sink::ThreadInfoType thread_info_type);
+
+    /**
+     * Renders {@param event} at {@param ptr} as line (with trailing '\n').
+     * There must be at least maxSize() bytes
+     */
+    void render(char *&ptr, const Event &event);
+
+    /**
+     * Same as render(), but async-signal-safe: time zone isn't applied,
+     * local time is shifted from UTC by offset of the last local time
+     * rendered by any pattern (or saved by saveUtcOffset()). So time might
+     * be off if offset was changed since then (e.g. by daylight saving)
+     */
+    void renderInSignal(char *&ptr, const Event &event) noexcept;
+
+    /**
+     * Same as above, but long message isn't copied: rendered parts of line
+     * and message in place (i.e. in event) are appended to {@param iov}.
+     * Parts rendered at {@param ptr} are joined with the last item of
+     * {@param iov} if it ends at {@param ptr}
+     * @returns true if message of event is referenced by {@param iov}
+     */
+    bool render(char *&ptr, const Event &event, std::vector<iovec> &iov);
+
+    /**
+     * Saves current UTC offset of local time for renderInSignal(). Must be
+     * called out of signal handler
+     */
+    static void saveUtcOffset();
+
+    /**
+     * @returns broken-down time of {@param sec} since epoch, shifted by
+     * {@param offset} seconds from UTC; async-signal-safe
+     */
+    static std::tm brokenDownTime(int64_t sec, int64_t offset) noexcept;
+
+    /**
+     * @returns max size of line rendered by render()
+     */
+    size_t maxSize() const noexcept {
+      return max_size_;
+    }
+
+    /**
+     * @returns max number of items which render() appends to iovec
+     */
+    size_t maxIovecs() const noexcept {
+      return message_steps_ * 2 + 1;
+    }
+
+    /// Shorter message is copied even if iovec is used: it's cheaper than
+    /// extra item of iovec
+    static constexpr size_t min_referenced_message_size = 256;
+
+   private:
+    enum class Op : uint8_t {
+      LITERAL,        //!< Copy of literal run
+      DATETIME,       //!< Copy of part of cached date and time
+      MICROSECONDS,
+      MILLISECONDS,
+      LEVEL,
+      LEVEL_CHAR,
+      NAME,
+      THREAD_NAME,
+      THREAD_NUMBER,
+      MESSAGE,
+      LEVEL_STYLE,    //!< Style of level, depends on level
+      TEXT_STYLE,     //!< Style of message, depends on level
+    };
+
+    /// Step of rendering; literal and datetime ones copy part of related
+    /// buffer at {@param offset} of size {@param size}
+    struct Step {
+      Op op;
+      uint16_t offset = 0;
+      uint16_t size = 0;
+    };
+
+    /// Part of date or time: specifier and its offset in cached datetime
+    struct DatetimePart {
+      char spec;
+      uint16_t offset;
+    };
+
+    struct Token;
+
+    void addLiteral(std::string_view literal);
+    void addDatetime(const Token *begin, const Token *end);
+    void addStep(Op op);
+    void updateDatetime(int64_t sec);
+    void putDatetime(const std::tm &tm) noexcept;
+    void putUtcOffset(char *ptr, const std::tm &tm) const;
+
+    template <bool gather>
+    bool renderSteps(char *&ptr, const Event &event, std::vector<iovec> *iov);
+
+    static constexpr size_t levels = static_cast<size_t>(Level::TRACE) + 1;
+
+    bool utc_;
+    std::vector<Step> steps_;
+    std::string literals_;
+    std::vector<DatetimePart> datetime_parts_;
+    std::string datetime_;
+    int64_t psec_ = -1;
+    std::array<std::string, levels> level_styles_{};
+    std::array<std::string, levels> text_styles_{};
+    size_t max_size_ = 1;  // trailing '\n'
+    size_t message_steps_ = 0;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_LINEPATTERN
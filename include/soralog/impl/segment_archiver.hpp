@@ -0,0 +1,124 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SEGMENTARCHIVER
+#define SORALOG_SEGMENTARCHIVER
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+namespace soralog {
+
+  /**
+   * @class SegmentArchiver
+   * Background low-priority worker which post-processes rotated segments of
+   * log-files: compresses them (gzip) and removes the oldest ones in according
+   * with retention limits. It is shared by all sinks; it keeps work (and disk
+   * latency) off sink workers, so switching to new file does not stall logging
+   */
+  class SegmentArchiver final {
+   public:
+    /**
+     * Post-processing task for one rotated segment
+     */
+    struct Task {
+      /// Path of rotated segment
+      std::filesystem::path segment;
+      /// Path of active log-file; its segments are named after it (see
+      /// parseSegmentName)
+      std::filesystem::path origin;
+      /// Compress segment by gzip
+      bool compress = false;
+      /// Keep no more than that number of segments; 0 - unlimited
+      size_t max_files = 0;
+      /// Keep no more than that total bytes of segments; 0 - unlimited
+      size_t max_total_size = 0;
+    };
+
+    /**
+     * Position of rotated segment among segments of its log-file
+     */
+    struct SegmentOrder {
+      /// Number of segment, or time of rotation as YYYYMMDDhhmmss
+      uint64_t number = 0;
+      /// Index of segment among ones rotated in the same second
+      uint64_t index = 0;
+      /// True if segment is named by time of rotation
+      bool timestamped = false;
+
+      bool operator<(const SegmentOrder &other) const noexcept {
+        return number < other.number
+            || (number == other.number && index < other.index);
+      }
+    };
+
+    SegmentArchiver(SegmentArchiver &&) noexcept = delete;
+    SegmentArchiver(const SegmentArchiver &) = delete;
+    SegmentArchiver &operator=(SegmentArchiver &&) noexcept = delete;
+    SegmentArchiver &operator=(SegmentArchiver const &) = delete;
+
+    SegmentArchiver();
+    ~SegmentArchiver();
+
+    /**
+     * @returns shared instance of archiver (with creating it if it does not
+     * exists now). Instance lives while at least one user holds it
+     */
+    static std::shared_ptr<SegmentArchiver> instance();
+
+    /**
+     * Enqueues {@param task} of post-processing of rotated segment
+     */
+    void enqueue(Task task);
+
+    /**
+     * Blocks until all enqueued tasks are done
+     */
+    void wait();
+
+    /**
+     * Compresses file {@param path} into `<path>.gz`, and removes original
+     * @returns path of compressed file, or empty path if failed
+     */
+    static std::filesystem::path compress(const std::filesystem::path &path);
+
+    /**
+     * @returns position of segment if {@param name} looks like name of
+     * segment of log-file named {@param origin_name}: `<origin>.<N>` or
+     * `<origin>.<YYYYMMDD-hhmmss>[-<n>]`, optionally with suffix `.gz`;
+     * nullopt elsewise
+     */
+    static std::optional<SegmentOrder> parseSegmentName(
+        std::string_view name, std::string_view origin_name);
+
+    /**
+     * Removes the oldest segments of log-file {@param origin} to satisfy
+     * limits {@param max_files} and {@param max_total_size}
+     */
+    static void applyRetention(const std::filesystem::path &origin,
+                               size_t max_files, size_t max_total_size);
+
+   private:
+    void run();
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable condvar_;
+    std::condition_variable done_condvar_;
+    std::deque<Task> tasks_;
+    bool in_progress_ = false;
+    bool need_to_finalize_ = false;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SEGMENTARCHIVER
@@ -0,0 +1,97 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SHMCOLLECTOR
+#define SORALOG_SHMCOLLECTOR
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <soralog/impl/shm_ring.hpp>
+#include <soralog/logging_system.hpp>
+
+namespace soralog {
+
+  /**
+   * @class ShmCollector
+   * Drains shared-memory rings written by SinkToShm of many processes, and
+   * relays their events (merged by time) into loggers of own logging system.
+   * Event is relayed by logger with the same name, which belongs to group
+   * with the same name if it exists, or to fallback group elsewise. Rings of
+   * finished (or crashed) processes are removed after they are drained
+   */
+  class ShmCollector final {
+   public:
+    /// How often directory is scanned for new and abandoned rings
+    static constexpr auto scan_interval = std::chrono::seconds(1);
+
+    ShmCollector(ShmCollector &&) noexcept = delete;
+    ShmCollector(const ShmCollector &) = delete;
+    ShmCollector &operator=(ShmCollector &&) noexcept = delete;
+    ShmCollector &operator=(ShmCollector const &) = delete;
+    ~ShmCollector() = default;
+
+    /**
+     * @param system is logging system which loggers are used to write events
+     * @param directory is directory where rings are placed
+     * @param channel is name of channel which rings are collected
+     */
+    ShmCollector(LoggingSystem &system, std::filesystem::path directory,
+                 std::string channel);
+
+    /**
+     * Drains all rings and relays their events
+     * @param rescan forces scanning of directory
+     * @returns number of relayed events
+     */
+    size_t poll(bool rescan = false);
+
+    /**
+     * @returns number of rings being drained
+     */
+    size_t rings() const noexcept {
+      return rings_.size();
+    }
+
+   private:
+    struct RingState {
+      std::unique_ptr<ShmRing> ring;
+      size_t reported_dropped = 0;
+      size_t reported_corrupted = 0;
+    };
+
+    /**
+     * Attaches new rings and removes drained abandoned ones
+     */
+    void scan();
+
+    /**
+     * Reports drops and corruptions of ring {@param state} happened since
+     * last report
+     */
+    static void report(RingState &state);
+
+    /**
+     * @returns logger for events of logger with name {@param name}
+     */
+    std::shared_ptr<Logger> getLogger(std::string_view name);
+
+    LoggingSystem &system_;
+    const std::filesystem::path directory_;
+    const std::string prefix_;
+
+    std::map<std::filesystem::path, RingState> rings_;
+    std::map<std::string, std::shared_ptr<Logger>, std::less<>> loggers_;
+    std::vector<ShmRing::Record> records_;
+    std::chrono::steady_clock::time_point next_scan_{};
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SHMCOLLECTOR
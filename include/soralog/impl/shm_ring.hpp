@@ -0,0 +1,201 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SHMRING
+#define SORALOG_SHMRING
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <soralog/sink.hpp>
+
+namespace soralog {
+
+  /**
+   * @class ShmRing
+   * Single-producer single-consumer ring of events in shared memory, which
+   * is used to pass events from process to local collector (`soralogd`).
+   *
+   * Ring is a file (normally in /dev/shm) of header followed by data area.
+   * Producer appends records and publishes new head once per batch; consumer
+   * reads records up to published head and moves tail. Record becomes
+   * visible only after it is written completely, so if producer dies in the
+   * middle of record, consumer never sees torn one. Nothing but memory access
+   * is done to put event, i.e. there is no system call per event.
+   *
+   * Record is 8-byte aligned: uint32 size of body, uint32 kind, body.
+   * Body of event: varint microseconds since epoch, 1 byte of level,
+   * varint thread number, strings of thread name, logger name and message
+   * (each is varint size and bytes), encoded fields up to the end of body.
+   * Padding record fills the end of data area if next record does not fit
+   * there.
+   *
+   * Ring created in overwrite mode has no consumer: producer frees space for
+   * new record by dropping the oldest ones. Such ring keeps last events in
+   * file after crash of process, and is read post-mortem by inspect().
+   */
+  class ShmRing final {
+   public:
+    /// Event read from ring. Views are valid till release()
+    struct Record {
+      std::chrono::system_clock::time_point timestamp;
+      Level level = Level::OFF;
+      size_t thread_number = 0;
+      std::string_view thread_name;
+      std::string_view name;
+      std::string_view message;
+      /// Encoded fields (see Fields)
+      std::string_view fields;
+    };
+
+    /// Suffix of ring files
+    static constexpr std::string_view suffix = ".ring";
+
+    ShmRing(ShmRing &&) noexcept = delete;
+    ShmRing(const ShmRing &) = delete;
+    ShmRing &operator=(ShmRing &&) noexcept = delete;
+    ShmRing &operator=(ShmRing const &) = delete;
+    ~ShmRing();
+
+    /**
+     * Creates new ring file {@param path} with data area at least
+     * {@param capacity} bytes (rounded up to power of two) for producer.
+     * If {@param overwrite} is true, the oldest records are overwritten
+     * instead of dropping new ones when ring is full
+     * @returns ring, or nullptr if failed (errno is set)
+     */
+    static std::unique_ptr<ShmRing> create(const std::filesystem::path &path,
+                                           size_t capacity,
+                                           bool overwrite = false);
+
+    /**
+     * Opens existing ring file {@param path} for consumer
+     * @returns ring, or nullptr if file is not valid ring
+     */
+    static std::unique_ptr<ShmRing> attach(const std::filesystem::path &path);
+
+    /**
+     * Opens ring at {@param offset} of file {@param path} read-only (e.g.
+     * ring file left after crash, or core dump containing ring) to read it
+     * once; release() must not be called for such ring
+     * @returns ring, or nullptr if there is no valid ring at the offset
+     */
+    static std::unique_ptr<ShmRing> inspect(const std::filesystem::path &path,
+                                            uint64_t offset = 0);
+
+    /// Size of header area of ring, which data area follows
+    static constexpr size_t header_area_size = 4096;
+
+    // Producer side
+
+    /**
+     * Puts {@param event} into ring. Record becomes visible for consumer
+     * after publish()
+     * @returns false if there is no room for it (event is counted as dropped)
+     */
+    bool put(const Event &event) noexcept;
+
+    /**
+     * Makes all put records visible for consumer
+     */
+    void publish() noexcept;
+
+    /**
+     * Marks ring as abandoned by producer, so consumer might remove it after
+     * it has been drained
+     */
+    void close() noexcept;
+
+    // Consumer side
+
+    /**
+     * Reads all published records not read yet into {@param records}
+     * @returns number of read records
+     */
+    size_t read(std::vector<Record> &records);
+
+    /**
+     * Frees space of read records for producer
+     */
+    void release() noexcept;
+
+    /**
+     * @returns true if producer closed ring or doesn't exist anymore
+     */
+    bool isAbandoned() const noexcept;
+
+    /**
+     * @returns number of events dropped by producer because ring was full
+     */
+    size_t dropped() const noexcept;
+
+    /**
+     * @returns number of records skipped by consumer as broken
+     */
+    size_t corrupted() const noexcept {
+      return corrupted_;
+    }
+
+    /**
+     * @returns pid of producer
+     */
+    int pid() const noexcept;
+
+    /**
+     * @returns true if ring is in overwrite mode
+     */
+    bool isOverwriting() const noexcept;
+
+    /**
+     * @returns full size of ring (header area and data area) in bytes
+     */
+    size_t size() const noexcept {
+      return mapping_size_;
+    }
+
+    const std::filesystem::path &path() const noexcept {
+      return path_;
+    }
+
+   private:
+    struct Header;
+
+    ShmRing(std::filesystem::path path, int fd, void *mapping,
+            size_t mapping_size);
+
+    /**
+     * @returns true if {@param header} is header of valid ring with data area
+     * of {@param capacity} bytes
+     */
+    static bool isValid(const Header &header, size_t capacity);
+
+    /**
+     * Drops the oldest records till {@param size} bytes are free
+     * @returns false if it's impossible
+     */
+    bool overwrite(size_t size) noexcept;
+
+    const std::filesystem::path path_;
+    const int fd_;
+    void *const mapping_;
+    const size_t mapping_size_;
+    Header *const header_;
+    char *const data_;
+    const size_t capacity_;
+    const bool overwrite_;
+
+    uint64_t position_ = 0;  // head for producer, read position for consumer
+    uint64_t tail_ = 0;      // last known tail (for producer)
+    size_t corrupted_ = 0;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SHMRING
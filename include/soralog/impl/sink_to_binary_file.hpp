@@ -0,0 +1,94 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SINKTOBINARYFILE
+#define SORALOG_SINKTOBINARYFILE
+
+#include <soralog/sink.hpp>
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  /**
+   * @class SinkToBinaryFile
+   * Writes events in compact binary format (see binary_format.hpp) instead of
+   * rendering them into text. Names of loggers and threads are interned,
+   * timestamps are delta-encoded. File is rendered to text offline by
+   * `soralog-decode` tool
+   */
+  class SinkToBinaryFile final : public Sink {
+   public:
+    SinkToBinaryFile() = delete;
+    SinkToBinaryFile(SinkToBinaryFile &&) noexcept = delete;
+    SinkToBinaryFile(const SinkToBinaryFile &) = delete;
+    SinkToBinaryFile &operator=(SinkToBinaryFile &&) noexcept = delete;
+    SinkToBinaryFile &operator=(SinkToBinaryFile const &) = delete;
+
+    SinkToBinaryFile(std::string name, std::filesystem::path path,
+                     std::optional<ThreadInfoType> thread_info_type = {},
+                     std::optional<size_t> capacity = {},
+                     std::optional<size_t> buffer_size = {},
+                     std::optional<size_t> latency = {});
+    ~SinkToBinaryFile() override;
+
+    /**
+     * Reopens log-file (e.g. after it was moved by external tool)
+     */
+    void rotate() noexcept override;
+
+    void flush() noexcept override;
+
+   protected:
+    void async_flush() noexcept override;
+
+   private:
+    void run();
+
+    /**
+     * Opens file into {@param out}, writes header if file is new, and begins
+     * new session (resets dictionaries and time base)
+     * @returns true if success
+     */
+    bool open(std::ofstream &out);
+
+    /**
+     * Puts record of event {@param event} into {@param ptr}, preceded by
+     * dictionary records if name or thread appear first time in session
+     */
+    void putEvent(char *&ptr, const Event &event);
+
+    const std::filesystem::path path_;
+
+    std::unique_ptr<std::thread> sink_worker_{};
+
+    std::vector<char> buff_;
+    std::ofstream out_{};
+    std::mutex mutex_{};
+    std::condition_variable condvar_{};
+    std::atomic_bool need_to_finalize_ = false;
+    std::atomic_bool need_to_flush_ = false;
+    std::atomic_bool need_to_rotate_ = false;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    std::atomic_bool flush_in_progress_ = false;
+
+    // State of current session (is touched inside of flush only)
+    int64_t prev_time_ = 0;
+    uint64_t next_id_ = 1;
+    std::map<std::string, uint64_t, std::less<>> names_;
+    std::map<size_t, std::pair<std::string, uint64_t>> threads_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SINKTOBINARYFILE
@@ -13,6 +13,9 @@
 #include <mutex>
 #include <thread>
 
+#include <soralog/impl/gathered_writer.hpp>
+#include <soralog/impl/line_pattern.hpp>
+
 namespace soralog {
   using namespace std::chrono_literals;
 
@@ -24,24 +27,51 @@ namespace soralog {
     SinkToConsole &operator=(SinkToConsole &&) noexcept = delete;
     SinkToConsole &operator=(SinkToConsole const &) = delete;
 
+    /**
+     * @param zero_copy makes lines be written by writev(2) with long messages
+     * taken in place from queue (see GatheredWriter)
+     * @param utc makes date and time of lines be in UTC
+     */
     SinkToConsole(std::string name, bool with_color,
                   std::optional<ThreadInfoType> thread_info_type = {},
                   std::optional<size_t> capacity = {},
                   std::optional<size_t> buffer_size = {},
-                  std::optional<size_t> latency = {});
+                  std::optional<size_t> latency = {},
+                  std::optional<std::string> pattern = {},
+                  std::optional<bool> zero_copy = {},
+                  std::optional<bool> utc = {});
     ~SinkToConsole() override;
 
     void rotate() noexcept override{};
 
     void flush() noexcept override;
 
+    /**
+     * Writes events left in queue into stdout directly (without color)
+     */
+    void drainOnCrash(
+        std::chrono::steady_clock::time_point deadline) noexcept override;
+
    protected:
     void async_flush() noexcept override;
 
+    /**
+     * Allocates buffer and starts worker on the first event
+     */
+    void start() override;
+
+    void lockForFork() noexcept override;
+
+    void unlockForFork() noexcept override;
+
+    bool resetInChild(bool reopen) noexcept override;
+
    private:
     void run();
 
-    const bool with_color_;
+    LinePattern line_pattern_;
+    const bool zero_copy_;
+    std::unique_ptr<GatheredWriter> gathered_;
 
     std::unique_ptr<std::thread> sink_worker_{};
 
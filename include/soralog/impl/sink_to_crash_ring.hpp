@@ -0,0 +1,96 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SINKTOCRASHRING
+#define SORALOG_SINKTOCRASHRING
+
+#include <soralog/sink.hpp>
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  class ShmRing;
+
+  /**
+   * @class SinkToCrashRing
+   * Keeps last events in ring of file mapped into memory (see ShmRing in
+   * overwrite mode). Pages of file belong to kernel, so events written into
+   * ring survive crash of process, and might be extracted by
+   * `soralog-postmortem`. Putting of event into ring is copying of it into
+   * memory, without rendering and system calls.
+   *
+   * By default sink has no latency, so events do not wait in queue, where
+   * they would be lost on crash. Ring left by previous run is kept with
+   * suffix '.prev' till the next one
+   */
+  class SinkToCrashRing final : public Sink {
+   public:
+    /// Suffix of ring left by previous run
+    static constexpr std::string_view previous_suffix = ".prev";
+
+    SinkToCrashRing() = delete;
+    SinkToCrashRing(SinkToCrashRing &&) noexcept = delete;
+    SinkToCrashRing(const SinkToCrashRing &) = delete;
+    SinkToCrashRing &operator=(SinkToCrashRing &&) noexcept = delete;
+    SinkToCrashRing &operator=(SinkToCrashRing const &) = delete;
+
+    /**
+     * @param path is path of ring file
+     * @param ring_size is size of ring in bytes
+     */
+    SinkToCrashRing(std::string name, std::filesystem::path path,
+                    std::optional<size_t> ring_size = {},
+                    std::optional<ThreadInfoType> thread_info_type = {},
+                    std::optional<size_t> capacity = {},
+                    std::optional<size_t> buffer_size = {},
+                    std::optional<size_t> latency = {});
+    ~SinkToCrashRing() override;
+
+    /**
+     * Does nothing: ring is overwritten in place
+     */
+    void rotate() noexcept override;
+
+    void flush() noexcept override;
+
+    /**
+     * Puts events left in queue into ring
+     */
+    void drainOnCrash(
+        std::chrono::steady_clock::time_point deadline) noexcept override;
+
+    /**
+     * @returns path of ring file, or empty one if ring is not created
+     */
+    std::filesystem::path path() const;
+
+   protected:
+    void async_flush() noexcept override;
+
+   private:
+    void run();
+
+    std::unique_ptr<ShmRing> ring_;
+
+    std::unique_ptr<std::thread> sink_worker_{};
+
+    std::mutex mutex_{};
+    std::condition_variable condvar_{};
+    std::atomic_bool need_to_finalize_ = false;
+    std::atomic_bool need_to_flush_ = false;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    std::atomic_bool flush_in_progress_ = false;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SINKTOCRASHRING
@@ -15,9 +15,15 @@
 #include <mutex>
 #include <thread>
 
+#include <soralog/impl/gathered_writer.hpp>
+#include <soralog/impl/line_pattern.hpp>
+#include <soralog/impl/segment_archiver.hpp>
+
 namespace soralog {
   using namespace std::chrono_literals;
 
+  class FrameCompressor;
+
   class SinkToFile final : public Sink {
    public:
     SinkToFile() = delete;
@@ -26,28 +32,172 @@ namespace soralog {
     SinkToFile &operator=(SinkToFile &&) noexcept = delete;
     SinkToFile &operator=(SinkToFile const &) = delete;
 
+    /**
+     * Rules of built-in rotation of log-file
+     */
+    struct RotationPolicy {
+      /// Naming of rotated segments
+      enum class Naming {
+        NUMBERED,    //!< <path>.1, <path>.2, ...
+        TIMESTAMPED  //!< <path>.YYYYMMDD-hhmmss
+      };
+
+      /// Size of file (in bytes) to rotate; 0 - no size-based rotation
+      size_t max_size = 0;
+      /// Interval of rotation; 0 - no time-based rotation
+      std::chrono::seconds interval{0};
+      /// Naming of rotated segments
+      Naming naming = Naming::NUMBERED;
+      /// Max number of kept segments; 0 - unlimited
+      size_t max_files = 0;
+      /// Max total size (in bytes) of kept segments; 0 - unlimited
+      size_t max_total_size = 0;
+      /// Compress rotated segments (gzip) in background
+      bool compress = false;
+    };
+
+    /**
+     * Streaming compression of written data. Each rendered batch is written
+     * as independent frame (gzip member), so any prefix of file consisting of
+     * whole frames is decodable (e.g. by zcat), and crash loses at most last
+     * frame
+     */
+    struct Compression {
+      enum class Codec {
+        NONE,  //!< Plain text
+        GZIP   //!< Frames are gzip members
+      };
+
+      Codec codec = Codec::NONE;
+      /// Level of compression: 1 (fastest) ... 9 (best); -1 - default
+      int level = -1;
+    };
+
+    /**
+     * Layout of records in file
+     */
+    enum class Layout {
+      TEXT,  //!< Line of text by pattern (see LinePattern)
+      JSON   //!< JSON object per line (timestamp is UTC, ISO 8601)
+    };
+
+    /**
+     * @param zero_copy makes text lines be written by writev(2) with long
+     * messages taken in place from queue (see GatheredWriter); it's ignored
+     * for JSON layout and compressed file
+     * @param utc makes date and time of text lines be in UTC
+     */
     SinkToFile(std::string name, std::filesystem::path path,
                std::optional<ThreadInfoType> thread_info_type = {},
                std::optional<size_t> capacity = {},
                std::optional<size_t> buffer_size = {},
-               std::optional<size_t> latency = {});
+               std::optional<size_t> latency = {},
+               std::optional<RotationPolicy> rotation = {},
+               std::optional<Compression> compression = {},
+               std::optional<Layout> layout = {},
+               std::optional<std::string> pattern = {},
+               std::optional<bool> zero_copy = {},
+               std::optional<bool> utc = {});
     ~SinkToFile() override;
 
+    /**
+     * Reopens log-file (e.g. after it was moved by external tool)
+     */
     void rotate() noexcept override;
 
     void flush() noexcept override;
 
+    /**
+     * Writes events left in queue into file directly; compressed file gets them as
+     * gzip member of stored block
+     */
+    void drainOnCrash(
+        std::chrono::steady_clock::time_point deadline) noexcept override;
+
    protected:
     void async_flush() noexcept override;
 
+    /**
+     * Opens file, allocates buffers and starts worker on the first event
+     */
+    void start() override;
+
+    void lockForFork() noexcept override;
+
+    void unlockForFork() noexcept override;
+
+    bool resetInChild(bool reopen) noexcept override;
+
    private:
     void run();
 
+    /**
+     * Allocates buffers and compressor, and prepares rotation
+     */
+    void setUp();
+
+    /**
+     * Opens file, reporting failure
+     */
+    void openFile();
+
+    /**
+     * Renders {@param event} into {@param ptr} as line of JSON
+     */
+    void renderJson(char *&ptr, const char *end, const Event &event);
+
+    /**
+     * Writes rendered data {@param data} of size {@param size} into file,
+     * compressing them as one frame if compression is enabled
+     */
+    void write(const char *data, size_t size);
+
+    /**
+     * Writes lines gathered by zero-copy mode into file
+     */
+    void writeGathered();
+
+    /**
+     * Opens descriptor of file for zero-copy mode (after file is opened)
+     */
+    void reopenFd() noexcept;
+
+    /**
+     * @returns true if active file should be rotated by policy
+     */
+    bool isRotationDue() const noexcept;
+
+    /**
+     * Moves active file to new segment, opens new one in its place, and
+     * passes segment to post-processing in background
+     */
+    void rotateSegment() noexcept;
+
+    /**
+     * @returns path for next rotated segment
+     */
+    std::filesystem::path nextSegmentPath();
+
     const std::filesystem::path path_;
+    const std::optional<RotationPolicy> rotation_;
+    const std::optional<Compression> compression_;
+    const Layout layout_;
+    LinePattern line_pattern_;
+    const bool zero_copy_;
+    std::unique_ptr<GatheredWriter> gathered_;
+    int fd_ = -1;
+    std::unique_ptr<FrameCompressor> compressor_;
+    std::shared_ptr<SegmentArchiver> archiver_;
+    size_t written_ = 0;
+    size_t next_segment_number_ = 1;
+    std::chrono::system_clock::time_point next_rotation_{};
+    bool reopen_after_fork_ = false;
 
     std::unique_ptr<std::thread> sink_worker_{};
 
     std::vector<char> buff_;
+    decltype(std::chrono::seconds() / std::chrono::seconds()) psec_ = -1;
+    std::array<char, 19> datetime_{};  // JSON layout of psec_
     std::ofstream out_{};
     std::mutex mutex_{};
     std::condition_variable condvar_{};
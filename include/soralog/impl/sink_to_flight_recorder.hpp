@@ -0,0 +1,142 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SINKTOFLIGHTRECORDER
+#define SORALOG_SINKTOFLIGHTRECORDER
+
+#include <soralog/sink.hpp>
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  class RecorderRing;
+
+  /**
+   * @class SinkToFlightRecorder
+   * Keeps last events in memory (overwriting the oldest ones) without
+   * rendering them, and dumps them into other sink on demand: when critical
+   * event is logged, when dump() is called, or when signal set by
+   * dumpOnSignal() arrives. Dumped events keep their original time and thread.
+   *
+   * Optionally, events of some level and more severe are forwarded to other
+   * sink immediately, so detailed logger might write only warnings into
+   * regular log, having details around incident in recorder
+   */
+  class SinkToFlightRecorder final : public Sink {
+   public:
+    SinkToFlightRecorder() = delete;
+    SinkToFlightRecorder(SinkToFlightRecorder &&) noexcept = delete;
+    SinkToFlightRecorder(const SinkToFlightRecorder &) = delete;
+    SinkToFlightRecorder &operator=(SinkToFlightRecorder &&) noexcept = delete;
+    SinkToFlightRecorder &operator=(SinkToFlightRecorder const &) = delete;
+
+    /**
+     * @param memory_size is size of memory to keep events in
+     * @param dump_sink is sink to dump events into
+     * @param forward_sink is sink to forward events immediately
+     * @param forward_level is the least severe level of forwarded events
+     */
+    SinkToFlightRecorder(std::string name, std::optional<size_t> memory_size,
+                         std::shared_ptr<Sink> dump_sink,
+                         std::shared_ptr<Sink> forward_sink = {},
+                         std::optional<Level> forward_level = {},
+                         std::optional<ThreadInfoType> thread_info_type = {},
+                         std::optional<size_t> capacity = {},
+                         std::optional<size_t> buffer_size = {},
+                         std::optional<size_t> latency = {});
+    ~SinkToFlightRecorder() override;
+
+    /**
+     * Dumps kept events into dump sink (asynchronously, if sink has latency)
+     */
+    void dump() noexcept;
+
+    /**
+     * @returns number of dumps done
+     */
+    size_t dumps() const noexcept {
+      return dumps_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Makes all flight recorders dump their events when signal
+     * {@param signal} arrives.
+     * Handler only marks dump as requested, and it is done by worker of sink
+     * (within its latency)
+     * @returns true if handler is installed
+     */
+    static bool dumpOnSignal(int signal);
+
+    /**
+     * Does nothing: there is no destination of events
+     */
+    void rotate() noexcept override;
+
+    void flush() noexcept override;
+
+    /**
+     * Selects rules of filters of dump and forward sinks for events of
+     * logger {@param name} by its {@param group_names}
+     */
+    void bindLogger(std::string_view name,
+                    const std::vector<std::string_view> &group_names) override;
+
+   protected:
+    void async_flush() noexcept override;
+
+   private:
+    /// Rules of filters of dump and forward sinks selected for logger
+    struct Relay {
+      SinkFilter::Selection dump;
+      SinkFilter::Selection forward;
+    };
+
+    void run();
+
+    /**
+     * @returns selections for logger {@param name}; ones of logger unknown
+     * to recorder are selected by name only. Requires relays_mutex_ held
+     */
+    const Relay &relayOf(std::string_view name);
+
+    /**
+     * Relays kept events into dump sink, and forgets them
+     * @param reason is explanation of dump for header of dump
+     */
+    void doDump(std::string_view reason);
+
+    const std::shared_ptr<Sink> dump_sink_;
+    const std::shared_ptr<Sink> forward_sink_;
+    const Level forward_level_;
+
+    std::unique_ptr<RecorderRing> ring_;
+
+    // Selections are made once per logger, not per relayed event
+    std::mutex relays_mutex_;
+    std::map<std::string, Relay, std::less<>> relays_;
+
+    std::unique_ptr<std::thread> sink_worker_{};
+
+    std::mutex mutex_{};
+    std::condition_variable condvar_{};
+    std::atomic_bool need_to_finalize_ = false;
+    std::atomic_bool need_to_flush_ = false;
+    std::atomic_bool need_to_dump_ = false;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    std::atomic_bool flush_in_progress_ = false;
+    std::atomic_size_t dumps_ = 0;
+    size_t seen_signals_ = 0;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SINKTOFLIGHTRECORDER
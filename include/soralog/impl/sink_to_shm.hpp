@@ -0,0 +1,101 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SINKTOSHM
+#define SORALOG_SINKTOSHM
+
+#include <soralog/sink.hpp>
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  class ShmRing;
+
+  /**
+   * @class SinkToShm
+   * Passes events into shared-memory ring (see ShmRing), which is drained by
+   * local collector `soralogd`. Collector merges events of many processes
+   * and writes them by own sinks, so processes do not compete for disk.
+   * Putting of event into ring does not make any system call
+   */
+  class SinkToShm final : public Sink {
+   public:
+    /// Default directory of rings
+    static constexpr std::string_view default_directory = "/dev/shm";
+
+    /// Default channel (common prefix of rings drained by one collector)
+    static constexpr std::string_view default_channel = "soralog";
+
+    SinkToShm() = delete;
+    SinkToShm(SinkToShm &&) noexcept = delete;
+    SinkToShm(const SinkToShm &) = delete;
+    SinkToShm &operator=(SinkToShm &&) noexcept = delete;
+    SinkToShm &operator=(SinkToShm const &) = delete;
+
+    /**
+     * @param channel is name of channel the collector listens
+     * @param directory is directory where ring is placed
+     * @param ring_size is size of ring in bytes
+     */
+    SinkToShm(std::string name, std::optional<std::string> channel = {},
+              std::optional<std::filesystem::path> directory = {},
+              std::optional<size_t> ring_size = {},
+              std::optional<ThreadInfoType> thread_info_type = {},
+              std::optional<size_t> capacity = {},
+              std::optional<size_t> buffer_size = {},
+              std::optional<size_t> latency = {});
+    ~SinkToShm() override;
+
+    /**
+     * Does nothing: ring has no state to rotate
+     */
+    void rotate() noexcept override;
+
+    void flush() noexcept override;
+
+    /**
+     * Puts events left in queue into ring
+     */
+    void drainOnCrash(
+        std::chrono::steady_clock::time_point deadline) noexcept override;
+
+    /**
+     * @returns path of ring file, or empty one if ring is not created
+     */
+    std::filesystem::path path() const;
+
+    /**
+     * @returns number of events dropped because ring was full
+     */
+    size_t dropped() const noexcept;
+
+   protected:
+    void async_flush() noexcept override;
+
+   private:
+    void run();
+
+    std::unique_ptr<ShmRing> ring_;
+
+    std::unique_ptr<std::thread> sink_worker_{};
+
+    std::mutex mutex_{};
+    std::condition_variable condvar_{};
+    std::atomic_bool need_to_finalize_ = false;
+    std::atomic_bool need_to_flush_ = false;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    std::atomic_bool flush_in_progress_ = false;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SINKTOSHM
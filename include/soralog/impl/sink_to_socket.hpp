@@ -0,0 +1,165 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SINKTOSOCKET
+#define SORALOG_SINKTOSOCKET
+
+#include <soralog/sink.hpp>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <soralog/impl/line_pattern.hpp>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  /**
+   * @class SinkToSocket
+   * Streams events to collector over TCP or Unix stream socket.
+   * Each record is 4-byte size (big endian) followed by text of record,
+   * rendered in the same layout as SinkToFile does (without line feed).
+   *
+   * Records are coalesced into large writes. While collector is not connected
+   * or does not keep up, records are kept in buffer limited by byte budget;
+   * if budget is exhausted, records are dropped according to policy.
+   * Connection is restored with exponential backoff. Socket is non-blocking,
+   * so pushing events is never blocked by network
+   */
+  class SinkToSocket final : public Sink {
+   public:
+    /// What to drop if budget is exhausted
+    enum class DropPolicy {
+      NEWEST,  //!< Drop incoming records, keep buffered ones
+      OLDEST,  //!< Drop oldest buffered records to free space for new ones
+    };
+
+    /// Backoff of reconnection: first delay, doubled up to max one
+    static constexpr auto min_reconnect_delay = 100ms;
+    static constexpr auto max_reconnect_delay = 10s;
+
+    /// How long connection might be establishing
+    static constexpr auto connect_timeout = 5s;
+
+    /// How long destructor waits to send buffered records
+    static constexpr auto finalize_timeout = 1s;
+
+    SinkToSocket() = delete;
+    SinkToSocket(SinkToSocket &&) noexcept = delete;
+    SinkToSocket(const SinkToSocket &) = delete;
+    SinkToSocket &operator=(SinkToSocket &&) noexcept = delete;
+    SinkToSocket &operator=(SinkToSocket const &) = delete;
+
+    /**
+     * @param address is path of Unix stream socket (if begins with '/'),
+     * or TCP address as `host:port` (IPv6 host in square brackets)
+     * @param budget is max size of records buffered while sending is
+     * impossible
+     * @param drop_policy is what to drop if budget is exhausted
+     */
+    SinkToSocket(std::string name, std::string address,
+                 std::optional<size_t> budget = {},
+                 std::optional<DropPolicy> drop_policy = {},
+                 std::optional<ThreadInfoType> thread_info_type = {},
+                 std::optional<size_t> capacity = {},
+                 std::optional<size_t> buffer_size = {},
+                 std::optional<size_t> latency = {});
+    ~SinkToSocket() override;
+
+    /**
+     * Drops connection and connects again (e.g. after collector was moved)
+     */
+    void rotate() noexcept override;
+
+    void flush() noexcept override;
+
+    /**
+     * @returns true if connection to collector is established
+     */
+    bool connected() const noexcept {
+      return state_.load(std::memory_order_acquire) == State::CONNECTED;
+    }
+
+    /**
+     * @returns number of records dropped because budget was exhausted
+     */
+    size_t dropped() const noexcept {
+      return dropped_.load(std::memory_order_relaxed);
+    }
+
+   protected:
+    void async_flush() noexcept override;
+
+   private:
+    enum class State { DISCONNECTED, CONNECTING, CONNECTED };
+
+    void run();
+
+    /**
+     * Starts connection, checks if started one is completed, or if
+     * established one is still alive
+     */
+    void connect();
+
+    /**
+     * Closes socket and schedules reconnection
+     */
+    void disconnect();
+
+    /**
+     * Appends rendered record {@param data} of size {@param size} to pending
+     * ones, dropping records if budget is exhausted
+     */
+    void enqueue(const char *data, size_t size);
+
+    /**
+     * Sends pending records as much as socket accepts
+     */
+    void transmit();
+
+    /**
+     * @returns true if there are records not sent yet
+     */
+    bool hasPending() const noexcept {
+      return sent_ < pending_.size();
+    }
+
+    const std::string address_;
+    const size_t budget_;
+    const DropPolicy drop_policy_;
+    LinePattern line_pattern_;
+
+    std::atomic<State> state_ = State::DISCONNECTED;
+    int socket_ = -1;
+    std::chrono::steady_clock::time_point next_connect_{};
+    std::chrono::milliseconds reconnect_delay_ = min_reconnect_delay;
+
+    // Pending records: [0, record_begin_) are sent completely,
+    // [record_begin_, sent_) is sent part of record being sent
+    std::vector<char> pending_;
+    size_t record_begin_ = 0;
+    size_t sent_ = 0;
+
+    std::unique_ptr<std::thread> sink_worker_{};
+
+    std::vector<char> buff_;
+    std::mutex mutex_{};
+    std::condition_variable condvar_{};
+    std::atomic_bool need_to_finalize_ = false;
+    std::atomic_bool need_to_flush_ = false;
+    std::atomic_bool need_to_reconnect_ = false;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    std::atomic_bool flush_in_progress_ = false;
+    std::atomic_bool wait_for_socket_ = false;
+    std::atomic_size_t dropped_ = 0;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SINKTOSOCKET
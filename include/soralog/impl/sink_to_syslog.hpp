@@ -0,0 +1,150 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SINKTOSYSLOG
+#define SORALOG_SINKTOSYSLOG
+
+#include <soralog/sink.hpp>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  /**
+   * @class SinkToSyslog
+   * Sends events to syslog daemon (or relay) as RFC 5424 messages over Unix
+   * datagram socket (e.g. `/dev/log`) or UDP. Records are rendered on worker
+   * and sent by batches via `sendmmsg`. Socket is non-blocking: if receiver
+   * does not keep up, worker waits a bit for it, and drops batch after that;
+   * producers never wait for socket
+   */
+  class SinkToSyslog final : public Sink {
+   public:
+    /// Facility codes of RFC 5424
+    enum class Facility : uint8_t {
+      KERN = 0,
+      USER = 1,
+      MAIL = 2,
+      DAEMON = 3,
+      AUTH = 4,
+      SYSLOG = 5,
+      LPR = 6,
+      NEWS = 7,
+      UUCP = 8,
+      CRON = 9,
+      AUTHPRIV = 10,
+      FTP = 11,
+      LOCAL0 = 16,
+      LOCAL1 = 17,
+      LOCAL2 = 18,
+      LOCAL3 = 19,
+      LOCAL4 = 20,
+      LOCAL5 = 21,
+      LOCAL6 = 22,
+      LOCAL7 = 23,
+    };
+
+    /// Default address of local syslog daemon
+    static constexpr std::string_view default_address = "/dev/log";
+
+    /// Max number of datagrams sent by one system call
+    static constexpr size_t max_batch_size = 64;
+
+    SinkToSyslog() = delete;
+    SinkToSyslog(SinkToSyslog &&) noexcept = delete;
+    SinkToSyslog(const SinkToSyslog &) = delete;
+    SinkToSyslog &operator=(SinkToSyslog &&) noexcept = delete;
+    SinkToSyslog &operator=(SinkToSyslog const &) = delete;
+
+    /**
+     * @param address is path of Unix datagram socket (if begins with '/'),
+     * or UDP address as `host:port` (IPv6 host in square brackets)
+     * @param facility is facility of all messages
+     * @param app_name is APP-NAME field of messages (name of program if empty)
+     */
+    SinkToSyslog(std::string name, std::string address,
+                 std::optional<Facility> facility = {},
+                 std::optional<std::string> app_name = {},
+                 std::optional<ThreadInfoType> thread_info_type = {},
+                 std::optional<size_t> capacity = {},
+                 std::optional<size_t> buffer_size = {},
+                 std::optional<size_t> latency = {});
+    ~SinkToSyslog() override;
+
+    /**
+     * Reconnects socket (e.g. after syslog daemon was restarted)
+     */
+    void rotate() noexcept override;
+
+    void flush() noexcept override;
+
+    /**
+     * @returns number of records dropped because receiver did not accept them
+     */
+    size_t dropped() const noexcept {
+      return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns facility parsed from its name {@param str} (e.g. "local0")
+     */
+    static std::optional<Facility> facilityFromStr(std::string_view str);
+
+   protected:
+    void async_flush() noexcept override;
+
+   private:
+    void run();
+
+    /**
+     * (Re)creates socket and connects it to address
+     * @returns true if success
+     */
+    bool connect();
+
+    /**
+     * Sends {@param count} rendered records described by msgs_. Only
+     * {@param on_worker} reconnects or waits for receiver; other threads
+     * drop records which can't be sent at once
+     */
+    void send(size_t count, bool on_worker);
+
+    const std::string address_;
+    const Facility facility_;
+    std::string app_name_;
+    std::string hostname_;
+    std::string procid_;
+
+    int socket_ = -1;
+    std::chrono::steady_clock::time_point next_connect_{};
+
+    std::unique_ptr<std::thread> sink_worker_{};
+
+    std::vector<char> buff_;
+    std::vector<struct iovec> iovecs_;
+    std::vector<struct mmsghdr> msgs_;
+    std::mutex mutex_{};
+    std::condition_variable condvar_{};
+    std::atomic_bool need_to_finalize_ = false;
+    std::atomic_bool need_to_flush_ = false;
+    std::atomic_bool need_to_reconnect_ = false;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    std::atomic_bool flush_in_progress_ = false;
+    std::atomic_size_t dropped_ = 0;
+    size_t reported_dropped_ = 0;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SINKTOSYSLOG
@@ -9,6 +9,8 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
+#include <string_view>
 
 namespace soralog {
 
@@ -40,6 +42,12 @@ namespace soralog {
           r[static_cast<uint8_t>(Level::TRACE)] = "Trace";
           return r;
         }();
+
+    /// Names of levels in configs and commands
+    constexpr std::array<std::string_view,
+                         static_cast<uint8_t>(Level::TRACE) + 1>
+        level_names = {"off",  "critical", "error", "warning",
+                       "info", "verbose",  "debug", "trace"};
   }
 
   /**
@@ -58,6 +66,39 @@ namespace soralog {
     return detail::level_to_str_map[static_cast<uint8_t>(level)];
   }
 
+  /**
+   * @returns name of {@param level} in configs and commands (e.g. 'info'),
+   * which is accepted by levelFromStr()
+   */
+  constexpr std::string_view levelName(Level level) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    return detail::level_names[static_cast<uint8_t>(level)];
+  }
+
+  /**
+   * @returns level by its name in config (e.g. 'info', 'warning' or 'warn'),
+   * or nullopt if {@param str} isn't name of level
+   */
+  constexpr std::optional<Level> levelFromStr(std::string_view str) {
+    for (size_t i = 0; i < detail::level_names.size(); ++i) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+      if (str == detail::level_names[i]) {
+        return static_cast<Level>(i);
+      }
+    }
+    // Short aliases
+    if (str == "crit") {
+      return Level::CRITICAL;
+    }
+    if (str == "warn") {
+      return Level::WARN;
+    }
+    if (str == "deb") {
+      return Level::DEBUG;
+    }
+    return std::nullopt;
+  }
+
 }  // namespace soralog
 
 #endif  // SORALOG_LEVEL
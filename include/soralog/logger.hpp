@@ -6,9 +6,13 @@
 #ifndef SORALOG_LOG
 #define SORALOG_LOG
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <type_traits>
 
+#include <soralog/hazard_pointer.hpp>
 #include <soralog/level.hpp>
 #include <soralog/sink.hpp>
 
@@ -20,13 +24,16 @@ namespace soralog {
   /**
    * @class Logger
    * @brief Entity for filtering events by level and pushing their data to sink
+   * Level and sink are published atomically: logging threads read them
+   * without locks and counting of references, while reconfiguration replaces
+   * them (see HazardGuard)
    */
   class Logger final {
    public:
     Logger() = delete;
     Logger(Logger &&) noexcept = delete;
     Logger(const Logger &) = delete;
-    ~Logger() = default;
+    ~Logger();
     Logger &operator=(Logger &&) noexcept = delete;
     Logger &operator=(Logger const &) = delete;
 
@@ -40,8 +47,10 @@ namespace soralog {
      */
     template <typename... Args>
     void push(Level level, std::string_view format, const Args &... args) {
-      if (level_ >= level) {
-        sink_->push(name_, level, format, args...);
+      if (level_.load(std::memory_order_relaxed) >= level) {
+        HazardGuard target(target_);
+        target->sink->push(target->filter_selection, name_, level, format,
+                           args...);
       }
     }
 
@@ -175,11 +184,71 @@ namespace soralog {
       push(Level::CRITICAL, "{}", arg);
     }
 
+    /**
+     * Logs event happened elsewhere (e.g. received from other process),
+     * keeping its time {@param timestamp} and origin thread
+     * ({@param thread_number} and {@param thread_name}), and its encoded
+     * {@param fields}
+     */
+    void relay(std::chrono::system_clock::time_point timestamp,
+               size_t thread_number, std::string_view thread_name,
+               Level level, std::string_view message,
+               std::string_view fields = {}) {
+      if (level_.load(std::memory_order_relaxed) >= level) {
+        HazardGuard target(target_);
+        target->sink->relay(target->filter_selection, name_, timestamp,
+                            thread_number, thread_name, level, message,
+                            fields);
+      }
+    }
+
+    /**
+     * Logs event from signal handler. Placeholders '{}' of {@param format}
+     * are replaced by integer {@param values} (nothing else is supported),
+     * and message is inserted into queue of sink without waiting, allocation
+     * and flushing (see Sink::pushFromSignal; logger must be prepared by
+     * prepareForSignal() in advance). Message longer than
+     * max_signal_message_size is truncated
+     * @returns false if event is dropped
+     */
+    template <typename... Ints>
+    bool logFromSignal(Level level, std::string_view format,
+                       Ints... values) noexcept {
+      static_assert((std::is_integral_v<Ints> && ...),
+                    "Only integers might be logged from signal handler");
+      if (level_.load(std::memory_order_relaxed) < level) {
+        return false;
+      }
+      HazardGuard target(target_, true);
+      if (!target->filter_selection.mightAccept(level)) {
+        return false;
+      }
+      const std::array<SignalArg, sizeof...(Ints)> args{
+          toSignalArg(values)...};
+      std::array<char, max_signal_message_size> message;
+      auto size = formatForSignal(message.data(), message.size(), format,
+                                  args.data(), args.size());
+      return target->sink->pushFromSignal(name_, level,
+                                          {message.data(), size});
+    }
+
+    /// Max size of message logged by logFromSignal()
+    static constexpr size_t max_signal_message_size = 512;
+
+    /**
+     * Starts sink of logger in advance (see Sink::prepare), so that
+     * logFromSignal() can use it. Sinks which are set to logger afterwards
+     * are started once they are set. Other loggers leave their sinks to start
+     * by first event
+     */
+    void prepareForSignal();
+
     /**
      * Flushes all events accumulated in sink immediately
      */
     void flush() const {
-      sink_->async_flush();
+      HazardGuard target(target_);
+      target->sink->async_flush();
     }
 
     // Level
@@ -188,7 +257,7 @@ namespace soralog {
      * @returns current level of logging
      */
     [[nodiscard]] Level level() const noexcept {
-      return level_;
+      return level_.load(std::memory_order_relaxed);
     }
 
     /**
@@ -225,7 +294,8 @@ namespace soralog {
      * @returns current sink of logging
      */
     [[nodiscard]] std::shared_ptr<const Sink> sink() const noexcept {
-      return sink_;
+      HazardGuard target(target_);
+      return target->sink;
     }
 
     /**
@@ -284,15 +354,63 @@ namespace soralog {
     void setGroup(const std::string &group_name);
 
    private:
+    /// Integer argument of logFromSignal()
+    struct SignalArg {
+      bool negative;
+      uint64_t magnitude;
+    };
+
+    template <typename Int>
+    static SignalArg toSignalArg(Int value) noexcept {
+      if constexpr (std::is_signed_v<Int>) {
+        // Negation in unsigned type is safe for min value too
+        return value < 0 ? SignalArg{true, 0 - static_cast<uint64_t>(value)}
+                         : SignalArg{false, static_cast<uint64_t>(value)};
+      } else {
+        return SignalArg{false, static_cast<uint64_t>(value)};
+      }
+    }
+
+    /**
+     * Substitutes {@param args} into {@param format} using buffer
+     * {@param buffer} of size {@param size}; async-signal-safe
+     * @returns size of message
+     */
+    static size_t formatForSignal(char *buffer, size_t size,
+                                  std::string_view format,
+                                  const SignalArg *args,
+                                  size_t count) noexcept;
+
+    /// Sink with rules of its filter, which are used by logging threads
+    struct Target {
+      std::shared_ptr<Sink> sink;
+      SinkFilter::Selection filter_selection;
+    };
+
+    /**
+     * Sets {@param sink} and publishes it, if it differs from current one
+     */
+    void replaceSink(std::shared_ptr<Sink> sink);
+
+    /**
+     * Selects rules of filter of sink applicable to this logger and publishes
+     * them with sink, unless they are published already; must be called each
+     * time sink or group is changed
+     */
+    void updateFilterSelection();
+
     LoggingSystem &system_;
 
     const std::string name_;
     std::shared_ptr<const Group> group_;
 
+    /// Sink as it's set; logging threads use target_
     std::shared_ptr<Sink> sink_;
     bool is_sink_overridden_{};
+    bool is_prepared_for_signal_{};
+    std::atomic<Target *> target_{nullptr};
 
-    Level level_{};
+    std::atomic<Level> level_{};
     bool is_level_overridden_{};
   };
 
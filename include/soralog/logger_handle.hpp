@@ -0,0 +1,57 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_LOGGERHANDLE
+#define SORALOG_LOGGERHANDLE
+
+namespace soralog {
+
+  class Logger;
+
+  /**
+   * @class LoggerHandle
+   * Copyable reference to logger kept by logging system (see
+   * LoggingSystem::getLoggerHandle). It's plain pointer, so copying it (e.g.
+   * into lambdas and tasks) doesn't touch counter of references, as copying
+   * of shared pointer does. Handle is valid while logging system exists.
+   * SL_ macros accept it as well as shared pointer
+   */
+  class LoggerHandle final {
+   public:
+    LoggerHandle() noexcept = default;
+
+    explicit LoggerHandle(Logger &logger) noexcept : logger_(&logger) {}
+
+    Logger *get() const noexcept {
+      return logger_;
+    }
+
+    Logger *operator->() const noexcept {
+      return logger_;
+    }
+
+    Logger &operator*() const noexcept {
+      return *logger_;
+    }
+
+    explicit operator bool() const noexcept {
+      return logger_ != nullptr;
+    }
+
+    bool operator==(const LoggerHandle &other) const noexcept {
+      return logger_ == other.logger_;
+    }
+
+    bool operator!=(const LoggerHandle &other) const noexcept {
+      return logger_ != other.logger_;
+    }
+
+   private:
+    Logger *logger_ = nullptr;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_LOGGERHANDLE
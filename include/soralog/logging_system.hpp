@@ -8,13 +8,22 @@
 
 #include <soralog/logger_factory.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <set>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <soralog/configurator.hpp>
+#include <soralog/logger_handle.hpp>
+#include <soralog/sharded_map.hpp>
 
 namespace soralog {
 
@@ -25,14 +34,17 @@ namespace soralog {
   /**
    * @class LoggingSystem
    * Holds created sinks and group and knowns created loggers to control his
-   * proterties
+   * proterties.
+   * Lookups (getLogger of existing logger, getSink, getGroup) take only
+   * shared lock of shard of map, so they run concurrently; changes are
+   * serialized by common mutex
    */
   class LoggingSystem final : public LoggerFactory {
    public:
     LoggingSystem() = delete;
     LoggingSystem(const LoggingSystem &) = delete;
     LoggingSystem &operator=(LoggingSystem const &) = delete;
-    ~LoggingSystem() override = default;
+    ~LoggingSystem() override;
     LoggingSystem(LoggingSystem &&tmp) noexcept = delete;
     LoggingSystem &operator=(LoggingSystem &&tmp) noexcept = delete;
 
@@ -44,6 +56,15 @@ namespace soralog {
      */
     [[nodiscard]] Configurator::Result configure();
 
+    /**
+     * Calls configurator again to apply changed config on working system
+     * (see ConfiguratorFromYAML and ConfigWatcher). Configurator is expected
+     * to make only changed sinks; existing groups are updated, and loggers
+     * follow them
+     * @return result of configure
+     */
+    [[nodiscard]] Configurator::Result reconfigure();
+
     /**
      * @returns loggers (with creating that if it isn't exists yet) with
      * name {@param logger_name} and group {@param group_name}
@@ -91,27 +112,119 @@ namespace soralog {
                        std::make_optional(level));
     }
 
+    /**
+     * @returns handle of logger (with creating that if it isn't exists yet)
+     * with name {@param logger_name} and group {@param group_name}. Logger is
+     * kept by system since then till system is destroyed
+     */
+    [[nodiscard]] LoggerHandle getLoggerHandle(std::string logger_name,
+                                               const std::string &group_name) {
+      return makeHandle(getLogger(std::move(logger_name), group_name));
+    }
+
+    /**
+     * @returns handle of {@param logger} got from this system (e.g. with
+     * overridden sink or level). Logger is kept by system since then till
+     * system is destroyed
+     */
+    [[nodiscard]] LoggerHandle makeHandle(std::shared_ptr<Logger> logger);
+
     /**
      * @returns sink with name {@param name}
      */
-    [[nodiscard]] std::shared_ptr<Sink> getSink(const std::string &name);
+    [[nodiscard]] std::shared_ptr<Sink> getSink(std::string_view name) const;
 
     /**
      * @returns group with name {@param name}
      */
-    [[nodiscard]] std::shared_ptr<Group> getGroup(const std::string &name);
+    [[nodiscard]] std::shared_ptr<Group> getGroup(
+        std::string_view name) const;
+
+    /**
+     * Calls {@param fn} for each sink (including sink to nowhere)
+     */
+    void forEachSink(
+        const std::function<void(const std::shared_ptr<Sink> &)> &fn) const;
+
+    /**
+     * Calls {@param fn} for each group
+     */
+    void forEachGroup(
+        const std::function<void(const std::shared_ptr<Group> &)> &fn) const;
+
+    /**
+     * Calls {@param fn} for each alive logger
+     */
+    void forEachLogger(
+        const std::function<void(const std::shared_ptr<Logger> &)> &fn) const;
+
+    /// State of group or logger at the moment of snapshot()
+    struct EntityState {
+      std::string name;
+      /// Name of parent group of group, or group of logger; empty if none
+      std::string group;
+      Level level;
+      std::string sink;
+      bool is_level_overridden;
+      bool is_sink_overridden;
+    };
+
+    /// Consistent state of all groups and alive loggers
+    struct Snapshot {
+      std::vector<EntityState> groups;
+      std::vector<EntityState> loggers;
+    };
+
+    /**
+     * @returns state of groups and loggers, taken at once, so it isn't torn
+     * by concurrent reconfiguration
+     */
+    [[nodiscard]] Snapshot snapshot() const;
 
     /**
      * Creates sink with type {@tparam SinkType} using arguments {@param args}
      */
     template <typename SinkType, typename... Args>
     std::shared_ptr<SinkType> makeSink(Args &&... args) {
-      std::lock_guard guard(mutex_);
       auto sink = std::make_shared<SinkType>(std::forward<Args>(args)...);
-      sinks_[sink->name()] = sink;
+      addSink(sink);
       return sink;
     }
 
+    /**
+     * Adds {@param sink}. If there is sink with the same name, it is replaced:
+     * groups and loggers which use it get new one
+     */
+    void addSink(std::shared_ptr<Sink> sink);
+
+    /**
+     * Retires sink with name {@param name}: groups which use it get sink to
+     * nowhere, loggers which use it get sink of own group, and events left in
+     * its queue are written
+     * @returns true if sink existed
+     */
+    bool removeSink(std::string_view name);
+
+    /**
+     * Installs handler of fatal signals (SIGSEGV, SIGBUS, SIGILL, SIGFPE,
+     * SIGABRT). Handler makes sinks stop accepting new events, drains queues
+     * of all sinks of this system, and re-raises signal. Draining takes at
+     * most {@param budget}, even if disk is wedged.
+     * Handler runs on alternate stack of the thread which calls this method;
+     * other threads might prepare own one by setupCrashStack().
+     * Only one logging system might have crash handler at a time
+     * @returns true if handler is installed
+     */
+    bool installCrashHandler(
+        std::chrono::milliseconds budget = std::chrono::seconds(1));
+
+    /**
+     * Sets alternate stack of signal handlers for current thread, so crash
+     * handler works even if thread has overflowed own stack
+     * @returns true if stack is set
+     */
+    static bool setupCrashStack();
+
     /**
      * Creates group with name {@param name}
      * @param parent - group from which sink and level are inherited
@@ -215,6 +328,26 @@ namespace soralog {
      */
     bool resetLevelOfLogger(const std::string &logger_name);
 
+    /**
+     * Calls {@param edits} which changes parents, sinks and levels of groups
+     * (e.g. by setParentOfGroup, setSinkOfGroup, setLevelOfGroup). Changes
+     * are propagated to subgroups and loggers once, after all edits are done.
+     * Transactions might be nested; outermost one propagates changes
+     */
+    void transaction(const std::function<void()> &edits);
+
+    /**
+     * Registers that parent of {@param group} is changed (it's called by
+     * group itself), so changes of new parent are propagated to it
+     */
+    void onParentOfGroupChanged(const Group &group);
+
+    /**
+     * Registers that group of {@param logger} is changed (it's called by
+     * logger itself), so changes of new group are propagated to it
+     */
+    void onGroupOfLoggerChanged(const Logger &logger);
+
    private:
     /**
      * @returns loggers (with creating that if it isn't exists yet) with
@@ -262,12 +395,120 @@ namespace soralog {
     static void setLevelOfLogger(const std::shared_ptr<Logger> &logger,
                                  std::optional<Level> level);
 
+    /**
+     * Marks {@param group} as changed; {@param reparented} means that its
+     * parent is changed. Changes are propagated at once, if there is no
+     * transaction in progress
+     */
+    void markEdited(const std::shared_ptr<Group> &group, bool reparented);
+
+    /**
+     * Propagates changes of edited groups to their subgroups and loggers;
+     * parents are processed before children
+     */
+    void propagateEdits();
+
+    /**
+     * Refreshes inherited properties of loggers of {@param group} and of
+     * subgroups (with their loggers) which inherit anything of it. All
+     * subgroups are refreshed if {@param reparented}, because chain of their
+     * parents is changed. Groups are refreshed once per pass, and recorded
+     * into {@param passed}
+     */
+    void propagate(const std::shared_ptr<Group> &group, bool reparented,
+                   std::map<const Group *, bool> &passed);
+
+    /**
+     * Refreshes properties of {@param logger} inherited from its group. Only
+     * level is stored, if sink isn't changed and group isn't
+     * {@param reparented}
+     */
+    static void refreshLogger(Logger &logger, bool reparented);
+
+    /**
+     * Adds {@param group} into list of children of its parent
+     */
+    void indexGroup(const std::shared_ptr<Group> &group);
+
+    /**
+     * Adds {@param logger} into list of loggers of its group
+     */
+    void indexLogger(const std::shared_ptr<Logger> &logger);
+
+    /**
+     * Makes crash handler see actual set of sinks
+     */
+    void updateCrashSinks();
+
+    /**
+     * Makes groups and loggers, which use sink {@param from} as own (not
+     * inherited) one, use sink {@param to} instead; then writes events left
+     * in queue of {@param from}
+     */
+    void relinkSink(const std::shared_ptr<Sink> &from,
+                    const std::shared_ptr<Sink> &to);
+
+    /**
+     * Handlers of pthread_atfork: systems are prepared to fork(), then
+     * resumed in parent process or reset in child one
+     */
+    static void onForkPrepare();
+    static void onForkParent();
+    static void onForkChild();
+
+    /**
+     * Takes locks and stops writing of sinks (see Sink::prepareFork), so
+     * nothing is left locked or half-written by threads which don't exist
+     * in child process
+     */
+    void prepareFork();
+
+    /**
+     * Releases everything taken by prepareFork() in parent process
+     */
+    void resumeAfterFork();
+
+    /**
+     * Resets locks and sinks in child process (see Sink::resetAfterFork)
+     */
+    void resetAfterFork();
+
+    /**
+     * @returns logger with name {@param logger_name} if it's alive; expired
+     * entry of it is removed
+     */
+    std::shared_ptr<Logger> findLogger(std::string_view logger_name);
+
+    /**
+     * Removes some expired entries of loggers near {@param logger_name}
+     */
+    void sweepLoggers(std::string_view logger_name);
+
     std::shared_ptr<Configurator> configurator_;
-    bool is_configured_ = false;
-    std::recursive_mutex mutex_;
-    std::unordered_map<std::string, std::weak_ptr<Logger>> loggers_;
-    std::unordered_map<std::string, std::shared_ptr<Sink>> sinks_;
-    std::unordered_map<std::string, std::shared_ptr<Group>> groups_;
+    std::atomic_bool is_configured_ = false;
+    mutable std::recursive_mutex mutex_;
+    ShardedMap<std::weak_ptr<Logger>> loggers_;
+    ShardedMap<std::shared_ptr<Sink>> sinks_;
+    ShardedMap<std::shared_ptr<Group>> groups_;
+
+    // Loggers referred by handles; they live as long as system
+    std::set<std::shared_ptr<Logger>> kept_loggers_;
+
+    // Tree of groups: children and loggers of each group. Entries are added
+    // when parent (group) is changed; ones that became stale are dropped
+    // when list is walked
+    std::map<const Group *, std::vector<std::shared_ptr<Group>>> children_;
+    std::map<const Group *, std::vector<std::weak_ptr<Logger>>> members_;
+
+    // Groups changed by transaction in progress, with flag of changed parent
+    size_t transaction_depth_ = 0;
+    std::map<std::shared_ptr<Group>, bool> edited_groups_;
+
+    // Sinks stopped while fork() is in progress
+    std::vector<std::shared_ptr<Sink>> forking_sinks_;
+
+    // Snapshot of sinks for crash handler is updated when sinks are changed
+    bool has_crash_handler_ = false;
   };
 
 }  // namespace soralog
@@ -7,6 +7,7 @@
 #define SORALOG_MACROS
 
 #include <soralog/logger.hpp>
+#include <soralog/logger_handle.hpp>
 
 /**
  * SL_LOG
@@ -23,10 +24,10 @@
  */
 
 namespace soralog::macro {
-  template <typename Logger, typename... Args>
-  inline void proxy(const std::shared_ptr<Logger> &log,
-                    soralog::Level level, std::string_view fmt,
-                    Args &&... args) {
+  /// {@param log} is pointer to logger: shared one or LoggerHandle
+  template <typename LoggerPtr, typename... Args>
+  inline void proxy(const LoggerPtr &log, soralog::Level level,
+                    std::string_view fmt, Args &&... args) {
     if (log->level() >= level) {
       log->log(level, fmt, std::move(args)()...);
     }
@@ -88,6 +89,9 @@ namespace soralog::macro {
 #ifndef WITHOUT_DEBUG_LOG_LEVEL
 #define SL_DEBUG(LOG, FMT, ...) \
   _SL_LOG((LOG), soralog::Level::DEBUG, (FMT), ##__VA_ARGS__, Z)
+#else
+#define SL_DEBUG(LOG, FMT, ...)
+#endif
 
 #define SL_VERBOSE(LOG, FMT, ...) \
   _SL_LOG((LOG), soralog::Level::VERBOSE, (FMT), ##__VA_ARGS__, Z)
@@ -99,7 +103,7 @@ namespace soralog::macro {
   _SL_LOG((LOG), soralog::Level::WARN, (FMT), ##__VA_ARGS__, Z)
 
 #define SL_ERROR(LOG, FMT, ...) \
-  _SL_LOG((LOG), soralog::Level::ERROR, (FMT), ##__VA_ARGS__, Z)
+  _SL_LOG((LOG), soralog::Level::ERROR_, (FMT), ##__VA_ARGS__, Z)
 
 #define SL_CRITICAL(LOG, FMT, ...) \
   _SL_LOG((LOG), soralog::Level::CRITICAL, (FMT), ##__VA_ARGS__, Z)
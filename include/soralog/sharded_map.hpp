@@ -0,0 +1,192 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SHARDEDMAP
+#define SORALOG_SHARDEDMAP
+
+#include <array>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+namespace soralog {
+
+  /**
+   * @class ShardedMap
+   * Read-mostly map of named entities. Names are spread over shards by hash,
+   * and each shard has own shared lock, so concurrent lookups don't contend
+   * with each other, and writer blocks only lookups of own shard. Lookup is
+   * done by std::string_view without building std::string.
+   * Absent entry is returned as default value of {@tparam T} (e.g. nullptr)
+   */
+  template <typename T, size_t shards = 16>
+  class ShardedMap final {
+   public:
+    /**
+     * @returns value of {@param key}, or default value if there is no such
+     * entry
+     */
+    T find(std::string_view key) const {
+      const auto &shard = shardOf(key);
+      std::shared_lock lock(shard.mutex);
+      if (auto it = shard.map.find(key); it != shard.map.end()) {
+        return it->second;
+      }
+      return T{};
+    }
+
+    /**
+     * Sets {@param value} of {@param key}
+     * @returns previous value, or default value if there was no such entry
+     */
+    T assign(std::string_view key, T value) {
+      auto &shard = shardOf(key);
+      std::unique_lock lock(shard.mutex);
+      auto it = shard.map.find(key);
+      if (it == shard.map.end()) {
+        shard.map.emplace(key, std::move(value));
+        return T{};
+      }
+      std::swap(it->second, value);
+      return value;
+    }
+
+    /**
+     * Removes entry of {@param key}
+     * @returns true if it was existed
+     */
+    bool erase(std::string_view key) {
+      auto &shard = shardOf(key);
+      std::unique_lock lock(shard.mutex);
+      if (auto it = shard.map.find(key); it != shard.map.end()) {
+        shard.map.erase(it);
+        return true;
+      }
+      return false;
+    }
+
+    /**
+     * @returns true if map has no entries
+     */
+    bool empty() const {
+      for (const auto &shard : shards_) {
+        std::shared_lock lock(shard.mutex);
+        if (!shard.map.empty()) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * Calls {@param fn} with name and value of each entry. Shards are
+     * visited one by one, so it isn't snapshot of whole map
+     */
+    template <typename Fn>
+    void forEach(const Fn &fn) const {
+      for (const auto &shard : shards_) {
+        std::shared_lock lock(shard.mutex);
+        for (const auto &[key, value] : shard.map) {
+          fn(key, value);
+        }
+      }
+    }
+
+    /**
+     * Calls {@param pred} with name and value of each entry, and removes
+     * entry if it returns true
+     */
+    template <typename Pred>
+    void eraseIf(const Pred &pred) {
+      for (auto &shard : shards_) {
+        std::unique_lock lock(shard.mutex);
+        for (auto it = shard.map.begin(); it != shard.map.end();) {
+          if (pred(it->first, it->second)) {
+            it = shard.map.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+    }
+
+    /**
+     * Checks at most {@param count} entries of shard of {@param key}, and
+     * removes ones which value satisfies {@param pred}. Each call continues
+     * from entry where previous one of the same shard stopped, so stale
+     * entries are cleaned up incrementally
+     */
+    template <typename Pred>
+    void sweep(std::string_view key, size_t count, const Pred &pred) {
+      auto &shard = shardOf(key);
+      std::unique_lock lock(shard.mutex);
+      auto it = shard.map.lower_bound(shard.cursor);
+      for (; count != 0 && !shard.map.empty(); --count) {
+        if (it == shard.map.end()) {
+          it = shard.map.begin();
+        }
+        if (pred(it->second)) {
+          it = shard.map.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      shard.cursor = it == shard.map.end() ? std::string{} : it->first;
+    }
+
+    /**
+     * Locks all shards exclusively, e.g. before fork(), so no lock is taken
+     * by thread which doesn't exist in child process
+     */
+    void lockAll() {
+      for (auto &shard : shards_) {
+        shard.mutex.lock();
+      }
+    }
+
+    /**
+     * Unlocks shards locked by lockAll()
+     */
+    void unlockAll() {
+      for (auto &shard : shards_) {
+        shard.mutex.unlock();
+      }
+    }
+
+    /**
+     * Same as unlockAll(), but in child process after fork(). Locks taken
+     * in parent can't be released by other process, so they are made anew
+     */
+    void resetLocks() {
+      for (auto &shard : shards_) {
+        new (&shard.mutex) std::shared_mutex;
+      }
+    }
+
+   private:
+    struct alignas(64) Shard {
+      mutable std::shared_mutex mutex;
+      std::map<std::string, T, std::less<>> map;
+      std::string cursor;  // of sweep()
+    };
+
+    Shard &shardOf(std::string_view key) {
+      return shards_[std::hash<std::string_view>{}(key) % shards];
+    }
+
+    const Shard &shardOf(std::string_view key) const {
+      return shards_[std::hash<std::string_view>{}(key) % shards];
+    }
+
+    std::array<Shard, shards> shards_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SHARDEDMAP
@@ -7,11 +7,17 @@
 #define SORALOG_SINK
 
 #include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <soralog/circular_buffer.hpp>
 #include <soralog/event.hpp>
+#include <soralog/sink_filter.hpp>
+#include <soralog/worker_placement.hpp>
 
 #ifdef NDEBUG
 #define IF_RELEASE true
@@ -42,13 +48,21 @@ namespace soralog {
     Sink &operator=(Sink const &) = delete;
     Sink &operator=(Sink &&) noexcept = delete;
 
+    /**
+     * If {@param lazy}, queue isn't allocated and start() isn't called till
+     * the first event, so sink which is configured but never used costs
+     * nothing
+     */
     Sink(std::string name, ThreadInfoType thread_info_type, size_t max_events,
-         size_t max_buffer_size, size_t latency)
+         size_t max_buffer_size, size_t latency, bool lazy = false)
         : name_(std::move(name)),
           thread_info_type_(thread_info_type),
-          events_(max_events),
+          events_(max_events, lazy),
           max_buffer_size_(max_buffer_size),
           latency_(latency) {
+      if (lazy) {
+        started_.store(false, std::memory_order_relaxed);
+      }
       // Auto-fix buffer size
       if (max_buffer_size_ < sizeof(Event) * 2) {
         const_cast<size_t &>(max_buffer_size_) = sizeof(Event) * 2;  // NOLINT
@@ -62,6 +76,59 @@ namespace soralog {
       return name_;
     }
 
+    /// State of queue of events
+    struct QueueStats {
+      size_t events;
+      size_t capacity;
+      size_t bytes;
+      size_t max_bytes;
+    };
+
+    /**
+     * @returns current fill of queue
+     */
+    QueueStats queueStats() const noexcept {
+      return {events_.size(), events_.capacity(),
+              size_.load(std::memory_order_relaxed), max_buffer_size_};
+    }
+
+    /**
+     * @returns filter of events, or nullptr if sink accepts all of them
+     */
+    const std::shared_ptr<const SinkFilter> &filter() const noexcept {
+      return filter_;
+    }
+
+    /**
+     * Sets {@param filter} of events. Must be set before sink is used by
+     * loggers, because they select rules of filter once (see
+     * SinkFilter::select)
+     */
+    void setFilter(std::shared_ptr<const SinkFilter> filter) noexcept {
+      filter_ = std::move(filter);
+    }
+
+    /**
+     * @returns rules of filter applicable to logger {@param name} of groups
+     * {@param group_names}
+     */
+    SinkFilter::Selection selectFilter(
+        std::string_view name,
+        const std::vector<std::string_view> &group_names = {}) const {
+      return filter_ ? filter_->select(name, group_names)
+                     : SinkFilter::Selection{};
+    }
+
+    /**
+     * Is called when logger {@param name} of groups {@param group_names}
+     * starts using sink or is moved to other group. Sink relaying events of
+     * loggers into other sinks selects filters of those here (see
+     * SinkToFlightRecorder). By default does nothing
+     */
+    virtual void bindLogger(
+        std::string_view name,
+        const std::vector<std::string_view> &group_names) {}
+
     /**
      * Emplaces new log event
      * @param name is name of logger
@@ -72,9 +139,267 @@ namespace soralog {
     template <typename... Args>
     void push(std::string_view name, Level level, std::string_view format,
               const Args &... args) noexcept(IF_RELEASE) {
+      if (filter_) {
+        push(selectFilter(name), name, level, format, args...);
+      } else {
+        emplace(name, thread_info_type_, level, format, args...);
+      }
+    }
+
+    /**
+     * Same as above, but filter is applied by rules of {@param selection}
+     * selected in advance (see selectFilter). Rejected event is never put
+     * into queue: level is checked before formatting, and message (if rules
+     * need) is formatted aside and checked before queueing
+     */
+    template <typename... Args>
+    void push(const SinkFilter::Selection &selection, std::string_view name,
+              Level level, std::string_view format,
+              const Args &... args) noexcept(IF_RELEASE) {
+      if (!selection.mightAccept(level)) {
+        return;
+      }
+      if (!filter_ || !selection.needsMessage(level)) {
+        emplace(name, thread_info_type_, level, format, args...);
+        return;
+      }
+      auto &event = filteredEvent();
+      event.emplace(name, thread_info_type_, level, format, args...);
+      if (filter_->acceptsMessage(selection, event->level(),
+                                  event->message())) {
+        emplace(event->timestamp(), event->thread_number(),
+                event->thread_name(), event->name(), event->level(),
+                event->message(), event->fields().data());
+      }
+    }
+
+    /**
+     * Emplaces log event happened elsewhere (e.g. received from other
+     * process), keeping its own time and thread. Rules of filter are selected
+     * by name of logger for each event, so rules limited by groups never
+     * match it; caller knowing origin logger selects them in advance
+     * @param name is name of logger
+     * @param timestamp is time of event
+     * @param thread_number and @param thread_name define origin thread
+     * @param level is level log event
+     * @param message is message of event
+     * @param fields are encoded fields of event (see Fields)
+     */
+    void relay(std::string_view name,
+               std::chrono::system_clock::time_point timestamp,
+               size_t thread_number, std::string_view thread_name,
+               Level level, std::string_view message,
+               std::string_view fields = {}) noexcept(IF_RELEASE) {
+      relay(selectFilter(name), name, timestamp, thread_number, thread_name,
+            level, message, fields);
+    }
+
+    /**
+     * Same as above, but filter is applied by rules of {@param selection}
+     * selected in advance (see selectFilter)
+     */
+    void relay(const SinkFilter::Selection &selection, std::string_view name,
+               std::chrono::system_clock::time_point timestamp,
+               size_t thread_number, std::string_view thread_name,
+               Level level, std::string_view message,
+               std::string_view fields = {}) noexcept(IF_RELEASE) {
+      if (!selection.mightAccept(level)
+          || (filter_ && selection.needsMessage(level)
+              && !filter_->acceptsMessage(selection, level, message))) {
+        return;
+      }
+      emplace(timestamp, thread_number, thread_name, name, level, message,
+              fields);
+    }
+
+    /**
+     * Pushes preformatted {@param message} from signal handler (or other
+     * context where nothing but lock-free operations are allowed).
+     * Filter of sink isn't applied here (caller might check level by
+     * selection of filter made in advance).
+     * Event is only inserted into queue: there is no formatting, allocation,
+     * waiting for place, or flushing; worker of sink writes it within its
+     * latency (sink without latency writes it on next flush). Lazy sink must
+     * be prepared in advance (see prepare())
+     * @returns false if event is dropped because queue is full or sink is
+     * not started
+     */
+    bool pushFromSignal(std::string_view name, Level level,
+                        std::string_view message) noexcept {
+      if (frozen_.load(std::memory_order_relaxed)
+          || disabled_.load(std::memory_order_relaxed) || !isStarted()) {
+        return false;
+      }
+      auto node = events_.tryPut(std::chrono::system_clock::now(),
+                                 util::getThreadNumber(), std::string_view{},
+                                 name, level, message);
+      if (!node) {
+        return false;
+      }
+      size_ += node->message().size();
+      node.release();
+      return true;
+    }
+
+    /**
+     * Starts lazy sink in advance (see start()), if it has not got any event
+     * yet. It must be done before sink is used from signal handler, where
+     * sink can't start
+     */
+    void prepare() {
+      if (!isStarted()) {
+        std::lock_guard lock(start_mutex_);
+        if (!isStarted()) {
+          events_.allocate();
+          worker_placement_.bindMemory(events_.memory(),
+                                       events_.memorySize(), name_);
+          start();
+          started_.store(true, std::memory_order_release);
+        }
+      }
+    }
+
+    const WorkerPlacement &workerPlacement() const noexcept {
+      return worker_placement_;
+    }
+
+    /**
+     * Sets {@param placement} of worker thread of sink; queue of sink is
+     * moved to NUMA node of worker. Must be set once, before sink is used
+     * by loggers. Worker which is already running applies it on its next
+     * wake up
+     */
+    void setWorkerPlacement(WorkerPlacement placement) {
+      worker_placement_ = std::move(placement);
+      if (events_.memory() != nullptr) {
+        worker_placement_.bindMemory(events_.memory(), events_.memorySize(),
+                                     name_);
+      }
+      placement_changed_.store(true, std::memory_order_release);
+    }
+
+    /// Behavior of sink in child process after fork()
+    enum class ForkPolicy {
+      RESTART,  //!< Worker is started again by the first event of child
+      REOPEN,   //!< Same, and destination (e.g. log-file) is reopened too
+      DISABLE   //!< Child drops events of sink
+    };
+
+    ForkPolicy forkPolicy() const noexcept {
+      return fork_policy_;
+    }
+
+    /**
+     * Sets {@param policy} of sink in child process after fork(). Sink which
+     * doesn't support restart (see resetInChild) is disabled in child anyway
+     */
+    void setForkPolicy(ForkPolicy policy) noexcept {
+      fork_policy_ = policy;
+    }
+
+    /**
+     * Writes queued events and stops writing till fork() is done, so no
+     * worker holds lock or is in the middle of write at the moment of fork.
+     * Called by handler of pthread_atfork (see LoggingSystem)
+     */
+    void prepareFork() noexcept {
+      start_mutex_.lock();
+      if (isStarted()) {
+        flush();
+      }
+      lockForFork();
+    }
+
+    /**
+     * Resumes writing in parent process after fork()
+     */
+    void resumeAfterFork() noexcept {
+      unlockForFork();
+      start_mutex_.unlock();
+    }
+
+    /**
+     * Resets sink in child process after fork() by its policy. Events queued
+     * at the moment of fork are dropped, because parent writes them
+     */
+    void resetAfterFork() noexcept {
+      events_.clear();
+      size_.store(0, std::memory_order_relaxed);
+      const bool restartable =
+          resetInChild(fork_policy_ == ForkPolicy::REOPEN);
+      if (!restartable || fork_policy_ == ForkPolicy::DISABLE) {
+        disabled_.store(true, std::memory_order_release);
+      } else if (isStarted()) {
+        started_.store(false, std::memory_order_release);
+      }
+      // New worker of child has to be placed again
+      placement_changed_.store(!worker_placement_.empty(),
+                               std::memory_order_relaxed);
+      // Lock is held by thread of parent, which doesn't exist here
+      new (&start_mutex_) std::mutex;
+    }
+
+    /**
+     * Does writing all events in destination place immediately
+     */
+    virtual void flush() noexcept = 0;
+
+    /**
+     * Does writing all events in destination place asynchronously
+     */
+    virtual void async_flush() noexcept = 0;
+
+    /**
+     * Does some actions to rorate log data (e.g. reopen log-file)
+     */
+    virtual void rotate() noexcept = 0;
+
+    /**
+     * Writes events left in queue into destination place from handler of
+     * fatal signal (see LoggingSystem::installCrashHandler). Only
+     * async-signal-safe calls might be used, and work must be stopped at
+     * {@param deadline}. By default does nothing, i.e. events are lost
+     */
+    virtual void drainOnCrash(
+        std::chrono::steady_clock::time_point deadline) noexcept {}
+
+    /**
+     * Makes all sinks drop new events, e.g. when process is crashing
+     */
+    static void freeze() noexcept {
+      frozen_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Requests rotation of all sinks. It's safe to call from signal handler:
+     * request is only marked, and each sink rotates on its next flush
+     */
+    static void requestRotation() noexcept {
+      rotation_requests_.fetch_add(1, std::memory_order_release);
+    }
+
+   private:
+    /**
+     * @returns event of current thread to check message before queueing
+     */
+    static std::optional<Event> &filteredEvent() noexcept {
+      thread_local std::optional<Event> event;
+      return event;
+    }
+
+    /**
+     * Constructs event in queue by {@param args}, flushing queue if needed
+     */
+    template <typename... Args>
+    void emplace(const Args &... args) noexcept(IF_RELEASE) {
+      if (frozen_.load(std::memory_order_relaxed)
+          || disabled_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      prepare();
+
       while (true) {
-        auto node =
-            events_.put(name, thread_info_type_, level, format, args...);
+        auto node = events_.put(args...);
 
         // Event is queued successfully
         if (node) {
@@ -94,22 +419,97 @@ namespace soralog {
       }
     }
 
+    inline static std::atomic_bool frozen_ = false;
+    inline static std::atomic_size_t rotation_requests_ = 0;
+    static_assert(std::atomic_size_t::is_always_lock_free,
+                  "Signal handler needs lock-free counter");
+
+    size_t seen_rotation_requests_ =
+        rotation_requests_.load(std::memory_order_relaxed);
+
+    std::shared_ptr<const SinkFilter> filter_;
+
+    std::mutex start_mutex_;
+    std::atomic_bool started_ = true;
+    std::atomic_bool disabled_ = false;
+    ForkPolicy fork_policy_ = ForkPolicy::RESTART;
+    WorkerPlacement worker_placement_;
+    std::atomic_bool placement_changed_ = false;
+
+   protected:
     /**
-     * Does writing all events in destination place immediately
+     * Allocates buffers, opens destination and starts worker of lazy sink.
+     * Called by thread which pushes the first event or prepares sink; it's
+     * called again in child process after fork(), so resources which are
+     * already made must be kept
      */
-    virtual void flush() noexcept = 0;
+    virtual void start() {}
 
     /**
-     * Does writing all events in destination place asynchronously
+     * Waits for worker to finish current write, and holds it till
+     * unlockForFork()
      */
-    virtual void async_flush() noexcept = 0;
+    virtual void lockForFork() noexcept {}
+
+    virtual void unlockForFork() noexcept {}
 
     /**
-     * Does some actions to rorate log data (e.g. reopen log-file)
+     * Resets state of worker in child process after fork(), where only
+     * forking thread exists, and locks taken by lockForFork() can't be
+     * released. File is reopened on next write if {@param reopen}
+     * @returns false if sink can't be restarted, so it's disabled in child
      */
-    virtual void rotate() noexcept = 0;
+    virtual bool resetInChild(bool reopen) noexcept {
+      return false;
+    }
+
+    /**
+     * Applies placement of worker (see setWorkerPlacement) if it's changed.
+     * Must be called by worker thread each time it wakes up
+     */
+    void placeWorker() noexcept {
+      if (placement_changed_.load(std::memory_order_relaxed)
+          && placement_changed_.exchange(false, std::memory_order_acquire)) {
+        worker_placement_.applyToCurrentThread(name_);
+      }
+    }
+
+    /**
+     * Passes events of queue to {@param fn} from handler of fatal signal,
+     * till {@param fn} returns false, {@param deadline} comes, or queue ends
+     * by event which isn't constructed yet (e.g. its formatting has crashed)
+     */
+    template <typename Fn>
+    void drainQueue(std::chrono::steady_clock::time_point deadline,
+                    const Fn &fn) noexcept {
+      while (std::chrono::steady_clock::now() < deadline) {
+        auto node = events_.tryGet();
+        if (!node || !fn(*node)) {
+          return;
+        }
+      }
+    }
+
+    /**
+     * @returns false if sink is lazy and has not got any event yet
+     */
+    bool isStarted() const noexcept {
+      return started_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @returns true if rotation is requested by requestRotation() since
+     * previous check. Must be called by one thread at a time (i.e. in flush)
+     */
+    bool isRotationRequested() noexcept {
+      const auto requests = rotation_requests_.load(std::memory_order_acquire);
+      if (requests == seen_rotation_requests_) {
+        return false;
+      }
+      seen_rotation_requests_ = requests;
+      return true;
+    }
 
-   protected:
     // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
     const std::string name_;
     // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
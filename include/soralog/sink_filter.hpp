@@ -0,0 +1,123 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_SINKFILTER
+#define SORALOG_SINKFILTER
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <soralog/level.hpp>
+
+namespace soralog {
+
+  /**
+   * @class SinkFilter
+   * Filter of events accepted by sink. It is set of rules; event is accepted
+   * if it matches any rule. Rule matches event if level of event is not more
+   * detailed than threshold of rule, logger (or its group) matches globs of
+   * rule, and message passes substring and regex checks of rule.
+   *
+   * Names are checked once per logger (see select()), so logging checks only
+   * level, and message checks are done only for rules which have them
+   */
+  class SinkFilter final {
+   public:
+    struct Rule {
+      /// Most detailed accepted level
+      Level level = Level::TRACE;
+      /// Globs ('*' - any sequence, '?' - any char) of logger name;
+      /// empty means any logger
+      std::vector<std::string> loggers;
+      /// Globs of group of logger or any its parent; empty means any group
+      std::vector<std::string> groups;
+      /// Substrings which message must contain (all of them)
+      std::vector<std::string> contains;
+      /// ECMAScript regex which must be found in message
+      std::optional<std::string> regex;
+    };
+
+    /// Rules applicable to some logger. Default one accepts everything
+    struct Selection {
+      /// Most detailed level accepted by any selected rule
+      Level level = Level::TRACE;
+      /// Most detailed level accepted by rule without message checks
+      Level plain_level = Level::TRACE;
+      /// Bitmask of selected rules with message checks
+      uint64_t rules = 0;
+
+      /**
+       * @returns true if event of {@param level} might be accepted
+       */
+      bool mightAccept(Level level) const noexcept {
+        return this->level >= level;
+      }
+
+      /**
+       * @returns true if message must be checked to accept event of
+       * {@param level}
+       */
+      bool needsMessage(Level level) const noexcept {
+        return plain_level < level;
+      }
+
+      bool operator==(const Selection &other) const noexcept {
+        return level == other.level && plain_level == other.plain_level
+            && rules == other.rules;
+      }
+
+      bool operator!=(const Selection &other) const noexcept {
+        return !(*this == other);
+      }
+    };
+
+    static constexpr size_t max_rules = 64;
+
+    SinkFilter() = delete;
+    SinkFilter(SinkFilter &&) noexcept = delete;
+    SinkFilter(const SinkFilter &) = delete;
+    SinkFilter &operator=(SinkFilter &&) noexcept = delete;
+    SinkFilter &operator=(SinkFilter const &) = delete;
+    ~SinkFilter();
+
+    /**
+     * Compiles {@param rules}
+     * @throws std::invalid_argument if there are no rules, too many rules or
+     * regex is malformed
+     */
+    explicit SinkFilter(std::vector<Rule> rules);
+
+    /**
+     * @returns rules applicable to logger {@param logger_name} of groups
+     * {@param group_names} (its group and parents of that)
+     */
+    Selection select(std::string_view logger_name,
+                     const std::vector<std::string_view> &group_names) const;
+
+    /**
+     * @returns true if {@param message} of event of {@param level} passes
+     * checks of any rule of {@param selection}
+     */
+    bool acceptsMessage(const Selection &selection, Level level,
+                        std::string_view message) const;
+
+    /**
+     * @returns true if {@param text} matches {@param glob}
+     */
+    static bool matchGlob(std::string_view glob,
+                          std::string_view text) noexcept;
+
+   private:
+    struct CompiledRule;
+
+    std::vector<CompiledRule> rules_;
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_SINKFILTER
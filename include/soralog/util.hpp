@@ -10,6 +10,8 @@
 #include <pthread.h>
 #endif
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <string>
 
 namespace soralog::util {
@@ -0,0 +1,71 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SORALOG_WORKERPLACEMENT
+#define SORALOG_WORKERPLACEMENT
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace soralog {
+
+  /**
+   * @struct WorkerPlacement
+   * Where and how worker thread of sink runs: CPUs it may use, its
+   * scheduling policy and niceness, and NUMA node which keeps its memory.
+   * It's used to keep writing of logs off cores of latency-critical threads.
+   * Supported on Linux only; elsewhere it's ignored
+   */
+  struct WorkerPlacement {
+    /// Scheduling policy of worker
+    enum class Policy {
+      NORMAL,  //!< Policy of thread which started worker (SCHED_OTHER)
+      BATCH,   //!< SCHED_BATCH: CPU-bound, never preempts other threads
+      IDLE     //!< SCHED_IDLE: runs only when CPU has nothing else to do
+    };
+
+    /// CPUs which worker may use; empty means CPUs of numa_node, or any
+    std::vector<unsigned> cpus;
+    /// NUMA node of worker and memory of queue of sink
+    std::optional<unsigned> numa_node;
+    Policy policy = Policy::NORMAL;
+    /// Niceness of worker (-20..19); negative one requires privileges
+    std::optional<int> nice;
+
+    /**
+     * @returns true if worker is left as scheduler placed it
+     */
+    bool empty() const noexcept {
+      return cpus.empty() && !numa_node && policy == Policy::NORMAL && !nice;
+    }
+
+    /**
+     * Applies placement to calling thread. Failures are reported to stderr
+     * for worker {@param worker_name}, and the rest is applied anyway
+     */
+    void applyToCurrentThread(std::string_view worker_name) const noexcept;
+
+    /**
+     * Moves pages of memory {@param data} of {@param size} bytes to
+     * numa_node, if it's set. Pages shared with other data are left in
+     * place. Failure is reported to stderr for worker {@param worker_name}
+     */
+    void bindMemory(const void *data, size_t size,
+                    std::string_view worker_name) const noexcept;
+
+    /**
+     * Parses list of CPUs like '0-3,8,10-11'
+     * @returns nullopt if {@param list} is malformed
+     */
+    static std::optional<std::vector<unsigned>> parseCpuList(
+        std::string_view list);
+  };
+
+}  // namespace soralog
+
+#endif  // SORALOG_WORKERPLACEMENT
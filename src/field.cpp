@@ -0,0 +1,170 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/field.hpp>
+
+#include <cstring>
+
+#include <soralog/impl/binary_format.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace binary_format;
+
+    /**
+     * Puts type {@param type} and {@param key} of field at {@param ptr}, if
+     * there is room for them and {@param value_size} bytes of value before
+     * {@param end}
+     * @returns false if there is no room
+     */
+    bool put_head(char *&ptr, const char *end, FieldType type,
+                  std::string_view key, size_t value_size) {
+      key = key.substr(0, UINT8_MAX);
+      if (static_cast<size_t>(end - ptr) < 2 + key.size() + value_size) {
+        return false;
+      }
+      *ptr++ = static_cast<char>(type);        // NOLINT
+      *ptr++ = static_cast<char>(key.size());  // NOLINT
+      std::memcpy(ptr, key.data(), key.size());
+      ptr += key.size();  // NOLINT
+      return true;
+    }
+
+    void put_text_string(char *&ptr, std::string_view str) {
+      if (!str.empty()
+          && str.find_first_of(" \"\\=") == std::string_view::npos) {
+        std::memcpy(ptr, str.data(), str.size());
+        ptr += str.size();  // NOLINT
+        return;
+      }
+      *ptr++ = '"';  // NOLINT
+      for (auto c : str) {
+        if (c == '"' || c == '\\') {
+          *ptr++ = '\\';  // NOLINT
+        }
+        *ptr++ = c;  // NOLINT
+      }
+      *ptr++ = '"';  // NOLINT
+    }
+
+  }  // namespace
+
+  void Fields::put(char *&ptr, const char *end, std::string_view key,
+                   int64_t value) {
+    const auto encoded = zigzagEncode(value);
+    if (put_head(ptr, end, FieldType::INT, key, varintSize(encoded))) {
+      putVarint(ptr, encoded);
+    }
+  }
+
+  void Fields::put(char *&ptr, const char *end, std::string_view key,
+                   uint64_t value) {
+    if (put_head(ptr, end, FieldType::UINT, key, varintSize(value))) {
+      putVarint(ptr, value);
+    }
+  }
+
+  void Fields::put(char *&ptr, const char *end, std::string_view key,
+                   double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if (put_head(ptr, end, FieldType::DOUBLE, key, sizeof(bits))) {
+      for (size_t i = 0; i < sizeof(bits); ++i) {
+        *ptr++ = static_cast<char>(bits >> (i * 8));  // NOLINT
+      }
+    }
+  }
+
+  void Fields::put(char *&ptr, const char *end, std::string_view key,
+                   bool value) {
+    if (put_head(ptr, end, FieldType::BOOL, key, 1)) {
+      *ptr++ = value ? 1 : 0;  // NOLINT
+    }
+  }
+
+  void Fields::put(char *&ptr, const char *end, std::string_view key,
+                   std::string_view value) {
+    // Value is cut to fit, but its size must fit anyway
+    if (put_head(ptr, end, FieldType::STRING, key, max_varint_size)) {
+      const auto room = static_cast<size_t>(end - ptr);
+      putString(ptr, value.substr(0, room - varintSize(room)));
+    }
+  }
+
+  bool Fields::next(const char *&ptr, const char *end, View &field) {
+    if (end - ptr < 2) {
+      return false;
+    }
+    field = View{};
+    field.type = static_cast<FieldType>(*ptr++);         // NOLINT
+    const auto key_size = static_cast<uint8_t>(*ptr++);  // NOLINT
+    if (static_cast<size_t>(end - ptr) < key_size) {
+      return false;
+    }
+    field.key = {ptr, key_size};
+    ptr += key_size;  // NOLINT
+
+    uint64_t value = 0;
+    switch (field.type) {
+      case FieldType::INT:
+        if (!getVarint(ptr, end, value)) {
+          return false;
+        }
+        field.int_value = zigzagDecode(value);
+        return true;
+      case FieldType::UINT:
+        return getVarint(ptr, end, field.uint_value);
+      case FieldType::DOUBLE:
+        if (end - ptr < 8) {
+          return false;
+        }
+        for (size_t i = 0; i < 8; ++i) {
+          value |= static_cast<uint64_t>(static_cast<uint8_t>(ptr[i]))
+                << (i * 8);  // NOLINT
+        }
+        std::memcpy(&field.double_value, &value, sizeof(value));
+        ptr += 8;  // NOLINT
+        return true;
+      case FieldType::BOOL:
+        if (ptr == end) {
+          return false;
+        }
+        field.bool_value = *ptr++ != 0;  // NOLINT
+        return true;
+      case FieldType::STRING:
+        return getString(ptr, end, field.string_value);
+      default:
+        return false;
+    }
+  }
+
+  void Fields::putText(char *&ptr) const {
+    forEach([&](const View &field) {
+      *ptr++ = ' ';  // NOLINT
+      std::memcpy(ptr, field.key.data(), field.key.size());
+      ptr += field.key.size();  // NOLINT
+      *ptr++ = '=';  // NOLINT
+      switch (field.type) {
+        case FieldType::INT:
+          ptr = fmt::format_to(ptr, "{}", field.int_value);
+          break;
+        case FieldType::UINT:
+          ptr = fmt::format_to(ptr, "{}", field.uint_value);
+          break;
+        case FieldType::DOUBLE:
+          ptr = fmt::format_to(ptr, "{}", field.double_value);
+          break;
+        case FieldType::BOOL:
+          ptr = fmt::format_to(ptr, "{}", field.bool_value);
+          break;
+        default:
+          put_text_string(ptr, field.string_value);
+      }
+    });
+  }
+
+}  // namespace soralog
@@ -106,8 +106,12 @@ namespace soralog {
   }
 
   void Group::setParentGroup(std::shared_ptr<const Group> group) {
+    const bool changed = parent_group_ != group;
     parent_group_ = std::move(group);
     if (parent_group_) {
+      if (changed) {
+        system_.onParentOfGroupChanged(*this);
+      }
       if (!is_sink_overridden_) {
         setSinkFromGroup(parent_group_);
       }
@@ -0,0 +1,132 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/hazard_pointer.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace soralog::hazard {
+
+  namespace {
+
+    std::atomic<Record *> records = nullptr;
+
+    /// Objects which wait for deletion
+    std::mutex retired_mutex;
+    std::vector<std::pair<const void *, void (*)(const void *)>> retired;
+
+    /**
+     * Holds record while thread exists
+     */
+    struct Owner final {
+      Owner(Owner &&) noexcept = delete;
+      Owner(const Owner &) = delete;
+      Owner &operator=(Owner &&) noexcept = delete;
+      Owner &operator=(Owner const &) = delete;
+
+      Owner() {
+        for (auto *record = records.load(std::memory_order_acquire);
+             record != nullptr; record = record->next) {
+          bool false_v = false;
+          if (record->active.compare_exchange_strong(
+                  false_v, true, std::memory_order_acq_rel)) {
+            this->record = record;
+            return;
+          }
+        }
+        record = new Record;  // NOLINT(cppcoreguidelines-owning-memory)
+        record->active.store(true, std::memory_order_relaxed);
+        record->next = records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(record->next, record,
+                                              std::memory_order_acq_rel)) {
+        }
+      }
+
+      ~Owner() {
+        current_record = nullptr;
+        record->active.store(false, std::memory_order_release);
+      }
+
+      Record *record;
+    };
+
+  }  // namespace
+
+  Record &acquireRecord() {
+    static thread_local Owner owner;
+    current_record = owner.record;
+    return *owner.record;
+  }
+
+  void retire(const void *ptr, void (*deleter)(const void *)) {
+    {
+      std::lock_guard lock(retired_mutex);
+      retired.emplace_back(ptr, deleter);
+    }
+    reclaim();
+  }
+
+  void reclaim() {
+    decltype(retired) deletable;
+    {
+      std::lock_guard lock(retired_mutex);
+      if (retired.empty()
+          || unslotted_readers.load(std::memory_order_seq_cst) != 0) {
+        return;
+      }
+      std::vector<const void *> hazards;
+      for (auto *record = records.load(std::memory_order_acquire);
+           record != nullptr; record = record->next) {
+        for (const auto &slot : record->slots) {
+          if (auto *ptr = slot.load(std::memory_order_seq_cst)) {
+            hazards.push_back(ptr);
+          }
+        }
+      }
+      std::sort(hazards.begin(), hazards.end());
+      auto protected_end = std::partition(
+          retired.begin(), retired.end(), [&](const auto &item) {
+            return std::binary_search(hazards.begin(), hazards.end(),
+                                      item.first);
+          });
+      deletable.assign(protected_end, retired.end());
+      retired.erase(protected_end, retired.end());
+    }
+    // Deleter might release something heavy (e.g. sink), so it's called
+    // without lock
+    for (const auto &[ptr, deleter] : deletable) {
+      deleter(ptr);
+    }
+  }
+
+  void prepareFork() {
+    retired_mutex.lock();
+  }
+
+  void resumeAfterFork() {
+    retired_mutex.unlock();
+  }
+
+  void resetAfterFork() {
+    new (&retired_mutex) std::mutex;
+    // Only forking thread exists in child, and it doesn't hold any guard
+    for (auto *record = records.load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+      if (record != current_record) {
+        for (auto &slot : record->slots) {
+          slot.store(nullptr, std::memory_order_relaxed);
+        }
+        record->used = 0;
+        record->active.store(false, std::memory_order_release);
+      }
+    }
+    unslotted_readers.store(0, std::memory_order_seq_cst);
+  }
+
+}  // namespace soralog::hazard
@@ -0,0 +1,193 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/binary_log_reader.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <soralog/impl/binary_format.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace binary_format;
+
+    /// Size of chunk to read file by
+    constexpr size_t chunk_size = 1u << 20;  // 1 Mb
+
+    /// Records greater than that are considered as garbage
+    constexpr size_t max_body_size = 1u << 20;  // 1 Mb
+
+  }  // namespace
+
+  BinaryLogReader::BinaryLogReader(const std::filesystem::path &path)
+      : in_(path, std::ios::binary) {
+    if (!in_.is_open()) {
+      status_ = Status::NOT_OPENED;
+      return;
+    }
+    if (!fill(header_size)) {
+      status_ = (end_ == begin_) ? Status::END : Status::BAD_HEADER;
+      return;
+    }
+    const auto *ptr = buff_.data() + begin_;  // NOLINT
+    if (std::string_view(ptr, magic.size()) != magic
+        || static_cast<uint8_t>(ptr[magic.size()]) != version) {  // NOLINT
+      status_ = Status::BAD_HEADER;
+      return;
+    }
+    begin_ += header_size;
+    offset_ = header_size;
+  }
+
+  bool BinaryLogReader::fill(size_t size) {
+    if (end_ - begin_ >= size) {
+      return true;
+    }
+
+    // Move unread data to beginning of buffer
+    std::memmove(buff_.data(), buff_.data() + begin_, end_ - begin_);  // NOLINT
+    end_ -= begin_;
+    begin_ = 0;
+
+    if (buff_.size() < std::max(size, chunk_size)) {
+      buff_.resize(std::max(size, chunk_size));
+    }
+
+    while (end_ < size && in_) {
+      in_.read(buff_.data() + end_, buff_.size() - end_);  // NOLINT
+      end_ += in_.gcount();
+    }
+    return end_ >= size;
+  }
+
+  std::optional<BinaryLogReader::Event> BinaryLogReader::next() {
+    while (status_ == Status::OK) {
+      if (!fill(1)) {
+        status_ = Status::END;
+        break;
+      }
+
+      // Size of body
+
+      const bool is_tail = !fill(max_varint_size);
+      const char *ptr = buff_.data() + begin_;  // NOLINT
+      const char *const data_end = buff_.data() + end_;  // NOLINT
+      uint64_t body_size = 0;
+      if (!getVarint(ptr, data_end, body_size)) {
+        status_ = is_tail ? Status::TORN : Status::CORRUPTED;
+        break;
+      }
+      if (body_size == 0 || body_size > max_body_size) {
+        status_ = Status::CORRUPTED;
+        break;
+      }
+
+      // Whole record
+
+      const size_t prefix_size = ptr - (buff_.data() + begin_);  // NOLINT
+      const size_t record_size = prefix_size + body_size + checksum_size;
+      if (!fill(record_size)) {
+        status_ = Status::TORN;
+        break;
+      }
+      const char *body = buff_.data() + begin_ + prefix_size;  // NOLINT
+      const char *const body_end = body + body_size;             // NOLINT
+
+      if (getChecksum(body_end) != crc32(body, body_size)) {
+        // Broken last record is torn one; elsewise, file is damaged
+        status_ = fill(record_size + 1) ? Status::CORRUPTED : Status::TORN;
+        break;
+      }
+
+      begin_ += record_size;
+      offset_ += record_size;
+
+      // Body
+
+      ptr = body;
+      auto type = static_cast<RecordType>(*ptr++);  // NOLINT
+      bool ok = true;
+      switch (type) {
+        case RecordType::SESSION: {
+          uint64_t time = 0;
+          ok = getVarint(ptr, body_end, time);
+          prev_time_ = static_cast<int64_t>(time);
+          names_.clear();
+          threads_.clear();
+        } break;
+
+        case RecordType::NAME: {
+          uint64_t id = 0;
+          std::string_view name;
+          ok = getVarint(ptr, body_end, id) && getString(ptr, body_end, name);
+          if (ok) {
+            names_[id] = name;
+          }
+        } break;
+
+        case RecordType::THREAD: {
+          uint64_t id = 0;
+          uint64_t number = 0;
+          std::string_view name;
+          ok = getVarint(ptr, body_end, id) && getVarint(ptr, body_end, number)
+              && getString(ptr, body_end, name);
+          if (ok) {
+            threads_[id] = {number, std::string(name)};
+          }
+        } break;
+
+        case RecordType::EVENT: {
+          uint64_t delta = 0;
+          uint64_t name_id = 0;
+          uint64_t thread_id = 0;
+          Event event;
+          ok = getVarint(ptr, body_end, delta) && ptr < body_end;
+          if (ok) {
+            auto level = static_cast<uint8_t>(*ptr++);  // NOLINT
+            event.level = static_cast<Level>(
+                std::min<uint8_t>(level, static_cast<uint8_t>(Level::TRACE)));
+            ok = getVarint(ptr, body_end, name_id)
+                && getVarint(ptr, body_end, thread_id)
+                && getString(ptr, body_end, event.message);
+          }
+          if (!ok) {
+            break;
+          }
+          event.fields = {ptr, static_cast<size_t>(body_end - ptr)};
+
+          prev_time_ += zigzagDecode(delta);
+          event.timestamp = std::chrono::system_clock::time_point(
+              std::chrono::duration_cast<
+                  std::chrono::system_clock::duration>(
+                  std::chrono::microseconds(prev_time_)));
+
+          if (auto it = names_.find(name_id); it != names_.end()) {
+            event.name = it->second;
+          } else {
+            event.name = "?";
+          }
+          if (auto it = threads_.find(thread_id); it != threads_.end()) {
+            event.thread_number = it->second.first;
+            event.thread_name = it->second.second;
+          }
+          return event;
+        }
+
+        default:
+          // Unknown record type (e.g. of newer version) is skipped
+          break;
+      }
+
+      if (!ok) {
+        status_ = Status::CORRUPTED;
+      }
+    }
+    return std::nullopt;
+  }
+
+}  // namespace soralog
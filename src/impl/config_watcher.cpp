@@ -0,0 +1,160 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/config_watcher.hpp>
+
+#include <cerrno>
+#include <iostream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+namespace soralog {
+
+  namespace {
+
+    std::filesystem::file_time_type write_time_of(
+        const std::filesystem::path &path) {
+      std::error_code ec;
+      auto time = std::filesystem::last_write_time(path, ec);
+      return ec ? std::filesystem::file_time_type{} : time;
+    }
+
+    void close_fd(int &fd) {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+
+  }  // namespace
+
+  ConfigWatcher::ConfigWatcher(LoggingSystem &system,
+                               std::filesystem::path path,
+                               Callback on_reload)
+      : system_(system),
+        path_(std::filesystem::absolute(std::move(path))),
+        on_reload_(std::move(on_reload)) {
+    if (::pipe2(stop_fds_, O_CLOEXEC) != 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Can't create pipe of config watcher");
+    }
+
+#if defined(__linux__)
+    // Directory is watched, because editors often replace file by other one
+    inotify_fd_ = ::inotify_init1(IN_CLOEXEC);
+    if (inotify_fd_ < 0
+        || ::inotify_add_watch(inotify_fd_, path_.parent_path().c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO)
+            < 0) {
+      const auto error = errno;
+      close_fd(inotify_fd_);
+      close_fd(stop_fds_[0]);
+      close_fd(stop_fds_[1]);
+      throw std::system_error(error, std::generic_category(),
+                              "Can't watch config " + path_.string());
+    }
+#endif
+
+    last_write_time_ = write_time_of(path_);
+    worker_ = std::thread([this] { run(); });
+  }
+
+  ConfigWatcher::~ConfigWatcher() {
+    const char stop = 0;
+    while (::write(stop_fds_[1], &stop, 1) < 0 && errno == EINTR) {
+    }
+    worker_.join();
+    close_fd(inotify_fd_);
+    close_fd(stop_fds_[0]);
+    close_fd(stop_fds_[1]);
+  }
+
+  void ConfigWatcher::run() {
+    while (wait()) {
+      reload();
+    }
+  }
+
+  bool ConfigWatcher::wait() {
+#if defined(__linux__)
+    pollfd fds[] = {{stop_fds_[0], POLLIN, 0}, {inotify_fd_, POLLIN, 0}};
+    bool changed = false;
+    for (;;) {
+      // Once change is seen, it is waited for the next one within debounce
+      auto n = ::poll(fds, 2, changed ? debounce.count() : -1);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      if (n == 0) {
+        return true;
+      }
+      if (fds[0].revents != 0) {
+        return false;
+      }
+      alignas(inotify_event) char buffer[4096];
+      auto size = ::read(inotify_fd_, buffer, sizeof(buffer));
+      for (auto ptr = buffer; size > 0 && ptr < buffer + size;) {
+        const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+        if (event->len != 0 && path_.filename() == event->name) {
+          changed = true;
+        }
+        ptr += sizeof(inotify_event) + event->len;
+      }
+    }
+#else
+    pollfd fds[] = {{stop_fds_[0], POLLIN, 0}};
+    for (;;) {
+      auto n = ::poll(fds, 1, poll_interval.count());
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      if (n != 0) {
+        return false;
+      }
+      if (auto time = write_time_of(path_); time != last_write_time_) {
+        last_write_time_ = time;
+        // Let writer finish
+        if (::poll(fds, 1, debounce.count()) != 0) {
+          return false;
+        }
+        return true;
+      }
+    }
+#endif
+  }
+
+  void ConfigWatcher::reload() {
+    Configurator::Result result;
+    try {
+      result = system_.reconfigure();
+    } catch (const std::exception &exception) {
+      result.has_error = true;
+      result.message = std::string("E: Can't reload config: ")
+                     + exception.what() + "\n";
+    }
+    reloads_.fetch_add(1, std::memory_order_release);
+
+    if (on_reload_) {
+      on_reload_(result);
+    } else if (result.has_error || result.has_warning) {
+      std::cerr << "Config " << path_ << " is reloaded with problems:\n"
+                << result.message << std::endl;
+    }
+  }
+
+}  // namespace soralog
@@ -5,6 +5,7 @@
 
 #include <soralog/impl/configurator_from_yaml.hpp>
 
+#include <csignal>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -12,6 +13,12 @@
 #include <soralog/group.hpp>
 #include <soralog/level.hpp>
 
+#include <soralog/impl/sink_to_binary_file.hpp>
+#include <soralog/impl/sink_to_crash_ring.hpp>
+#include <soralog/impl/sink_to_flight_recorder.hpp>
+#include <soralog/impl/sink_to_shm.hpp>
+#include <soralog/impl/sink_to_socket.hpp>
+#include <soralog/impl/sink_to_syslog.hpp>
 #include <soralog/impl/sink_to_console.hpp>
 #include <soralog/impl/sink_to_file.hpp>
 #include <soralog/impl/sink_to_nowhere.hpp>
@@ -27,19 +34,26 @@ namespace soralog {
         false;
 #endif
 
+    constexpr bool debug_level_disable =
+#ifdef WITHOUT_DEBUG_LOG_LEVEL
+        true;
+#else
+        false;
+#endif
+
     template <typename>
     inline constexpr bool always_false_v = false;
   }  // namespace
 
   Configurator::Result ConfiguratorFromYAML::applyOn(
       LoggingSystem &system) const {
-    return Applicator(system, config_, previous_).run();
+    return Applicator(system, config_, previous_, applied_sinks_).run();
   }
 
   ConfiguratorFromYAML::Result ConfiguratorFromYAML::Applicator::run() && {
     ConfiguratorFromYAML::Result result;
 
-    if (previous_ != nullptr) {
+    if (previous_ != nullptr && !reload_) {
       result = previous_->applyOn(system_);
     }
 
@@ -73,8 +87,14 @@ namespace soralog {
         },
         config_);
 
+    // Config which can't be loaded isn't applied at all, and previously
+    // applied one stays actual
     if (!has_error_) {
       parse(node);
+      if (reload_) {
+        retireSinks();
+      }
+      applied_sinks_ = std::move(parsed_sinks_);
     }
 
     result.has_error = result.has_error || has_error_;
@@ -183,35 +203,95 @@ namespace soralog {
       return;
     }
 
+    auto dump = YAML::Dump(sink);
+    if (reload_ && isSinkUnchanged(name, dump, sink)) {
+      parsed_sinks_[name] = std::move(dump);
+      return;
+    }
+
+    filter_ = parseFilter(name, sink);
+    fork_policy_ = parseForkPolicy(name, sink);
+    worker_placement_ = parseWorkerPlacement(name, sink);
+    auto previous = system_.getSink(name);
+
     if (type == "console") {
       parseSinkToConsole(name, sink);
     } else if (type == "file") {
       parseSinkToFile(name, sink);
+    } else if (type == "binary") {
+      parseSinkToBinaryFile(name, sink);
+    } else if (type == "syslog") {
+      parseSinkToSyslog(name, sink);
+    } else if (type == "socket") {
+      parseSinkToSocket(name, sink);
+    } else if (type == "shm") {
+      parseSinkToShm(name, sink);
+    } else if (type == "crash_ring") {
+      parseSinkToCrashRing(name, sink);
+    } else if (type == "recorder") {
+      parseSinkToFlightRecorder(name, sink);
     } else {
       errors_ << "E: Unknown 'type' of sink node '" << name << "': " << type
               << "\n";
       has_error_ = true;
     }
+
+    filter_.reset();
+
+    if (auto created = system_.getSink(name); created && created != previous) {
+      parsed_sinks_[name] = std::move(dump);
+      made_sinks_.emplace(name);
+    } else if (reload_ && applied_sinks_->count(name) != 0) {
+      // Sink is malformed now, so previous one is kept
+      parsed_sinks_[name] = applied_sinks_->at(name);
+    }
   }
 
-  void ConfiguratorFromYAML::Applicator::parseSinkToConsole(
-      const std::string &name, const YAML::Node &sink_node) {
-    bool color = false;
-    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
-    std::optional<size_t> capacity;
-    std::optional<size_t> buffer_size;
-    std::optional<size_t> latency;
+  bool ConfiguratorFromYAML::Applicator::isSinkUnchanged(
+      const std::string &name, const std::string &dump,
+      const YAML::Node &sink_node) const {
+    auto it = applied_sinks_->find(name);
+    if (it == applied_sinks_->end() || it->second != dump
+        || !system_.getSink(name)) {
+      return false;
+    }
+    // Sink which refers to remade sink has to be remade too
+    for (auto key : {"dump_sink", "forward_sink"}) {
+      auto node = sink_node[key];
+      if (node.IsDefined() && node.IsScalar()
+          && made_sinks_.count(node.as<std::string>()) != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
 
-    auto color_node = sink_node["color"];
-    if (color_node.IsDefined()) {
-      if (!color_node.IsScalar()) {
-        errors_ << "W: Property 'color' of sink node is not true or false\n";
-        has_warning_ = true;
-      } else {
-        color = color_node.as<bool>();
+  bool ConfiguratorFromYAML::Applicator::isSinkDefined(
+      const std::string &name) const {
+    // Sinks of previous application are replaced silently
+    return reload_ ? parsed_sinks_.count(name) != 0
+                   : system_.getSink(name) != nullptr;
+  }
+
+  void ConfiguratorFromYAML::Applicator::retireSinks() {
+    for (const auto &[name, dump] : *applied_sinks_) {
+      if (parsed_sinks_.count(name) == 0) {
+        system_.removeSink(name);
       }
     }
+  }
+
+  bool ConfiguratorFromYAML::Applicator::isSinkProperty(
+      const std::string &key) {
+    return key == "name" || key == "type" || key == "thread"
+        || key == "capacity" || key == "buffer" || key == "latency"
+        || key == "filter" || key == "at_fork" || key == "worker";
+  }
 
+  void ConfiguratorFromYAML::Applicator::parseSinkProperties(
+      const std::string &name, const YAML::Node &sink_node,
+      Sink::ThreadInfoType &thread_info_type, std::optional<size_t> &capacity,
+      std::optional<size_t> &buffer_size, std::optional<size_t> &latency) {
     auto thread_node = sink_node["thread"];
     if (thread_node.IsDefined()) {
       if (!thread_node.IsScalar()) {
@@ -282,38 +362,61 @@ namespace soralog {
         }
       }
     }
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToConsole(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool color = false;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> latency;
+
+    auto color_node = sink_node["color"];
+    if (color_node.IsDefined()) {
+      if (!color_node.IsScalar()) {
+        errors_ << "W: Property 'color' of sink node is not true or false\n";
+        has_warning_ = true;
+      } else {
+        color = color_node.as<bool>();
+      }
+    }
+
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
+
+    auto pattern = parsePattern(name, sink_node);
+    auto zero_copy = parseFlag(name, sink_node, "zero_copy");
+    auto utc = parseFlag(name, sink_node, "utc");
 
     for (const auto &it : sink_node) {
       auto key = it.first.as<std::string>();
       auto val = it.second;
 
-      if (key == "name")
-        continue;
-      if (key == "type")
+      if (isSinkProperty(key))
         continue;
       if (key == "color")
         continue;
-      if (key == "thread")
-        continue;
-      if (key == "capacity")
+      if (key == "pattern")
         continue;
-      if (key == "buffer")
+      if (key == "zero_copy")
         continue;
-      if (key == "latency")
+      if (key == "utc")
         continue;
       errors_ << "W: Unknown property of sink '" << name
               << "' with type 'console': " << key << "\n";
       has_warning_ = true;
     }
 
-    if (system_.getSink(name)) {
+    if (isSinkDefined(name)) {
       errors_ << "W: Already exists sink with name '" << name
               << "'; Previous version will be overridden\n";
       has_warning_ = true;
     }
 
-    system_.makeSink<SinkToConsole>(name, color, thread_info_type, capacity,
-                                    buffer_size, latency);
+    makeFilteredSink<SinkToConsole>(name, color, thread_info_type, capacity,
+                                    buffer_size, latency, pattern, zero_copy,
+                                    utc);
   }
 
   void ConfiguratorFromYAML::Applicator::parseSinkToFile(
@@ -335,92 +438,122 @@ namespace soralog {
       has_error_ = true;
     }
 
-    auto thread_node = sink_node["thread"];
-    if (thread_node.IsDefined()) {
-      if (!thread_node.IsScalar()) {
-        errors_ << "W: Property 'thread' of sink node is not scalar\n";
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
+
+    std::optional<SinkToFile::RotationPolicy> rotation;
+    auto rotation_node = sink_node["rotation"];
+    if (rotation_node.IsDefined()) {
+      if (!rotation_node.IsMap()) {
+        errors_ << "W: Property 'rotation' of sink '" << name
+                << "' is not a map\n";
         has_warning_ = true;
       } else {
-        auto thread_str = thread_node.as<std::string>();
-        if (thread_str == "name") {
-          thread_info_type = Sink::ThreadInfoType::NAME;
-        } else if (thread_str == "id") {
-          thread_info_type = Sink::ThreadInfoType::ID;
-        } else if (thread_str != "none") {
-          errors_ << "W: Wrong property 'thread' value of sink '" << name
-                  << "': " << thread_str << "\n";
-          has_warning_ = true;
-        }
+        rotation = parseRotation(name, rotation_node);
       }
     }
 
-    auto capacity_node = sink_node["capacity"];
-    if (capacity_node.IsDefined()) {
-      if (!capacity_node.IsScalar()) {
-        errors_ << "W: Property 'capacity' of sink node is not scalar\n";
+    std::optional<SinkToFile::Compression> compression;
+    auto compress_node = sink_node["compress"];
+    if (compress_node.IsDefined()) {
+      if (!compress_node.IsScalar()) {
+        errors_ << "W: Property 'compress' of sink '" << name
+                << "' is not scalar\n";
         has_warning_ = true;
       } else {
-        auto capacity_int = capacity_node.as<int>();
-        if (capacity_int >= 4) {
-          capacity.emplace(capacity_int);
-        } else {
-          errors_ << "W: Wrong property 'capacity' value of sink '" << name
-                  << "': " << capacity_node.as<std::string>() << "\n";
+        auto codec_str = compress_node.as<std::string>();
+        if (codec_str == "gzip") {
+          compression.emplace();
+          compression->codec = SinkToFile::Compression::Codec::GZIP;
+        } else if (codec_str == "lz4" || codec_str == "zstd") {
+          errors_ << "W: Compression '" << codec_str << "' of sink '" << name
+                  << "' is not supported by this build; "
+                     "Use 'gzip' instead. Data will be written uncompressed\n";
+          has_warning_ = true;
+        } else if (codec_str != "none") {
+          errors_ << "W: Wrong property 'compress' value of sink '" << name
+                  << "': " << codec_str << "\n";
           has_warning_ = true;
         }
       }
     }
 
-    auto buffer_node = sink_node["buffer"];
-    if (buffer_node.IsDefined()) {
-      if (!buffer_node.IsScalar()) {
-        errors_ << "W: Property 'buffer' of sink node is not scalar\n";
+    auto compress_level_node = sink_node["compress_level"];
+    if (compress_level_node.IsDefined()) {
+      if (!compress_level_node.IsScalar()) {
+        errors_ << "W: Property 'compress_level' of sink node is not scalar\n";
         has_warning_ = true;
       } else {
-        auto buffer_int = buffer_node.as<int>();
-        if (buffer_int >= sizeof(Event) * 4) {
-          buffer_size.emplace(buffer_int);
-        } else {
-          errors_ << "W: Wrong property 'buffer' value of sink '" << name
-                  << "': " << buffer_node.as<std::string>() << "\n";
+        auto level_int = compress_level_node.as<int>();
+        if (level_int < 1 || level_int > 9) {
+          errors_ << "W: Wrong property 'compress_level' value of sink '"
+                  << name << "': " << compress_level_node.as<std::string>()
+                  << "\n";
           has_warning_ = true;
+        } else if (compression) {
+          compression->level = level_int;
         }
       }
     }
 
-    auto latency_node = sink_node["latency"];
-    if (latency_node.IsDefined()) {
-      if (!latency_node.IsScalar()) {
-        errors_ << "W: Property 'latency' of sink node is not scalar\n";
+    std::optional<SinkToFile::Layout> layout;
+    auto layout_node = sink_node["layout"];
+    if (layout_node.IsDefined()) {
+      if (!layout_node.IsScalar()) {
+        errors_ << "W: Property 'layout' of sink '" << name
+                << "' is not scalar\n";
         has_warning_ = true;
       } else {
-        auto latency_int = latency_node.as<int>();
-        if (std::to_string(latency_int) != latency_node.as<std::string>()
-            || latency_int < 0) {
-          errors_ << "W: Wrong value of property 'latency' value of sink '"
-                  << name << "': " << latency_node.as<std::string>() << "\n";
-          has_warning_ = true;
+        auto layout_str = layout_node.as<std::string>();
+        if (layout_str == "text") {
+          layout = SinkToFile::Layout::TEXT;
+        } else if (layout_str == "json") {
+          layout = SinkToFile::Layout::JSON;
         } else {
-          latency.emplace(latency_int);
+          errors_ << "W: Wrong property 'layout' value of sink '" << name
+                  << "': " << layout_str << "\n";
+          has_warning_ = true;
         }
       }
     }
 
+    auto pattern = parsePattern(name, sink_node);
+    if (pattern && layout == SinkToFile::Layout::JSON) {
+      errors_ << "W: Property 'pattern' of sink '" << name
+              << "' is ignored by JSON layout\n";
+      has_warning_ = true;
+    }
+
+    // Time of JSON layout is always UTC
+    auto utc = parseFlag(name, sink_node, "utc");
+
+    auto zero_copy = parseFlag(name, sink_node, "zero_copy");
+    if (zero_copy.value_or(false)
+        && (layout == SinkToFile::Layout::JSON || compression)) {
+      errors_ << "W: Property 'zero_copy' of sink '" << name
+              << "' is ignored by JSON layout and compressed file\n";
+      has_warning_ = true;
+    }
+
     for (const auto &it : sink_node) {
       auto key = it.first.as<std::string>();
-      if (key == "name")
-        continue;
-      if (key == "type")
+      if (isSinkProperty(key))
         continue;
       if (key == "path")
         continue;
-      if (key == "thread")
+      if (key == "layout")
+        continue;
+      if (key == "pattern")
+        continue;
+      if (key == "zero_copy")
         continue;
-      if (key == "capacity")
+      if (key == "utc")
         continue;
-      if (key == "buffer")
+      if (key == "compress")
         continue;
-      if (key == "latency")
+      if (key == "compress_level")
+        continue;
+      if (key == "rotation")
         continue;
       errors_ << "W: Unknown property of sink '" << name << "': " << key
               << "\n";
@@ -433,142 +566,1043 @@ namespace soralog {
 
     auto path = path_node.as<std::string>();
 
-    if (system_.getSink(name)) {
+    if (isSinkDefined(name)) {
       errors_ << "W: Already exists sink with name '" << name
               << "'; Previous version will be overridden\n";
       has_warning_ = true;
     }
 
-    system_.makeSink<SinkToFile>(name, path, thread_info_type, capacity,
-                                 buffer_size, latency);
+    makeFilteredSink<SinkToFile>(name, path, thread_info_type, capacity,
+                                 buffer_size, latency, rotation,
+                                 compression, layout, pattern, zero_copy,
+                                 utc);
   }
 
-  void ConfiguratorFromYAML::Applicator::parseGroups(
-      const YAML::Node &groups, const std::optional<std::string> &parent) {
-    if (groups.IsNull()) {
-      errors_ << "E: Node 'groups' is empty\n";
-      has_error_ = true;
-      return;
-    }
+  void ConfiguratorFromYAML::Applicator::parseSinkToBinaryFile(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> latency;
 
-    if (!groups.IsSequence()) {
-      errors_ << "E: Node 'groups' is not a sequence\n";
+    auto path_node = sink_node["path"];
+    if (!path_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'path' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (!path_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'path' of sink '" << name << "' is not scalar\n";
       has_error_ = true;
-      return;
     }
 
-    for (auto i = 0; i < groups.size(); ++i) {
-      auto group = groups[i];
-      if (!group.IsMap()) {
-        errors_ << "E: Element #" << i << " of 'groups' is not a map\n";
-        has_error_ = true;
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (isSinkProperty(key))
         continue;
-      }
-      parseGroup(i, group, parent);
+      if (key == "path")
+        continue;
+      errors_ << "W: Unknown property of sink '" << name
+              << "' with type 'binary': " << key << "\n";
+      has_warning_ = true;
     }
-  }
 
-  void ConfiguratorFromYAML::Applicator::parseGroup(
-      int number, const YAML::Node &group_node,
-      const std::optional<std::string> &parent) {
-    bool fail = false;
+    if (fail) {
+      return;
+    }
 
-    bool is_fallback = false;
+    auto path = path_node.as<std::string>();
 
-    auto name_node = group_node["name"];
-    std::string tmp_name = "node #" + std::to_string(number);
-    if (!name_node.IsDefined()) {
-      fail = true;
-      errors_ << "W: Not found 'name' of group " << tmp_name << "\n";
-      has_error_ = true;
-    } else if (!name_node.IsScalar()) {
-      fail = true;
-      errors_ << "E: Property 'name' of group " << tmp_name
-              << " is not scalar\n";
-      has_error_ = true;
-    } else {
-      tmp_name = "'" + name_node.as<std::string>() + "'";
+    if (isSinkDefined(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
     }
 
-    auto fallback_node = group_node["is_fallback"];
-    if (fallback_node.IsDefined()) {
-      if (!fallback_node.IsScalar()) {
-        fail = true;
-        errors_ << "E: Property 'is_fallback' of group " << tmp_name
-                << " is not scalar\n";
-        has_error_ = true;
+    makeFilteredSink<SinkToBinaryFile>(name, path, thread_info_type, capacity,
+                                       buffer_size, latency);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToSyslog(
+      const std::string &name, const YAML::Node &sink_node) {
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> latency;
+
+    std::string address(SinkToSyslog::default_address);
+    auto address_node = sink_node["address"];
+    if (address_node.IsDefined()) {
+      if (!address_node.IsScalar()) {
+        errors_ << "W: Property 'address' of sink '" << name
+                << "' is not scalar; Default one will be used\n";
+        has_warning_ = true;
       } else {
-        is_fallback = fallback_node.as<bool>();
+        address = address_node.as<std::string>();
       }
     }
 
-    std::optional<std::string> sink{};
-    auto sink_node = group_node["sink"];
-    if (sink_node.IsDefined()) {
-      if (!sink_node.IsScalar()) {
-        fail = true;
-        errors_ << "E: Property 'sink' of group " << tmp_name
-                << " is not scalar\n";
-        has_error_ = true;
+    std::optional<SinkToSyslog::Facility> facility;
+    auto facility_node = sink_node["facility"];
+    if (facility_node.IsDefined()) {
+      if (!facility_node.IsScalar()) {
+        errors_ << "W: Property 'facility' of sink '" << name
+                << "' is not scalar\n";
+        has_warning_ = true;
       } else {
-        sink.emplace(sink_node.as<std::string>());
-        if (!system_.getSink(sink.value())) {
-          fail = true;
-          errors_ << "E: Sink '" << *sink << "' of group " << tmp_name
-                  << " is undefined\n";
-          has_error_ = true;
+        auto facility_str = facility_node.as<std::string>();
+        facility = SinkToSyslog::facilityFromStr(facility_str);
+        if (!facility) {
+          errors_ << "W: Wrong property 'facility' value of sink '" << name
+                  << "': " << facility_str << "\n";
+          has_warning_ = true;
         }
       }
-    } else if (!parent) {
-      sink.emplace("*");
     }
 
-    std::optional<std::string> level_string{};
-    auto level_node = group_node["level"];
-    if (level_node.IsDefined()) {
-      if (!level_node.IsScalar()) {
-        fail = true;
-        errors_ << "E: Property 'level' of group " << tmp_name
-                << " is not scalar\n";
-        has_error_ = true;
+    std::optional<std::string> app_name;
+    auto app_name_node = sink_node["app_name"];
+    if (app_name_node.IsDefined()) {
+      if (!app_name_node.IsScalar()) {
+        errors_ << "W: Property 'app_name' of sink '" << name
+                << "' is not scalar\n";
+        has_warning_ = true;
       } else {
-        level_string.emplace(level_node.as<std::string>());
+        app_name = app_name_node.as<std::string>();
       }
-    } else if (!parent) {
-      fail = true;
-      errors_ << "E: Not found 'level' of root group " << tmp_name << "\n";
-      has_error_ = true;
     }
 
-    auto children_node = group_node["children"];
-    if (children_node.IsDefined()) {
-      if (!children_node.IsNull() && !children_node.IsSequence()) {
-        fail = true;
-        errors_ << "E: Property 'children' of group " << tmp_name
-                << " is not sequence\n";
-        has_error_ = true;
-      }
-    }
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
 
-    for (const auto &it : group_node) {
+    for (const auto &it : sink_node) {
       auto key = it.first.as<std::string>();
-
-      if (key == "name")
-        continue;
-      if (key == "is_fallback")
+      if (isSinkProperty(key))
         continue;
-      if (key == "sink")
+      if (key == "address")
         continue;
-      if (key == "level")
+      if (key == "facility")
         continue;
-      if (key == "children")
+      if (key == "app_name")
         continue;
-      errors_ << "W: Unknown property of group " << tmp_name << ": " << key
-              << "\n";
+      errors_ << "W: Unknown property of sink '" << name
+              << "' with type 'syslog': " << key << "\n";
       has_warning_ = true;
     }
 
-    if (sink) {
+    if (isSinkDefined(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    makeFilteredSink<SinkToSyslog>(name, address, facility, app_name,
+                                   thread_info_type, capacity, buffer_size,
+                                   latency);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToSocket(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> latency;
+
+    auto address_node = sink_node["address"];
+    if (!address_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'address' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (!address_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'address' of sink '" << name
+              << "' is not scalar\n";
+      has_error_ = true;
+    }
+
+    std::optional<size_t> budget;
+    auto budget_node = sink_node["budget"];
+    if (budget_node.IsDefined()) {
+      if (!budget_node.IsScalar()) {
+        errors_ << "W: Property 'budget' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto budget_int = budget_node.as<long long>(-1);
+        if (budget_int < static_cast<long long>(sizeof(Event))) {
+          errors_ << "W: Wrong property 'budget' value of sink '" << name
+                  << "': " << budget_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          budget.emplace(budget_int);
+        }
+      }
+    }
+
+    std::optional<SinkToSocket::DropPolicy> drop_policy;
+    auto drop_node = sink_node["drop"];
+    if (drop_node.IsDefined()) {
+      if (!drop_node.IsScalar()) {
+        errors_ << "W: Property 'drop' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto drop_str = drop_node.as<std::string>();
+        if (drop_str == "newest") {
+          drop_policy = SinkToSocket::DropPolicy::NEWEST;
+        } else if (drop_str == "oldest") {
+          drop_policy = SinkToSocket::DropPolicy::OLDEST;
+        } else {
+          errors_ << "W: Wrong property 'drop' value of sink '" << name
+                  << "': " << drop_str << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (isSinkProperty(key))
+        continue;
+      if (key == "address")
+        continue;
+      if (key == "budget")
+        continue;
+      if (key == "drop")
+        continue;
+      errors_ << "W: Unknown property of sink '" << name
+              << "' with type 'socket': " << key << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    auto address = address_node.as<std::string>();
+
+    if (isSinkDefined(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    makeFilteredSink<SinkToSocket>(name, address, budget, drop_policy,
+                                   thread_info_type, capacity, buffer_size,
+                                   latency);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToShm(
+      const std::string &name, const YAML::Node &sink_node) {
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> latency;
+
+    auto parse_string = [&](const char *property,
+                            std::optional<std::string> &value) {
+      auto node = sink_node[property];
+      if (!node.IsDefined()) {
+        return;
+      }
+      if (!node.IsScalar()) {
+        errors_ << "W: Property '" << property << "' of sink '" << name
+                << "' is not scalar\n";
+        has_warning_ = true;
+        return;
+      }
+      value = node.as<std::string>();
+    };
+
+    std::optional<std::string> channel;
+    parse_string("channel", channel);
+
+    std::optional<std::string> directory;
+    parse_string("directory", directory);
+
+    std::optional<size_t> ring_size;
+    auto ring_size_node = sink_node["ring_size"];
+    if (ring_size_node.IsDefined()) {
+      if (!ring_size_node.IsScalar()) {
+        errors_ << "W: Property 'ring_size' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto ring_size_int = ring_size_node.as<long long>(-1);
+        if (ring_size_int < static_cast<long long>(sizeof(Event) * 4)) {
+          errors_ << "W: Wrong property 'ring_size' value of sink '" << name
+                  << "': " << ring_size_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          ring_size.emplace(ring_size_int);
+        }
+      }
+    }
+
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (isSinkProperty(key))
+        continue;
+      if (key == "channel")
+        continue;
+      if (key == "directory")
+        continue;
+      if (key == "ring_size")
+        continue;
+      errors_ << "W: Unknown property of sink '" << name
+              << "' with type 'shm': " << key << "\n";
+      has_warning_ = true;
+    }
+
+    if (isSinkDefined(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    makeFilteredSink<SinkToShm>(
+        name, channel,
+        directory ? std::optional<std::filesystem::path>(*directory)
+                  : std::nullopt,
+        ring_size, thread_info_type, capacity, buffer_size, latency);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToCrashRing(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> latency;
+
+    auto path_node = sink_node["path"];
+    if (!path_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'path' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (!path_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'path' of sink '" << name << "' is not scalar\n";
+      has_error_ = true;
+    }
+
+    std::optional<size_t> ring_size;
+    auto ring_size_node = sink_node["ring_size"];
+    if (ring_size_node.IsDefined()) {
+      if (!ring_size_node.IsScalar()) {
+        errors_ << "W: Property 'ring_size' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto ring_size_int = ring_size_node.as<long long>(-1);
+        if (ring_size_int < static_cast<long long>(sizeof(Event) * 4)) {
+          errors_ << "W: Wrong property 'ring_size' value of sink '" << name
+                  << "': " << ring_size_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          ring_size.emplace(ring_size_int);
+        }
+      }
+    }
+
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (isSinkProperty(key))
+        continue;
+      if (key == "path")
+        continue;
+      if (key == "ring_size")
+        continue;
+      errors_ << "W: Unknown property of sink '" << name
+              << "' with type 'crash_ring': " << key << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    auto path = path_node.as<std::string>();
+
+    if (isSinkDefined(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    makeFilteredSink<SinkToCrashRing>(name, path, ring_size, thread_info_type,
+                                      capacity, buffer_size, latency);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToFlightRecorder(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> latency;
+
+    auto parse_string = [&](const char *property,
+                            std::optional<std::string> &value) {
+      auto node = sink_node[property];
+      if (!node.IsDefined()) {
+        return;
+      }
+      if (!node.IsScalar()) {
+        errors_ << "E: Property '" << property << "' of sink '" << name
+                << "' is not scalar\n";
+        has_error_ = true;
+        fail = true;
+        return;
+      }
+      value = node.as<std::string>();
+    };
+
+    std::optional<size_t> memory_size;
+    auto memory_size_node = sink_node["memory_size"];
+    if (memory_size_node.IsDefined()) {
+      if (!memory_size_node.IsScalar()) {
+        errors_ << "W: Property 'memory_size' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto memory_size_int = memory_size_node.as<long long>(-1);
+        if (memory_size_int < static_cast<long long>(sizeof(Event) * 4)) {
+          errors_ << "W: Wrong property 'memory_size' value of sink '" << name
+                  << "': " << memory_size_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          memory_size.emplace(memory_size_int);
+        }
+      }
+    }
+
+    std::optional<std::string> dump_sink_name;
+    parse_string("dump_sink", dump_sink_name);
+
+    std::optional<std::string> dump_path;
+    parse_string("dump_path", dump_path);
+
+    std::optional<std::string> forward_sink_name;
+    parse_string("forward_sink", forward_sink_name);
+
+    std::optional<std::string> forward_level_string;
+    parse_string("forward_level", forward_level_string);
+
+    std::optional<std::string> dump_signal_string;
+    parse_string("dump_signal", dump_signal_string);
+
+    std::shared_ptr<Sink> dump_sink;
+    if (dump_sink_name && dump_path) {
+      errors_ << "E: Sink '" << name
+              << "' has both properties 'dump_sink' and 'dump_path'\n";
+      has_error_ = true;
+      fail = true;
+    } else if (dump_sink_name) {
+      dump_sink = system_.getSink(*dump_sink_name);
+      if (!dump_sink) {
+        errors_ << "E: Unknown dump sink of sink '" << name
+                << "': " << *dump_sink_name << "\n";
+        has_error_ = true;
+        fail = true;
+      }
+    } else if (!dump_path) {
+      errors_ << "E: Sink '" << name
+              << "' has neither property 'dump_sink' nor 'dump_path'\n";
+      has_error_ = true;
+      fail = true;
+    }
+
+    std::shared_ptr<Sink> forward_sink;
+    if (forward_sink_name) {
+      forward_sink = system_.getSink(*forward_sink_name);
+      if (!forward_sink) {
+        errors_ << "E: Unknown forward sink of sink '" << name
+                << "': " << *forward_sink_name << "\n";
+        has_error_ = true;
+        fail = true;
+      }
+    }
+
+    std::optional<Level> forward_level;
+    if (forward_level_string) {
+      forward_level = levelFromStr(*forward_level_string);
+      if (!forward_level) {
+        errors_ << "W: Wrong property 'forward_level' value of sink '" << name
+                << "': " << *forward_level_string << "\n";
+        has_warning_ = true;
+      }
+      if (forward_level && !forward_sink) {
+        errors_ << "W: Property 'forward_level' of sink '" << name
+                << "' is useless without 'forward_sink'\n";
+        has_warning_ = true;
+      }
+    }
+
+    std::optional<int> dump_signal;
+    if (dump_signal_string) {
+      if (dump_signal_string == "SIGUSR1" || dump_signal_string == "USR1") {
+        dump_signal.emplace(SIGUSR1);
+      } else if (dump_signal_string == "SIGUSR2"
+                 || dump_signal_string == "USR2") {
+        dump_signal.emplace(SIGUSR2);
+      } else if (dump_signal_string == "SIGHUP"
+                 || dump_signal_string == "HUP") {
+        dump_signal.emplace(SIGHUP);
+      } else {
+        auto signal = sink_node["dump_signal"].as<int>(0);
+        if (signal > 0 && signal < NSIG) {
+          dump_signal.emplace(signal);
+        } else {
+          errors_ << "W: Wrong property 'dump_signal' value of sink '" << name
+                  << "': " << *dump_signal_string << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    parseSinkProperties(name, sink_node, thread_info_type, capacity,
+                        buffer_size, latency);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (isSinkProperty(key))
+        continue;
+      if (key == "memory_size")
+        continue;
+      if (key == "dump_sink")
+        continue;
+      if (key == "dump_path")
+        continue;
+      if (key == "forward_sink")
+        continue;
+      if (key == "forward_level")
+        continue;
+      if (key == "dump_signal")
+        continue;
+      errors_ << "W: Unknown property of sink '" << name
+              << "' with type 'recorder': " << key << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    if (isSinkDefined(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    if (dump_path) {
+      // Dump is written synchronously by worker of recorder
+      dump_sink = std::make_shared<SinkToFile>(name + ":dump", *dump_path,
+                                               thread_info_type, capacity,
+                                               buffer_size, 0);
+    }
+
+    if (dump_signal && !SinkToFlightRecorder::dumpOnSignal(*dump_signal)) {
+      errors_ << "W: Can't set handler of signal " << *dump_signal
+              << " for sink '" << name << "'\n";
+      has_warning_ = true;
+    }
+
+    makeFilteredSink<SinkToFlightRecorder>(
+        name, memory_size, std::move(dump_sink), std::move(forward_sink),
+        forward_level, thread_info_type, capacity, buffer_size, latency);
+  }
+
+  std::optional<std::string>
+  ConfiguratorFromYAML::Applicator::parsePattern(
+      const std::string &name, const YAML::Node &sink_node) {
+    auto pattern_node = sink_node["pattern"];
+    if (!pattern_node.IsDefined()) {
+      return std::nullopt;
+    }
+    if (!pattern_node.IsScalar()) {
+      errors_ << "W: Property 'pattern' of sink '" << name
+              << "' is not scalar; Default one will be used\n";
+      has_warning_ = true;
+      return std::nullopt;
+    }
+    auto pattern = pattern_node.as<std::string>();
+    try {
+      LinePattern(pattern, Sink::ThreadInfoType::NAME, false);
+    } catch (const std::invalid_argument &exception) {
+      errors_ << "W: Wrong property 'pattern' value of sink '" << name
+              << "': " << exception.what() << "; Default one will be used\n";
+      has_warning_ = true;
+      return std::nullopt;
+    }
+    return pattern;
+  }
+
+  Sink::ForkPolicy ConfiguratorFromYAML::Applicator::parseForkPolicy(
+      const std::string &name, const YAML::Node &sink_node) {
+    auto node = sink_node["at_fork"];
+    if (!node.IsDefined()) {
+      return Sink::ForkPolicy::RESTART;
+    }
+    if (!node.IsScalar()) {
+      errors_ << "W: Property 'at_fork' of sink node is not scalar\n";
+      has_warning_ = true;
+      return Sink::ForkPolicy::RESTART;
+    }
+    auto policy = node.as<std::string>();
+    if (policy == "reopen") {
+      return Sink::ForkPolicy::REOPEN;
+    }
+    if (policy == "disable") {
+      return Sink::ForkPolicy::DISABLE;
+    }
+    if (policy != "restart") {
+      errors_ << "W: Wrong property 'at_fork' value of sink '" << name
+              << "': " << policy << "\n";
+      has_warning_ = true;
+    }
+    return Sink::ForkPolicy::RESTART;
+  }
+
+  WorkerPlacement ConfiguratorFromYAML::Applicator::parseWorkerPlacement(
+      const std::string &name, const YAML::Node &sink_node) {
+    WorkerPlacement placement;
+
+    auto worker_node = sink_node["worker"];
+    if (!worker_node.IsDefined()) {
+      return placement;
+    }
+    if (!worker_node.IsMap()) {
+      errors_ << "W: Property 'worker' of sink '" << name
+              << "' is not a map\n";
+      has_warning_ = true;
+      return placement;
+    }
+
+    auto wrong_value = [&](const char *property, const YAML::Node &node) {
+      errors_ << "W: Wrong value of property 'worker." << property
+              << "' of sink '" << name << "': " << YAML::Dump(node) << "\n";
+      has_warning_ = true;
+    };
+
+    auto cpus_node = worker_node["cpus"];
+    if (cpus_node.IsDefined()) {
+      std::optional<std::vector<unsigned>> cpus;
+      if (cpus_node.IsScalar()) {
+        cpus = WorkerPlacement::parseCpuList(cpus_node.as<std::string>());
+      } else if (cpus_node.IsSequence()) {
+        std::string list;
+        for (const auto &cpu_node : cpus_node) {
+          if (!cpu_node.IsScalar()) {
+            list.clear();
+            break;
+          }
+          list += (list.empty() ? "" : ",") + cpu_node.as<std::string>();
+        }
+        cpus = WorkerPlacement::parseCpuList(list);
+      }
+      if (cpus) {
+        placement.cpus = std::move(*cpus);
+      } else {
+        wrong_value("cpus", cpus_node);
+      }
+    }
+
+    auto numa_node = worker_node["numa_node"];
+    if (numa_node.IsDefined()) {
+      try {
+        placement.numa_node = numa_node.as<unsigned>();
+      } catch (const std::exception &) {
+        wrong_value("numa_node", numa_node);
+      }
+    }
+
+    auto policy_node = worker_node["policy"];
+    if (policy_node.IsDefined()) {
+      auto policy = policy_node.IsScalar() ? policy_node.as<std::string>()
+                                           : std::string{};
+      if (policy == "normal") {
+        placement.policy = WorkerPlacement::Policy::NORMAL;
+      } else if (policy == "batch") {
+        placement.policy = WorkerPlacement::Policy::BATCH;
+      } else if (policy == "idle") {
+        placement.policy = WorkerPlacement::Policy::IDLE;
+      } else {
+        wrong_value("policy", policy_node);
+      }
+    }
+
+    auto nice_node = worker_node["nice"];
+    if (nice_node.IsDefined()) {
+      try {
+        auto nice = nice_node.as<int>();
+        if (nice < -20 || nice > 19) {
+          throw std::out_of_range("niceness is out of range");
+        }
+        placement.nice = nice;
+      } catch (const std::exception &) {
+        wrong_value("nice", nice_node);
+      }
+    }
+
+    for (const auto &it : worker_node) {
+      auto key = it.first.as<std::string>();
+      if (key != "cpus" && key != "numa_node" && key != "policy"
+          && key != "nice") {
+        errors_ << "W: Unknown property of worker of sink '" << name
+                << "': " << key << "\n";
+        has_warning_ = true;
+      }
+    }
+
+    return placement;
+  }
+
+  std::shared_ptr<const SinkFilter>
+  ConfiguratorFromYAML::Applicator::parseFilter(const std::string &name,
+                                                const YAML::Node &sink_node) {
+    auto filter_node = sink_node["filter"];
+    if (!filter_node.IsDefined() || filter_node.IsNull()) {
+      return nullptr;
+    }
+
+    bool fail = false;
+    auto report = [&](const std::string &message) {
+      errors_ << "E: " << message << " in 'filter' of sink '" << name
+              << "'\n";
+      has_error_ = true;
+      fail = true;
+    };
+
+    // Property might be scalar or sequence of scalars
+    auto parse_strings = [&](const YAML::Node &rule_node, const char *key,
+                             std::vector<std::string> &strings) {
+      auto node = rule_node[key];
+      if (!node.IsDefined()) {
+        return;
+      }
+      if (node.IsScalar()) {
+        strings.emplace_back(node.as<std::string>());
+        return;
+      }
+      if (node.IsSequence()) {
+        for (const auto &item : node) {
+          if (!item.IsScalar()) {
+            report(std::string("Element of '") + key + "' is not scalar");
+            return;
+          }
+          strings.emplace_back(item.as<std::string>());
+        }
+        return;
+      }
+      report(std::string("Property '") + key
+             + "' is not scalar or sequence");
+    };
+
+    auto parse_rule = [&](const YAML::Node &rule_node) {
+      SinkFilter::Rule rule;
+      if (!rule_node.IsMap()) {
+        report("Rule is not YAML map");
+        return rule;
+      }
+      for (const auto &it : rule_node) {
+        auto key = it.first.as<std::string>();
+        if (key == "level") {
+          if (!it.second.IsScalar()) {
+            report("Property 'level' is not scalar");
+          } else if (auto level =
+                         levelFromStr(it.second.as<std::string>())) {
+            rule.level = *level;
+          } else {
+            report("Invalid level '" + it.second.as<std::string>() + "'");
+          }
+        } else if (key == "regex") {
+          if (!it.second.IsScalar()) {
+            report("Property 'regex' is not scalar");
+          } else {
+            rule.regex.emplace(it.second.as<std::string>());
+          }
+        } else if (key != "logger" && key != "group" && key != "contains") {
+          report("Unknown property '" + key + "'");
+        }
+      }
+      parse_strings(rule_node, "logger", rule.loggers);
+      parse_strings(rule_node, "group", rule.groups);
+      parse_strings(rule_node, "contains", rule.contains);
+      return rule;
+    };
+
+    std::vector<SinkFilter::Rule> rules;
+    if (filter_node.IsSequence()) {
+      for (const auto &rule_node : filter_node) {
+        rules.emplace_back(parse_rule(rule_node));
+      }
+    } else {
+      rules.emplace_back(parse_rule(filter_node));
+    }
+
+    if (fail) {
+      return nullptr;
+    }
+    try {
+      return std::make_shared<SinkFilter>(std::move(rules));
+    } catch (const std::invalid_argument &exception) {
+      report(std::string("Wrong value: ") + exception.what());
+      return nullptr;
+    }
+  }
+
+  std::optional<bool> ConfiguratorFromYAML::Applicator::parseFlag(
+      const std::string &name, const YAML::Node &sink_node,
+      const char *property) {
+    auto flag_node = sink_node[property];
+    if (!flag_node.IsDefined()) {
+      return std::nullopt;
+    }
+    if (!flag_node.IsScalar()) {
+      errors_ << "W: Property '" << property << "' of sink '" << name
+              << "' is not true or false\n";
+      has_warning_ = true;
+      return std::nullopt;
+    }
+    return flag_node.as<bool>();
+  }
+
+  std::optional<SinkToFile::RotationPolicy>
+  ConfiguratorFromYAML::Applicator::parseRotation(
+      const std::string &name, const YAML::Node &rotation_node) {
+    SinkToFile::RotationPolicy rotation;
+
+    auto parse_size = [&](const char *property, size_t &value) {
+      auto node = rotation_node[property];
+      if (!node.IsDefined()) {
+        return;
+      }
+      if (!node.IsScalar()) {
+        errors_ << "W: Property 'rotation." << property << "' of sink '"
+                << name << "' is not scalar\n";
+        has_warning_ = true;
+        return;
+      }
+      try {
+        auto size = node.as<int64_t>();
+        if (size < 0) {
+          throw std::out_of_range("negative value");
+        }
+        value = size;
+      } catch (const std::exception &) {
+        errors_ << "W: Wrong value of property 'rotation." << property
+                << "' of sink '" << name << "': " << node.as<std::string>()
+                << "\n";
+        has_warning_ = true;
+      }
+    };
+
+    parse_size("size", rotation.max_size);
+    size_t interval = 0;
+    parse_size("interval", interval);
+    rotation.interval = std::chrono::seconds(interval);
+    parse_size("max_files", rotation.max_files);
+    parse_size("max_size", rotation.max_total_size);
+
+    auto naming_node = rotation_node["naming"];
+    if (naming_node.IsDefined()) {
+      if (!naming_node.IsScalar()) {
+        errors_ << "W: Property 'rotation.naming' of sink '" << name
+                << "' is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto naming_str = naming_node.as<std::string>();
+        if (naming_str == "numbered") {
+          rotation.naming = SinkToFile::RotationPolicy::Naming::NUMBERED;
+        } else if (naming_str == "timestamp") {
+          rotation.naming = SinkToFile::RotationPolicy::Naming::TIMESTAMPED;
+        } else {
+          errors_ << "W: Wrong property 'rotation.naming' value of sink '"
+                  << name << "': " << naming_str << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto compress_node = rotation_node["compress"];
+    if (compress_node.IsDefined()) {
+      if (!compress_node.IsScalar()) {
+        errors_ << "W: Property 'rotation.compress' of sink '" << name
+                << "' is not true or false\n";
+        has_warning_ = true;
+      } else {
+        rotation.compress = compress_node.as<bool>();
+      }
+    }
+
+    for (const auto &it : rotation_node) {
+      auto key = it.first.as<std::string>();
+      if (key == "size")
+        continue;
+      if (key == "interval")
+        continue;
+      if (key == "naming")
+        continue;
+      if (key == "max_files")
+        continue;
+      if (key == "max_size")
+        continue;
+      if (key == "compress")
+        continue;
+      errors_ << "W: Unknown property of rotation of sink '" << name
+              << "': " << key << "\n";
+      has_warning_ = true;
+    }
+
+    if (rotation.max_size == 0
+        && rotation.interval == std::chrono::seconds::zero()) {
+      errors_ << "W: Rotation of sink '" << name
+              << "' has neither 'size' nor 'interval'; "
+                 "Built-in rotation will not be used\n";
+      has_warning_ = true;
+      return std::nullopt;
+    }
+
+    return rotation;
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseGroups(
+      const YAML::Node &groups, const std::optional<std::string> &parent) {
+    if (groups.IsNull()) {
+      errors_ << "E: Node 'groups' is empty\n";
+      has_error_ = true;
+      return;
+    }
+
+    if (!groups.IsSequence()) {
+      errors_ << "E: Node 'groups' is not a sequence\n";
+      has_error_ = true;
+      return;
+    }
+
+    for (auto i = 0; i < groups.size(); ++i) {
+      auto group = groups[i];
+      if (!group.IsMap()) {
+        errors_ << "E: Element #" << i << " of 'groups' is not a map\n";
+        has_error_ = true;
+        continue;
+      }
+      parseGroup(i, group, parent);
+    }
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseGroup(
+      int number, const YAML::Node &group_node,
+      const std::optional<std::string> &parent) {
+    bool fail = false;
+
+    bool is_fallback = false;
+
+    auto name_node = group_node["name"];
+    std::string tmp_name = "node #" + std::to_string(number);
+    if (!name_node.IsDefined()) {
+      fail = true;
+      errors_ << "W: Not found 'name' of group " << tmp_name << "\n";
+      has_error_ = true;
+    } else if (!name_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'name' of group " << tmp_name
+              << " is not scalar\n";
+      has_error_ = true;
+    } else {
+      tmp_name = "'" + name_node.as<std::string>() + "'";
+    }
+
+    auto fallback_node = group_node["is_fallback"];
+    if (fallback_node.IsDefined()) {
+      if (!fallback_node.IsScalar()) {
+        fail = true;
+        errors_ << "E: Property 'is_fallback' of group " << tmp_name
+                << " is not scalar\n";
+        has_error_ = true;
+      } else {
+        is_fallback = fallback_node.as<bool>();
+      }
+    }
+
+    std::optional<std::string> sink{};
+    auto sink_node = group_node["sink"];
+    if (sink_node.IsDefined()) {
+      if (!sink_node.IsScalar()) {
+        fail = true;
+        errors_ << "E: Property 'sink' of group " << tmp_name
+                << " is not scalar\n";
+        has_error_ = true;
+      } else {
+        sink.emplace(sink_node.as<std::string>());
+        if (!system_.getSink(sink.value())) {
+          fail = true;
+          errors_ << "E: Sink '" << *sink << "' of group " << tmp_name
+                  << " is undefined\n";
+          has_error_ = true;
+        }
+      }
+    } else if (!parent) {
+      sink.emplace("*");
+    }
+
+    std::optional<std::string> level_string{};
+    auto level_node = group_node["level"];
+    if (level_node.IsDefined()) {
+      if (!level_node.IsScalar()) {
+        fail = true;
+        errors_ << "E: Property 'level' of group " << tmp_name
+                << " is not scalar\n";
+        has_error_ = true;
+      } else {
+        level_string.emplace(level_node.as<std::string>());
+      }
+    } else if (!parent) {
+      fail = true;
+      errors_ << "E: Not found 'level' of root group " << tmp_name << "\n";
+      has_error_ = true;
+    }
+
+    auto children_node = group_node["children"];
+    if (children_node.IsDefined()) {
+      if (!children_node.IsNull() && !children_node.IsSequence()) {
+        fail = true;
+        errors_ << "E: Property 'children' of group " << tmp_name
+                << " is not sequence\n";
+        has_error_ = true;
+      }
+    }
+
+    for (const auto &it : group_node) {
+      auto key = it.first.as<std::string>();
+
+      if (key == "name")
+        continue;
+      if (key == "is_fallback")
+        continue;
+      if (key == "sink")
+        continue;
+      if (key == "level")
+        continue;
+      if (key == "children")
+        continue;
+      errors_ << "W: Unknown property of group " << tmp_name << ": " << key
+              << "\n";
+      has_warning_ = true;
+    }
+
+    if (sink) {
       if (!system_.getSink(*sink)) {
         errors_ << "E: Unknown sink in group " << tmp_name << ": " << *sink
                 << "\n";
@@ -578,35 +1612,22 @@ namespace soralog {
 
     std::optional<Level> level{};
     if (level_string) {
-      if (level_string == "off") {
-        level.emplace(Level::OFF);
-      } else if (level_string == "critical" || level_string == "crit") {
-        level.emplace(Level::CRITICAL);
-      } else if (level_string == "error") {
-        level.emplace(Level::ERROR_);
-      } else if (level_string == "warning" || level_string == "warn") {
-        level.emplace(Level::WARN);
-      } else if (level_string == "info") {
-        level.emplace(Level::INFO);
-      } else if (level_string == "verbose") {
-        level.emplace(Level::VERBOSE);
-      } else if (level_string == "debug" || level_string == "deb") {
-        level.emplace(Level::DEBUG);
+      level = levelFromStr(*level_string);
+      if (level == Level::DEBUG) {
         if constexpr (debug_level_disable) {
-          errors_ << "W: Level 'trace' in group " << tmp_name
+          errors_ << "W: Level 'debug' in group " << tmp_name
                   << " woun't work: it has disabled with compile option"
                   << "\n";
           has_warning_ = true;
         }
-      } else if (level_string == "trace") {
-        level.emplace(Level::TRACE);
+      } else if (level == Level::TRACE) {
         if constexpr (is_release_build) {
           errors_ << "W: Level 'trace' in group " << tmp_name
                   << " would not work: it is release build"
                   << "\n";
           has_warning_ = true;
         }
-      } else {
+      } else if (!level) {
         errors_ << "E: Invalid level in group " << tmp_name << ": "
                 << *level_string << "\n";
         has_error_ = true;
@@ -632,12 +1653,18 @@ namespace soralog {
     if (system_.getGroup(name)) {
       if (parent.has_value()) {
         system_.setParentOfGroup(name, parent.value());
+      } else if (reload_) {
+        system_.unsetParentOfGroup(name);
       }
       if (sink.has_value()) {
         system_.setSinkOfGroup(name, sink.value());
+      } else if (reload_) {
+        system_.resetSinkOfGroup(name);
       }
       if (level.has_value()) {
         system_.setLevelOfGroup(name, level.value());
+      } else if (reload_) {
+        system_.resetLevelOfGroup(name);
       }
     } else {
       system_.makeGroup(name, parent, sink, level);
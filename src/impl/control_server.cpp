@@ -0,0 +1,344 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/control_server.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <soralog/group.hpp>
+#include <soralog/logger.hpp>
+
+namespace soralog {
+
+  namespace {
+
+#if defined(MSG_NOSIGNAL)
+    constexpr int send_flags = MSG_NOSIGNAL;
+#else
+    constexpr int send_flags = 0;
+#endif
+
+    std::vector<std::string_view> split(std::string_view line) {
+      std::vector<std::string_view> words;
+      size_t pos = 0;
+      while (true) {
+        pos = line.find_first_not_of(" \t\r", pos);
+        if (pos == std::string_view::npos) {
+          return words;
+        }
+        auto end = std::min(line.find_first_of(" \t\r", pos), line.size());
+        words.emplace_back(line.substr(pos, end - pos));
+        pos = end;
+      }
+    }
+
+    template <typename T>
+    void sort_by_name(std::vector<std::shared_ptr<T>> &entities) {
+      std::sort(entities.begin(), entities.end(),
+                [](const auto &lhs, const auto &rhs) {
+                  return lhs->name() < rhs->name();
+                });
+    }
+
+    void sort_by_name(std::vector<LoggingSystem::EntityState> &entities) {
+      std::sort(entities.begin(), entities.end(),
+                [](const auto &lhs, const auto &rhs) {
+                  return lhs.name < rhs.name;
+                });
+    }
+
+    /**
+     * @returns list of inherited properties, or empty string if there are
+     * none
+     */
+    std::string inherited(bool level, bool sink) {
+      if (!level && !sink) {
+        return "";
+      }
+      return std::string(" inherited=")
+           + (level ? (sink ? "level,sink" : "level") : "sink");
+    }
+
+    bool write_all(int fd, std::string_view data) {
+      while (!data.empty()) {
+        auto n = ::send(fd, data.data(), data.size(), send_flags);
+        if (n < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return false;
+        }
+        data.remove_prefix(n);
+      }
+      return true;
+    }
+
+    void close_fd(int &fd) {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+
+    constexpr std::string_view help =
+        "help                           - this list\n"
+        "groups                         - groups with parent, level and sink\n"
+        "loggers                        - loggers with group, level and sink\n"
+        "sinks                          - sinks with statistics of queue\n"
+        "level group|logger NAME LEVEL  - set level ('reset' to inherit)\n"
+        "flush [SINK]                   - write queued events of sink (all)\n"
+        "rotate [SINK]                  - reopen file of sink (all)\n";
+
+  }  // namespace
+
+  ControlServer::ControlServer(LoggingSystem &system,
+                               std::filesystem::path path,
+                               std::chrono::milliseconds client_timeout)
+      : system_(system),
+        path_(std::move(path)),
+        client_timeout_(client_timeout) {
+    sockaddr_un address{};
+    if (path_.native().size() >= sizeof(address.sun_path)) {
+      throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                              "Path of control socket is too long");
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path));
+
+    auto fail = [&](const std::string &what) {
+      const auto error = errno;
+      close_fd(listen_fd_);
+      close_fd(stop_fds_[0]);
+      close_fd(stop_fds_[1]);
+      throw std::system_error(error, std::generic_category(), what);
+    };
+
+    if (::pipe2(stop_fds_, O_CLOEXEC) != 0) {
+      fail("Can't create pipe of control server");
+    }
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+      fail("Can't create control socket");
+    }
+    // Socket of previous run is left if process was killed; anything else
+    // at that path is not ours to remove
+    struct stat st {};
+    if (::lstat(path_.c_str(), &st) == 0) {
+      if (!S_ISSOCK(st.st_mode)) {
+        errno = EEXIST;
+        fail("Path of control socket is occupied by other file "
+             + path_.string());
+      }
+      ::unlink(path_.c_str());
+    }
+    // Socket file is created accessible by owner only, so nobody else can
+    // connect before it's listened
+    const auto previous_umask = ::umask(S_IRWXG | S_IRWXO | S_IXUSR);
+    const auto bound = ::bind(listen_fd_,
+                              reinterpret_cast<sockaddr *>(&address),
+                              sizeof(address));
+    ::umask(previous_umask);
+    if (bound != 0 || ::listen(listen_fd_, 4) != 0) {
+      fail("Can't listen control socket " + path_.string());
+    }
+
+    worker_ = std::thread([this] { run(); });
+  }
+
+  ControlServer::~ControlServer() {
+    const char stop = 0;
+    while (::write(stop_fds_[1], &stop, 1) < 0 && errno == EINTR) {
+    }
+    worker_.join();
+    close_fd(listen_fd_);
+    close_fd(stop_fds_[0]);
+    close_fd(stop_fds_[1]);
+    ::unlink(path_.c_str());
+  }
+
+  void ControlServer::run() {
+    pollfd fds[] = {{stop_fds_[0], POLLIN, 0}, {listen_fd_, POLLIN, 0}};
+    for (;;) {
+      if (::poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      if (fds[0].revents != 0) {
+        return;
+      }
+      if ((fds[1].revents & POLLIN) != 0) {
+        if (auto fd =
+                ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            fd >= 0) {
+#if defined(SO_NOSIGPIPE)
+          int on = 1;
+          ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+          serve(fd);
+          ::close(fd);
+        }
+      }
+    }
+  }
+
+  void ControlServer::serve(int fd) {
+    pollfd fds[] = {{stop_fds_[0], POLLIN, 0}, {fd, POLLIN, 0}};
+    std::string buffer;
+    std::array<char, 1024> chunk{};
+    for (;;) {
+      const auto ready =
+          ::poll(fds, 2, static_cast<int>(client_timeout_.count()));
+      if (ready < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      if (ready == 0) {
+        // Silent client doesn't hold other clients anymore
+        write_all(fd, "ERROR timeout\n");
+        return;
+      }
+      if (fds[0].revents != 0) {
+        return;
+      }
+      auto n = ::read(fd, chunk.data(), chunk.size());
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return;
+      }
+      buffer.append(chunk.data(), n);
+
+      size_t pos = 0;
+      for (size_t end; (end = buffer.find('\n', pos)) != std::string::npos;
+           pos = end + 1) {
+        auto line = std::string_view(buffer).substr(pos, end - pos);
+        if (!write_all(fd, execute(line))) {
+          return;
+        }
+      }
+      buffer.erase(0, pos);
+
+      if (buffer.size() > max_line_size) {
+        write_all(fd, "ERROR command is too long\n");
+        return;
+      }
+    }
+  }
+
+  std::string ControlServer::execute(std::string_view command) {
+    const auto args = split(command);
+    if (args.empty()) {
+      return "ERROR empty command\n";
+    }
+    const auto &cmd = args[0];
+    std::ostringstream out;
+
+    if (cmd == "help" && args.size() == 1) {
+      out << help;
+
+    } else if (cmd == "groups" && args.size() == 1) {
+      auto groups = system_.snapshot().groups;
+      sort_by_name(groups);
+      for (const auto &group : groups) {
+        out << "group " << group.name
+            << " parent=" << (group.group.empty() ? "-" : group.group)
+            << " level=" << levelName(group.level) << " sink=" << group.sink
+            << inherited(!group.is_level_overridden,
+                         !group.is_sink_overridden)
+            << "\n";
+      }
+
+    } else if (cmd == "loggers" && args.size() == 1) {
+      auto loggers = system_.snapshot().loggers;
+      sort_by_name(loggers);
+      for (const auto &logger : loggers) {
+        out << "logger " << logger.name << " group=" << logger.group
+            << " level=" << levelName(logger.level) << " sink=" << logger.sink
+            << inherited(!logger.is_level_overridden,
+                         !logger.is_sink_overridden)
+            << "\n";
+      }
+
+    } else if (cmd == "sinks" && args.size() == 1) {
+      std::vector<std::shared_ptr<Sink>> sinks;
+      system_.forEachSink([&](const auto &sink) { sinks.push_back(sink); });
+      sort_by_name(sinks);
+      for (const auto &sink : sinks) {
+        const auto stats = sink->queueStats();
+        out << "sink " << sink->name() << " events=" << stats.events << "/"
+            << stats.capacity << " bytes=" << stats.bytes << "/"
+            << stats.max_bytes << "\n";
+      }
+
+    } else if (cmd == "level" && args.size() == 4) {
+      const std::string name(args[2]);
+      std::optional<Level> level;
+      if (args[3] != "reset") {
+        level = levelFromStr(args[3]);
+        if (!level) {
+          return "ERROR unknown level '" + std::string(args[3]) + "'\n";
+        }
+      }
+      bool done = false;
+      if (args[1] == "group") {
+        done = level ? system_.setLevelOfGroup(name, *level)
+                     : system_.resetLevelOfGroup(name);
+      } else if (args[1] == "logger") {
+        done = level ? system_.setLevelOfLogger(name, *level)
+                     : system_.resetLevelOfLogger(name);
+      } else {
+        return "ERROR expected 'group' or 'logger'\n";
+      }
+      if (!done) {
+        return "ERROR unknown " + std::string(args[1]) + " '" + name + "'\n";
+      }
+
+    } else if ((cmd == "flush" || cmd == "rotate") && args.size() <= 2) {
+      std::vector<std::shared_ptr<Sink>> sinks;
+      if (args.size() == 2) {
+        auto sink = system_.getSink(args[1]);
+        if (!sink) {
+          return "ERROR unknown sink '" + std::string(args[1]) + "'\n";
+        }
+        sinks.push_back(std::move(sink));
+      } else {
+        system_.forEachSink([&](const auto &sink) { sinks.push_back(sink); });
+      }
+      for (const auto &sink : sinks) {
+        if (cmd == "flush") {
+          sink->flush();
+        } else {
+          sink->rotate();
+        }
+      }
+
+    } else {
+      return "ERROR unknown command or wrong arguments: '"
+           + std::string(cmd) + "'\n";
+    }
+
+    out << "OK\n";
+    return out.str();
+  }
+
+}  // namespace soralog
@@ -0,0 +1,226 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/crash_writer.hpp>
+
+#include <unistd.h>
+
+#include <cerrno>
+
+#include <zlib.h>
+
+#include <soralog/impl/json_escape.hpp>
+#include <soralog/impl/line_pattern.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    /// Max size of rendered event except message
+    constexpr size_t max_prefix_size = 128;
+
+    void put_string(char *&ptr, std::string_view str) {
+      std::memcpy(ptr, str.data(), str.size());
+      ptr += str.size();  // NOLINT
+    }
+
+    void put_number(char *&ptr, uint64_t value, size_t width) {
+      std::array<char, 20> digits{};
+      size_t n = 0;
+      do {
+        digits[n++] = static_cast<char>('0' + value % 10);  // NOLINT
+        value /= 10;
+      } while (value != 0);
+      for (; n < width; --width) {
+        *ptr++ = '0';  // NOLINT
+      }
+      while (n != 0) {
+        *ptr++ = digits[--n];  // NOLINT
+      }
+    }
+
+    /**
+     * Renders "YYYY-MM-DDThh:mm:ss.uuuuuuZ" of UTC as JSON layout does
+     */
+    void put_timestamp(char *&ptr,
+                       std::chrono::system_clock::time_point time) {
+      const auto since_epoch = time.time_since_epoch();
+      const auto tm = LinePattern::brokenDownTime(since_epoch / 1s, 0);
+      put_number(ptr, static_cast<uint64_t>(tm.tm_year + 1900), 4);
+      *ptr++ = '-';  // NOLINT
+      put_number(ptr, static_cast<uint64_t>(tm.tm_mon + 1), 2);
+      *ptr++ = '-';  // NOLINT
+      put_number(ptr, static_cast<uint64_t>(tm.tm_mday), 2);
+      *ptr++ = 'T';  // NOLINT
+      put_number(ptr, static_cast<uint64_t>(tm.tm_hour), 2);
+      *ptr++ = ':';  // NOLINT
+      put_number(ptr, static_cast<uint64_t>(tm.tm_min), 2);
+      *ptr++ = ':';  // NOLINT
+      put_number(ptr, static_cast<uint64_t>(tm.tm_sec), 2);
+      *ptr++ = '.';  // NOLINT
+      put_number(ptr, static_cast<uint64_t>(since_epoch % 1s / 1us), 6);
+      *ptr++ = 'Z';  // NOLINT
+    }
+
+    void put_le(char *&ptr, uint32_t value, size_t bytes) {
+      for (size_t i = 0; i < bytes; ++i) {
+        *ptr++ = static_cast<char>(value >> (i * 8));  // NOLINT
+      }
+    }
+
+  }  // namespace
+
+  CrashWriter::CrashWriter(int fd, Sink::ThreadInfoType thread_info_type,
+                           bool gzip,
+                           std::chrono::steady_clock::time_point deadline,
+                           LinePattern *pattern) noexcept
+      : fd_(fd),
+        thread_info_type_(thread_info_type),
+        gzip_(gzip),
+        pattern_(pattern),
+        deadline_(deadline) {}
+
+  CrashWriter::~CrashWriter() {
+    flush();
+  }
+
+  void CrashWriter::prepare() {
+    LinePattern::saveUtcOffset();
+  }
+
+  bool CrashWriter::lock(
+      std::atomic_bool &flag,
+      std::chrono::steady_clock::time_point deadline) noexcept {
+    while (true) {
+      bool false_v = false;
+      if (flag.compare_exchange_strong(false_v, true,
+                                       std::memory_order_acq_rel)) {
+        return true;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      struct timespec pause {
+        0, 1000000  // 1ms
+      };
+      ::nanosleep(&pause, nullptr);
+    }
+  }
+
+  bool CrashWriter::put(const Event &event) noexcept {
+    const size_t max_size = pattern_ != nullptr
+        ? pattern_->maxSize()
+        : max_prefix_size
+            + json::maxEscapedSize(event.thread_name().size()
+                                   + event.name().size()
+                                   + event.message().size()
+                                   + event.fields().data().size());
+    if (max_size > buffer_.size()) {
+      return true;  // event is skipped: it can't be rendered in buffer
+    }
+    if (buffer_.size() - size_ < max_size) {
+      if (!flush()) {
+        return false;
+      }
+    }
+
+    char *ptr = buffer_.data() + size_;  // NOLINT
+
+    if (pattern_ != nullptr) {
+      pattern_->renderInSignal(ptr, event);
+    } else {
+      putJson(ptr, event);
+    }
+    size_ = ptr - buffer_.data();
+    return true;
+  }
+
+  void CrashWriter::putJson(char *&ptr, const Event &event) noexcept {
+    put_string(ptr, R"({"timestamp":")");
+    put_timestamp(ptr, event.timestamp());
+    put_string(ptr, R"(","level":")");
+    put_string(ptr, levelToStr(event.level()));
+    *ptr++ = '"';  // NOLINT
+
+    switch (thread_info_type_) {
+      case Sink::ThreadInfoType::NAME:
+        put_string(ptr, R"(,"thread":")");
+        ptr = json::escape(ptr, event.thread_name());
+        *ptr++ = '"';  // NOLINT
+        break;
+      case Sink::ThreadInfoType::ID:
+        put_string(ptr, R"(,"thread":)");
+        put_number(ptr, event.thread_number(), 0);
+        break;
+      default:
+        break;
+    }
+
+    put_string(ptr, R"(,"logger":")");
+    ptr = json::escape(ptr, event.name());
+    put_string(ptr, R"(","message":")");
+    ptr = json::escape(ptr, event.message());
+    *ptr++ = '"';  // NOLINT
+    ptr = json::putFields(ptr, event.fields());
+    put_string(ptr, "}\n");
+  }
+
+  bool CrashWriter::flush() noexcept {
+    if (size_ == 0 || failed_) {
+      size_ = 0;
+      return !failed_;
+    }
+    const auto size = static_cast<uint32_t>(size_);
+    size_ = 0;
+
+    if (!gzip_) {
+      return writeAll(buffer_.data(), size);
+    }
+
+    // Gzip member of one stored (not compressed) deflate block
+    std::array<char, 15> header{};
+    char *ptr = header.data();
+    put_string(ptr, std::string_view("\x1f\x8b\x08\0\0\0\0\0\0\xff", 10));
+    *ptr++ = 0x01;  // NOLINT: final stored block
+    put_le(ptr, size, 2);
+    put_le(ptr, ~size & 0xffff, 2);
+
+    std::array<char, 8> trailer{};
+    ptr = trailer.data();
+    put_le(ptr,
+           crc32(crc32(0, nullptr, 0),
+                 reinterpret_cast<const Bytef *>(buffer_.data()),  // NOLINT
+                 size),
+           4);
+    put_le(ptr, size, 4);
+
+    return writeAll(header.data(), header.size())
+        && writeAll(buffer_.data(), size)
+        && writeAll(trailer.data(), trailer.size());
+  }
+
+  bool CrashWriter::writeAll(const char *data, size_t size) noexcept {
+    while (size != 0 && !failed_) {
+      if (std::chrono::steady_clock::now() >= deadline_) {
+        failed_ = true;
+        break;
+      }
+      auto written = ::write(fd_, data, size);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        failed_ = true;
+        break;
+      }
+      data += written;  // NOLINT
+      size -= written;
+    }
+    return !failed_;
+  }
+
+}  // namespace soralog
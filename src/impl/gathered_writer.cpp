@@ -0,0 +1,83 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/gathered_writer.hpp>
+
+#include <cerrno>
+#include <climits>
+
+namespace soralog {
+
+  namespace {
+#ifdef IOV_MAX
+    constexpr size_t max_iovecs = IOV_MAX;
+#else
+    constexpr size_t max_iovecs = 1024;
+#endif
+  }  // namespace
+
+  GatheredWriter::GatheredWriter(size_t scratch_size,
+                                 size_t max_held_events)
+      : scratch_(scratch_size),
+        ptr_(scratch_.data()),
+        max_held_events_(std::max<size_t>(max_held_events, 1)) {
+    iov_.reserve(max_iovecs);
+    held_.reserve(max_held_events_);
+  }
+
+  void GatheredWriter::add(LinePattern &pattern, NodeRef &node) {
+    if (pattern.render(ptr_, *node, iov_)) {
+      held_.emplace_back(std::move(node));
+    }
+  }
+
+  size_t GatheredWriter::size() const noexcept {
+    size_t size = 0;
+    for (const auto &item : iov_) {
+      size += item.iov_len;
+    }
+    return size;
+  }
+
+  bool GatheredWriter::full(const LinePattern &pattern) const noexcept {
+    return static_cast<size_t>(scratch_.data() + scratch_.size() - ptr_)
+            < pattern.maxSize()
+        || iov_.size() + pattern.maxIovecs() > max_iovecs
+        || held_.size() >= max_held_events_;
+  }
+
+  size_t GatheredWriter::write(int fd) {
+    size_t total = 0;
+    auto *iov = iov_.data();
+    auto count = iov_.size();
+    while (count != 0) {
+      auto res = ::writev(fd, iov, static_cast<int>(count));
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      }
+      auto written = static_cast<size_t>(res);
+      total += written;
+      while (count != 0 && written >= iov->iov_len) {
+        written -= iov->iov_len;
+        ++iov;  // NOLINT
+        --count;
+      }
+      if (count != 0) {
+        iov->iov_base = static_cast<char *>(iov->iov_base) + written;  // NOLINT
+        iov->iov_len -= written;
+      }
+    }
+
+    // Slots of queue are released only after their messages are written
+    held_.clear();
+    iov_.clear();
+    ptr_ = scratch_.data();
+    return total;
+  }
+
+}  // namespace soralog
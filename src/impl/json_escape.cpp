@@ -0,0 +1,213 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/json_escape.hpp>
+
+#include <cmath>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SORALOG_JSON_X86
+#include <immintrin.h>
+#endif
+
+namespace soralog::json {
+
+  namespace {
+
+    constexpr std::string_view hex = "0123456789abcdef";
+
+    char *put_escaped(char *out, char c) noexcept {
+      *out++ = '\\';  // NOLINT
+      switch (c) {
+        case '"':
+          *out++ = '"';  // NOLINT
+          break;
+        case '\\':
+          *out++ = '\\';  // NOLINT
+          break;
+        case '\n':
+          *out++ = 'n';  // NOLINT
+          break;
+        case '\r':
+          *out++ = 'r';  // NOLINT
+          break;
+        case '\t':
+          *out++ = 't';  // NOLINT
+          break;
+        case '\b':
+          *out++ = 'b';  // NOLINT
+          break;
+        case '\f':
+          *out++ = 'f';  // NOLINT
+          break;
+        default: {
+          const auto byte = static_cast<unsigned char>(c);
+          *out++ = 'u';                // NOLINT
+          *out++ = '0';                // NOLINT
+          *out++ = '0';                // NOLINT
+          *out++ = hex[byte >> 4];     // NOLINT
+          *out++ = hex[byte & 0x0f];   // NOLINT
+        }
+      }
+      return out;
+    }
+
+    bool needs_escape(char c) noexcept {
+      return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+    }
+
+    char *escape_scalar(char *out, const char *in, size_t size) noexcept {
+      for (const char *end = in + size; in != end; ++in) {  // NOLINT
+        if (needs_escape(*in)) {
+          out = put_escaped(out, *in);
+        } else {
+          *out++ = *in;  // NOLINT
+        }
+      }
+      return out;
+    }
+
+#ifdef SORALOG_JSON_X86
+
+    // Vector is copied to output as is, and then output is rewound to the
+    // first byte needing escape (if any)
+
+    char *escape_sse2(char *out, const char *in, size_t size) noexcept {
+      const auto quote = _mm_set1_epi8('"');
+      const auto backslash = _mm_set1_epi8('\\');
+      const auto control = _mm_set1_epi8(0x1f);
+      while (size >= 16) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), v);
+        const auto special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                         _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+        const auto mask =
+            static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask == 0) {
+          in += 16;  // NOLINT
+          out += 16;  // NOLINT
+          size -= 16;
+          continue;
+        }
+        const auto n = static_cast<size_t>(__builtin_ctz(mask));
+        out = put_escaped(out + n, in[n]);  // NOLINT
+        in += n + 1;  // NOLINT
+        size -= n + 1;
+      }
+      return escape_scalar(out, in, size);
+    }
+
+    __attribute__((target("avx2"))) char *escape_avx2(char *out,
+                                                      const char *in,
+                                                      size_t size) noexcept {
+      const auto quote = _mm256_set1_epi8('"');
+      const auto backslash = _mm256_set1_epi8('\\');
+      const auto control = _mm256_set1_epi8(0x1f);
+      while (size >= 32) {
+        const auto v =
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), v);
+        const auto special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                            _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v));
+        const auto mask =
+            static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask == 0) {
+          in += 32;  // NOLINT
+          out += 32;  // NOLINT
+          size -= 32;
+          continue;
+        }
+        const auto n = static_cast<size_t>(__builtin_ctz(mask));
+        out = put_escaped(out + n, in[n]);  // NOLINT
+        in += n + 1;  // NOLINT
+        size -= n + 1;
+      }
+      return escape_sse2(out, in, size);
+    }
+
+#endif  // SORALOG_JSON_X86
+
+    Isa detect() noexcept {
+#ifdef SORALOG_JSON_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+      }
+      return Isa::SSE2;
+#else
+      return Isa::SCALAR;
+#endif
+    }
+
+    // Escaping before dynamic initialization (i.e. from constructors of
+    // other static objects) is just done by scalar code
+    const Isa best_isa = detect();
+
+  }  // namespace
+
+  Isa bestIsa() noexcept {
+    return best_isa;
+  }
+
+  char *escape(char *out, std::string_view str) noexcept {
+    return escape(out, str, best_isa);
+  }
+
+  char *escape(char *out, std::string_view str, Isa isa) noexcept {
+    if (isa > best_isa) {
+      isa = best_isa;
+    }
+    switch (isa) {
+#ifdef SORALOG_JSON_X86
+      case Isa::AVX2:
+        return escape_avx2(out, str.data(), str.size());
+      case Isa::SSE2:
+        return escape_sse2(out, str.data(), str.size());
+#endif
+      default:
+        return escape_scalar(out, str.data(), str.size());
+    }
+  }
+
+  char *putFields(char *out, const Fields &fields) noexcept {
+    fields.forEach([&](const Fields::View &field) {
+      *out++ = ',';  // NOLINT
+      *out++ = '"';  // NOLINT
+      out = escape(out, field.key);
+      *out++ = '"';  // NOLINT
+      *out++ = ':';  // NOLINT
+      switch (field.type) {
+        case FieldType::INT:
+          out = fmt::format_to(out, "{}", field.int_value);
+          break;
+        case FieldType::UINT:
+          out = fmt::format_to(out, "{}", field.uint_value);
+          break;
+        case FieldType::DOUBLE:
+          out = std::isfinite(field.double_value)
+              ? fmt::format_to(out, "{}", field.double_value)
+              : fmt::format_to(out, "null");
+          break;
+        case FieldType::BOOL:
+          out = fmt::format_to(out, "{}", field.bool_value);
+          break;
+        default:
+          *out++ = '"';  // NOLINT
+          out = escape(out, field.string_value);
+          *out++ = '"';  // NOLINT
+      }
+    });
+    return out;
+  }
+
+}  // namespace soralog::json
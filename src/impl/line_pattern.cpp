@@ -0,0 +1,632 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/line_pattern.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include <fmt/chrono.h>
+#include <fmt/color.h>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    namespace fmt_internal {
+#if FMT_VERSION >= 70000
+      using namespace fmt::detail;  // NOLINT
+#else
+      using namespace fmt::internal;  // NOLINT
+#endif
+    }  // namespace fmt_internal
+
+    constexpr std::array<fmt::color, static_cast<size_t>(Level::TRACE) + 1>
+        level_to_color_map{
+            fmt::color::brown,         // OFF
+            fmt::color::red,           // CRITICAL
+            fmt::color::orange_red,    // ERROR
+            fmt::color::orange,        // WARNING
+            fmt::color::forest_green,  // INFO
+            fmt::color::dark_green,    // VERBOSE
+            fmt::color::medium_blue,   // DEBUG
+            fmt::color::gray,          // TRACE
+        };
+
+    // Same escape as fmt uses internally; it is not exported since fmt 8
+    constexpr std::string_view reset_style = "\x1b[0m";
+
+    template <typename T>
+    std::string to_string(const T &style) {
+      return {std::begin(style), std::end(style)};
+    }
+
+    std::string foreground_style(fmt::color color) {
+      return to_string(fmt_internal::make_foreground_color<char>(color));
+    }
+
+    std::string emphasis_style(fmt::emphasis emphasis) {
+      return to_string(fmt_internal::make_emphasis<char>(emphasis));
+    }
+
+    constexpr size_t max_pattern_size = 1024;
+    constexpr size_t level_width = 8;
+    constexpr size_t thread_name_width = 15;
+    constexpr size_t thread_number_width = 6;
+    constexpr size_t max_name_size = 32;
+
+    template <typename T>
+    void put_string(char *&ptr, const T &str) {
+      std::memcpy(ptr, str.data(), str.size());
+      ptr += str.size();  // NOLINT
+    }
+
+    void put_padded(char *&ptr, std::string_view str, size_t width) {
+      str = str.substr(0, width);
+      std::memcpy(ptr, str.data(), str.size());
+      std::memset(ptr + str.size(), ' ', width - str.size());  // NOLINT
+      ptr += width;  // NOLINT
+    }
+
+    /// Two-digit strings "00".."99" one by one
+    constexpr auto digit_pairs = [] {
+      std::array<char, 200> pairs{};
+      for (size_t i = 0; i < 100; ++i) {
+        pairs[i * 2] = static_cast<char>('0' + i / 10);      // NOLINT
+        pairs[i * 2 + 1] = static_cast<char>('0' + i % 10);  // NOLINT
+      }
+      return pairs;
+    }();
+
+    /// Puts {@param width} last decimal digits of {@param value} (with
+    /// leading zeros) at {@param ptr}, by two digits per division
+    void put_digits(char *ptr, uint64_t value, size_t width) {
+      auto i = width;
+      while (i >= 2) {
+        i -= 2;
+        std::memcpy(ptr + i, &digit_pairs[value % 100 * 2], 2);  // NOLINT
+        value /= 100;
+      }
+      if (i != 0) {
+        *ptr = static_cast<char>('0' + value % 10);
+      }
+    }
+
+    /// @returns number of decimal digits of {@param value}
+    size_t count_digits(uint64_t value) {
+      size_t count = 1;
+      for (; value >= 100; value /= 100) {
+        count += 2;
+      }
+      return count + (value >= 10 ? 1 : 0);
+    }
+
+    /// Levels padded to width of their column
+    constexpr auto padded_levels = [] {
+      std::array<std::array<char, level_width>,
+                 static_cast<size_t>(Level::TRACE) + 1>
+          levels{};
+      for (size_t i = 0; i < levels.size(); ++i) {
+        const char *str = detail::level_to_str_map[i];  // NOLINT
+        for (size_t j = 0; j < level_width; ++j) {
+          levels[i][j] = *str != '\0' ? *str++ : ' ';  // NOLINT
+        }
+      }
+      return levels;
+    }();
+
+    /// @returns width of date or time part, or 0 if {@param spec} is not one
+    size_t datetime_width(char spec, bool utc) {
+      switch (spec) {
+        case 'Y':
+          return 4;
+        case 'y':
+        case 'm':
+        case 'd':
+        case 'H':
+        case 'M':
+        case 'S':
+          return 2;
+        case 'z':
+          return utc ? 1 : 6;  // "Z" or "+hh:mm"
+        default:
+          return 0;
+      }
+    }
+
+    /// UTC offset of local time in seconds, as it was recently; it's used
+    /// where time zone can't be applied (see LinePattern::renderInSignal)
+    std::atomic_long utc_offset = 0;
+
+    /**
+     * @class SharedTime
+     * Broken-down time of recent second, shared by patterns of all sinks, so
+     * time zone is applied once per second for whole process
+     */
+    class SharedTime final {
+     public:
+      std::tm get(int64_t sec, bool utc) {
+        auto &cache = utc ? utc_ : local_;
+        std::lock_guard lock(mutex_);
+        if (cache.sec != sec) {
+          cache.sec = sec;
+          cache.tm = utc ? fmt::gmtime(static_cast<std::time_t>(sec))
+                         : fmt::localtime(static_cast<std::time_t>(sec));
+          if (!utc) {
+            utc_offset.store(cache.tm.tm_gmtoff, std::memory_order_relaxed);
+          }
+        }
+        return cache.tm;
+      }
+
+     private:
+      struct Cache {
+        int64_t sec = -1;
+        std::tm tm{};
+      };
+
+      std::mutex mutex_;
+      Cache local_;
+      Cache utc_;
+    };
+
+    SharedTime &shared_time() {
+      static SharedTime shared_time;
+      return shared_time;
+    }
+
+  }  // namespace
+
+  /// Item of parsed pattern before compilation
+  struct LinePattern::Token {
+    Op op;
+    char spec = 0;         // of DATETIME
+    std::string literal{};  // of LITERAL
+  };
+
+  LinePattern::LinePattern(std::string_view pattern,
+                           Sink::ThreadInfoType thread_info_type,
+                           bool with_color, bool utc)
+      : utc_(utc) {
+    // Offsets of steps are 16-bit
+    if (pattern.size() > max_pattern_size) {
+      throw std::invalid_argument("pattern is too long");
+    }
+
+    std::vector<Token> tokens;
+
+    auto literal = [&](std::string str) {
+      tokens.push_back({Op::LITERAL, 0, std::move(str)});
+    };
+    auto styled = [&](Op op, const std::string &style) {
+      if (with_color) {
+        literal(style);
+      }
+      tokens.push_back({op});
+      if (with_color) {
+        literal(std::string(reset_style));
+      }
+    };
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+      if (pattern[i] != '%') {
+        literal(std::string(1, pattern[i]));
+        continue;
+      }
+      if (++i == pattern.size()) {
+        throw std::invalid_argument("pattern ends with single '%'");
+      }
+      const char spec = pattern[i];
+      if (datetime_width(spec, utc_) != 0) {
+        tokens.push_back({Op::DATETIME, spec});
+        continue;
+      }
+      switch (spec) {
+        case '%':
+          literal("%");
+          break;
+        case 'F':
+          tokens.push_back({Op::DATETIME, 'Y'});
+          literal("-");
+          tokens.push_back({Op::DATETIME, 'm'});
+          literal("-");
+          tokens.push_back({Op::DATETIME, 'd'});
+          break;
+        case 'T':
+          tokens.push_back({Op::DATETIME, 'H'});
+          literal(":");
+          tokens.push_back({Op::DATETIME, 'M'});
+          literal(":");
+          tokens.push_back({Op::DATETIME, 'S'});
+          break;
+        case 'f':
+          styled(Op::MICROSECONDS, foreground_style(fmt::color::gray));
+          break;
+        case 'e':
+          styled(Op::MILLISECONDS, foreground_style(fmt::color::gray));
+          break;
+        case 'l':
+        case 'L':
+          if (with_color) {
+            tokens.push_back({Op::LEVEL_STYLE});
+          }
+          tokens.push_back({spec == 'l' ? Op::LEVEL : Op::LEVEL_CHAR});
+          if (with_color) {
+            literal(std::string(reset_style));
+          }
+          break;
+        case 'n':
+          styled(Op::NAME, emphasis_style(fmt::emphasis::bold));
+          break;
+        case 't':
+          if (thread_info_type == Sink::ThreadInfoType::NAME) {
+            tokens.push_back({Op::THREAD_NAME});
+          } else if (thread_info_type == Sink::ThreadInfoType::ID) {
+            tokens.push_back({Op::THREAD_NUMBER});
+          }
+          break;
+        case 'v':
+          if (with_color) {
+            tokens.push_back({Op::TEXT_STYLE});
+          }
+          tokens.push_back({Op::MESSAGE});
+          if (with_color) {
+            literal(std::string(reset_style));
+          }
+          break;
+        default:
+          throw std::invalid_argument(
+              fmt::format("unknown specifier '%{}'", spec));
+      }
+    }
+
+    // Run of date and time parts (with literals between them) is one step
+    for (auto it = tokens.begin(); it != tokens.end(); ++it) {
+      if (it->op != Op::DATETIME) {
+        if (it->op == Op::LITERAL) {
+          addLiteral(it->literal);
+        } else {
+          addStep(it->op);
+        }
+        continue;
+      }
+      auto last = it;
+      for (auto next = it + 1; next != tokens.end()
+           && (next->op == Op::LITERAL || next->op == Op::DATETIME);
+           ++next) {
+        if (next->op == Op::DATETIME) {
+          last = next;
+        }
+      }
+      addDatetime(&*it, &*last + 1);
+      it = last;
+    }
+    addLiteral("\n");
+
+    if (with_color) {
+      for (size_t i = 0; i < levels; ++i) {
+        level_styles_[i] = foreground_style(level_to_color_map[i])  // NOLINT
+            + emphasis_style(fmt::emphasis::bold);
+        const auto level = static_cast<Level>(i);
+        if (level <= Level::ERROR_) {
+          text_styles_[i] = emphasis_style(fmt::emphasis::bold);  // NOLINT
+        } else if (level >= Level::DEBUG) {
+          text_styles_[i] = emphasis_style(fmt::emphasis::italic);  // NOLINT
+        }
+      }
+    }
+  }
+
+  std::string_view LinePattern::defaultPattern(
+      Sink::ThreadInfoType thread_info_type) {
+    // Separator between logical parts of line is couple of spaces to differ
+    // of single space
+    if (thread_info_type == Sink::ThreadInfoType::NONE) {
+      return "%y.%m.%d %H:%M:%S.%f  %l  %n  %v";
+    }
+    return "%y.%m.%d %H:%M:%S.%f  %t  %l  %n  %v";
+  }
+
+  void LinePattern::addLiteral(std::string_view literal) {
+    if (literal.empty()) {
+      return;
+    }
+    // Adjacent literals are stored one by one, so they join into one run
+    if (steps_.empty() || steps_.back().op != Op::LITERAL) {
+      steps_.push_back({Op::LITERAL, static_cast<uint16_t>(literals_.size())});
+    }
+    literals_.append(literal);
+    steps_.back().size += literal.size();
+    max_size_ += literal.size();
+  }
+
+  void LinePattern::addDatetime(const Token *begin, const Token *end) {
+    Step step{Op::DATETIME, static_cast<uint16_t>(datetime_.size())};
+    for (const auto *token = begin; token != end; ++token) {  // NOLINT
+      if (token->op == Op::LITERAL) {
+        datetime_.append(token->literal);
+      } else {
+        datetime_parts_.push_back(
+            {token->spec, static_cast<uint16_t>(datetime_.size())});
+        datetime_.append(datetime_width(token->spec, utc_), '0');
+      }
+    }
+    step.size = datetime_.size() - step.offset;
+    steps_.push_back(step);
+    max_size_ += step.size;
+  }
+
+  void LinePattern::addStep(Op op) {
+    size_t max_size = 0;
+    switch (op) {
+      case Op::MICROSECONDS:
+        max_size = 6;
+        break;
+      case Op::MILLISECONDS:
+        max_size = 3;
+        break;
+      case Op::LEVEL:
+        max_size = level_width;
+        break;
+      case Op::LEVEL_CHAR:
+        max_size = 1;
+        break;
+      case Op::NAME:
+        max_size = max_name_size;
+        break;
+      case Op::THREAD_NAME:
+        max_size = thread_name_width;
+        break;
+      case Op::THREAD_NUMBER:
+        max_size = 2 + std::numeric_limits<size_t>::digits10 + 1;
+        break;
+      case Op::MESSAGE:
+        max_size = max_text_event_size;
+        ++message_steps_;
+        break;
+      case Op::LEVEL_STYLE:
+      case Op::TEXT_STYLE:
+        // Color and emphasis together are far less
+        max_size = 64;
+        break;
+      default:
+        break;
+    }
+    steps_.push_back({op});
+    max_size_ += max_size;
+  }
+
+  void LinePattern::saveUtcOffset() {
+    std::time_t now = std::time(nullptr);
+    std::tm tm{};
+    if (::localtime_r(&now, &tm) != nullptr) {
+      utc_offset.store(tm.tm_gmtoff, std::memory_order_relaxed);
+    }
+  }
+
+  std::tm LinePattern::brokenDownTime(int64_t sec, int64_t offset) noexcept {
+    sec += offset;
+    // Civil date from days since epoch (proleptic Gregorian calendar)
+    int64_t days = sec / 86400;
+    int64_t rest = sec % 86400;
+    if (rest < 0) {
+      rest += 86400;
+      --days;
+    }
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int64_t doe = days - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+
+    std::tm tm{};
+    tm.tm_year = static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0))
+               - 1900;
+    tm.tm_mon = static_cast<int>(month - 1);
+    tm.tm_mday = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    tm.tm_hour = static_cast<int>(rest / 3600);
+    tm.tm_min = static_cast<int>(rest / 60 % 60);
+    tm.tm_sec = static_cast<int>(rest % 60);
+    tm.tm_gmtoff = offset;
+    return tm;
+  }
+
+  void LinePattern::updateDatetime(int64_t sec) {
+    psec_ = sec;
+    if (!datetime_parts_.empty()) {
+      putDatetime(shared_time().get(sec, utc_));
+    }
+  }
+
+  void LinePattern::putDatetime(const std::tm &tm) noexcept {
+    for (const auto &part : datetime_parts_) {
+      unsigned value = 0;
+      switch (part.spec) {
+        case 'z':
+          putUtcOffset(&datetime_[part.offset], tm);
+          continue;
+        case 'Y':
+          value = tm.tm_year + 1900;
+          break;
+        case 'y':
+          value = tm.tm_year % 100;
+          break;
+        case 'm':
+          value = tm.tm_mon + 1;
+          break;
+        case 'd':
+          value = tm.tm_mday;
+          break;
+        case 'H':
+          value = tm.tm_hour;
+          break;
+        case 'M':
+          value = tm.tm_min;
+          break;
+        default:
+          value = tm.tm_sec;
+      }
+      put_digits(&datetime_[part.offset], value,
+                 datetime_width(part.spec, utc_));
+    }
+  }
+
+  void LinePattern::putUtcOffset(char *ptr, const std::tm &tm) const {
+    if (utc_) {
+      *ptr = 'Z';
+      return;
+    }
+    const auto offset = tm.tm_gmtoff / 60;  // in minutes
+    const auto magnitude = static_cast<uint64_t>(std::abs(offset));
+    ptr[0] = offset < 0 ? '-' : '+';        // NOLINT
+    put_digits(ptr + 1, magnitude / 60, 2);  // NOLINT
+    ptr[3] = ':';                           // NOLINT
+    put_digits(ptr + 4, magnitude % 60, 2);  // NOLINT
+  }
+
+  namespace {
+
+    /// Appends part of line at [{@param begin}, {@param end}) to {@param iov}
+    void add_iovec(std::vector<iovec> &iov, const char *begin,
+                   const char *end) {
+      if (begin == end) {
+        return;
+      }
+      if (!iov.empty()
+          && static_cast<const char *>(iov.back().iov_base)
+                  + iov.back().iov_len  // NOLINT
+              == begin) {
+        iov.back().iov_len += end - begin;
+        return;
+      }
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      iov.push_back({const_cast<char *>(begin),
+                     static_cast<size_t>(end - begin)});
+    }
+
+  }  // namespace
+
+  template <bool gather>
+  bool LinePattern::renderSteps(char *&ptr, const Event &event,
+                                std::vector<iovec> *iov) {
+    const auto time = event.timestamp().time_since_epoch();
+    const auto sec = time / 1s;
+    const auto usec = time % 1s / 1us;
+
+    if (sec != psec_) {
+      updateDatetime(sec);
+    }
+
+    [[maybe_unused]] const char *part = ptr;
+    bool referenced = false;
+
+    for (const auto &step : steps_) {
+      switch (step.op) {
+        case Op::LITERAL:
+          std::memcpy(ptr, literals_.data() + step.offset, step.size);
+          ptr += step.size;  // NOLINT
+          break;
+        case Op::DATETIME:
+          std::memcpy(ptr, datetime_.data() + step.offset, step.size);
+          ptr += step.size;  // NOLINT
+          break;
+        case Op::MICROSECONDS:
+          put_digits(ptr, usec, 6);
+          ptr += 6;  // NOLINT
+          break;
+        case Op::MILLISECONDS:
+          put_digits(ptr, usec / 1000, 3);
+          ptr += 3;  // NOLINT
+          break;
+        case Op::LEVEL:
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+          put_string(ptr, padded_levels[static_cast<size_t>(event.level())]);
+          break;
+        case Op::LEVEL_CHAR:
+          *ptr++ = levelToChar(event.level());  // NOLINT
+          break;
+        case Op::NAME:
+          put_string(ptr, event.name());
+          break;
+        case Op::THREAD_NAME:
+          put_padded(ptr, event.thread_name(), thread_name_width);
+          break;
+        case Op::THREAD_NUMBER: {
+          // Same as "T:{:<6}"
+          const auto number = event.thread_number();
+          const auto digits = count_digits(number);
+          *ptr++ = 'T';  // NOLINT
+          *ptr++ = ':';  // NOLINT
+          put_digits(ptr, number, digits);
+          ptr += digits;  // NOLINT
+          if (digits < thread_number_width) {
+            std::memset(ptr, ' ', thread_number_width - digits);
+            ptr += thread_number_width - digits;  // NOLINT
+          }
+          break;
+        }
+        case Op::MESSAGE:
+          if constexpr (gather) {
+            const auto message = event.message();
+            if (message.size() >= min_referenced_message_size) {
+              add_iovec(*iov, part, ptr);
+              add_iovec(*iov, message.data(),
+                        message.data() + message.size());  // NOLINT
+              part = ptr;
+              referenced = true;
+              event.fields().putText(ptr);
+              break;
+            }
+          }
+          put_string(ptr, event.message());
+          event.fields().putText(ptr);
+          break;
+        case Op::LEVEL_STYLE:
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+          put_string(ptr, level_styles_[static_cast<size_t>(event.level())]);
+          break;
+        case Op::TEXT_STYLE:
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+          put_string(ptr, text_styles_[static_cast<size_t>(event.level())]);
+          break;
+      }
+    }
+
+    if constexpr (gather) {
+      add_iovec(*iov, part, ptr);
+    }
+    return referenced;
+  }
+
+  void LinePattern::render(char *&ptr, const Event &event) {
+    renderSteps<false>(ptr, event, nullptr);
+  }
+
+  void LinePattern::renderInSignal(char *&ptr, const Event &event) noexcept {
+    const auto sec = event.timestamp().time_since_epoch() / 1s;
+    if (sec != psec_) {
+      psec_ = sec;
+      if (!datetime_parts_.empty()) {
+        putDatetime(brokenDownTime(
+            sec, utc_ ? 0 : utc_offset.load(std::memory_order_relaxed)));
+      }
+    }
+    renderSteps<false>(ptr, event, nullptr);
+  }
+
+  bool LinePattern::render(char *&ptr, const Event &event,
+                           std::vector<iovec> &iov) {
+    return renderSteps<true>(ptr, event, &iov);
+  }
+
+}  // namespace soralog
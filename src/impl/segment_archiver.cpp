@@ -0,0 +1,265 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/segment_archiver.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <zlib.h>
+
+#include <soralog/util.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    /// Lowest priority of thread, to not compete with producers and sinks
+    void lower_thread_priority() {
+#if defined(__linux__)
+      // On Linux niceness is attribute of thread, not whole process
+      ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)),
+                    19);
+#endif
+    }
+
+  }  // namespace
+
+  SegmentArchiver::SegmentArchiver() {
+    worker_ = std::thread([this] { run(); });
+  }
+
+  SegmentArchiver::~SegmentArchiver() {
+    {
+      std::lock_guard lock(mutex_);
+      need_to_finalize_ = true;
+    }
+    condvar_.notify_one();
+    worker_.join();
+  }
+
+  std::shared_ptr<SegmentArchiver> SegmentArchiver::instance() {
+    static std::mutex mutex;
+    static std::weak_ptr<SegmentArchiver> weak_instance;
+
+    std::lock_guard lock(mutex);
+    auto instance = weak_instance.lock();
+    if (!instance) {
+      instance = std::make_shared<SegmentArchiver>();
+      weak_instance = instance;
+    }
+    return instance;
+  }
+
+  void SegmentArchiver::enqueue(Task task) {
+    {
+      std::lock_guard lock(mutex_);
+      tasks_.emplace_back(std::move(task));
+    }
+    condvar_.notify_one();
+  }
+
+  void SegmentArchiver::wait() {
+    std::unique_lock lock(mutex_);
+    done_condvar_.wait(lock, [&] { return tasks_.empty() && !in_progress_; });
+  }
+
+  void SegmentArchiver::run() {
+    util::setThreadName("log:archiver");
+    lower_thread_priority();
+
+    while (true) {
+      std::unique_lock lock(mutex_);
+      condvar_.wait(lock, [&] { return !tasks_.empty() || need_to_finalize_; });
+      if (tasks_.empty()) {
+        // Finalizing, and nothing to do anymore
+        return;
+      }
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      in_progress_ = true;
+      lock.unlock();
+
+      if (task.compress) {
+        compress(task.segment);
+      }
+      if (task.max_files != 0 || task.max_total_size != 0) {
+        applyRetention(task.origin, task.max_files, task.max_total_size);
+      }
+
+      lock.lock();
+      in_progress_ = false;
+      if (tasks_.empty()) {
+        done_condvar_.notify_all();
+      }
+    }
+  }
+
+  std::filesystem::path SegmentArchiver::compress(
+      const std::filesystem::path &path) {
+    auto compressed = path;
+    compressed += ".gz";
+    auto tmp = compressed;
+    tmp += ".tmp";
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+      std::cerr << "Can't open log segment '" << path
+                << "' to compress: " << strerror(errno) << std::endl;
+      return {};
+    }
+
+    gzFile out = ::gzopen(tmp.c_str(), "wb");
+    if (out == nullptr) {
+      std::cerr << "Can't create compressed log segment '" << tmp
+                << "': " << strerror(errno) << std::endl;
+      return {};
+    }
+
+    std::array<char, 1u << 16> buff{};  // NOLINT
+    bool ok = true;
+    while (in) {
+      in.read(buff.data(), buff.size());
+      auto size = static_cast<unsigned>(in.gcount());
+      if (size != 0
+          && ::gzwrite(out, buff.data(), size) != static_cast<int>(size)) {
+        ok = false;
+        break;
+      }
+    }
+    ok = (::gzclose(out) == Z_OK) && ok;
+
+    std::error_code ec;
+    if (!ok) {
+      std::cerr << "Can't compress log segment '" << path << "'" << std::endl;
+      std::filesystem::remove(tmp, ec);
+      return {};
+    }
+
+    // Compressed file appears under final name only when it is completed
+    std::filesystem::rename(tmp, compressed, ec);
+    if (ec) {
+      std::filesystem::remove(tmp, ec);
+      return {};
+    }
+    std::filesystem::remove(path, ec);
+    return compressed;
+  }
+
+  std::optional<SegmentArchiver::SegmentOrder>
+  SegmentArchiver::parseSegmentName(std::string_view name,
+                                    std::string_view origin_name) {
+    if (name.size() <= origin_name.size() + 1
+        || name.substr(0, origin_name.size()) != origin_name
+        || name[origin_name.size()] != '.') {
+      return std::nullopt;
+    }
+    name.remove_prefix(origin_name.size() + 1);
+    if (name.size() > 3 && name.substr(name.size() - 3) == ".gz") {
+      name.remove_suffix(3);
+    }
+
+    // Parses non-empty sequence of digits of at most {@param max_size}
+    auto parse_digits = [](std::string_view digits,
+                           size_t max_size) -> std::optional<uint64_t> {
+      if (digits.empty() || digits.size() > max_size) {
+        return std::nullopt;
+      }
+      uint64_t number = 0;
+      for (auto c : digits) {
+        if (c < '0' || c > '9') {
+          return std::nullopt;
+        }
+        number = number * 10 + (c - '0');
+      }
+      return number;
+    };
+
+    // Numbered: <N>
+    if (auto number = parse_digits(name, 19)) {
+      return SegmentOrder{*number, 0, false};
+    }
+
+    // Timestamped: YYYYMMDD-hhmmss[-n]
+    constexpr size_t datetime_size = 15;
+    if (name.size() < datetime_size || name[8] != '-') {
+      return std::nullopt;
+    }
+    auto date = parse_digits(name.substr(0, 8), 8);
+    auto time = parse_digits(name.substr(9, 6), 6);
+    if (!date || !time) {
+      return std::nullopt;
+    }
+    SegmentOrder order{*date * 1000000 + *time, 0, true};
+    name.remove_prefix(datetime_size);
+    if (!name.empty()) {
+      auto index = name[0] == '-' ? parse_digits(name.substr(1), 19)
+                                  : std::nullopt;
+      if (!index) {
+        return std::nullopt;
+      }
+      order.index = *index;
+    }
+    return order;
+  }
+
+  void SegmentArchiver::applyRetention(const std::filesystem::path &origin,
+                                       size_t max_files,
+                                       size_t max_total_size) {
+    struct Segment {
+      std::filesystem::path path;
+      SegmentOrder order;
+      size_t size;
+    };
+    std::vector<Segment> segments;
+
+    auto dir = origin.parent_path();
+    if (dir.empty()) {
+      dir = ".";
+    }
+    const auto origin_name = origin.filename().string();
+
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, ec)) {
+      // Other files (e.g. unfinished compression, or files of other sinks
+      // with similar names) are not touched
+      auto order =
+          parseSegmentName(entry.path().filename().string(), origin_name);
+      if (!order || !entry.is_regular_file(ec)) {
+        continue;
+      }
+      segments.push_back({entry.path(), *order, entry.file_size(ec)});
+    }
+
+    // Newest first
+    std::sort(segments.begin(), segments.end(),
+              [](const auto &lhs, const auto &rhs) {
+                return rhs.order < lhs.order;
+              });
+
+    size_t count = 0;
+    size_t total_size = 0;
+    for (const auto &segment : segments) {
+      ++count;
+      total_size += segment.size;
+      if ((max_files != 0 && count > max_files)
+          || (max_total_size != 0 && total_size > max_total_size)) {
+        std::filesystem::remove(segment.path, ec);
+      }
+    }
+  }
+
+}  // namespace soralog
@@ -0,0 +1,132 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/shm_collector.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include <soralog/group.hpp>
+#include <soralog/logger.hpp>
+
+namespace soralog {
+
+  ShmCollector::ShmCollector(LoggingSystem &system,
+                             std::filesystem::path directory,
+                             std::string channel)
+      : system_(system),
+        directory_(std::move(directory)),
+        prefix_(std::move(channel) + ".") {}
+
+  void ShmCollector::scan() {
+    std::error_code ec;
+    for (const auto &entry :
+         std::filesystem::directory_iterator(directory_, ec)) {
+      const auto filename = entry.path().filename().string();
+      if (filename.size() <= prefix_.size() + ShmRing::suffix.size()
+          || filename.compare(0, prefix_.size(), prefix_) != 0
+          || filename.compare(filename.size() - ShmRing::suffix.size(),
+                              ShmRing::suffix.size(), ShmRing::suffix)
+              != 0) {
+        continue;
+      }
+      if (rings_.count(entry.path()) != 0) {
+        continue;
+      }
+      if (auto ring = ShmRing::attach(entry.path())) {
+        rings_.emplace(entry.path(), RingState{std::move(ring)});
+      }
+    }
+    if (ec) {
+      std::cerr << "Can't scan directory " << directory_ << ": "
+                << ec.message() << std::endl;
+    }
+  }
+
+  void ShmCollector::report(RingState &state) {
+    const auto dropped = state.ring->dropped();
+    if (dropped != state.reported_dropped) {
+      std::cerr << "Process " << state.ring->pid() << " dropped "
+                << dropped - state.reported_dropped
+                << " events because ring was full" << std::endl;
+      state.reported_dropped = dropped;
+    }
+    const auto corrupted = state.ring->corrupted();
+    if (corrupted != state.reported_corrupted) {
+      std::cerr << "Ring " << state.ring->path() << " has "
+                << corrupted - state.reported_corrupted << " broken records"
+                << std::endl;
+      state.reported_corrupted = corrupted;
+    }
+  }
+
+  std::shared_ptr<Logger> ShmCollector::getLogger(std::string_view name) {
+    if (auto it = loggers_.find(name); it != loggers_.end()) {
+      return it->second;
+    }
+
+    std::string logger_name(name);
+    std::shared_ptr<Logger> logger;
+    if (system_.getGroup(logger_name)) {
+      logger = system_.getLogger(logger_name, logger_name);
+    } else if (auto group = system_.getFallbackGroup()) {
+      logger = system_.getLogger(logger_name, group->name());
+    }
+    loggers_.emplace(std::move(logger_name), logger);
+    return logger;
+  }
+
+  size_t ShmCollector::poll(bool rescan) {
+    const bool need_to_scan =
+        rescan || std::chrono::steady_clock::now() >= next_scan_;
+    if (need_to_scan) {
+      next_scan_ = std::chrono::steady_clock::now() + scan_interval;
+      scan();
+    }
+
+    // Abandoned state is checked before reading, so everything written by
+    // finished producer is read before ring is removed
+    std::vector<bool> abandoned;
+    abandoned.reserve(rings_.size());
+
+    records_.clear();
+    for (auto &[path, state] : rings_) {
+      abandoned.push_back(need_to_scan && state.ring->isAbandoned());
+      state.ring->read(records_);
+    }
+
+    // Merge events of all processes by time
+    std::stable_sort(records_.begin(), records_.end(),
+                     [](const auto &lhs, const auto &rhs) {
+                       return lhs.timestamp < rhs.timestamp;
+                     });
+
+    for (const auto &record : records_) {
+      if (auto logger = getLogger(record.name)) {
+        logger->relay(record.timestamp, record.thread_number,
+                      record.thread_name, record.level, record.message,
+                      record.fields);
+      }
+    }
+
+    // Records are copied into sinks; space of rings might be reused now
+    auto flag = abandoned.begin();
+    for (auto it = rings_.begin(); it != rings_.end(); ++flag) {
+      auto &state = it->second;
+      state.ring->release();
+      report(state);
+      if (*flag) {
+        std::error_code ec;
+        std::filesystem::remove(it->first, ec);
+        it = rings_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    return records_.size();
+  }
+
+}  // namespace soralog
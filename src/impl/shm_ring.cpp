@@ -0,0 +1,397 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/shm_ring.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <soralog/impl/binary_format.hpp>
+
+namespace soralog {
+
+  struct ShmRing::Header {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity;
+    int64_t pid;
+    uint32_t flags;
+
+    // Each counter is modified by one side only and has own cache line
+    alignas(64) std::atomic<uint64_t> head;     // by producer
+    alignas(64) std::atomic<uint64_t> tail;     // by consumer
+    alignas(64) std::atomic<uint64_t> dropped;  // by producer
+    std::atomic<uint32_t> closed;               // by producer
+  };
+
+  namespace {
+
+    using namespace binary_format;
+
+    constexpr std::string_view ring_magic = "SORALOGR";
+    constexpr uint32_t ring_version = 1;
+
+    /// Flag of ring in overwrite mode
+    constexpr uint32_t overwrite_flag = 1;
+
+    enum class RecordKind : uint32_t {
+      EVENT = 1,
+      PADDING = 2,
+    };
+
+    struct RecordHeader {
+      uint32_t size;  // size of body
+      RecordKind kind;
+    };
+
+    constexpr size_t alignment = 8;
+
+    constexpr size_t align(size_t size) {
+      return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    int64_t to_usec(std::chrono::system_clock::time_point time) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+                 time.time_since_epoch())
+          .count();
+    }
+
+  }  // namespace
+
+  ShmRing::ShmRing(std::filesystem::path path, int fd, void *mapping,
+                   size_t mapping_size)
+      : path_(std::move(path)),
+        fd_(fd),
+        mapping_(mapping),
+        mapping_size_(mapping_size),
+        header_(static_cast<Header *>(mapping)),
+        data_(static_cast<char *>(mapping) + header_area_size),  // NOLINT
+        capacity_(mapping_size - header_area_size),
+        overwrite_((header_->flags & overwrite_flag) != 0) {}
+
+  ShmRing::~ShmRing() {
+    ::munmap(mapping_, mapping_size_);
+    ::close(fd_);
+  }
+
+  std::unique_ptr<ShmRing> ShmRing::create(const std::filesystem::path &path,
+                                           size_t capacity, bool overwrite) {
+    static_assert(sizeof(Header) <= header_area_size);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "Lock-free atomics are required in shared memory");
+
+    size_t size = 4096;
+    while (size < capacity) {
+      size <<= 1;
+    }
+
+    // Ring is prepared under temporary name, and appears for consumer
+    // completely initialized
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    0660);
+    if (fd < 0) {
+      return nullptr;
+    }
+    const size_t mapping_size = header_area_size + size;
+    void *mapping = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(mapping_size)) == 0) {
+      mapping = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+    }
+    if (mapping == MAP_FAILED) {
+      auto error = errno;
+      ::close(fd);
+      ::unlink(tmp_path.c_str());
+      errno = error;
+      return nullptr;
+    }
+
+    auto *header = new (mapping) Header{};
+    std::memcpy(header->magic.data(), ring_magic.data(), ring_magic.size());
+    header->version = ring_version;
+    header->header_size = header_area_size;
+    header->capacity = size;
+    header->pid = ::getpid();
+    header->flags = overwrite ? overwrite_flag : 0;
+
+    if (::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      auto error = errno;
+      ::munmap(mapping, mapping_size);
+      ::close(fd);
+      ::unlink(tmp_path.c_str());
+      errno = error;
+      return nullptr;
+    }
+
+    return std::unique_ptr<ShmRing>(
+        new ShmRing(path, fd, mapping, mapping_size));
+  }
+
+  std::unique_ptr<ShmRing> ShmRing::attach(const std::filesystem::path &path) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0
+        || static_cast<size_t>(st.st_size) <= header_area_size) {
+      ::close(fd);
+      return nullptr;
+    }
+    const auto mapping_size = static_cast<size_t>(st.st_size);
+    void *mapping = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    if (!isValid(*static_cast<const Header *>(mapping),
+                 mapping_size - header_area_size)) {
+      ::munmap(mapping, mapping_size);
+      ::close(fd);
+      return nullptr;
+    }
+
+    auto ring = std::unique_ptr<ShmRing>(
+        new ShmRing(path, fd, mapping, mapping_size));
+    ring->position_ = ring->header_->tail.load(std::memory_order_acquire);
+    return ring;
+  }
+
+  std::unique_ptr<ShmRing> ShmRing::inspect(const std::filesystem::path &path,
+                                            uint64_t offset) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0
+        || static_cast<uint64_t>(st.st_size) < offset + header_area_size) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    // Size of ring is unknown until header is read
+    void *mapping = ::mmap(nullptr, header_area_size, PROT_READ, MAP_PRIVATE,
+                           fd, static_cast<off_t>(offset));
+    if (mapping == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+    const auto *header = static_cast<const Header *>(mapping);
+    const auto capacity = header->capacity;
+    const bool valid = isValid(*header, capacity)
+        && static_cast<uint64_t>(st.st_size)
+            >= offset + header_area_size + capacity;
+    ::munmap(mapping, header_area_size);
+    if (!valid) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    const size_t mapping_size = header_area_size + capacity;
+    mapping = ::mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd,
+                     static_cast<off_t>(offset));
+    if (mapping == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+
+    auto ring = std::unique_ptr<ShmRing>(
+        new ShmRing(path, fd, mapping, mapping_size));
+    ring->position_ = ring->header_->tail.load(std::memory_order_acquire);
+    return ring;
+  }
+
+  bool ShmRing::isValid(const Header &header, size_t capacity) {
+    return std::string_view(header.magic.data(), header.magic.size())
+        == ring_magic
+        && header.version == ring_version
+        && header.header_size == header_area_size
+        && header.capacity == capacity && capacity != 0
+        && (capacity & (capacity - 1)) == 0;
+  }
+
+  bool ShmRing::overwrite(size_t size) noexcept {
+    if (size > capacity_) {
+      return false;
+    }
+    while (position_ + size - tail_ > capacity_) {
+      RecordHeader record{};
+      std::memcpy(&record, data_ + (tail_ & (capacity_ - 1)),  // NOLINT
+                  sizeof(record));
+      tail_ += align(sizeof(record) + record.size);
+    }
+    header_->tail.store(tail_, std::memory_order_release);
+
+    // Records are overwritten strictly after the tail is moved, so the ring
+    // is consistent at any moment the process might crash
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    return true;
+  }
+
+  bool ShmRing::put(const Event &event) noexcept {
+    const auto time = static_cast<uint64_t>(to_usec(event.timestamp()));
+    const auto thread_name = event.thread_name();
+    const auto name = event.name();
+    const auto message = event.message();
+    const auto fields = event.fields().data();
+
+    const size_t body_size = varintSize(time) + 1
+        + varintSize(event.thread_number()) + varintSize(thread_name.size())
+        + thread_name.size() + varintSize(name.size()) + name.size()
+        + varintSize(message.size()) + message.size() + fields.size();
+    const size_t record_size = align(sizeof(RecordHeader) + body_size);
+
+    const size_t offset = position_ & (capacity_ - 1);
+    const size_t padding =
+        (capacity_ - offset < record_size) ? capacity_ - offset : 0;
+
+    if (position_ + padding + record_size - tail_ > capacity_) {
+      if (overwrite_) {
+        if (!overwrite(padding + record_size)) {
+          header_->dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+      } else {
+        // Might be consumer has freed some space already
+        tail_ = header_->tail.load(std::memory_order_acquire);
+        if (position_ + padding + record_size - tail_ > capacity_) {
+          header_->dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+      }
+    }
+
+    if (padding != 0) {
+      RecordHeader record{static_cast<uint32_t>(padding - sizeof(RecordHeader)),
+                          RecordKind::PADDING};
+      std::memcpy(data_ + offset, &record, sizeof(record));  // NOLINT
+      position_ += padding;
+    }
+
+    char *ptr = data_ + (position_ & (capacity_ - 1));  // NOLINT
+    RecordHeader record{static_cast<uint32_t>(body_size), RecordKind::EVENT};
+    std::memcpy(ptr, &record, sizeof(record));
+    ptr += sizeof(record);  // NOLINT
+
+    putVarint(ptr, time);
+    *ptr++ = static_cast<char>(event.level());  // NOLINT
+    putVarint(ptr, event.thread_number());
+    putString(ptr, thread_name);
+    putString(ptr, name);
+    putString(ptr, message);
+    std::memcpy(ptr, fields.data(), fields.size());
+
+    position_ += record_size;
+    return true;
+  }
+
+  void ShmRing::publish() noexcept {
+    header_->head.store(position_, std::memory_order_release);
+  }
+
+  void ShmRing::close() noexcept {
+    publish();
+    header_->closed.store(1, std::memory_order_release);
+  }
+
+  size_t ShmRing::read(std::vector<Record> &records) {
+    const auto head = header_->head.load(std::memory_order_acquire);
+    size_t count = 0;
+
+    // Ring is mutable by other process, so everything is checked
+    if (head - position_ > capacity_) {
+      ++corrupted_;
+      position_ = head;
+      return 0;
+    }
+
+    while (position_ < head) {
+      const size_t offset = position_ & (capacity_ - 1);
+      RecordHeader record{};
+      std::memcpy(&record, data_ + offset, sizeof(record));  // NOLINT
+      const size_t record_size = align(sizeof(record) + record.size);
+
+      if (record_size > capacity_ - offset
+          || record_size > head - position_) {
+        // Broken size; nothing can be read up to head reliably
+        ++corrupted_;
+        position_ = head;
+        break;
+      }
+
+      if (record.kind == RecordKind::EVENT) {
+        const char *ptr = data_ + offset + sizeof(record);  // NOLINT
+        const char *const end = ptr + record.size;           // NOLINT
+        Record event;
+        uint64_t time = 0;
+        uint64_t thread_number = 0;
+        bool ok = getVarint(ptr, end, time) && ptr < end;
+        if (ok) {
+          auto level = static_cast<uint8_t>(*ptr++);  // NOLINT
+          event.level = static_cast<Level>(
+              std::min<uint8_t>(level, static_cast<uint8_t>(Level::TRACE)));
+          ok = getVarint(ptr, end, thread_number)
+              && getString(ptr, end, event.thread_name)
+              && getString(ptr, end, event.name)
+              && getString(ptr, end, event.message);
+        }
+        if (ok) {
+          event.fields = {ptr, static_cast<size_t>(end - ptr)};
+          event.timestamp = std::chrono::system_clock::time_point(
+              std::chrono::duration_cast<
+                  std::chrono::system_clock::duration>(
+                  std::chrono::microseconds(time)));
+          event.thread_number = thread_number;
+          records.emplace_back(event);
+          ++count;
+        } else {
+          ++corrupted_;
+        }
+      } else if (record.kind != RecordKind::PADDING) {
+        ++corrupted_;
+      }
+
+      position_ += record_size;
+    }
+    return count;
+  }
+
+  void ShmRing::release() noexcept {
+    header_->tail.store(position_, std::memory_order_release);
+  }
+
+  bool ShmRing::isAbandoned() const noexcept {
+    if (header_->closed.load(std::memory_order_acquire) != 0) {
+      return true;
+    }
+    return ::kill(static_cast<pid_t>(header_->pid), 0) != 0 && errno == ESRCH;
+  }
+
+  size_t ShmRing::dropped() const noexcept {
+    return header_->dropped.load(std::memory_order_relaxed);
+  }
+
+  int ShmRing::pid() const noexcept {
+    return static_cast<int>(header_->pid);
+  }
+
+  bool ShmRing::isOverwriting() const noexcept {
+    return overwrite_;
+  }
+
+}  // namespace soralog
@@ -0,0 +1,282 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_binary_file.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <soralog/impl/binary_format.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+    using namespace binary_format;
+
+    /// Reserve of buffer for dictionary records, size prefix and checksum
+    constexpr size_t record_overhead = 256;
+
+    void put_type(char *&ptr, RecordType type) {
+      *ptr++ = static_cast<char>(type);  // NOLINT
+    }
+
+    /**
+     * Puts size of body {@param body_size}, then body filled by {@param fill},
+     * then checksum of body
+     */
+    template <typename Fill>
+    void put_record(char *&ptr, size_t body_size, const Fill &fill) {
+      putVarint(ptr, body_size);
+      const char *body = ptr;
+      fill(ptr);
+      assert(static_cast<size_t>(ptr - body) == body_size);
+      putChecksum(ptr, body, body_size);
+    }
+
+    int64_t to_usec(std::chrono::system_clock::time_point time) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+                 time.time_since_epoch())
+          .count();
+    }
+
+  }  // namespace
+
+  SinkToBinaryFile::SinkToBinaryFile(
+      std::string name, std::filesystem::path path,
+      std::optional<ThreadInfoType> thread_info_type,
+      std::optional<size_t> capacity, std::optional<size_t> buffer_size,
+      std::optional<size_t> latency)
+      : Sink(std::move(name), thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 11),     // 2048 events
+             buffer_size.value_or(1u << 22),  // 4 Mb
+             latency.value_or(1000)),         // 1 sec
+        path_(std::move(path)),
+        buff_(max_buffer_size_) {
+    if (!open(out_)) {
+      std::cerr << "Can't open log file '" << path_ << "': " << strerror(errno)
+                << std::endl;
+    } else if (latency_ != std::chrono::milliseconds::zero()) {
+      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
+    }
+  }
+
+  SinkToBinaryFile::~SinkToBinaryFile() {
+    if (sink_worker_) {
+      need_to_finalize_.store(true, std::memory_order_release);
+      async_flush();
+      sink_worker_->join();
+      sink_worker_.reset();
+    } else {
+      flush();
+    }
+  }
+
+  bool SinkToBinaryFile::open(std::ofstream &out) {
+    out.open(path_, std::ios::app | std::ios::binary);
+    if (!out.is_open()) {
+      return false;
+    }
+
+    std::array<char, header_size + record_overhead> buff{};
+    auto *ptr = buff.data();
+
+    std::error_code ec;
+    if (std::filesystem::file_size(path_, ec) == 0) {
+      std::memcpy(ptr, magic.data(), magic.size());
+      ptr += magic.size();  // NOLINT
+      *ptr++ = static_cast<char>(version);  // NOLINT
+    }
+
+    prev_time_ = to_usec(std::chrono::system_clock::now());
+    next_id_ = 1;
+    names_.clear();
+    threads_.clear();
+
+    put_record(ptr, 1 + varintSize(prev_time_), [&](char *&ptr) {
+      put_type(ptr, RecordType::SESSION);
+      putVarint(ptr, prev_time_);
+    });
+
+    out.write(buff.data(), ptr - buff.data());
+    return true;
+  }
+
+  void SinkToBinaryFile::putEvent(char *&ptr, const Event &event) {
+    // Name of logger
+
+    auto name = event.name();
+    auto name_it = names_.find(name);
+    if (name_it == names_.end()) {
+      name_it = names_.emplace(std::string(name), next_id_++).first;
+      const auto id = name_it->second;
+      put_record(ptr,
+                 1 + varintSize(id) + varintSize(name.size()) + name.size(),
+                 [&](char *&ptr) {
+                   put_type(ptr, RecordType::NAME);
+                   putVarint(ptr, id);
+                   putString(ptr, name);
+                 });
+    }
+    const auto name_id = name_it->second;
+
+    // Thread
+
+    uint64_t thread_id = 0;
+    if (thread_info_type_ != ThreadInfoType::NONE) {
+      auto number = event.thread_number();
+      auto thread_name = thread_info_type_ == ThreadInfoType::NAME
+          ? event.thread_name()
+          : std::string_view{};
+      auto &[known_name, id] = threads_[number];
+      if (id == 0 || known_name != thread_name) {
+        // New thread, or thread was renamed
+        known_name = thread_name;
+        id = next_id_++;
+        put_record(ptr,
+                   1 + varintSize(id) + varintSize(number)
+                       + varintSize(thread_name.size()) + thread_name.size(),
+                   [&, id = id](char *&ptr) {
+                     put_type(ptr, RecordType::THREAD);
+                     putVarint(ptr, id);
+                     putVarint(ptr, number);
+                     putString(ptr, thread_name);
+                   });
+      }
+      thread_id = id;
+    }
+
+    // Event itself
+
+    const auto time = to_usec(event.timestamp());
+    const auto delta = zigzagEncode(time - prev_time_);
+    prev_time_ = time;
+
+    const auto message = event.message();
+    const auto fields = event.fields().data();
+    put_record(ptr,
+               1 + varintSize(delta) + 1 + varintSize(name_id)
+                   + varintSize(thread_id) + varintSize(message.size())
+                   + message.size() + fields.size(),
+               [&](char *&ptr) {
+                 put_type(ptr, RecordType::EVENT);
+                 putVarint(ptr, delta);
+                 *ptr++ = static_cast<char>(event.level());  // NOLINT
+                 putVarint(ptr, name_id);
+                 putVarint(ptr, thread_id);
+                 putString(ptr, message);
+                 std::memcpy(ptr, fields.data(), fields.size());
+                 ptr += fields.size();  // NOLINT
+               });
+  }
+
+  void SinkToBinaryFile::async_flush() noexcept {
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      need_to_flush_.store(true, std::memory_order_release);
+      condvar_.notify_one();
+    } else {
+      flush();
+    }
+  }
+
+  void SinkToBinaryFile::flush() noexcept {
+    bool false_v = false;
+    if (!flush_in_progress_.compare_exchange_strong(
+            false_v, true, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    // Rotation might be requested from signal handler
+    if (isRotationRequested()) {
+      need_to_rotate_.store(true, std::memory_order_release);
+    }
+
+    auto *const begin = buff_.data();
+    auto *const end = buff_.data() + buff_.size();  // NOLINT
+    auto *ptr = begin;
+
+    while (true) {
+      auto node = events_.get();
+      if (node) {
+        const auto &event = *node;
+
+        // There is no rendering: event is copied almost as is
+        putEvent(ptr, event);
+
+        size_ -= event.message().size();
+      }
+
+      if ((end - ptr) < sizeof(Event) + record_overhead || !node
+          || std::chrono::steady_clock::now()
+              >= next_flush_.load(std::memory_order_acquire)) {
+        next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                          std::memory_order_release);
+        out_.write(begin, ptr - begin);
+        ptr = begin;
+      }
+
+      if (!node) {
+        bool true_v = true;
+        if (need_to_flush_.compare_exchange_weak(true_v, false,
+                                                 std::memory_order_acq_rel)) {
+          out_.flush();
+        }
+        break;
+      }
+    }
+
+    bool true_v = true;
+    if (need_to_rotate_.compare_exchange_weak(true_v, false,
+                                              std::memory_order_acq_rel)) {
+      out_.flush();
+      std::ofstream out;
+      if (!open(out)) {
+        std::cerr << "Can't re-open log file '" << path_
+                  << "': " << strerror(errno) << std::endl;
+      } else {
+        std::swap(out_, out);
+      }
+    }
+
+    flush_in_progress_.store(false, std::memory_order_release);
+  }
+
+  void SinkToBinaryFile::rotate() noexcept {
+    need_to_rotate_.store(true, std::memory_order_release);
+    async_flush();
+  }
+
+  void SinkToBinaryFile::run() {
+    util::setThreadName("log:" + name_);
+
+    next_flush_.store(std::chrono::steady_clock::now(),
+                      std::memory_order_relaxed);
+
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        if (condvar_.wait_until(lock,
+                                next_flush_.load(std::memory_order_relaxed))
+            == std::cv_status::no_timeout) {
+          if (!need_to_flush_.load(std::memory_order_relaxed)
+              && !need_to_finalize_.load(std::memory_order_relaxed)) {
+            continue;
+          }
+        }
+      }
+
+      placeWorker();
+      flush();
+
+      if (need_to_finalize_.load(std::memory_order_acquire)
+          && events_.size() == 0) {
+        return;
+      }
+    }
+  }
+
+}  // namespace soralog
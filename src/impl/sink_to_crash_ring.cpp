@@ -0,0 +1,152 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_crash_ring.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <soralog/impl/crash_writer.hpp>
+#include <soralog/impl/shm_ring.hpp>
+
+namespace soralog {
+
+  SinkToCrashRing::SinkToCrashRing(
+      std::string name, std::filesystem::path path,
+      std::optional<size_t> ring_size,
+      std::optional<ThreadInfoType> thread_info_type,
+      std::optional<size_t> capacity, std::optional<size_t> buffer_size,
+      std::optional<size_t> latency)
+      : Sink(std::move(name), thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 8),      // 256 events
+             buffer_size.value_or(1u << 20),  // 1 Mb
+             latency.value_or(0)) {           // no latency
+    // Ring of previous run might keep events around its crash
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) {
+      auto previous_path = path;
+      previous_path += previous_suffix;
+      std::filesystem::rename(path, previous_path, ec);
+      if (ec) {
+        std::cerr << "Can't keep previous ring '" << path
+                  << "': " << ec.message() << std::endl;
+      }
+    }
+
+    ring_ = ShmRing::create(path, ring_size.value_or(1u << 22),  // 4 Mb
+                            true);
+    if (!ring_) {
+      std::cerr << "Can't create crash ring '" << path
+                << "': " << strerror(errno) << std::endl;
+    } else if (latency_ != std::chrono::milliseconds::zero()) {
+      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
+    }
+  }
+
+  SinkToCrashRing::~SinkToCrashRing() {
+    if (sink_worker_) {
+      need_to_finalize_.store(true, std::memory_order_release);
+      async_flush();
+      sink_worker_->join();
+      sink_worker_.reset();
+    } else {
+      flush();
+    }
+    if (ring_) {
+      ring_->close();
+    }
+  }
+
+  std::filesystem::path SinkToCrashRing::path() const {
+    return ring_ ? ring_->path() : std::filesystem::path{};
+  }
+
+  void SinkToCrashRing::async_flush() noexcept {
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      need_to_flush_.store(true, std::memory_order_release);
+      condvar_.notify_one();
+    } else {
+      flush();
+    }
+  }
+
+  void SinkToCrashRing::flush() noexcept {
+    bool false_v = false;
+    if (!flush_in_progress_.compare_exchange_strong(
+            false_v, true, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    while (true) {
+      auto node = events_.get();
+      if (!node) {
+        break;
+      }
+      const auto &event = *node;
+
+      // The oldest events are overwritten if ring is full
+      if (ring_) {
+        ring_->put(event);
+      }
+
+      size_ -= event.message().size();
+    }
+
+    if (ring_) {
+      ring_->publish();
+    }
+
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_release);
+    need_to_flush_.store(false, std::memory_order_release);
+
+    flush_in_progress_.store(false, std::memory_order_release);
+  }
+
+  void SinkToCrashRing::drainOnCrash(
+      std::chrono::steady_clock::time_point deadline) noexcept {
+    if (!ring_ || !CrashWriter::lock(flush_in_progress_, deadline)) {
+      return;
+    }
+    drainQueue(deadline, [&](const Event &event) {
+      ring_->put(event);
+      return true;
+    });
+    ring_->publish();
+  }
+
+  void SinkToCrashRing::rotate() noexcept {}
+
+  void SinkToCrashRing::run() {
+    util::setThreadName("log:" + name_);
+
+    next_flush_.store(std::chrono::steady_clock::now(),
+                      std::memory_order_relaxed);
+
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        if (condvar_.wait_until(lock,
+                                next_flush_.load(std::memory_order_relaxed))
+            == std::cv_status::no_timeout) {
+          if (!need_to_flush_.load(std::memory_order_relaxed)
+              && !need_to_finalize_.load(std::memory_order_relaxed)) {
+            continue;
+          }
+        }
+      }
+
+      placeWorker();
+      flush();
+
+      if (need_to_finalize_.load(std::memory_order_acquire)
+          && events_.size() == 0) {
+        return;
+      }
+    }
+  }
+
+}  // namespace soralog
@@ -5,44 +5,85 @@
 
 #include <soralog/impl/sink_to_file.hpp>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <stdexcept>
 
 #include <fmt/chrono.h>
+#include <zlib.h>
 
-namespace soralog {
-
-  namespace {
-
-    using namespace std::chrono_literals;
+#include <soralog/impl/crash_writer.hpp>
+#include <soralog/impl/json_escape.hpp>
 
-    // Separator is using between logical parts of log record.
-    // Might be any substring or symbol: space, tab, etc.
-    // Couple of space is selected to differ of single space
-    constexpr std::string_view separator = "  ";
+namespace soralog {
 
-    void put_separator(char *&ptr) {
-      for (auto c : separator) {
-        *ptr++ = c;  // NOLINT
+  /**
+   * Compresses each piece of data into self-contained gzip member
+   */
+  class FrameCompressor final {
+   public:
+    FrameCompressor(FrameCompressor &&) noexcept = delete;
+    FrameCompressor(const FrameCompressor &) = delete;
+    FrameCompressor &operator=(FrameCompressor &&) noexcept = delete;
+    FrameCompressor &operator=(FrameCompressor const &) = delete;
+
+    explicit FrameCompressor(int level) {
+      // 15 bits of window, +16 means gzip wrapper instead of zlib one
+      if (deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8,
+                       Z_DEFAULT_STRATEGY)
+          != Z_OK) {
+        throw std::runtime_error("Can't initialize gzip compressor");
       }
     }
 
-    void put_level(char *&ptr, Level level) {
-      const char *const end = ptr + 8;  // NOLINT
-      const char *str = levelToStr(level);
-      do {
-        *ptr++ = *str++;  // NOLINT
-      } while (*str != '\0');
-      while (ptr < end) {
-        *ptr++ = ' ';  // NOLINT
-      }
+    ~FrameCompressor() {
+      deflateEnd(&stream_);
     }
 
-    void put_level_short(char *&ptr, Level level) {
-      *ptr++ = levelToChar(level);  // NOLINT
+    /**
+     * @returns compressed frame for {@param data} of size {@param size}.
+     * Result is valid till next call
+     */
+    std::string_view compress(const char *data, size_t size) {
+      // Each frame begins new gzip member with own header and trailer
+      deflateReset(&stream_);
+
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+      stream_.avail_in = size;
+
+      frame_.resize(deflateBound(&stream_, size));
+      size_t produced = 0;
+      while (true) {
+        stream_.next_out =
+            reinterpret_cast<Bytef *>(frame_.data() + produced);  // NOLINT
+        stream_.avail_out = frame_.size() - produced;
+        auto res = deflate(&stream_, Z_FINISH);
+        produced = frame_.size() - stream_.avail_out;
+        if (res == Z_STREAM_END) {
+          break;
+        }
+        if (res != Z_OK && res != Z_BUF_ERROR) {
+          return {};
+        }
+        frame_.resize(frame_.size() * 2);
+      }
+      return {frame_.data(), produced};
     }
 
+   private:
+    z_stream stream_{};
+    std::vector<char> frame_;
+  };
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
     template <typename T>
     void put_string(char *&ptr, const T &name) {
       for (auto c : name) {
@@ -50,17 +91,17 @@ namespace soralog {
       }
     }
 
-    template <typename T>
-    void put_string(char *&ptr, const T &name, size_t width) {
-      if (width == 0)
-        return;
-      for (auto c : name) {
-        if (c == '\0' || width == 0)
-          break;
-        *ptr++ = c;  // NOLINT
-        --width;
-      }
-      while (width--) *ptr++ = ' ';  // NOLINT
+    /// Max size of event rendered as JSON: every byte of strings might be
+    /// escaped, and the rest is less than 256 bytes
+    constexpr size_t max_json_record_size =
+        256 + json::maxEscapedSize(sizeof(Event));
+
+    bool segment_exists(const std::filesystem::path &path) {
+      std::error_code ec;
+      auto compressed = path;
+      compressed += ".gz";
+      return std::filesystem::exists(path, ec)
+          || std::filesystem::exists(compressed, ec);
     }
 
   }  // namespace
@@ -69,24 +110,150 @@ namespace soralog {
                          std::optional<ThreadInfoType> thread_info_type,
                          std::optional<size_t> capacity,
                          std::optional<size_t> buffer_size,
-                         std::optional<size_t> latency)
+                         std::optional<size_t> latency,
+                         std::optional<RotationPolicy> rotation,
+                         std::optional<Compression> compression,
+                         std::optional<Layout> layout,
+                         std::optional<std::string> pattern,
+                         std::optional<bool> zero_copy,
+                         std::optional<bool> utc)
       : Sink(std::move(name), thread_info_type.value_or(ThreadInfoType::NONE),
              capacity.value_or(1u << 11),     // 2048 events
              buffer_size.value_or(1u << 22),  // 4 Mb
-             latency.value_or(1000)),         // 1 sec
+             latency.value_or(1000),          // 1 sec
+             true),
         path_(std::move(path)),
-        buff_(max_buffer_size_) {
+        rotation_(std::move(rotation)),
+        compression_(std::move(compression)),
+        layout_(layout.value_or(Layout::TEXT)),
+        line_pattern_(
+            pattern.value_or(std::string(
+                LinePattern::defaultPattern(thread_info_type_))),
+            thread_info_type_, false, utc.value_or(false)),
+        zero_copy_(zero_copy.value_or(false) && layout_ == Layout::TEXT
+                   && !(compression_
+                        && compression_->codec
+                               == Compression::Codec::GZIP)) {
+    // Settings are checked here, though compressor is made on first event
+    if (compression_ && compression_->codec == Compression::Codec::GZIP
+        && (compression_->level < Z_DEFAULT_COMPRESSION
+            || compression_->level > Z_BEST_COMPRESSION)) {
+      throw std::runtime_error("Can't initialize gzip compressor");
+    }
+  }
+
+  void SinkToFile::setUp() {
+    buff_.resize(zero_copy_ ? 0
+                            : std::max(max_buffer_size_,
+                                       2
+                                           * (layout_ == Layout::JSON
+                                                  ? max_json_record_size
+                                                  : line_pattern_.maxSize())));
+    if (zero_copy_) {
+      // Half of queue is left for producers meanwhile
+      gathered_ = std::make_unique<GatheredWriter>(
+          std::max(max_buffer_size_, 2 * line_pattern_.maxSize()),
+          events_.capacity() / 2);
+    }
+
+    if (compression_ && compression_->codec == Compression::Codec::GZIP) {
+      compressor_ = std::make_unique<FrameCompressor>(compression_->level);
+    }
+
+    if (rotation_) {
+      if ((rotation_->compress && !compressor_) || rotation_->max_files != 0
+          || rotation_->max_total_size != 0) {
+        archiver_ = SegmentArchiver::instance();
+      }
+      next_rotation_ = std::chrono::system_clock::now() + rotation_->interval;
+
+      // Continue numbering of segments left by previous runs
+      if (rotation_->naming == RotationPolicy::Naming::NUMBERED) {
+        auto dir = path_.parent_path();
+        const auto origin_name = path_.filename().string();
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator(
+                 dir.empty() ? "." : dir, ec)) {
+          auto order = SegmentArchiver::parseSegmentName(
+              entry.path().filename().string(), origin_name);
+          if (order && !order->timestamped) {
+            next_segment_number_ =
+                std::max<size_t>(next_segment_number_, order->number + 1);
+          }
+        }
+      }
+    }
+  }
+
+  void SinkToFile::openFile() {
     out_.open(path_, std::ios::app);
     if (!out_.is_open()) {
       std::cerr << "Can't open log file '" << path_ << "': " << strerror(errno)
                 << std::endl;
-    } else if (latency_ != std::chrono::milliseconds::zero()) {
+    } else {
+      std::error_code ec;
+      written_ = std::filesystem::file_size(path_, ec);
+      if (ec) {
+        written_ = 0;
+      }
+      reopenFd();
+    }
+  }
+
+  void SinkToFile::start() {
+    // File and buffers are kept when worker is started again after fork,
+    // unless file is to be reopened
+    if (buff_.empty() && !gathered_) {
+      setUp();
+    }
+    if (reopen_after_fork_) {
+      reopen_after_fork_ = false;
+      out_.close();
+      if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+      }
+    }
+    if (!out_.is_open()) {
+      openFile();
+    }
+
+    if (out_.is_open() && latency_ != std::chrono::milliseconds::zero()) {
       sink_worker_ = std::make_unique<std::thread>([this] { run(); });
     }
   }
 
+  void SinkToFile::lockForFork() noexcept {
+    bool false_v = false;
+    while (!flush_in_progress_.compare_exchange_weak(
+        false_v, true, std::memory_order_acq_rel)) {
+      false_v = false;
+      std::this_thread::yield();
+    }
+    mutex_.lock();
+  }
+
+  void SinkToFile::unlockForFork() noexcept {
+    mutex_.unlock();
+    flush_in_progress_.store(false, std::memory_order_release);
+  }
+
+  bool SinkToFile::resetInChild(bool reopen) noexcept {
+    // Thread of worker doesn't exist here, so its object can be neither
+    // joined nor destroyed, and is abandoned
+    static_cast<void>(sink_worker_.release());
+    new (&mutex_) std::mutex;
+    new (&condvar_) std::condition_variable;
+    need_to_finalize_.store(false, std::memory_order_relaxed);
+    need_to_flush_.store(false, std::memory_order_relaxed);
+    // File is reopened on start of worker
+    reopen_after_fork_ = reopen;
+    flush_in_progress_.store(false, std::memory_order_release);
+    return true;
+  }
+
   SinkToFile::~SinkToFile() {
-    if (latency_ != std::chrono::milliseconds::zero()) {
+    if (sink_worker_) {
       need_to_finalize_.store(true, std::memory_order_release);
       async_flush();
       sink_worker_->join();
@@ -94,6 +261,9 @@ namespace soralog {
     } else {
       flush();
     }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
   }
 
   void SinkToFile::async_flush() noexcept {
@@ -106,94 +276,66 @@ namespace soralog {
   }
 
   void SinkToFile::flush() noexcept {
+    if (!isStarted()) {
+      return;
+    }
     bool false_v = false;
     if (!flush_in_progress_.compare_exchange_strong(
             false_v, true, std::memory_order_acq_rel)) {
       return;
     }
 
+    // Rotation might be requested from signal handler
+    if (isRotationRequested()) {
+      need_to_rotate_.store(true, std::memory_order_release);
+    }
+
     auto *const begin = buff_.data();
     auto *const end = buff_.data() + buff_.size();  // NOLINT
     auto *ptr = begin;
 
-    decltype(1s / 1s) psec = 0;
-    std::tm tm{};
-    std::array<char, 17> datetime{};  // "00.00.00 00:00:00"
+    const size_t max_record_size = layout_ == Layout::JSON
+        ? max_json_record_size
+        : line_pattern_.maxSize();
 
     while (true) {
       auto node = events_.get();
-      if (node) {
+      const bool has_event = static_cast<bool>(node);
+      if (has_event) {
         const auto &event = *node;
 
-        const auto time = event.timestamp().time_since_epoch();
-        const auto sec = time / 1s;
-        const auto usec = time % 1s / 1us;
-
-        if (psec != sec) {
-          tm = fmt::localtime(sec);
-          fmt::format_to_n(datetime.data(), datetime.size(),
-                           "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}",
-                           tm.tm_year % 100, tm.tm_mon + 1, tm.tm_mday,
-                           tm.tm_hour, tm.tm_min, tm.tm_sec);
-          psec = sec;
-        }
-
-        // Timestamp
-
-        std::memcpy(ptr, datetime.data(), datetime.size());
-        ptr = ptr + datetime.size();  // NOLINT
-
-        ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}", usec).out;
-
-        put_separator(ptr);
-
-        // Thread
-
-        switch (thread_info_type_) {
-          case ThreadInfoType::NAME:
-            put_string(ptr, event.thread_name(), 15);
-            put_separator(ptr);
-            break;
-
-          case ThreadInfoType::ID:
-            ptr = fmt::format_to_n(ptr, end - ptr, "T:{:<6}",
-                                   event.thread_number())
-                      .out;
-            put_separator(ptr);
-            break;
+        size_ -= event.message().size();
 
-          default:
-            break;
+        if (gathered_) {
+          // Node might be held till write, so it's moved out
+          gathered_->add(line_pattern_, node);
+        } else if (layout_ == Layout::JSON) {
+          renderJson(ptr, end, event);
+        } else {
+          line_pattern_.render(ptr, event);
         }
-
-        // Level
-
-        put_level(ptr, event.level());
-        put_separator(ptr);
-
-        // Name
-
-        put_string(ptr, event.name());
-        put_separator(ptr);
-
-        // Message
-
-        put_string(ptr, event.message());
-        *ptr++ = '\n';  // NOLINT
-
-        size_ -= event.message().size();
       }
 
-      if ((end - ptr) < sizeof(Event) || !node
+      if ((gathered_ ? gathered_->full(line_pattern_)
+                     : (end - ptr) < max_record_size)
+          || !has_event
           || std::chrono::steady_clock::now()
               >= next_flush_.load(std::memory_order_acquire)) {
         next_flush_.store(std::chrono::steady_clock::now() + latency_,
                           std::memory_order_release);
-        out_.write(begin, ptr - begin);
+        if (gathered_) {
+          writeGathered();
+        } else {
+          write(begin, ptr - begin);
+        }
         ptr = begin;
+
+        if (rotation_ && isRotationDue()) {
+          rotateSegment();
+        }
       }
 
-      if (!node) {
+      if (!has_event) {
         bool true_v = true;
         if (need_to_flush_.compare_exchange_weak(true_v, false,
                                                  std::memory_order_acq_rel)) {
@@ -218,12 +360,226 @@ namespace soralog {
         }
       } else {
         std::swap(out_, out);
+        std::error_code ec;
+        written_ = std::filesystem::file_size(path_, ec);
+        if (ec) {
+          written_ = 0;
+        }
+        reopenFd();
       }
     }
 
     flush_in_progress_.store(false, std::memory_order_release);
   }
 
+  void SinkToFile::renderJson(char *&ptr, const char *end,
+                              const Event &event) {
+    const auto time = event.timestamp().time_since_epoch();
+    const auto sec = time / 1s;
+    const auto usec = time % 1s / 1us;
+
+    if (psec_ != sec) {
+      auto tm = fmt::gmtime(sec);
+      fmt::format_to_n(datetime_.data(), datetime_.size(),
+                       "{:0>4}-{:0>2}-{:0>2}T{:0>2}:{:0>2}:{:0>2}",
+                       tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                       tm.tm_hour, tm.tm_min, tm.tm_sec);
+      psec_ = sec;
+    }
+
+    put_string(ptr, std::string_view(R"({"timestamp":")"));
+    put_string(ptr, datetime_);
+    ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}Z", usec).out;
+
+    put_string(ptr, std::string_view(R"(","level":")"));
+    put_string(ptr, std::string_view(levelToStr(event.level())));
+    *ptr++ = '"';  // NOLINT
+
+    switch (thread_info_type_) {
+      case ThreadInfoType::NAME:
+        put_string(ptr, std::string_view(R"(,"thread":")"));
+        ptr = json::escape(ptr, event.thread_name());
+        *ptr++ = '"';  // NOLINT
+        break;
+
+      case ThreadInfoType::ID:
+        ptr = fmt::format_to_n(ptr, end - ptr, R"(,"thread":{})",
+                               event.thread_number())
+                  .out;
+        break;
+
+      default:
+        break;
+    }
+
+    put_string(ptr, std::string_view(R"(,"logger":")"));
+    ptr = json::escape(ptr, event.name());
+    put_string(ptr, std::string_view(R"(","message":")"));
+    ptr = json::escape(ptr, event.message());
+    *ptr++ = '"';  // NOLINT
+    ptr = json::putFields(ptr, event.fields());
+    put_string(ptr, std::string_view("}\n"));
+  }
+
+  void SinkToFile::write(const char *data, size_t size) {
+    if (size == 0) {
+      return;
+    }
+    if (compressor_) {
+      auto frame = compressor_->compress(data, size);
+      out_.write(frame.data(), frame.size());
+      size = frame.size();
+    } else {
+      out_.write(data, size);
+    }
+    // Rendered data must not stay in stream, where crash would lose it
+    out_.flush();
+    // Size of file is counted by data which reached it
+    if (out_) {
+      written_ += size;
+    }
+  }
+
+  void SinkToFile::writeGathered() {
+    const auto size = gathered_->size();
+    if (size == 0) {
+      return;
+    }
+    const auto written = gathered_->write(fd_);
+    // Failure of opening file is already reported
+    if (written < size && fd_ >= 0) {
+      std::cerr << "Can't write log file '" << path_
+                << "': " << strerror(errno) << std::endl;
+    }
+    written_ += written;
+  }
+
+  void SinkToFile::reopenFd() noexcept {
+    if (!zero_copy_) {
+      return;
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    // File is just opened by stream, which writes nothing in zero-copy mode
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd_ < 0) {
+      std::cerr << "Can't open log file '" << path_
+                << "': " << strerror(errno) << std::endl;
+    }
+  }
+
+  void SinkToFile::drainOnCrash(
+      std::chrono::steady_clock::time_point deadline) noexcept {
+    // Flush in progress writes already rendered data itself
+    if (!isStarted() || !CrashWriter::lock(flush_in_progress_, deadline)
+        || events_.size() == 0) {
+      return;
+    }
+    int fd = ::open(path_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    {
+      CrashWriter writer(fd, thread_info_type_, compressor_ != nullptr,
+                         deadline,
+                         layout_ == Layout::JSON ? nullptr : &line_pattern_);
+      drainQueue(deadline,
+                 [&](const Event &event) { return writer.put(event); });
+    }
+    ::close(fd);
+  }
+
+  bool SinkToFile::isRotationDue() const noexcept {
+    if (written_ == 0) {
+      // Nothing to rotate: don't produce empty segments
+      return false;
+    }
+    if (rotation_->max_size != 0 && written_ >= rotation_->max_size) {
+      return true;
+    }
+    if (rotation_->interval != std::chrono::seconds::zero()
+        && std::chrono::system_clock::now() >= next_rotation_) {
+      return true;
+    }
+    return false;
+  }
+
+  std::filesystem::path SinkToFile::nextSegmentPath() {
+    if (rotation_->naming == RotationPolicy::Naming::NUMBERED) {
+      while (true) {
+        auto segment = path_;
+        segment += "." + std::to_string(next_segment_number_++);
+        if (!segment_exists(segment)) {
+          return segment;
+        }
+      }
+    }
+
+    auto tm = fmt::localtime(std::chrono::system_clock::to_time_t(
+        std::chrono::system_clock::now()));
+    std::array<char, 16> datetime{};  // "YYYYMMDD-hhmmss"
+    auto size = fmt::format_to_n(datetime.data(), datetime.size(),
+                                 "{:0>4}{:0>2}{:0>2}-{:0>2}{:0>2}{:0>2}",
+                                 tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                                 tm.tm_hour, tm.tm_min, tm.tm_sec)
+                    .size;
+
+    auto segment = path_;
+    segment += "." + std::string(datetime.data(), size);
+    // Several rotations in the same second
+    for (size_t n = 1; segment_exists(segment); ++n) {
+      segment = path_;
+      segment += "." + std::string(datetime.data(), size) + "-"
+          + std::to_string(n);
+    }
+    return segment;
+  }
+
+  void SinkToFile::rotateSegment() noexcept {
+    next_rotation_ = std::chrono::system_clock::now() + rotation_->interval;
+
+    // Events are keeping in buffer meanwhile, so nothing is lost
+    out_.flush();
+    out_.close();
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+
+    std::filesystem::path segment;
+    try {
+      segment = nextSegmentPath();
+      std::filesystem::rename(path_, segment);
+    } catch (const std::exception &exception) {
+      std::cerr << "Can't rotate log file '" << path_
+                << "': " << exception.what() << std::endl;
+      segment.clear();
+    }
+    // Even on failure - don't retry rotation at each write
+    written_ = 0;
+
+    out_.open(path_, std::ios::app);
+    if (!out_.is_open()) {
+      std::cerr << "Can't open log file '" << path_ << "': " << strerror(errno)
+                << std::endl;
+    } else {
+      reopenFd();
+    }
+
+    // Heavy work (compression and cleanup) is done in background
+    if (archiver_ && !segment.empty()) {
+      SegmentArchiver::Task task;
+      task.segment = std::move(segment);
+      task.origin = path_;
+      // Segments of compressed stream are already compressed
+      task.compress = rotation_->compress && !compressor_;
+      task.max_files = rotation_->max_files;
+      task.max_total_size = rotation_->max_total_size;
+      archiver_->enqueue(std::move(task));
+    }
+  }
+
   void SinkToFile::rotate() noexcept {
     need_to_rotate_.store(true, std::memory_order_release);
     async_flush();
@@ -248,6 +604,7 @@ namespace soralog {
         }
       }
 
+      placeWorker();
       flush();
 
       if (need_to_finalize_.load(std::memory_order_acquire)
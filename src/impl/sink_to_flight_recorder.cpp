@@ -0,0 +1,366 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_flight_recorder.hpp>
+
+#include <csignal>
+#include <cstring>
+#include <vector>
+
+namespace soralog {
+
+  /**
+   * Ring of events in memory. New event overwrites the oldest ones if there
+   * is no room for it
+   */
+  class RecorderRing final {
+   public:
+    RecorderRing(RecorderRing &&) noexcept = delete;
+    RecorderRing(const RecorderRing &) = delete;
+    RecorderRing &operator=(RecorderRing &&) noexcept = delete;
+    RecorderRing &operator=(RecorderRing const &) = delete;
+    ~RecorderRing() = default;
+
+    explicit RecorderRing(size_t size)
+        : capacity_(std::max(align(size), min_size)),
+          data_(capacity_ + sizeof(RecordHeader)) {}
+
+    /**
+     * Copies {@param event} into ring
+     */
+    void put(const Event &event) {
+      const auto thread_name = event.thread_name().substr(0, UINT8_MAX);
+      const auto name = event.name().substr(0, UINT8_MAX);
+      // Too long message is cut to keep several events at least
+      const auto message = event.message().substr(0, capacity_ / 4);
+      const auto fields = event.fields().data();
+      const size_t record_size =
+          align(sizeof(RecordHeader) + thread_name.size() + name.size()
+                + message.size() + fields.size());
+
+      const size_t offset = end_ % capacity_;
+      const size_t padding = (capacity_ - offset < record_size)
+          ? capacity_ - offset
+          : 0;
+
+      // Overwrite the oldest events
+      while (end_ + padding + record_size - begin_ > capacity_) {
+        const auto &oldest = header(begin_ % capacity_);
+        begin_ += oldest.size;
+        if (oldest.kind == Kind::EVENT) {
+          --count_;
+        }
+      }
+
+      if (padding != 0) {
+        auto &filler = header(offset);
+        filler = RecordHeader{};
+        filler.size = static_cast<uint32_t>(padding);
+        filler.kind = Kind::PADDING;
+        end_ += padding;
+      }
+
+      auto &record = header(end_ % capacity_);
+      record.size = static_cast<uint32_t>(record_size);
+      record.kind = Kind::EVENT;
+      record.level = event.level();
+      record.thread_name_size = static_cast<uint8_t>(thread_name.size());
+      record.name_size = static_cast<uint8_t>(name.size());
+      record.message_size = static_cast<uint32_t>(message.size());
+      record.fields_size = static_cast<uint16_t>(fields.size());
+      record.timestamp = event.timestamp().time_since_epoch().count();
+      record.thread_number = event.thread_number();
+
+      char *ptr = reinterpret_cast<char *>(&record + 1);  // NOLINT
+      std::memcpy(ptr, thread_name.data(), thread_name.size());
+      ptr += thread_name.size();  // NOLINT
+      std::memcpy(ptr, name.data(), name.size());
+      ptr += name.size();  // NOLINT
+      std::memcpy(ptr, message.data(), message.size());
+      ptr += message.size();  // NOLINT
+      std::memcpy(ptr, fields.data(), fields.size());
+
+      end_ += record_size;
+      ++count_;
+    }
+
+    /**
+     * Calls {@param fn} for each kept event from the oldest one with
+     * arguments: time, thread number, thread name, logger name, level,
+     * message, encoded fields
+     */
+    template <typename Fn>
+    void forEach(const Fn &fn) const {
+      for (auto pos = begin_; pos < end_;) {
+        const auto &record = header(pos % capacity_);
+        pos += record.size;
+        if (record.kind != Kind::EVENT) {
+          continue;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const char *ptr = reinterpret_cast<const char *>(&record + 1);
+        std::string_view thread_name(ptr, record.thread_name_size);
+        ptr += record.thread_name_size;  // NOLINT
+        std::string_view name(ptr, record.name_size);
+        ptr += record.name_size;  // NOLINT
+        std::string_view message(ptr, record.message_size);
+        ptr += record.message_size;  // NOLINT
+        std::string_view fields(ptr, record.fields_size);
+        fn(std::chrono::system_clock::time_point(
+               std::chrono::system_clock::duration(record.timestamp)),
+           record.thread_number, thread_name, name, record.level, message,
+           fields);
+      }
+    }
+
+    void clear() noexcept {
+      begin_ = end_ = 0;
+      count_ = 0;
+    }
+
+    size_t count() const noexcept {
+      return count_;
+    }
+
+   private:
+    enum class Kind : uint8_t { EVENT, PADDING };
+
+    struct RecordHeader {
+      uint32_t size;  // whole size of record including header
+      Kind kind;
+      Level level;
+      uint8_t thread_name_size;
+      uint8_t name_size;
+      uint32_t message_size;
+      uint16_t fields_size;
+      std::chrono::system_clock::duration::rep timestamp;
+      uint64_t thread_number;
+    };
+
+    static constexpr size_t min_size = 1u << 16;
+
+    static constexpr size_t align(size_t size) {
+      return (size + alignof(RecordHeader) - 1)
+          & ~(alignof(RecordHeader) - 1);
+    }
+
+    RecordHeader &header(size_t offset) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      return *reinterpret_cast<RecordHeader *>(data_.data() + offset);
+    }
+
+    const RecordHeader &header(size_t offset) const {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      return *reinterpret_cast<const RecordHeader *>(data_.data() + offset);
+    }
+
+    // Sizes of records and capacity are aligned, so padding record is at
+    // least 8 bytes; extra space after capacity is for header of it
+    const size_t capacity_;
+    std::vector<char> data_;
+    uint64_t begin_ = 0;  // position of the oldest record
+    uint64_t end_ = 0;    // position of next record
+    size_t count_ = 0;
+  };
+
+  namespace {
+
+    /// Number of arrived signals requesting dump
+    std::atomic_size_t signals_arrived = 0;
+    static_assert(std::atomic_size_t::is_always_lock_free,
+                  "Signal handler needs lock-free counter");
+
+    void on_signal(int /*signal*/) {
+      signals_arrived.fetch_add(1, std::memory_order_relaxed);
+    }
+
+  }  // namespace
+
+  SinkToFlightRecorder::SinkToFlightRecorder(
+      std::string name, std::optional<size_t> memory_size,
+      std::shared_ptr<Sink> dump_sink, std::shared_ptr<Sink> forward_sink,
+      std::optional<Level> forward_level,
+      std::optional<ThreadInfoType> thread_info_type,
+      std::optional<size_t> capacity, std::optional<size_t> buffer_size,
+      std::optional<size_t> latency)
+      : Sink(std::move(name), thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 11),     // 2048 events
+             buffer_size.value_or(1u << 22),  // 4 Mb
+             latency.value_or(100)),          // 100 ms
+        dump_sink_(std::move(dump_sink)),
+        forward_sink_(std::move(forward_sink)),
+        forward_level_(forward_sink_ ? forward_level.value_or(Level::WARN)
+                                     : Level::OFF),
+        ring_(std::make_unique<RecorderRing>(
+            memory_size.value_or(1u << 24))),  // 16 Mb
+        seen_signals_(signals_arrived.load(std::memory_order_relaxed)) {
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
+    }
+  }
+
+  SinkToFlightRecorder::~SinkToFlightRecorder() {
+    if (sink_worker_) {
+      need_to_finalize_.store(true, std::memory_order_release);
+      async_flush();
+      sink_worker_->join();
+      sink_worker_.reset();
+    } else {
+      flush();
+    }
+  }
+
+  bool SinkToFlightRecorder::dumpOnSignal(int signal) {
+    struct sigaction action {};
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return ::sigaction(signal, &action, nullptr) == 0;
+  }
+
+  void SinkToFlightRecorder::dump() noexcept {
+    need_to_dump_.store(true, std::memory_order_release);
+    async_flush();
+  }
+
+  void SinkToFlightRecorder::bindLogger(
+      std::string_view name,
+      const std::vector<std::string_view> &group_names) {
+    Relay relay;
+    if (dump_sink_) {
+      relay.dump = dump_sink_->selectFilter(name, group_names);
+    }
+    if (forward_sink_) {
+      relay.forward = forward_sink_->selectFilter(name, group_names);
+    }
+    std::lock_guard guard(relays_mutex_);
+    relays_.insert_or_assign(std::string(name), relay);
+  }
+
+  const SinkToFlightRecorder::Relay &SinkToFlightRecorder::relayOf(
+      std::string_view name) {
+    if (auto it = relays_.find(name); it != relays_.end()) {
+      return it->second;
+    }
+    Relay relay;
+    if (dump_sink_) {
+      relay.dump = dump_sink_->selectFilter(name);
+    }
+    if (forward_sink_) {
+      relay.forward = forward_sink_->selectFilter(name);
+    }
+    return relays_.emplace(std::string(name), relay).first->second;
+  }
+
+  void SinkToFlightRecorder::doDump(std::string_view reason) {
+    if (dump_sink_) {
+      dump_sink_->push(name_, Level::INFO,
+                       "Flight recorder dump of {} events by {}",
+                       ring_->count(), reason);
+      ring_->forEach([&](auto timestamp, auto thread_number, auto thread_name,
+                         auto name, auto level, auto message, auto fields) {
+        dump_sink_->relay(relayOf(name).dump, name, timestamp, thread_number,
+                          thread_name, level, message, fields);
+      });
+      dump_sink_->flush();
+    }
+    ring_->clear();
+    dumps_.fetch_add(1, std::memory_order_release);
+  }
+
+  void SinkToFlightRecorder::async_flush() noexcept {
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      need_to_flush_.store(true, std::memory_order_release);
+      condvar_.notify_one();
+    } else {
+      flush();
+    }
+  }
+
+  void SinkToFlightRecorder::flush() noexcept {
+    bool false_v = false;
+    if (!flush_in_progress_.compare_exchange_strong(
+            false_v, true, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    std::lock_guard guard(relays_mutex_);
+
+    bool critical = false;
+
+    while (true) {
+      auto node = events_.get();
+      if (!node) {
+        break;
+      }
+      const auto &event = *node;
+
+      // There is no rendering: event is copied almost as is
+      ring_->put(event);
+
+      if (event.level() <= forward_level_) {
+        forward_sink_->relay(relayOf(event.name()).forward, event.name(),
+                             event.timestamp(), event.thread_number(),
+                             event.thread_name(), event.level(),
+                             event.message(), event.fields().data());
+      }
+      critical = critical || event.level() == Level::CRITICAL;
+
+      size_ -= event.message().size();
+    }
+
+    const auto signals = signals_arrived.load(std::memory_order_relaxed);
+
+    bool true_v = true;
+    if (critical) {
+      doDump("critical event");
+    } else if (need_to_dump_.compare_exchange_strong(
+                   true_v, false, std::memory_order_acq_rel)) {
+      doDump("request");
+    } else if (signals != seen_signals_) {
+      doDump("signal");
+    }
+    need_to_dump_.store(false, std::memory_order_release);
+    seen_signals_ = signals;
+
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_release);
+    need_to_flush_.store(false, std::memory_order_release);
+
+    flush_in_progress_.store(false, std::memory_order_release);
+  }
+
+  void SinkToFlightRecorder::rotate() noexcept {}
+
+  void SinkToFlightRecorder::run() {
+    util::setThreadName("log:" + name_);
+
+    next_flush_.store(std::chrono::steady_clock::now(),
+                      std::memory_order_relaxed);
+
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        if (condvar_.wait_until(lock,
+                                next_flush_.load(std::memory_order_relaxed))
+            == std::cv_status::no_timeout) {
+          if (!need_to_flush_.load(std::memory_order_relaxed)
+              && !need_to_finalize_.load(std::memory_order_relaxed)) {
+            continue;
+          }
+        }
+      }
+
+      placeWorker();
+      flush();
+
+      if (need_to_finalize_.load(std::memory_order_acquire)
+          && events_.size() == 0) {
+        return;
+      }
+    }
+  }
+
+}  // namespace soralog
@@ -0,0 +1,160 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_shm.hpp>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <soralog/impl/crash_writer.hpp>
+#include <soralog/impl/shm_ring.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    /// Number of rings created in this process; makes names unique
+    std::atomic_size_t ring_counter = 0;
+
+  }  // namespace
+
+  SinkToShm::SinkToShm(std::string name, std::optional<std::string> channel,
+                       std::optional<std::filesystem::path> directory,
+                       std::optional<size_t> ring_size,
+                       std::optional<ThreadInfoType> thread_info_type,
+                       std::optional<size_t> capacity,
+                       std::optional<size_t> buffer_size,
+                       std::optional<size_t> latency)
+      : Sink(std::move(name), thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 11),     // 2048 events
+             buffer_size.value_or(1u << 22),  // 4 Mb
+             latency.value_or(10)) {          // 10 ms
+    // Name of ring: <channel>.<pid>.<number>.ring
+    auto path = directory.value_or(default_directory);
+    path /= channel.value_or(std::string(default_channel)) + "."
+        + std::to_string(::getpid()) + "." + std::to_string(++ring_counter)
+        + std::string(ShmRing::suffix);
+
+    ring_ = ShmRing::create(path, ring_size.value_or(1u << 22));  // 4 Mb
+    if (!ring_) {
+      std::cerr << "Can't create shared memory ring '" << path
+                << "': " << strerror(errno) << std::endl;
+    } else if (latency_ != std::chrono::milliseconds::zero()) {
+      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
+    }
+  }
+
+  SinkToShm::~SinkToShm() {
+    if (sink_worker_) {
+      need_to_finalize_.store(true, std::memory_order_release);
+      async_flush();
+      sink_worker_->join();
+      sink_worker_.reset();
+    } else {
+      flush();
+    }
+    if (ring_) {
+      ring_->close();
+    }
+  }
+
+  std::filesystem::path SinkToShm::path() const {
+    return ring_ ? ring_->path() : std::filesystem::path{};
+  }
+
+  size_t SinkToShm::dropped() const noexcept {
+    return ring_ ? ring_->dropped() : 0;
+  }
+
+  void SinkToShm::async_flush() noexcept {
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      need_to_flush_.store(true, std::memory_order_release);
+      condvar_.notify_one();
+    } else {
+      flush();
+    }
+  }
+
+  void SinkToShm::flush() noexcept {
+    bool false_v = false;
+    if (!flush_in_progress_.compare_exchange_strong(
+            false_v, true, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    while (true) {
+      auto node = events_.get();
+      if (!node) {
+        break;
+      }
+      const auto &event = *node;
+
+      // If ring is full, event is dropped (and counted in ring)
+      if (ring_) {
+        ring_->put(event);
+      }
+
+      size_ -= event.message().size();
+    }
+
+    // Batch becomes visible for collector at once
+    if (ring_) {
+      ring_->publish();
+    }
+
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_release);
+    need_to_flush_.store(false, std::memory_order_release);
+
+    flush_in_progress_.store(false, std::memory_order_release);
+  }
+
+  void SinkToShm::drainOnCrash(
+      std::chrono::steady_clock::time_point deadline) noexcept {
+    if (!ring_ || !CrashWriter::lock(flush_in_progress_, deadline)) {
+      return;
+    }
+    drainQueue(deadline, [&](const Event &event) {
+      ring_->put(event);
+      return true;
+    });
+    ring_->publish();
+  }
+
+  void SinkToShm::rotate() noexcept {}
+
+  void SinkToShm::run() {
+    util::setThreadName("log:" + name_);
+
+    next_flush_.store(std::chrono::steady_clock::now(),
+                      std::memory_order_relaxed);
+
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        if (condvar_.wait_until(lock,
+                                next_flush_.load(std::memory_order_relaxed))
+            == std::cv_status::no_timeout) {
+          if (!need_to_flush_.load(std::memory_order_relaxed)
+              && !need_to_finalize_.load(std::memory_order_relaxed)) {
+            continue;
+          }
+        }
+      }
+
+      placeWorker();
+      flush();
+
+      if (need_to_finalize_.load(std::memory_order_acquire)
+          && events_.size() == 0) {
+        return;
+      }
+    }
+  }
+
+}  // namespace soralog
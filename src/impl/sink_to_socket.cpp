@@ -0,0 +1,430 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_socket.hpp>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    /// Size of record size prefix
+    constexpr size_t prefix_size = 4;
+
+    /// Pending records are sent as soon as they reach this size
+    constexpr size_t write_chunk_size = 1u << 16;  // 64 Kb
+
+    void put_size(char *ptr, uint32_t size) {
+      for (size_t i = 0; i < prefix_size; ++i) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        ptr[i] = static_cast<char>(size >> ((prefix_size - 1 - i) * 8));
+      }
+    }
+
+    uint32_t get_size(const char *ptr) {
+      uint32_t size = 0;
+      for (size_t i = 0; i < prefix_size; ++i) {
+        size = (size << 8) | static_cast<uint8_t>(ptr[i]);  // NOLINT
+      }
+      return size;
+    }
+
+    /**
+     * Creates non-blocking stream socket and starts connection to
+     * {@param address}
+     * @returns socket, or -1 if failed
+     */
+    int start_connection(const std::string &address) {
+      if (!address.empty() && address.front() == '/') {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (address.size() >= sizeof(addr.sun_path)) {
+          errno = ENAMETOOLONG;
+          return -1;
+        }
+        std::memcpy(addr.sun_path, address.data(), address.size());
+
+        int fd =
+            ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+          return -1;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))
+                != 0
+            && errno != EINPROGRESS) {
+          auto error = errno;
+          ::close(fd);
+          errno = error;
+          return -1;
+        }
+        return fd;
+      }
+
+      // TCP address: `host:port` or `[host]:port`
+      auto colon = address.rfind(':');
+      if (colon == std::string::npos) {
+        errno = EINVAL;
+        return -1;
+      }
+      auto host = address.substr(0, colon);
+      auto port = address.substr(colon + 1);
+      if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+      }
+
+      addrinfo hints{};
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      addrinfo *result = nullptr;
+      if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+        errno = EHOSTUNREACH;
+        return -1;
+      }
+
+      int fd = ::socket(result->ai_family,
+                        result->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        result->ai_protocol);
+      if (fd >= 0
+          && ::connect(fd, result->ai_addr, result->ai_addrlen) != 0
+          && errno != EINPROGRESS) {
+        auto error = errno;
+        ::close(fd);
+        errno = error;
+        fd = -1;
+      }
+      ::freeaddrinfo(result);
+      return fd;
+    }
+
+  }  // namespace
+
+  SinkToSocket::SinkToSocket(std::string name, std::string address,
+                             std::optional<size_t> budget,
+                             std::optional<DropPolicy> drop_policy,
+                             std::optional<ThreadInfoType> thread_info_type,
+                             std::optional<size_t> capacity,
+                             std::optional<size_t> buffer_size,
+                             std::optional<size_t> latency)
+      : Sink(std::move(name), thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 11),     // 2048 events
+             buffer_size.value_or(1u << 20),  // 1 Mb
+             latency.value_or(100)),          // 100 ms
+        address_(std::move(address)),
+        budget_(budget.value_or(1u << 24)),  // 16 Mb
+        drop_policy_(drop_policy.value_or(DropPolicy::NEWEST)),
+        line_pattern_(LinePattern::defaultPattern(thread_info_type_),
+                      thread_info_type_, false),
+        buff_(line_pattern_.maxSize()) {
+    connect();
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
+    }
+  }
+
+  SinkToSocket::~SinkToSocket() {
+    if (sink_worker_) {
+      need_to_finalize_.store(true, std::memory_order_release);
+      async_flush();
+      sink_worker_->join();
+      sink_worker_.reset();
+    } else {
+      flush();
+    }
+    if (socket_ >= 0) {
+      ::close(socket_);
+    }
+  }
+
+  void SinkToSocket::connect() {
+    if (state_.load(std::memory_order_relaxed) == State::DISCONNECTED) {
+      if (std::chrono::steady_clock::now() < next_connect_) {
+        return;
+      }
+      socket_ = start_connection(address_);
+      if (socket_ < 0) {
+        disconnect();
+        return;
+      }
+      next_connect_ = std::chrono::steady_clock::now() + connect_timeout;
+      state_.store(State::CONNECTING, std::memory_order_release);
+    }
+
+    if (state_.load(std::memory_order_relaxed) == State::CONNECTING) {
+      pollfd pfd{socket_, POLLOUT, 0};
+      if (::poll(&pfd, 1, 0) <= 0) {
+        if (std::chrono::steady_clock::now() >= next_connect_) {
+          disconnect();  // Timed out
+        }
+        return;  // Still in progress
+      }
+      int error = 0;
+      socklen_t len = sizeof(error);
+      if (::getsockopt(socket_, SOL_SOCKET, SO_ERROR, &error, &len) != 0
+          || error != 0) {
+        disconnect();
+        return;
+      }
+      reconnect_delay_ = min_reconnect_delay;
+      state_.store(State::CONNECTED, std::memory_order_release);
+      return;
+    }
+
+    // Collector is not expected to send anything, so readable socket means
+    // connection is closed by peer. Detecting it before sending helps to
+    // not lose records written into dead connection
+    pollfd pfd{socket_, POLLIN, 0};
+    if (::poll(&pfd, 1, 0) > 0) {
+      std::array<char, 256> trash{};
+      auto res = ::recv(socket_, trash.data(), trash.size(), MSG_DONTWAIT);
+      if (res == 0
+          || (res < 0 && errno != EAGAIN && errno != EWOULDBLOCK
+              && errno != EINTR)) {
+        disconnect();
+      }
+    }
+  }
+
+  void SinkToSocket::disconnect() {
+    if (socket_ >= 0) {
+      ::close(socket_);
+      socket_ = -1;
+    }
+    state_.store(State::DISCONNECTED, std::memory_order_release);
+    next_connect_ = std::chrono::steady_clock::now() + reconnect_delay_;
+    reconnect_delay_ = std::min<std::chrono::milliseconds>(
+        reconnect_delay_ * 2, max_reconnect_delay);
+
+    // Record torn by disconnection will be sent again from its beginning
+    sent_ = record_begin_;
+  }
+
+  void SinkToSocket::enqueue(const char *data, size_t size) {
+    const size_t record_size = prefix_size + size;
+
+    if (pending_.size() - record_begin_ + record_size > budget_) {
+      if (drop_policy_ == DropPolicy::NEWEST) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      // Drop oldest records except partially sent one. Frees quarter of
+      // budget at least, to avoid moving data for each new record
+      size_t begin = record_begin_;
+      if (sent_ > record_begin_) {
+        begin += prefix_size + get_size(&pending_[record_begin_]);
+      }
+      const size_t need = std::max(
+          pending_.size() - record_begin_ + record_size - budget_,
+          budget_ / 4);
+      size_t end = begin;
+      size_t count = 0;
+      while (end < pending_.size() && end - begin < need) {
+        end += prefix_size + get_size(&pending_[end]);
+        ++count;
+      }
+      pending_.erase(pending_.begin() + begin, pending_.begin() + end);
+      dropped_.fetch_add(count, std::memory_order_relaxed);
+
+      if (pending_.size() - record_begin_ + record_size > budget_) {
+        // Record is too big for budget
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+
+    const size_t offset = pending_.size();
+    pending_.resize(offset + record_size);
+    put_size(&pending_[offset], size);
+    std::memcpy(&pending_[offset + prefix_size], data, size);
+  }
+
+  void SinkToSocket::transmit() {
+    while (hasPending()) {
+      auto res = ::send(socket_, &pending_[sent_], pending_.size() - sent_,
+                        MSG_DONTWAIT | MSG_NOSIGNAL);
+      if (res > 0) {
+        sent_ += res;
+        continue;
+      }
+      if (res < 0 && errno == EINTR) {
+        continue;
+      }
+      if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        // Collector does not keep up; worker will wait for socket
+        wait_for_socket_.store(true, std::memory_order_release);
+        break;
+      }
+      disconnect();
+      return;
+    }
+
+    if (!hasPending()) {
+      pending_.clear();
+      record_begin_ = 0;
+      sent_ = 0;
+      return;
+    }
+
+    // Find beginning of record being sent now
+    while (record_begin_ + prefix_size <= sent_) {
+      auto next =
+          record_begin_ + prefix_size + get_size(&pending_[record_begin_]);
+      if (next > sent_) {
+        break;
+      }
+      record_begin_ = next;
+    }
+
+    // Compact buffer if sent part is big enough
+    if (record_begin_ >= pending_.size() / 2) {
+      pending_.erase(pending_.begin(), pending_.begin() + record_begin_);
+      sent_ -= record_begin_;
+      record_begin_ = 0;
+    }
+  }
+
+  void SinkToSocket::async_flush() noexcept {
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      need_to_flush_.store(true, std::memory_order_release);
+      condvar_.notify_one();
+    } else {
+      flush();
+    }
+  }
+
+  void SinkToSocket::flush() noexcept {
+    bool false_v = false;
+    if (!flush_in_progress_.compare_exchange_strong(
+            false_v, true, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    // Rotation might be requested from signal handler
+    if (isRotationRequested()) {
+      need_to_reconnect_.store(true, std::memory_order_release);
+    }
+
+    // Connection (which might need resolving of name) is maintained by worker
+    // only, so producers flushing on overflow are not delayed by it
+    const bool on_worker =
+        !sink_worker_ || sink_worker_->get_id() == std::this_thread::get_id();
+    if (on_worker) {
+      bool true_v = true;
+      if (need_to_reconnect_.compare_exchange_weak(
+              true_v, false, std::memory_order_acq_rel)) {
+        disconnect();
+        reconnect_delay_ = min_reconnect_delay;
+        next_connect_ = std::chrono::steady_clock::now();
+      }
+      connect();
+    }
+
+    auto *const begin = buff_.data();
+
+    while (true) {
+      auto node = events_.get();
+      if (!node) {
+        break;
+      }
+      const auto &event = *node;
+      auto *ptr = begin;
+
+      line_pattern_.render(ptr, event);
+
+      enqueue(begin, ptr - begin);
+
+      size_ -= event.message().size();
+
+      // Coalesced records are sent by large pieces
+      if (pending_.size() - sent_ >= write_chunk_size && connected()) {
+        transmit();
+      }
+    }
+
+    if (connected()) {
+      transmit();
+    }
+
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_release);
+    need_to_flush_.store(false, std::memory_order_release);
+
+    flush_in_progress_.store(false, std::memory_order_release);
+  }
+
+  void SinkToSocket::rotate() noexcept {
+    need_to_reconnect_.store(true, std::memory_order_release);
+    async_flush();
+  }
+
+  void SinkToSocket::run() {
+    util::setThreadName("log:" + name_);
+
+    next_flush_.store(std::chrono::steady_clock::now(),
+                      std::memory_order_relaxed);
+
+    auto wait_for_socket = [this](std::chrono::milliseconds timeout) {
+      pollfd pfd{socket_, POLLOUT, 0};
+      ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    };
+
+    while (true) {
+      if (state_.load(std::memory_order_acquire) == State::CONNECTING
+          || wait_for_socket_.exchange(false, std::memory_order_acq_rel)) {
+        // Wait for connection is completed or socket becomes writable
+        wait_for_socket(latency_);
+      } else {
+        std::unique_lock lock(mutex_);
+        if (condvar_.wait_until(lock,
+                                next_flush_.load(std::memory_order_relaxed))
+            == std::cv_status::no_timeout) {
+          if (!need_to_flush_.load(std::memory_order_relaxed)
+              && !need_to_finalize_.load(std::memory_order_relaxed)) {
+            continue;
+          }
+        }
+      }
+
+      placeWorker();
+      flush();
+
+      if (need_to_finalize_.load(std::memory_order_acquire)
+          && events_.size() == 0) {
+        // Give a chance to send buffered records
+        const auto deadline =
+            std::chrono::steady_clock::now() + finalize_timeout;
+        while (hasPending() && std::chrono::steady_clock::now() < deadline) {
+          if (connected()) {
+            wait_for_socket(10ms);
+          } else {
+            std::this_thread::sleep_for(10ms);
+          }
+          flush();
+        }
+        if (hasPending()) {
+          std::cerr << "Sink '" << name_ << "' lost "
+                    << pending_.size() - record_begin_
+                    << " bytes of records not sent to '" << address_ << "'"
+                    << std::endl;
+        }
+        return;
+      }
+    }
+  }
+
+}  // namespace soralog
@@ -0,0 +1,449 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_syslog.hpp>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#include <fmt/format.h>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    /// Reserve of buffer for header of record
+    constexpr size_t record_overhead = 1024;
+
+    /// How long worker waits for socket if receiver does not keep up
+    constexpr auto send_timeout = 100ms;
+
+    /// Min interval between attempts to connect
+    constexpr auto reconnect_interval = 1s;
+
+    /**
+     * @returns severity of RFC 5424 corresponding to {@param level}
+     */
+    uint8_t severity(Level level) {
+      switch (level) {
+        case Level::CRITICAL:
+          return 2;  // Critical
+        case Level::ERROR_:
+          return 3;  // Error
+        case Level::WARN:
+          return 4;  // Warning
+        case Level::INFO:
+        case Level::VERBOSE:
+          return 6;  // Informational
+        default:
+          return 7;  // Debug
+      }
+    }
+
+    /**
+     * Puts header field {@param str} limited by {@param max_size} symbols.
+     * Symbols are not allowed by RFC 5424 are replaced by '_', empty field is
+     * replaced by NILVALUE
+     */
+    void put_field(char *&ptr, std::string_view str, size_t max_size) {
+      if (str.empty()) {
+        *ptr++ = '-';  // NOLINT
+        return;
+      }
+      for (auto c : str.substr(0, max_size)) {
+        *ptr++ = (c > 32 && c < 127) ? c : '_';  // NOLINT
+      }
+    }
+
+    void put_string(char *&ptr, std::string_view str) {
+      std::memcpy(ptr, str.data(), str.size());
+      ptr += str.size();  // NOLINT
+    }
+
+  }  // namespace
+
+  SinkToSyslog::SinkToSyslog(std::string name, std::string address,
+                             std::optional<Facility> facility,
+                             std::optional<std::string> app_name,
+                             std::optional<ThreadInfoType> thread_info_type,
+                             std::optional<size_t> capacity,
+                             std::optional<size_t> buffer_size,
+                             std::optional<size_t> latency)
+      : Sink(std::move(name), thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 11),     // 2048 events
+             buffer_size.value_or(1u << 20),  // 1 Mb
+             latency.value_or(200)),          // 200 ms
+        address_(std::move(address)),
+        facility_(facility.value_or(Facility::USER)),
+        app_name_(app_name.value_or(program_invocation_short_name)),
+        procid_(std::to_string(::getpid())),
+        buff_(std::max(max_buffer_size_,
+                       max_text_event_size + record_overhead)),
+        iovecs_(max_batch_size),
+        msgs_(max_batch_size) {
+    std::array<char, 256> hostname{};
+    if (::gethostname(hostname.data(), hostname.size() - 1) == 0) {
+      hostname_ = hostname.data();
+    }
+
+    for (size_t i = 0; i < max_batch_size; ++i) {
+      msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+      msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    if (!connect()) {
+      std::cerr << "Can't connect to syslog '" << address_
+                << "': " << strerror(errno) << std::endl;
+    }
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
+    }
+  }
+
+  SinkToSyslog::~SinkToSyslog() {
+    if (sink_worker_) {
+      need_to_finalize_.store(true, std::memory_order_release);
+      async_flush();
+      sink_worker_->join();
+      sink_worker_.reset();
+    } else {
+      flush();
+    }
+    if (socket_ >= 0) {
+      ::close(socket_);
+    }
+  }
+
+  std::optional<SinkToSyslog::Facility> SinkToSyslog::facilityFromStr(
+      std::string_view str) {
+    if (str == "kern") return Facility::KERN;
+    if (str == "user") return Facility::USER;
+    if (str == "mail") return Facility::MAIL;
+    if (str == "daemon") return Facility::DAEMON;
+    if (str == "auth") return Facility::AUTH;
+    if (str == "syslog") return Facility::SYSLOG;
+    if (str == "lpr") return Facility::LPR;
+    if (str == "news") return Facility::NEWS;
+    if (str == "uucp") return Facility::UUCP;
+    if (str == "cron") return Facility::CRON;
+    if (str == "authpriv") return Facility::AUTHPRIV;
+    if (str == "ftp") return Facility::FTP;
+    if (str == "local0") return Facility::LOCAL0;
+    if (str == "local1") return Facility::LOCAL1;
+    if (str == "local2") return Facility::LOCAL2;
+    if (str == "local3") return Facility::LOCAL3;
+    if (str == "local4") return Facility::LOCAL4;
+    if (str == "local5") return Facility::LOCAL5;
+    if (str == "local6") return Facility::LOCAL6;
+    if (str == "local7") return Facility::LOCAL7;
+    return std::nullopt;
+  }
+
+  bool SinkToSyslog::connect() {
+    if (socket_ >= 0) {
+      ::close(socket_);
+      socket_ = -1;
+    }
+
+    if (!address_.empty() && address_.front() == '/') {
+      sockaddr_un addr{};
+      addr.sun_family = AF_UNIX;
+      if (address_.size() >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+      }
+      std::memcpy(addr.sun_path, address_.data(), address_.size());
+
+      int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      if (fd < 0) {
+        return false;
+      }
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))
+          != 0) {
+        auto error = errno;
+        ::close(fd);
+        errno = error;
+        return false;
+      }
+      socket_ = fd;
+      return true;
+    }
+
+    // UDP address: `host:port` or `[host]:port`
+    auto colon = address_.rfind(':');
+    if (colon == std::string::npos) {
+      errno = EINVAL;
+      return false;
+    }
+    auto host = address_.substr(0, colon);
+    auto port = address_.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+      host = host.substr(1, host.size() - 2);
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *result = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+      errno = EHOSTUNREACH;
+      return false;
+    }
+
+    for (auto *ai = result; ai != nullptr; ai = ai->ai_next) {
+      int fd = ::socket(ai->ai_family,
+                        ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        ai->ai_protocol);
+      if (fd < 0) {
+        continue;
+      }
+      if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+        socket_ = fd;
+        break;
+      }
+      ::close(fd);
+    }
+    ::freeaddrinfo(result);
+
+    return socket_ >= 0;
+  }
+
+  void SinkToSyslog::send(size_t count, bool on_worker) {
+    size_t sent = 0;
+    bool waited = false;
+    bool reconnected = false;
+    while (sent < count && socket_ >= 0) {
+      auto res = ::sendmmsg(socket_, &msgs_[sent], count - sent,
+                            MSG_DONTWAIT | MSG_NOSIGNAL);
+      if (res > 0) {
+        sent += res;
+        continue;
+      }
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+        // Receiver does not keep up. Only worker waits for it a bit, others
+        // (producers flushing on overflow) never block on socket
+        if (!sink_worker_ || !on_worker || waited) {
+          break;
+        }
+        waited = true;
+        pollfd pfd{socket_, POLLOUT, 0};
+        ::poll(&pfd, 1, send_timeout / 1ms);
+        continue;
+      }
+      // Receiver is gone (e.g. syslog daemon restarted) - try to reconnect;
+      // other threads leave it to worker
+      if (!on_worker) {
+        need_to_reconnect_.store(true, std::memory_order_release);
+        break;
+      }
+      if (reconnected || !connect()) {
+        break;
+      }
+      reconnected = true;
+    }
+
+    if (sent < count) {
+      dropped_.fetch_add(count - sent, std::memory_order_relaxed);
+    } else if (auto dropped = dropped_.load(std::memory_order_relaxed);
+               dropped != reported_dropped_) {
+      std::cerr << "Sink '" << name_ << "' dropped "
+                << dropped - reported_dropped_
+                << " records because syslog did not accept them" << std::endl;
+      reported_dropped_ = dropped;
+    }
+  }
+
+  void SinkToSyslog::async_flush() noexcept {
+    if (latency_ != std::chrono::milliseconds::zero()) {
+      need_to_flush_.store(true, std::memory_order_release);
+      condvar_.notify_one();
+    } else {
+      flush();
+    }
+  }
+
+  void SinkToSyslog::flush() noexcept {
+    bool false_v = false;
+    if (!flush_in_progress_.compare_exchange_strong(
+            false_v, true, std::memory_order_acq_rel)) {
+      return;
+    }
+
+    // Rotation might be requested from signal handler
+    if (isRotationRequested()) {
+      need_to_reconnect_.store(true, std::memory_order_release);
+    }
+
+    // Connection (which might need resolving of name) is maintained by worker
+    // only, so producers flushing on overflow are not delayed by it
+    const bool on_worker =
+        !sink_worker_ || sink_worker_->get_id() == std::this_thread::get_id();
+    if (on_worker) {
+      const auto now = std::chrono::steady_clock::now();
+      bool true_v = true;
+      if (need_to_reconnect_.compare_exchange_weak(
+              true_v, false, std::memory_order_acq_rel)) {
+        if (!connect()) {
+          std::cerr << "Can't reconnect to syslog '" << address_
+                    << "': " << strerror(errno) << std::endl;
+        }
+      } else if (socket_ < 0 && now >= next_connect_) {
+        next_connect_ = now + reconnect_interval;
+        connect();
+      }
+    }
+
+    auto *const begin = buff_.data();
+    auto *const end = buff_.data() + buff_.size();  // NOLINT
+    auto *ptr = begin;
+    size_t count = 0;
+
+    decltype(1s / 1s) psec = 0;
+    std::array<char, 19> datetime{};  // "0000-00-00T00:00:00"
+
+    while (true) {
+      auto node = events_.get();
+      if (node) {
+        const auto &event = *node;
+        auto *const record = ptr;
+
+        // PRI and VERSION
+
+        ptr = fmt::format_to_n(ptr, end - ptr, "<{}>1 ",
+                               static_cast<unsigned>(facility_) * 8
+                                   + severity(event.level()))
+                  .out;
+
+        // TIMESTAMP (UTC)
+
+        const auto time = event.timestamp().time_since_epoch();
+        const auto sec = time / 1s;
+        const auto usec = time % 1s / 1us;
+
+        if (psec != sec) {
+          std::tm tm{};
+          auto time_t = static_cast<std::time_t>(sec);
+          ::gmtime_r(&time_t, &tm);
+          fmt::format_to_n(datetime.data(), datetime.size(),
+                           "{:0>4}-{:0>2}-{:0>2}T{:0>2}:{:0>2}:{:0>2}",
+                           tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                           tm.tm_hour, tm.tm_min, tm.tm_sec);
+          psec = sec;
+        }
+        put_string(ptr, {datetime.data(), datetime.size()});
+        ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}Z ", usec).out;
+
+        // HOSTNAME APP-NAME PROCID MSGID STRUCTURED-DATA
+
+        put_field(ptr, hostname_, 255);
+        *ptr++ = ' ';  // NOLINT
+        put_field(ptr, app_name_, 48);
+        *ptr++ = ' ';  // NOLINT
+        put_field(ptr, procid_, 128);
+        *ptr++ = ' ';  // NOLINT
+        put_field(ptr, event.name(), 32);
+        put_string(ptr, " - ");
+
+        // MSG
+
+        switch (thread_info_type_) {
+          case ThreadInfoType::NAME:
+            *ptr++ = '[';  // NOLINT
+            put_string(ptr, event.thread_name());
+            put_string(ptr, "] ");
+            break;
+
+          case ThreadInfoType::ID:
+            ptr = fmt::format_to_n(ptr, end - ptr, "[T:{}] ",
+                                   event.thread_number())
+                      .out;
+            break;
+
+          default:
+            break;
+        }
+
+        put_string(ptr, event.message());
+        event.fields().putText(ptr);
+
+        iovecs_[count].iov_base = record;
+        iovecs_[count].iov_len = ptr - record;
+        ++count;
+
+        size_ -= event.message().size();
+      }
+
+      if (count == max_batch_size
+          || (end - ptr) < max_text_event_size + record_overhead
+          || (!node && count != 0)
+          || std::chrono::steady_clock::now()
+              >= next_flush_.load(std::memory_order_acquire)) {
+        next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                          std::memory_order_release);
+        if (count != 0) {
+          send(count, on_worker);
+        }
+        ptr = begin;
+        count = 0;
+      }
+
+      if (!node) {
+        need_to_flush_.store(false, std::memory_order_release);
+        break;
+      }
+    }
+
+    flush_in_progress_.store(false, std::memory_order_release);
+  }
+
+  void SinkToSyslog::rotate() noexcept {
+    need_to_reconnect_.store(true, std::memory_order_release);
+    async_flush();
+  }
+
+  void SinkToSyslog::run() {
+    util::setThreadName("log:" + name_);
+
+    next_flush_.store(std::chrono::steady_clock::now(),
+                      std::memory_order_relaxed);
+
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        if (condvar_.wait_until(lock,
+                                next_flush_.load(std::memory_order_relaxed))
+            == std::cv_status::no_timeout) {
+          if (!need_to_flush_.load(std::memory_order_relaxed)
+              && !need_to_finalize_.load(std::memory_order_relaxed)) {
+            continue;
+          }
+        }
+      }
+
+      placeWorker();
+      flush();
+
+      if (need_to_finalize_.load(std::memory_order_acquire)
+          && events_.size() == 0) {
+        return;
+      }
+    }
+  }
+
+}  // namespace soralog
@@ -20,6 +20,42 @@ namespace soralog {
     setLevelFromGroup(group_);
   }
 
+  Logger::~Logger() {
+    // Logger isn't used by other threads anymore
+    delete target_.load(std::memory_order_acquire);
+  }
+
+  size_t Logger::formatForSignal(char *buffer, size_t size,
+                                 std::string_view format,
+                                 const SignalArg *args,
+                                 size_t count) noexcept {
+    size_t pos = 0;
+    size_t arg = 0;
+    for (size_t i = 0; i < format.size() && pos < size; ++i) {
+      if (format[i] == '{' && i + 1 < format.size() && format[i + 1] == '}'
+          && arg < count) {
+        const auto &[negative, magnitude] = args[arg++];  // NOLINT
+        std::array<char, 20> digits{};  // enough for any uint64
+        size_t n = 0;
+        auto value = magnitude;
+        do {
+          digits[n++] = static_cast<char>('0' + value % 10);
+          value /= 10;
+        } while (value != 0);
+        if (negative && pos < size) {
+          buffer[pos++] = '-';  // NOLINT
+        }
+        while (n != 0 && pos < size) {
+          buffer[pos++] = digits[--n];  // NOLINT
+        }
+        ++i;
+        continue;
+      }
+      buffer[pos++] = format[i];  // NOLINT
+    }
+    return pos;
+  }
+
   // Level
 
   void Logger::resetLevel() {
@@ -28,13 +64,13 @@ namespace soralog {
 
   void Logger::setLevel(Level level) {
     is_level_overridden_ = true;
-    level_ = level;
+    level_.store(level, std::memory_order_relaxed);
   }
 
   void Logger::setLevelFromGroup(const std::shared_ptr<const Group> &group) {
     assert(group);
     is_level_overridden_ = group != group_;
-    level_ = group->level();
+    level_.store(group->level(), std::memory_order_relaxed);
   }
 
   void Logger::setLevelFromGroup(const std::string &group_name) {
@@ -46,8 +82,8 @@ namespace soralog {
   // Sink
 
   void Logger::resetSink() {
-    sink_ = std::const_pointer_cast<Sink>(group_->sink());
     is_sink_overridden_ = false;
+    replaceSink(std::const_pointer_cast<Sink>(group_->sink()));
   }
 
   void Logger::setSink(const std::string &sink_name) {
@@ -59,14 +95,14 @@ namespace soralog {
   void Logger::setSink(std::shared_ptr<Sink> sink) {
     assert(sink);
     is_sink_overridden_ = true;
-    sink_ = std::move(sink);
+    replaceSink(std::move(sink));
   }
 
   void Logger::setSinkFromGroup(const std::shared_ptr<const Group> &group) {
     assert(group);
     if (auto sink = std::const_pointer_cast<Sink>(group->sink())) {
       is_sink_overridden_ = group != group_;
-      sink_ = std::move(sink);
+      replaceSink(std::move(sink));
     }
   }
 
@@ -76,17 +112,79 @@ namespace soralog {
     }
   }
 
+  void Logger::prepareForSignal() {
+    is_prepared_for_signal_ = true;
+    if (sink_) {
+      sink_->prepare();
+    }
+  }
+
+  void Logger::replaceSink(std::shared_ptr<Sink> sink) {
+    // Logging threads aren't disturbed if the same sink is set again
+    if (sink_ != sink) {
+      sink_ = std::move(sink);
+      updateFilterSelection();
+    }
+  }
+
+  void Logger::updateFilterSelection() {
+    if (!sink_) {
+      return;
+    }
+    // Logger might log from signal handler, where sink can't be started
+    if (is_prepared_for_signal_) {
+      sink_->prepare();
+    }
+    std::vector<std::string_view> group_names;
+    for (auto group = group_.get(); group; group = group->parent().get()) {
+      group_names.emplace_back(group->name());
+    }
+    sink_->bindLogger(name_, group_names);
+    SinkFilter::Selection selection;
+    if (sink_->filter()) {
+      selection = sink_->selectFilter(name_, group_names);
+    }
+    // Target is replaced only if it's changed indeed; it's written by this
+    // thread only, so it's safe to be read without guard
+    if (auto current = target_.load(std::memory_order_relaxed);
+        current && current->sink == sink_
+        && current->filter_selection == selection) {
+      return;
+    }
+    auto target = std::make_unique<Target>();
+    target->sink = sink_;
+    target->filter_selection = selection;
+    // Previous target might be still used by logging threads. Exchange is
+    // sequentially consistent with stores of hazard slots, so reclaim() sees
+    // slot of any reader which might have got previous target
+    if (auto previous =
+            target_.exchange(target.release(), std::memory_order_seq_cst)) {
+      hazard::retire(previous, [](const void *ptr) {
+        delete static_cast<const Target *>(ptr);
+      });
+    }
+  }
+
   // Group
 
   void Logger::setGroup(std::shared_ptr<const Group> group) {
     assert(group);
+    const bool changed = group_ != group;
     group_ = std::move(group);
-    if (!is_sink_overridden_) {
-      setSinkFromGroup(group_);
+    if (changed) {
+      system_.onGroupOfLoggerChanged(*this);
     }
     if (!is_level_overridden_) {
       setLevelFromGroup(group_);
     }
+    if (!is_sink_overridden_) {
+      if (auto sink = std::const_pointer_cast<Sink>(group_->sink())) {
+        sink_ = std::move(sink);
+      }
+    }
+    // Globs of groups might match new group, so selection is checked even if
+    // sink is the same
+    updateFilterSelection();
   }
 
   void Logger::setGroup(const std::string &group_name) {
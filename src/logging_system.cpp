@@ -5,20 +5,370 @@
 
 #include <soralog/logging_system.hpp>
 
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <csignal>
 #include <iostream>
+#include <new>
 #include <set>
 #include <functional>
 
 #include <soralog/group.hpp>
+#include <soralog/hazard_pointer.hpp>
+#include <soralog/impl/crash_writer.hpp>
 #include <soralog/impl/sink_to_nowhere.hpp>
 #include <soralog/logger.hpp>
 
 namespace soralog {
 
+  namespace {
+
+    constexpr std::array fatal_signals{SIGSEGV, SIGBUS, SIGILL, SIGFPE,
+                                       SIGABRT};
+
+    /// Actions of fatal signals before crash handler was installed
+    std::array<struct sigaction, fatal_signals.size()> previous_actions{};
+
+    using CrashSinks = std::vector<std::shared_ptr<Sink>>;
+
+    /// Sinks to drain on crash; snapshot keeps them alive, and it's retired
+    /// (see hazard::retire) when replaced
+    std::atomic<const CrashSinks *> crash_sinks = nullptr;
+
+    /**
+     * Replaces snapshot of sinks to drain on crash by {@param sinks}
+     */
+    void replace_crash_sinks(std::unique_ptr<const CrashSinks> sinks) {
+      // Crash handler might be reading previous snapshot at the moment
+      if (auto previous = crash_sinks.exchange(sinks.release(),
+                                               std::memory_order_seq_cst)) {
+        hazard::retire(previous, [](const void *ptr) {
+          delete static_cast<const CrashSinks *>(ptr);
+        });
+      }
+    }
+
+    /// System which crash handler is installed by
+    std::atomic<const LoggingSystem *> crash_system = nullptr;
+
+    std::atomic<int64_t> crash_budget_ms = 0;
+    std::atomic_bool crash_in_progress = false;
+    std::atomic_int crash_signal = 0;
+
+    constexpr size_t crash_stack_size = 1u << 18;  // 256 Kb
+
+    /// Live systems, which are prepared to fork() by handlers of
+    /// pthread_atfork; mutex is held while fork() is in progress
+    std::mutex fork_mutex;
+    std::vector<LoggingSystem *> fork_systems;
+    std::once_flag fork_handlers_once;
+
+    /**
+     * Restores action of {@param signal} existed before crash handler, and
+     * raises signal again (it's delivered after return from handler, or
+     * immediately if it's default action)
+     */
+    void reraise(int signal) {
+      for (size_t i = 0; i < fatal_signals.size(); ++i) {
+        if (fatal_signals[i] == signal) {
+          ::sigaction(signal, &previous_actions[i], nullptr);  // NOLINT
+        }
+      }
+      ::raise(signal);
+      sigset_t set;
+      sigemptyset(&set);
+      sigaddset(&set, signal);
+      ::sigprocmask(SIG_UNBLOCK, &set, nullptr);
+    }
+
+    /**
+     * Backstop of time budget: write into wedged disk is not interrupted
+     * by deadline
+     */
+    void on_crash_timeout(int /*signal*/) {
+      reraise(crash_signal.load());
+    }
+
+    void on_fatal_signal(int signal) {
+      bool false_v = false;
+      if (!crash_in_progress.compare_exchange_strong(false_v, true)) {
+        // Other thread is crashing too and drains sinks; it terminates
+        // process when done
+        while (true) {
+          ::pause();
+        }
+      }
+      crash_signal.store(signal);
+
+      Sink::freeze();
+
+      const auto budget = std::chrono::milliseconds(crash_budget_ms.load());
+      struct sigaction action {};
+      action.sa_handler = on_crash_timeout;
+      action.sa_flags = SA_ONSTACK;
+      sigemptyset(&action.sa_mask);
+      ::sigaction(SIGALRM, &action, nullptr);
+      ::alarm(static_cast<unsigned>(budget / std::chrono::seconds(1)) + 1);
+
+      const auto deadline = std::chrono::steady_clock::now() + budget;
+      if (HazardGuard sinks(crash_sinks, true); sinks.get() != nullptr) {
+        for (const auto &sink : *sinks) {
+          sink->drainOnCrash(deadline);
+        }
+      }
+
+      ::alarm(0);
+      reraise(signal);
+    }
+
+    /**
+     * Alternate stack of signal handlers of thread
+     */
+    class CrashStack final {
+     public:
+      CrashStack(CrashStack &&) noexcept = delete;
+      CrashStack(const CrashStack &) = delete;
+      CrashStack &operator=(CrashStack &&) noexcept = delete;
+      CrashStack &operator=(CrashStack const &) = delete;
+
+      CrashStack() : memory_(crash_stack_size) {
+        stack_t stack{};
+        stack.ss_sp = memory_.data();
+        stack.ss_size = memory_.size();
+        installed_ = ::sigaltstack(&stack, nullptr) == 0;
+      }
+
+      ~CrashStack() {
+        if (installed_) {
+          stack_t stack{};
+          stack.ss_flags = SS_DISABLE;
+          ::sigaltstack(&stack, nullptr);
+        }
+      }
+
+      bool installed() const {
+        return installed_;
+      }
+
+     private:
+      std::vector<char> memory_;
+      bool installed_ = false;
+    };
+
+  }  // namespace
+
   LoggingSystem::LoggingSystem(std::shared_ptr<Configurator> configurator)
       : configurator_(std::move(configurator)) {
     makeSink<SinkToNowhere>("*");
+
+    std::call_once(fork_handlers_once, [] {
+      ::pthread_atfork(onForkPrepare, onForkParent, onForkChild);
+    });
+    std::lock_guard guard(fork_mutex);
+    fork_systems.push_back(this);
+  }
+
+  LoggingSystem::~LoggingSystem() {
+    {
+      std::lock_guard guard(fork_mutex);
+      fork_systems.erase(
+          std::find(fork_systems.begin(), fork_systems.end(), this));
+    }
+
+    const LoggingSystem *self = this;
+    if (crash_system.compare_exchange_strong(self, nullptr)) {
+      replace_crash_sinks(nullptr);
+      for (size_t i = 0; i < fatal_signals.size(); ++i) {
+        ::sigaction(fatal_signals[i], &previous_actions[i],  // NOLINT
+                    nullptr);
+      }
+    }
+    // Releases sinks which were replaced while some thread logged into them
+    hazard::reclaim();
+  }
+
+  void LoggingSystem::onForkPrepare() {
+    fork_mutex.lock();
+    for (auto *system : fork_systems) {
+      system->prepareFork();
+    }
+    // Taken last: objects are retired under mutex of system
+    hazard::prepareFork();
+  }
+
+  void LoggingSystem::onForkParent() {
+    hazard::resumeAfterFork();
+    for (auto it = fork_systems.rbegin(); it != fork_systems.rend(); ++it) {
+      (*it)->resumeAfterFork();
+    }
+    fork_mutex.unlock();
+  }
+
+  void LoggingSystem::onForkChild() {
+    hazard::resetAfterFork();
+    for (auto it = fork_systems.rbegin(); it != fork_systems.rend(); ++it) {
+      (*it)->resetAfterFork();
+    }
+    new (&fork_mutex) std::mutex;
+  }
+
+  void LoggingSystem::prepareFork() {
+    mutex_.lock();
+    sinks_.forEach([&](const auto &, const auto &sink) {
+      forking_sinks_.push_back(sink);
+    });
+    for (const auto &sink : forking_sinks_) {
+      sink->prepareFork();
+    }
+    loggers_.lockAll();
+    sinks_.lockAll();
+    groups_.lockAll();
+  }
+
+  void LoggingSystem::resumeAfterFork() {
+    groups_.unlockAll();
+    sinks_.unlockAll();
+    loggers_.unlockAll();
+    for (const auto &sink : forking_sinks_) {
+      sink->resumeAfterFork();
+    }
+    forking_sinks_.clear();
+    mutex_.unlock();
+  }
+
+  void LoggingSystem::resetAfterFork() {
+    // Locks are held by thread of parent, which doesn't exist here
+    groups_.resetLocks();
+    sinks_.resetLocks();
+    loggers_.resetLocks();
+    for (const auto &sink : forking_sinks_) {
+      sink->resetAfterFork();
+    }
+    forking_sinks_.clear();
+    new (&mutex_) std::recursive_mutex;
+  }
+
+  bool LoggingSystem::setupCrashStack() {
+    static thread_local CrashStack stack;
+    return stack.installed();
+  }
+
+  bool LoggingSystem::installCrashHandler(std::chrono::milliseconds budget) {
+    std::lock_guard guard(mutex_);
+
+    const LoggingSystem *none = nullptr;
+    if (!crash_system.compare_exchange_strong(none, this)
+        && none != this) {
+      return false;
+    }
+
+    CrashWriter::prepare();
+    setupCrashStack();
+
+    crash_budget_ms.store(budget.count());
+    has_crash_handler_ = true;
+    updateCrashSinks();
+
+    if (none == this) {
+      return true;  // already installed; budget is updated
+    }
+
+    struct sigaction action {};
+    action.sa_handler = on_fatal_signal;
+    action.sa_flags = SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < fatal_signals.size(); ++i) {
+      if (::sigaction(fatal_signals[i], &action,
+                      &previous_actions[i])  // NOLINT
+          != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void LoggingSystem::updateCrashSinks() {
+    if (!has_crash_handler_) {
+      return;
+    }
+    auto sinks = std::make_unique<CrashSinks>();
+    sinks_.forEach([&](const auto & /*name*/, const auto &sink) {
+      sinks->push_back(sink);
+    });
+    replace_crash_sinks(std::move(sinks));
+  }
+
+  void LoggingSystem::addSink(std::shared_ptr<Sink> sink) {
+    std::lock_guard guard(mutex_);
+    // Replaced sink is kept by snapshot of crash handler, while it's read
+    auto previous = sinks_.assign(sink->name(), sink);
+    updateCrashSinks();
+    if (previous) {
+      relinkSink(previous, sink);
+    }
+  }
+
+  void LoggingSystem::relinkSink(const std::shared_ptr<Sink> &from,
+                                 const std::shared_ptr<Sink> &to) {
+    std::lock_guard guard(mutex_);
+
+    // Groups are collected first, because changing of sink walks over groups
+    std::set<std::shared_ptr<Group>> groups;
+    groups_.forEach([&](const auto & /*name*/, const auto &group) {
+      // Root group has own sink, even though it isn't marked as overridden
+      if ((group->isSinkOverridden() || !group->parent())
+          && group->sink() == from) {
+        groups.emplace(group);
+      }
+    });
+    transaction([&] {
+      for (const auto &group : groups) {
+        setSinkOfGroup(group, to);
+      }
+    });
+
+    loggers_.eraseIf([&](const auto & /*name*/, const auto &weak_logger) {
+      auto logger = weak_logger.lock();
+      if (!logger) {
+        return true;
+      }
+      if (logger->isSinkOverridden() && logger->sink() == from) {
+        logger->setSink(to);
+      }
+      return false;
+    });
+
+    from->flush();
+  }
+
+  bool LoggingSystem::removeSink(std::string_view name) {
+    std::lock_guard guard(mutex_);
+
+    auto sink = sinks_.find(name);
+    if (!sink || name == "*") {
+      return false;
+    }
+    sinks_.erase(name);
+    updateCrashSinks();
+
+    // Loggers overridden to retired sink get sink of own group
+    loggers_.eraseIf([&](const auto & /*name*/, const auto &weak_logger) {
+      auto logger = weak_logger.lock();
+      if (!logger) {
+        return true;
+      }
+      if (logger->isSinkOverridden() && logger->sink() == sink) {
+        logger->resetSink();
+      }
+      return false;
+    });
+
+    relinkSink(sink, sinks_.find("*"));
+    return true;
   }
 
   std::shared_ptr<Group> LoggingSystem::makeGroup(
@@ -28,29 +378,26 @@ namespace soralog {
     auto group =
         std::make_shared<Group>(*this, std::move(name), parent, sink, level);
     std::lock_guard guard(mutex_);
-    if (groups_.find("*") == groups_.end()) {
-      groups_["*"] = group;
+    if (!groups_.find("*")) {
+      groups_.assign("*", group);
     }
-    groups_[group->name()] = group;
+    groups_.assign(group->name(), group);
+    indexGroup(group);
     return group;
   }
 
   bool LoggingSystem::setFallbackGroup(const std::string &group_name) {
     std::lock_guard guard(mutex_);
-    auto it = groups_.find(group_name);
-    if (it == groups_.end()) {
+    auto group = groups_.find(group_name);
+    if (!group) {
       return false;
     }
-    groups_["*"] = it->second;
+    groups_.assign("*", std::move(group));
     return true;
   }
 
   std::shared_ptr<Group> LoggingSystem::getFallbackGroup() const {
-    auto it = groups_.find("*");
-    if (it == groups_.end()) {
-      return {};
-    }
-    return it->second;
+    return groups_.find("*");
   }
 
   Configurator::Result LoggingSystem::configure() {
@@ -69,9 +416,9 @@ namespace soralog {
       result.has_error = true;
       return result;
     }
-    for (auto &[name, group] : groups_) {
+    groups_.forEach([&](const std::string &name, const auto &group) {
       if (name == "*") {
-        continue;
+        return;
       }
       if (group->sink()->name() == "*") {
         result.message +=
@@ -79,25 +426,40 @@ namespace soralog {
             "Sink to nowhere will be used\n";
         result.has_warning = true;
       }
-    }
+    });
 
     return result;
   }
 
+  Configurator::Result LoggingSystem::reconfigure() {
+    std::lock_guard guard(mutex_);
+
+    if (!is_configured_) {
+      throw std::logic_error("LoggerSystem is not yet configured");
+    }
+    Configurator::Result result;
+    transaction([&] { result = configurator_->applyOn(*this); });
+    return result;
+  }
+
   std::shared_ptr<Logger> LoggingSystem::getLogger(
       std::string logger_name, const std::string &group_name,
       const std::optional<std::string> &sink_name,
       const std::optional<Level> &level) {
-    std::lock_guard guard(mutex_);
-
-    if (!is_configured_) {
+    if (!is_configured_.load(std::memory_order_acquire)) {
       throw std::logic_error("LoggerSystem is not yet configured");
     }
 
-    if (auto it = loggers_.find(logger_name); it != loggers_.end()) {
-      if (auto logger = it->second.lock()) {
-        return std::move(logger);
-      }
+    // Existing logger is found under shared lock only
+    if (auto logger = loggers_.find(logger_name).lock()) {
+      return logger;
+    }
+
+    std::lock_guard guard(mutex_);
+
+    // It might be created by other thread meanwhile
+    if (auto logger = loggers_.find(logger_name).lock()) {
+      return logger;
     }
 
     if (group_name == "*") {
@@ -134,94 +496,113 @@ namespace soralog {
       logger->setLevel(level.value());
     }
 
-    loggers_[logger->name()] = logger;
+    loggers_.assign(logger->name(), logger);
+    indexLogger(logger);
+    sweepLoggers(logger->name());
     return logger;
   }
 
-  [[nodiscard]] std::shared_ptr<Sink> LoggingSystem::getSink(
-      const std::string &sink_name) {
+  LoggerHandle LoggingSystem::makeHandle(std::shared_ptr<Logger> logger) {
+    assert(logger);
     std::lock_guard guard(mutex_);
-    auto it = sinks_.find(sink_name);
-    if (it == sinks_.end()) {
-      return {};
-    }
-    return it->second;
+    LoggerHandle handle(*logger);
+    kept_loggers_.emplace(std::move(logger));
+    return handle;
   }
 
-  [[nodiscard]] std::shared_ptr<Group> LoggingSystem::getGroup(
-      const std::string &group_name) {
-    std::lock_guard guard(mutex_);
-    auto it = groups_.find(group_name);
-    if (it == groups_.end()) {
-      return {};
+  std::shared_ptr<Logger> LoggingSystem::findLogger(
+      std::string_view logger_name) {
+    auto logger = loggers_.find(logger_name).lock();
+    if (!logger) {
+      // Entry is expired or absent
+      loggers_.erase(logger_name);
     }
-    return it->second;
+    return logger;
   }
 
-  void LoggingSystem::setParentOfGroup(const std::shared_ptr<Group> &group,
-                                       const std::shared_ptr<Group> &parent) {
-    assert(group != nullptr);
+  void LoggingSystem::sweepLoggers(std::string_view logger_name) {
+    // Couple of entries per new logger is enough to keep number of expired
+    // ones below number of alive ones
+    constexpr size_t entries_per_sweep = 2;
+    loggers_.sweep(logger_name, entries_per_sweep,
+                   [](const auto &logger) { return logger.expired(); });
+  }
 
-    if (parent && parent->parent() == group) {
-      parent->unsetParentGroup();
-    }
-    group->setParentGroup(parent);
+  [[nodiscard]] std::shared_ptr<Sink> LoggingSystem::getSink(
+      std::string_view sink_name) const {
+    return sinks_.find(sink_name);
+  }
 
-    std::map<std::shared_ptr<const Group>, int> passed_groups;
+  [[nodiscard]] std::shared_ptr<Group> LoggingSystem::getGroup(
+      std::string_view group_name) const {
+    return groups_.find(group_name);
+  }
 
-    std::vector<std::set<std::shared_ptr<Group>>> affecting_groups;
+  void LoggingSystem::forEachSink(
+      const std::function<void(const std::shared_ptr<Sink> &)> &fn) const {
+    // Entities are collected first, so fn is called without locks
+    std::vector<std::shared_ptr<Sink>> sinks;
+    sinks_.forEach([&](const auto & /*name*/, const auto &sink) {
+      sinks.emplace_back(sink);
+    });
+    std::for_each(sinks.begin(), sinks.end(), fn);
+  }
 
-    std::function<int(const std::shared_ptr<const Group> &)> fn =
-        [&](const std::shared_ptr<const Group> &current) mutable -> int {
-      if (auto it = passed_groups.find(current); it != passed_groups.end()) {
-        return it->second;
-      }
-      if (current == group) {
-        return 0;
-      }
-      if (current->isLevelOverridden() && current->isSinkOverridden()) {
-        return -1;
-      }
-      if (!current->parent()) {
-        return -1;
-      }
-      auto n = fn(current->parent());
-      if (n == -1) {
-        return -1;
+  void LoggingSystem::forEachGroup(
+      const std::function<void(const std::shared_ptr<Group> &)> &fn) const {
+    std::vector<std::shared_ptr<Group>> groups;
+    groups_.forEach([&](const std::string &name, const auto &group) {
+      // Skip alias of fallback group
+      if (name != "*") {
+        groups.emplace_back(group);
       }
-      if (n >= affecting_groups.size()) {
-        affecting_groups.resize(n + 1);
+    });
+    std::for_each(groups.begin(), groups.end(), fn);
+  }
+
+  void LoggingSystem::forEachLogger(
+      const std::function<void(const std::shared_ptr<Logger> &)> &fn) const {
+    std::vector<std::shared_ptr<Logger>> loggers;
+    loggers_.forEach([&](const auto & /*name*/, const auto &weak_logger) {
+      if (auto logger = weak_logger.lock()) {
+        loggers.emplace_back(std::move(logger));
       }
-      affecting_groups[n].emplace(std::const_pointer_cast<Group>(current));
-      return ++n;
-    };
+    });
+    std::for_each(loggers.begin(), loggers.end(), fn);
+  }
 
+  LoggingSystem::Snapshot LoggingSystem::snapshot() const {
     std::lock_guard guard(mutex_);
+    Snapshot snapshot;
+    forEachGroup([&](const auto &group) {
+      const auto &parent = group->parent();
+      snapshot.groups.push_back({group->name(),
+                                 parent ? parent->name() : std::string{},
+                                 group->level(), group->sink()->name(),
+                                 !parent || group->isLevelOverridden(),
+                                 !parent || group->isSinkOverridden()});
+    });
+    forEachLogger([&](const auto &logger) {
+      snapshot.loggers.push_back(
+          {logger->name(), logger->group()->name(), logger->level(),
+           logger->sink()->name(), logger->isLevelOverridden(),
+           logger->isSinkOverridden()});
+    });
+    return snapshot;
+  }
 
-    for (const auto &it : groups_) {
-      auto n = fn(it.second);
-      passed_groups[it.second] = n;
-    }
+  void LoggingSystem::setParentOfGroup(const std::shared_ptr<Group> &group,
+                                       const std::shared_ptr<Group> &parent) {
+    assert(group != nullptr);
 
-    for (const auto &stage : std::move(affecting_groups)) {
-      for (const auto &changing_group : stage) {
-        changing_group->setParentGroup(changing_group->parent());
-      }
-    }
+    std::lock_guard guard(mutex_);
 
-    for (auto it = loggers_.begin(); it != loggers_.end();) {
-      if (auto logger = it->second.lock()) {
-        if (auto it2 = passed_groups.find(logger->group());
-            it2 != passed_groups.end()) {
-          if (it2->second != -1) {
-            logger->setGroup(logger->group());
-          }
-        }
-        ++it;
-      } else {
-        it = loggers_.erase(it);
-      }
+    if (parent && parent->parent() == group) {
+      parent->unsetParentGroup();
+      markEdited(parent, true);
     }
+    group->setParentGroup(parent);
+    markEdited(group, true);
   }
 
   void LoggingSystem::setSinkOfGroup(
@@ -229,137 +610,174 @@ namespace soralog {
       std::optional<std::shared_ptr<Sink>> sink) {
     assert(group != nullptr);
 
+    std::lock_guard guard(mutex_);
+
     if (sink) {
       group->setSink(*sink);
     } else {
       group->resetSink();
     }
+    markEdited(group, false);
+  }
 
-    std::map<std::shared_ptr<const Group>, int> passed_groups;
+  void LoggingSystem::setLevelOfGroup(const std::shared_ptr<Group> &group,
+                                      std::optional<Level> level) {
+    assert(group != nullptr);
 
-    std::vector<std::set<std::shared_ptr<Group>>> affecting_groups;
+    std::lock_guard guard(mutex_);
 
-    std::function<int(const std::shared_ptr<const Group> &)> fn =
-        [&](const std::shared_ptr<const Group> &current) mutable -> int {
-      if (auto it = passed_groups.find(current); it != passed_groups.end()) {
-        return it->second;
-      }
-      if (current == group) {
-        return 0;
-      }
-      if (current->isSinkOverridden()) {
-        return -1;
-      }
-      if (!current->parent()) {
-        return -1;
-      }
-      auto n = fn(current->parent());
-      if (n == -1) {
-        return -1;
-      }
-      if (n >= affecting_groups.size()) {
-        affecting_groups.resize(n + 1);
-      }
-      affecting_groups[n].emplace(std::const_pointer_cast<Group>(current));
-      return ++n;
-    };
+    if (level) {
+      group->setLevel(*level);
+    } else {
+      group->resetLevel();
+    }
+    markEdited(group, false);
+  }
 
+  void LoggingSystem::transaction(const std::function<void()> &edits) {
     std::lock_guard guard(mutex_);
 
-    for (const auto &it : groups_) {
-      auto n = fn(it.second);
-      passed_groups[it.second] = n;
+    ++transaction_depth_;
+    try {
+      edits();
+    } catch (...) {
+      // Edits done before exception are applied anyway
+      if (--transaction_depth_ == 0) {
+        propagateEdits();
+      }
+      throw;
     }
+    if (--transaction_depth_ == 0) {
+      propagateEdits();
+    }
+  }
 
-    for (const auto &stage : std::move(affecting_groups)) {
-      for (const auto &changing_group : stage) {
-        changing_group->setSinkFromGroup(changing_group->parent());
+  void LoggingSystem::markEdited(const std::shared_ptr<Group> &group,
+                                 bool reparented) {
+    auto &flag = edited_groups_[group];
+    flag = flag || reparented;
+    if (transaction_depth_ == 0) {
+      propagateEdits();
+    }
+  }
+
+  void LoggingSystem::propagateEdits() {
+    std::multimap<size_t, std::pair<std::shared_ptr<Group>, bool>> by_depth;
+    for (auto &[group, reparented] : edited_groups_) {
+      size_t depth = 0;
+      for (auto parent = group->parent(); parent; parent = parent->parent()) {
+        ++depth;
       }
+      by_depth.emplace(depth, std::make_pair(group, reparented));
+    }
+    edited_groups_.clear();
+
+    std::map<const Group *, bool> passed;
+    for (const auto &[depth, edit] : by_depth) {
+      propagate(edit.first, edit.second, passed);
     }
+  }
 
-    for (auto it = loggers_.begin(); it != loggers_.end();) {
-      if (auto logger = it->second.lock()) {
-        if (!logger->isSinkOverridden()) {
-          if (auto it2 = passed_groups.find(logger->group());
-              it2 != passed_groups.end()) {
-            if (it2->second != -1) {
-              logger->setSinkFromGroup(logger->group());
-            }
-          }
+  void LoggingSystem::propagate(const std::shared_ptr<Group> &group,
+                                bool reparented,
+                                std::map<const Group *, bool> &passed) {
+    if (auto [it, inserted] = passed.emplace(group.get(), reparented);
+        !inserted) {
+      if (it->second || !reparented) {
+        return;
+      }
+      it->second = true;
+    }
+
+    if (auto it = members_.find(group.get()); it != members_.end()) {
+      auto &loggers = it->second;
+      loggers.erase(std::remove_if(loggers.begin(), loggers.end(),
+                                   [&](const auto &weak_logger) {
+                                     auto logger = weak_logger.lock();
+                                     if (!logger || logger->group() != group) {
+                                       return true;
+                                     }
+                                     refreshLogger(*logger, reparented);
+                                     return false;
+                                   }),
+                    loggers.end());
+    }
+
+    if (auto it = children_.find(group.get()); it != children_.end()) {
+      auto &children = it->second;
+      children.erase(std::remove_if(children.begin(), children.end(),
+                                    [&](const auto &child) {
+                                      return child->parent() != group;
+                                    }),
+                     children.end());
+      for (const auto &child : std::vector(children)) {
+        if (reparented || !child->isLevelOverridden()
+            || !child->isSinkOverridden()) {
+          // Refreshes inherited properties
+          child->setParentGroup(group);
+          propagate(child, reparented, passed);
         }
-        ++it;
-      } else {
-        it = loggers_.erase(it);
       }
     }
   }
 
-  void LoggingSystem::setLevelOfGroup(const std::shared_ptr<Group> &group,
-                                      std::optional<Level> level) {
-    assert(group != nullptr);
-
-    if (level) {
-      group->setLevel(*level);
-    } else {
-      group->resetLevel();
+  void LoggingSystem::refreshLogger(Logger &logger, bool reparented) {
+    const auto &group = logger.group();
+    if (reparented) {
+      // Chain of groups is changed, so filter of sink is selected anew
+      logger.setGroup(group);
+      return;
     }
+    if (!logger.isLevelOverridden()) {
+      logger.setLevelFromGroup(group);
+    }
+    if (!logger.isSinkOverridden()) {
+      logger.setSinkFromGroup(group);
+    }
+  }
 
-    std::map<std::shared_ptr<const Group>, int> passed_groups;
-
-    std::vector<std::set<std::shared_ptr<Group>>> affecting_groups;
-
-    std::function<int(const std::shared_ptr<const Group> &)> fn =
-        [&](const std::shared_ptr<const Group> &current) mutable -> int {
-      if (auto it = passed_groups.find(current); it != passed_groups.end()) {
-        return it->second;
-      }
-      if (current == group) {
-        return 0;
+  void LoggingSystem::indexGroup(const std::shared_ptr<Group> &group) {
+    if (auto parent = group->parent()) {
+      auto &children = children_[parent.get()];
+      if (std::find(children.begin(), children.end(), group)
+          == children.end()) {
+        children.emplace_back(group);
       }
-      if (current->isLevelOverridden()) {
-        return -1;
-      }
-      if (!current->parent()) {
-        return -1;
-      }
-      auto n = fn(current->parent());
-      if (n == -1) {
-        return -1;
-      }
-      if (n >= affecting_groups.size()) {
-        affecting_groups.resize(n + 1);
-      }
-      affecting_groups[n].emplace(std::const_pointer_cast<Group>(current));
-      return ++n;
-    };
-
-    std::lock_guard guard(mutex_);
-
-    for (const auto &it : groups_) {
-      auto n = fn(it.second);
-      passed_groups[it.second] = n;
     }
+  }
 
-    for (const auto &stage : std::move(affecting_groups)) {
-      for (const auto &changing_group : stage) {
-        changing_group->setLevelFromGroup(changing_group->parent());
-      }
+  void LoggingSystem::indexLogger(const std::shared_ptr<Logger> &logger) {
+    auto &loggers = members_[logger->group().get()];
+    // Stale entries are dropped before list grows, so it isn't bloated by
+    // expired loggers
+    if (loggers.size() == loggers.capacity()) {
+      loggers.erase(std::remove_if(loggers.begin(), loggers.end(),
+                                   [&](const auto &weak_logger) {
+                                     auto member = weak_logger.lock();
+                                     return !member
+                                         || member->group()
+                                                != logger->group();
+                                   }),
+                    loggers.end());
+    }
+    loggers.emplace_back(logger);
+  }
+
+  void LoggingSystem::onParentOfGroupChanged(const Group &group) {
+    std::lock_guard guard(mutex_);
+    // Groups which aren't registered in system are ignored
+    if (auto registered = groups_.find(group.name());
+        registered.get() == &group) {
+      indexGroup(registered);
     }
+  }
 
-    for (auto it = loggers_.begin(); it != loggers_.end();) {
-      if (auto logger = it->second.lock()) {
-        if (!logger->isLevelOverridden()) {
-          if (auto it2 = passed_groups.find(logger->group());
-              it2 != passed_groups.end()) {
-            if (it2->second != -1) {
-              logger->setLevelFromGroup(logger->group());
-            }
-          }
-        }
-        ++it;
-      } else {
-        it = loggers_.erase(it);
-      }
+  void LoggingSystem::onGroupOfLoggerChanged(const Logger &logger) {
+    std::lock_guard guard(mutex_);
+    // Loggers which aren't registered in system are ignored
+    if (auto registered = loggers_.find(logger.name()).lock();
+        registered.get() == &logger) {
+      indexLogger(registered);
     }
   }
 
@@ -388,17 +806,15 @@ namespace soralog {
                                        const std::string &parent_name) {
     std::lock_guard guard(mutex_);
 
-    auto it1 = groups_.find(group_name);
-    if (it1 == groups_.end()) {
+    auto group = groups_.find(group_name);
+    if (!group) {
       return false;
     }
-    auto &group = it1->second;
 
-    auto it2 = groups_.find(parent_name);
-    if (it2 == groups_.end()) {
+    auto parent = groups_.find(parent_name);
+    if (!parent) {
       return false;
     }
-    auto &parent = it2->second;
 
     // Check for recursion
     if (parent->parent() != group) {
@@ -418,11 +834,10 @@ namespace soralog {
   bool LoggingSystem::unsetParentOfGroup(const std::string &group_name) {
     std::lock_guard guard(mutex_);
 
-    auto it = groups_.find(group_name);
-    if (it == groups_.end()) {
+    auto group = groups_.find(group_name);
+    if (!group) {
       return false;
     }
-    auto &group = it->second;
 
     setParentOfGroup(group, {});
     return true;
@@ -435,8 +850,7 @@ namespace soralog {
     if (!sink) {
       return false;
     }
-    if (auto it = groups_.find(group_name); it != groups_.end()) {
-      auto &group = it->second;
+    if (auto group = groups_.find(group_name)) {
       setSinkOfGroup(group, std::move(sink));
       return true;
     }
@@ -446,8 +860,7 @@ namespace soralog {
   bool LoggingSystem::resetSinkOfGroup(const std::string &group_name) {
     std::lock_guard guard(mutex_);
 
-    if (auto it = groups_.find(group_name); it != groups_.end()) {
-      auto &group = it->second;
+    if (auto group = groups_.find(group_name)) {
       setSinkOfGroup(group, {});
       return true;
     }
@@ -457,8 +870,7 @@ namespace soralog {
   bool LoggingSystem::setLevelOfGroup(const std::string &group_name,
                                       Level level) {
     std::lock_guard guard(mutex_);
-    if (auto it = groups_.find(group_name); it != groups_.end()) {
-      auto &group = it->second;
+    if (auto group = groups_.find(group_name)) {
       setLevelOfGroup(group, level);
       return true;
     }
@@ -467,8 +879,7 @@ namespace soralog {
 
   bool LoggingSystem::resetLevelOfGroup(const std::string &group_name) {
     std::lock_guard guard(mutex_);
-    if (auto it = groups_.find(group_name); it != groups_.end()) {
-      auto &group = it->second;
+    if (auto group = groups_.find(group_name)) {
       setLevelOfGroup(group, {});
       return true;
     }
@@ -479,12 +890,9 @@ namespace soralog {
                                        const std::string &group_name) {
     std::lock_guard guard(mutex_);
     if (auto group = getGroup(group_name)) {
-      if (auto it = loggers_.find(logger_name); it != loggers_.end()) {
-        if (auto logger = it->second.lock()) {
-          logger->setGroup(std::move(group));
-          return true;
-        }
-        loggers_.erase(it);
+      if (auto logger = findLogger(logger_name)) {
+        logger->setGroup(std::move(group));
+        return true;
       }
     }
     return false;
@@ -494,12 +902,9 @@ namespace soralog {
                                       const std::string &sink_name) {
     std::lock_guard guard(mutex_);
     if (auto sink = getSink(sink_name)) {
-      if (auto it = loggers_.find(logger_name); it != loggers_.end()) {
-        if (auto logger = it->second.lock()) {
-          logger->setSink(std::move(sink));
-          return true;
-        }
-        loggers_.erase(it);
+      if (auto logger = findLogger(logger_name)) {
+        logger->setSink(std::move(sink));
+        return true;
       }
     }
     return false;
@@ -507,11 +912,9 @@ namespace soralog {
 
   bool LoggingSystem::resetSinkOfLogger(const std::string &logger_name) {
     std::lock_guard guard(mutex_);
-    if (auto it = loggers_.find(logger_name); it != loggers_.end()) {
-      if (auto logger = it->second.lock()) {
-        logger->setSinkFromGroup(logger->group());
-        return true;
-      }
+    if (auto logger = findLogger(logger_name)) {
+      logger->setSinkFromGroup(logger->group());
+      return true;
     }
     return false;
   }
@@ -519,24 +922,18 @@ namespace soralog {
   bool LoggingSystem::setLevelOfLogger(const std::string &logger_name,
                                        Level level) {
     std::lock_guard guard(mutex_);
-    if (auto it = loggers_.find(logger_name); it != loggers_.end()) {
-      if (auto logger = it->second.lock()) {
-        logger->setLevel(level);
-        return true;
-      }
-      loggers_.erase(it);
+    if (auto logger = findLogger(logger_name)) {
+      logger->setLevel(level);
+      return true;
     }
     return false;
   }
 
   bool LoggingSystem::resetLevelOfLogger(const std::string &logger_name) {
     std::lock_guard guard(mutex_);
-    if (auto it = loggers_.find(logger_name); it != loggers_.end()) {
-      if (auto logger = it->second.lock()) {
-        logger->setLevelFromGroup(logger->group());
-        return true;
-      }
-      loggers_.erase(it);
+    if (auto logger = findLogger(logger_name)) {
+      logger->setLevelFromGroup(logger->group());
+      return true;
     }
     return false;
   }
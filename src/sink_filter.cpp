@@ -0,0 +1,133 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/sink_filter.hpp>
+
+#include <algorithm>
+#include <regex>
+#include <stdexcept>
+
+namespace soralog {
+
+  struct SinkFilter::CompiledRule {
+    Rule rule;
+    std::optional<std::regex> regex;
+
+    bool hasMessageChecks() const noexcept {
+      return !rule.contains.empty() || regex.has_value();
+    }
+  };
+
+  SinkFilter::~SinkFilter() = default;
+
+  SinkFilter::SinkFilter(std::vector<Rule> rules) {
+    if (rules.empty()) {
+      throw std::invalid_argument("filter has no rules");
+    }
+    if (rules.size() > max_rules) {
+      throw std::invalid_argument("filter has more than "
+                                  + std::to_string(max_rules) + " rules");
+    }
+    rules_.reserve(rules.size());
+    for (auto &rule : rules) {
+      std::optional<std::regex> regex;
+      if (rule.regex) {
+        try {
+          regex.emplace(*rule.regex, std::regex::ECMAScript);
+        } catch (const std::regex_error &exception) {
+          throw std::invalid_argument("malformed regex '" + *rule.regex
+                                      + "': " + exception.what());
+        }
+      }
+      rules_.push_back(CompiledRule{std::move(rule), std::move(regex)});
+    }
+  }
+
+  SinkFilter::Selection SinkFilter::select(
+      std::string_view logger_name,
+      const std::vector<std::string_view> &group_names) const {
+    auto matches_any = [](const std::vector<std::string> &globs,
+                          std::string_view name) {
+      return std::any_of(globs.begin(), globs.end(), [&](const auto &glob) {
+        return matchGlob(glob, name);
+      });
+    };
+
+    Selection selection{Level::OFF, Level::OFF, 0};
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      const auto &rule = rules_[i].rule;
+      if (!rule.loggers.empty() && !matches_any(rule.loggers, logger_name)) {
+        continue;
+      }
+      if (!rule.groups.empty()
+          && std::none_of(group_names.begin(), group_names.end(),
+                          [&](auto group_name) {
+                            return matches_any(rule.groups, group_name);
+                          })) {
+        continue;
+      }
+      selection.level = std::max(selection.level, rule.level);
+      if (rules_[i].hasMessageChecks()) {
+        selection.rules |= uint64_t(1) << i;
+      } else {
+        selection.plain_level = std::max(selection.plain_level, rule.level);
+      }
+    }
+    return selection;
+  }
+
+  bool SinkFilter::acceptsMessage(const Selection &selection, Level level,
+                                  std::string_view message) const {
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      if ((selection.rules & (uint64_t(1) << i)) == 0) {
+        continue;
+      }
+      const auto &[rule, regex] = rules_[i];
+      if (rule.level < level) {
+        continue;
+      }
+      if (std::any_of(rule.contains.begin(), rule.contains.end(),
+                      [&](const auto &substring) {
+                        return message.find(substring)
+                            == std::string_view::npos;
+                      })) {
+        continue;
+      }
+      if (regex
+          && !std::regex_search(message.begin(), message.end(), *regex)) {
+        continue;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool SinkFilter::matchGlob(std::string_view glob,
+                             std::string_view text) noexcept {
+    size_t g = 0;
+    size_t t = 0;
+    // Position after last '*' and text position it is tried to stop at
+    std::optional<std::pair<size_t, size_t>> star;
+    while (t < text.size()) {
+      if (g < glob.size() && glob[g] == '*') {
+        star.emplace(++g, t);
+      } else if (g < glob.size() && (glob[g] == '?' || glob[g] == text[t])) {
+        ++g;
+        ++t;
+      } else if (star) {
+        // Let last '*' consume one more char
+        g = star->first;
+        t = ++star->second;
+      } else {
+        return false;
+      }
+    }
+    while (g < glob.size() && glob[g] == '*') {
+      ++g;
+    }
+    return g == glob.size();
+  }
+
+}  // namespace soralog
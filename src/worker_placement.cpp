@@ -0,0 +1,191 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/worker_placement.hpp>
+
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace soralog {
+
+  namespace {
+
+    /// Upper bound of number of CPU in list, to not make huge lists by typo
+    constexpr unsigned max_cpu = 8191;
+
+    void warn(const char *what, std::string_view worker_name, int error) {
+      std::cerr << "Can't set " << what << " of worker '" << worker_name
+                << "': " << std::strerror(error) << "\n";
+    }
+
+#if defined(__linux__)
+    /// Number of NUMA nodes in mask passed to kernel
+    constexpr unsigned max_numa_nodes = 1024;
+
+    using NodeMask =
+        std::array<unsigned long,  // NOLINT(google-runtime-int)
+                   max_numa_nodes / (sizeof(unsigned long) * CHAR_BIT)>;
+
+    /**
+     * @returns false if {@param node} doesn't fit to {@param mask}
+     */
+    bool makeNodeMask(unsigned node, NodeMask &mask) {
+      if (node >= max_numa_nodes) {
+        return false;
+      }
+      const auto bits = sizeof(unsigned long) * CHAR_BIT;
+      mask[node / bits] |= 1UL << (node % bits);  // NOLINT
+      return true;
+    }
+
+    /**
+     * @returns CPUs of NUMA {@param node}, or nullopt if there is no such
+     * node
+     */
+    std::optional<std::vector<unsigned>> cpusOfNode(unsigned node) {
+      std::ifstream file("/sys/devices/system/node/node"
+                         + std::to_string(node) + "/cpulist");
+      std::string list;
+      if (!std::getline(file, list)) {
+        return std::nullopt;
+      }
+      return WorkerPlacement::parseCpuList(list);
+    }
+#endif
+
+  }  // namespace
+
+  void WorkerPlacement::applyToCurrentThread(
+      std::string_view worker_name) const noexcept {
+#if defined(__linux__)
+    auto cpus = this->cpus;
+    if (cpus.empty() && numa_node) {
+      if (auto node_cpus = cpusOfNode(*numa_node)) {
+        cpus = std::move(*node_cpus);
+      } else {
+        warn("CPUs of NUMA node", worker_name, ENOENT);
+      }
+    }
+    if (!cpus.empty()) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+          CPU_SET(cpu, &set);
+        }
+      }
+      if (auto error =
+              ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set)) {
+        warn("CPU affinity", worker_name, error);
+      }
+    }
+
+    if (policy != Policy::NORMAL) {
+      sched_param param{};
+      if (auto error = ::pthread_setschedparam(
+              ::pthread_self(),
+              policy == Policy::BATCH ? SCHED_BATCH : SCHED_IDLE, &param)) {
+        warn("scheduling policy", worker_name, error);
+      }
+    }
+
+    if (nice) {
+      // On Linux niceness is attribute of thread, not whole process
+      if (::setpriority(PRIO_PROCESS,
+                        static_cast<id_t>(::syscall(SYS_gettid)), *nice)
+          != 0) {
+        warn("niceness", worker_name, errno);
+      }
+    }
+
+    if (numa_node) {
+      // Memory allocated by worker itself is taken from its node too
+      NodeMask mask{};
+      if (!makeNodeMask(*numa_node, mask)
+          || ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.data(),
+                       max_numa_nodes + 1)
+                 != 0) {
+        warn("NUMA memory policy", worker_name,
+             *numa_node >= max_numa_nodes ? EINVAL : errno);
+      }
+    }
+#endif
+  }
+
+  void WorkerPlacement::bindMemory(
+      const void *data, size_t size,
+      std::string_view worker_name) const noexcept {
+#if defined(__linux__)
+    if (!numa_node || data == nullptr) {
+      return;
+    }
+    const auto page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<uintptr_t>(data);
+    const auto first = (begin + page - 1) / page * page;
+    const auto last = (begin + size) / page * page;
+    if (last <= first) {
+      return;
+    }
+    NodeMask mask{};
+    if (!makeNodeMask(*numa_node, mask)
+        || ::syscall(SYS_mbind, first, last - first, MPOL_BIND, mask.data(),
+                     max_numa_nodes + 1, MPOL_MF_MOVE)
+               != 0) {
+      warn("NUMA node of queue", worker_name,
+           *numa_node >= max_numa_nodes ? EINVAL : errno);
+    }
+#endif
+  }
+
+  std::optional<std::vector<unsigned>> WorkerPlacement::parseCpuList(
+      std::string_view list) {
+    auto parseNumber = [](std::string_view text) -> std::optional<unsigned> {
+      unsigned value = 0;
+      auto end = text.data() + text.size();
+      auto [ptr, error] = std::from_chars(text.data(), end, value);
+      if (error != std::errc() || ptr != end || value > max_cpu) {
+        return std::nullopt;
+      }
+      return value;
+    };
+
+    std::vector<unsigned> cpus;
+    while (true) {
+      auto comma = list.find(',');
+      auto item = list.substr(0, comma);
+      auto dash = item.find('-');
+      auto first = parseNumber(item.substr(0, dash));
+      auto last = dash == std::string_view::npos
+                    ? first
+                    : parseNumber(item.substr(dash + 1));
+      if (!first || !last || *first > *last) {
+        return std::nullopt;
+      }
+      for (auto cpu = *first; cpu <= *last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+      if (comma == std::string_view::npos) {
+        return cpus;
+      }
+      list.remove_prefix(comma + 1);
+    }
+  }
+
+}  // namespace soralog
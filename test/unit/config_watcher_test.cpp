@@ -0,0 +1,177 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "soralog/group.hpp"
+#include "soralog/impl/config_watcher.hpp"
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class ConfigWatcherTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    dir_ = filename.data();
+    std::filesystem::create_directories(dir_);
+    config_ = dir_ / "logging.yaml";
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(dir_);
+  }
+
+  /**
+   * Rewrites config by {@param content}
+   */
+  void writeConfig(const std::string &content) {
+    std::ofstream(config_) << content;
+  }
+
+  /**
+   * @returns config with file sink writing into {@param log}, group 'main'
+   * of {@param level}, and {@param extra} lines of sinks
+   */
+  std::string makeConfig(const std::string &log, const std::string &level,
+                         const std::string &extra = "") {
+    return R"(
+sinks:
+  - name: console
+    type: console
+  - name: file
+    type: file
+    path: )"
+        + (dir_ / log).string() + R"(
+    latency: 1000000
+)" + extra
+        + R"(
+groups:
+  - name: main
+    sink: console
+    level: )"
+        + level + R"(
+    children:
+      - name: storage
+        sink: file
+      - name: network
+)";
+  }
+
+  std::string read(const std::string &log) {
+    std::ifstream file(dir_ / log);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+  }
+
+  std::filesystem::path dir_;
+  std::filesystem::path config_;
+};
+
+/**
+ * @given system configured by YAML file
+ * @when file is changed and system is reconfigured
+ * @then unchanged sink is kept, changed sink is replaced and loggers use new
+ * one, disappeared sink is retired, levels are updated; events queued in
+ * replaced sinks are written
+ */
+TEST_F(ConfigWatcherTest, Reload) {
+  writeConfig(makeConfig("a.log", "info",
+                         "  - name: extra\n    type: console\n"));
+  LoggingSystem system(std::make_shared<ConfiguratorFromYAML>(config_));
+  auto result = system.configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+
+  auto console = system.getSink("console");
+  auto file = system.getSink("file");
+  auto storage = system.getLogger("storage", "storage");
+  auto network = system.getLogger("network", "network");
+  auto custom = system.getLogger("custom", "main", "extra");
+  storage->info("before reload");
+  EXPECT_EQ(network->level(), Level::INFO);
+
+  writeConfig(makeConfig("b.log", "warning"));
+  result = system.reconfigure();
+  ASSERT_FALSE(result.has_error) << result.message;
+  EXPECT_FALSE(result.has_warning) << result.message;
+
+  EXPECT_EQ(system.getSink("console"), console);
+  EXPECT_NE(system.getSink("file"), file);
+  EXPECT_EQ(system.getSink("extra"), nullptr);
+
+  EXPECT_EQ(storage->sink(), system.getSink("file"));
+  EXPECT_EQ(custom->sink(), console);
+  EXPECT_FALSE(custom->isSinkOverridden());
+  EXPECT_EQ(network->level(), Level::WARN);
+
+  storage->warn("after reload");
+  file.reset();
+  EXPECT_NE(read("a.log").find("before reload"), std::string::npos);
+
+  // Config which can't be loaded changes nothing
+  writeConfig("groups: [");
+  auto new_file = system.getSink("file");
+  result = system.reconfigure();
+  EXPECT_TRUE(result.has_error);
+  EXPECT_EQ(system.getSink("file"), new_file);
+
+  // Dropped sink of group is replaced by sink of parent
+  writeConfig(R"(
+sinks:
+  - name: console
+    type: console
+groups:
+  - name: main
+    sink: console
+    level: warning
+    children:
+      - name: storage
+      - name: network
+)");
+  result = system.reconfigure();
+  ASSERT_FALSE(result.has_error) << result.message;
+  EXPECT_EQ(system.getSink("console"), console);
+  EXPECT_EQ(system.getSink("file"), nullptr);
+  EXPECT_EQ(storage->sink(), console);
+  new_file.reset();
+  EXPECT_NE(read("b.log").find("after reload"), std::string::npos);
+}
+
+/**
+ * @given system configured by YAML file, and watcher of that file
+ * @when file is rewritten
+ * @then system is reconfigured
+ */
+TEST_F(ConfigWatcherTest, Watch) {
+  writeConfig(makeConfig("a.log", "info"));
+  LoggingSystem system(std::make_shared<ConfiguratorFromYAML>(config_));
+  auto result = system.configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+  auto network = system.getLogger("network", "network");
+  auto console = system.getSink("console");
+
+  bool reload_failed = false;
+  ConfigWatcher watcher(system, config_, [&](const auto &result) {
+    reload_failed = result.has_error;
+  });
+
+  writeConfig(makeConfig("a.log", "error"));
+  for (auto i = 0; i < 500 && watcher.reloads() == 0; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_NE(watcher.reloads(), 0);
+  EXPECT_FALSE(reload_failed);
+  EXPECT_EQ(network->level(), Level::ERROR_);
+  EXPECT_EQ(system.getSink("console"), console);
+}
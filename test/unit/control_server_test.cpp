@@ -0,0 +1,206 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+
+#include "soralog/group.hpp"
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/impl/control_server.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+class ControlServerTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    path_ = filename.data();
+
+    system_ =
+        std::make_shared<LoggingSystem>(std::make_shared<ConfiguratorFromYAML>(
+            std::string(R"(
+sinks:
+  - name: console
+    type: console
+    capacity: 64
+  - name: other
+    type: console
+groups:
+  - name: main
+    sink: console
+    level: info
+    children:
+      - name: network
+        level: debug
+      - name: storage
+        sink: other
+)")));
+    auto result = system_->configure();
+    ASSERT_FALSE(result.has_error) << result.message;
+  }
+  void TearDown() override {
+    std::filesystem::remove(path_);
+  }
+
+  /**
+   * @returns descriptor of connection to control socket
+   */
+  int connect() {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_GE(fd, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path));
+    EXPECT_EQ(::connect(fd, reinterpret_cast<sockaddr *>(&address),
+                        sizeof(address)),
+              0);
+    return fd;
+  }
+
+  /**
+   * @returns everything read from {@param fd} till it's closed by peer
+   */
+  static std::string readAll(int fd) {
+    std::string data;
+    char chunk[256];
+    for (ssize_t n; (n = ::read(fd, chunk, sizeof(chunk))) > 0;) {
+      data.append(chunk, n);
+    }
+    return data;
+  }
+
+  std::filesystem::path path_;
+  std::shared_ptr<LoggingSystem> system_;
+};
+
+/**
+ * @given control server of configured system
+ * @when commands are executed
+ * @then entities are listed, and levels are changed
+ */
+TEST_F(ControlServerTest, Execute) {
+  ControlServer server(*system_, path_);
+  auto peer = system_->getLogger("peer", "network");
+  auto db = system_->getLogger("db", "storage", "console", Level::ERROR_);
+
+  EXPECT_EQ(server.execute("groups"),
+            "group main parent=- level=info sink=console\n"
+            "group network parent=main level=debug sink=console "
+            "inherited=sink\n"
+            "group storage parent=main level=info sink=other "
+            "inherited=level\n"
+            "OK\n");
+  EXPECT_EQ(server.execute("loggers"),
+            "logger db group=storage level=error sink=console\n"
+            "logger peer group=network level=debug sink=console "
+            "inherited=level,sink\n"
+            "OK\n");
+  EXPECT_EQ(server.execute(" sinks \r").rfind("sink * events=", 0), 0);
+  EXPECT_NE(server.execute("sinks").find("\nsink console events=0/64 "),
+            std::string::npos);
+
+  EXPECT_EQ(server.execute("level group network warn"), "OK\n");
+  EXPECT_EQ(peer->level(), Level::WARN);
+  EXPECT_EQ(server.execute("level group network reset"), "OK\n");
+  EXPECT_EQ(peer->level(), Level::INFO);
+  EXPECT_EQ(server.execute("level logger db reset"), "OK\n");
+  EXPECT_EQ(db->level(), Level::INFO);
+
+  EXPECT_EQ(server.execute("flush"), "OK\n");
+  EXPECT_EQ(server.execute("rotate console"), "OK\n");
+
+  EXPECT_EQ(server.execute("level group absent info"),
+            "ERROR unknown group 'absent'\n");
+  EXPECT_EQ(server.execute("level logger db loud"),
+            "ERROR unknown level 'loud'\n");
+  EXPECT_EQ(server.execute("flush absent"), "ERROR unknown sink 'absent'\n");
+  EXPECT_EQ(server.execute("groups all"),
+            "ERROR unknown command or wrong arguments: 'groups'\n");
+  EXPECT_EQ(server.execute(""), "ERROR empty command\n");
+}
+
+/**
+ * @given control server of configured system
+ * @when client sends commands by socket
+ * @then it gets replies
+ */
+TEST_F(ControlServerTest, Socket) {
+  ControlServer server(*system_, path_);
+
+  int fd = connect();
+
+  // Commands might be sent at once
+  const std::string request = "level group main error\nbad\n";
+  ASSERT_EQ(::write(fd, request.data(), request.size()), request.size());
+
+  const std::string expected =
+      "OK\nERROR unknown command or wrong arguments: 'bad'\n";
+  std::string reply;
+  while (reply.size() < expected.size()) {
+    char chunk[256];
+    auto n = ::read(fd, chunk, sizeof(chunk));
+    ASSERT_GT(n, 0);
+    reply.append(chunk, n);
+  }
+  EXPECT_EQ(reply, expected);
+  EXPECT_EQ(system_->getGroup("main")->level(), Level::ERROR_);
+  ::close(fd);
+}
+
+/**
+ * @given path of control socket
+ * @when server listens it
+ * @then socket is accessible by owner only; other file at that path is not
+ * replaced
+ */
+TEST_F(ControlServerTest, SocketFile) {
+  {
+    ControlServer server(*system_, path_);
+    struct stat st {};
+    ASSERT_EQ(::lstat(path_.c_str(), &st), 0);
+    EXPECT_TRUE(S_ISSOCK(st.st_mode));
+    EXPECT_EQ(st.st_mode & 0777, S_IRUSR | S_IWUSR);
+  }
+
+  std::ofstream(path_) << "data";
+  EXPECT_THROW(ControlServer(*system_, path_), std::system_error);
+  std::ifstream file(path_);
+  std::string content;
+  EXPECT_TRUE(std::getline(file, content));
+  EXPECT_EQ(content, "data");
+}
+
+/**
+ * @given control server with short client timeout
+ * @when client connects and sends nothing
+ * @then it is disconnected after timeout, and next client is served
+ */
+TEST_F(ControlServerTest, SilentClient) {
+  ControlServer server(*system_, path_, std::chrono::milliseconds(100));
+
+  int silent = connect();
+  int other = connect();
+  const std::string request = "help\n";
+  ASSERT_EQ(::write(other, request.data(), request.size()), request.size());
+
+  EXPECT_EQ(readAll(silent), "ERROR timeout\n");
+  ::close(silent);
+
+  ::shutdown(other, SHUT_WR);
+  auto reply = readAll(other);
+  EXPECT_EQ(reply.substr(reply.size() - 3), "OK\n");
+  ::close(other);
+}
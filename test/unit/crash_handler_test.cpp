@@ -0,0 +1,278 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <fstream>
+
+#include <zlib.h>
+
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace {
+  /// Value whose formatting crashes
+  struct Crashing {};
+}  // namespace
+
+template <>
+struct fmt::formatter<Crashing> : fmt::formatter<std::string_view> {
+  template <typename FormatContext>
+  auto format(const Crashing & /*value*/, FormatContext &ctx) const {
+    ::raise(SIGSEGV);
+    return ctx.out();
+  }
+};
+
+class CrashHandlerTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    dir_ = filename.data();
+    std::filesystem::create_directories(dir_);
+    path_ = dir_ / "crash.log";
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(dir_);
+  }
+
+  /**
+   * Runs {@param fn} in child process with logging system writing into file
+   * with very big latency (so events are kept in queue), and crash handler
+   * @returns status of child
+   */
+  template <typename Fn>
+  int runChild(const std::string &extra_config,
+               std::chrono::milliseconds budget, const Fn &fn) {
+    auto pid = ::fork();
+    if (pid == 0) {
+      LoggingSystem system(std::make_shared<ConfiguratorFromYAML>(
+          std::string(R"(
+sinks:
+  - name: file
+    type: file
+    path: )") + path_.string()
+          + R"(
+    thread: name
+    latency: 1000000
+)" + extra_config + R"(
+groups:
+  - name: main
+    sink: file
+    level: trace
+)"));
+      if (system.configure().has_error
+          || !system.installCrashHandler(budget)) {
+        ::_exit(EXIT_FAILURE);
+      }
+      auto logger = system.getLogger("crasher", "main");
+      fn(*logger);
+      ::_exit(EXIT_SUCCESS);  // must not be reached
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return status;
+  }
+
+  static std::vector<std::string> split(const std::string &content) {
+    std::vector<std::string> lines;
+    std::istringstream in(content);
+    for (std::string line; std::getline(in, line);) {
+      lines.emplace_back(std::move(line));
+    }
+    return lines;
+  }
+
+  std::string read() const {
+    std::ifstream in(path_);
+    return {std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>()};
+  }
+
+  std::string readGzip() const {
+    std::string content;
+    gzFile in = gzopen(path_.c_str(), "rb");
+    std::array<char, 4096> buff{};
+    int size;
+    while ((size = gzread(in, buff.data(), buff.size())) > 0) {
+      content.append(buff.data(), size);
+    }
+    gzclose(in);
+    return content;
+  }
+
+ protected:
+  std::filesystem::path dir_;
+  std::filesystem::path path_;
+};
+
+/**
+ * @given Process with crash handler and file sink keeping events in queue
+ * @when Process aborts
+ * @then Events of queue are written into file in regular layout, and
+ * process is terminated by the same signal
+ */
+TEST_F(CrashHandlerTest, DrainsQueueOnAbort) {
+  auto status = runChild("", 1s, [](Logger &logger) {
+    for (int i = 0; i < 100; ++i) {
+      logger.info("message #{}", i);
+    }
+    std::abort();
+  });
+  ASSERT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(WTERMSIG(status), SIGABRT);
+
+  auto lines = split(read());
+  ASSERT_EQ(lines.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_NE(lines[i].find(fmt::format("Info      crasher  message #{}", i)),
+              std::string::npos)
+        << lines[i];
+  }
+  // Layout: "YY.MM.DD hh:mm:ss.uuuuuu  <thread name>  ..."
+  EXPECT_EQ(lines[0][2], '.');
+  EXPECT_EQ(lines[0][17], '.');
+  EXPECT_EQ(lines[0].substr(24, 2), "  ");
+}
+
+/**
+ * @given Process with crash handler and file sink of JSON layout
+ * @when Process aborts
+ * @then Drained events are written as JSON lines too
+ */
+TEST_F(CrashHandlerTest, DrainsIntoJsonFile) {
+  auto status = runChild("    layout: json\n", 1s, [](Logger &logger) {
+    logger.info("say \"{}\"", "bye");
+    std::abort();
+  });
+  ASSERT_TRUE(WIFSIGNALED(status));
+
+  auto lines = split(read());
+  ASSERT_EQ(lines.size(), 1);
+  // {"timestamp":"YYYY-MM-DDThh:mm:ss.uuuuuuZ","level":...
+  EXPECT_EQ(lines[0].substr(0, 14), R"({"timestamp":")");
+  EXPECT_EQ(lines[0].substr(24, 1), "T");
+  EXPECT_EQ(lines[0].substr(40, 10), R"(Z","level")");
+  EXPECT_NE(lines[0].find(R"("logger":"crasher","message":"say \"bye\""})"),
+            std::string::npos)
+      << lines[0];
+}
+
+/**
+ * @given Process with crash handler and gzip-compressed file sink
+ * @when Process is crashed by segmentation fault
+ * @then Drained events are appended as gzip member, and file is decodable
+ */
+TEST_F(CrashHandlerTest, DrainsIntoCompressedFile) {
+  auto status = runChild("    compress: gzip\n", 1s, [](Logger &logger) {
+    for (int i = 0; i < 10; ++i) {
+      logger.warn("message #{}", i);
+    }
+    ::raise(SIGSEGV);
+  });
+  ASSERT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(WTERMSIG(status), SIGSEGV);
+
+  auto lines = split(readGzip());
+  ASSERT_EQ(lines.size(), 10);
+  EXPECT_NE(lines[9].find("message #9"), std::string::npos) << lines[9];
+}
+
+/**
+ * @given Process with crash handler, whose log file can't be written
+ * (replaced by FIFO without reader, so opening blocks forever)
+ * @when Process crashes
+ * @then Process is terminated by original signal within time budget
+ */
+TEST_F(CrashHandlerTest, WedgedDiskDoesNotHangCrash) {
+  auto started = std::chrono::steady_clock::now();
+  auto status = runChild("", 100ms, [&](Logger &logger) {
+    logger.info("message");
+    std::filesystem::remove(path_);
+    ::mkfifo(path_.c_str(), 0600);
+    ::raise(SIGBUS);
+  });
+  ASSERT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(WTERMSIG(status), SIGBUS);
+  EXPECT_LT(std::chrono::steady_clock::now() - started, 5s);
+}
+
+/**
+ * @given Process with crash handler and sink which isn't used by any logger
+ * @when Sink is removed, and then process crashes
+ * @then Sink is destroyed once it is removed (snapshot of sinks of crash
+ * handler doesn't keep it), and crash is handled by actual snapshot
+ */
+TEST_F(CrashHandlerTest, ReleasesRemovedSinks) {
+  auto pid = ::fork();
+  if (pid == 0) {
+    LoggingSystem system(std::make_shared<ConfiguratorFromYAML>(
+        std::string(R"(
+sinks:
+  - name: file
+    type: file
+    path: )") + path_.string()
+        + R"(
+    latency: 1000000
+  - name: spare
+    type: file
+    path: )" + (dir_ / "spare.log").string()
+        + R"(
+groups:
+  - name: main
+    sink: file
+    level: trace
+)"));
+    if (system.configure().has_error || !system.installCrashHandler(1s)) {
+      ::_exit(EXIT_FAILURE);
+    }
+    std::weak_ptr<Sink> spare = system.getSink("spare");
+    if (!system.removeSink("spare") || !spare.expired()) {
+      ::_exit(EXIT_FAILURE);
+    }
+    system.getLogger("crasher", "main")->info("message");
+    std::abort();
+  }
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  ASSERT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(WTERMSIG(status), SIGABRT);
+  EXPECT_NE(read().find("message"), std::string::npos);
+}
+
+/**
+ * @given Process with crash handler and file sink keeping events in queue
+ * @when Process crashes while event is being formatted in slot of queue
+ * @then Events queued before it are written, and handler doesn't wait for
+ * that slot till backstop alarm
+ */
+TEST_F(CrashHandlerTest, CrashInFormatter) {
+  auto started = std::chrono::steady_clock::now();
+  auto status = runChild("", 2s, [](Logger &logger) {
+    for (int i = 0; i < 10; ++i) {
+      logger.info("message #{}", i);
+    }
+    logger.info("crashing {}", Crashing{});
+  });
+  ASSERT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(WTERMSIG(status), SIGSEGV);
+  // Backstop alarm would come in 3 seconds
+  EXPECT_LT(std::chrono::steady_clock::now() - started, 2s);
+
+  auto lines = split(read());
+  ASSERT_EQ(lines.size(), 10);
+  EXPECT_NE(lines[9].find("message #9"), std::string::npos) << lines[9];
+}
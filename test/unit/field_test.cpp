@@ -0,0 +1,174 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <soralog/sink.hpp>
+#include <soralog/macro.hpp>
+
+using namespace soralog;
+using namespace testing;
+
+namespace {
+  struct Point {
+    int x;
+    int y;
+  };
+}  // namespace
+
+template <>
+struct fmt::formatter<Point> : fmt::formatter<std::string_view> {
+  template <typename FormatContext>
+  auto format(const Point &point, FormatContext &ctx) const {
+    return fmt::format_to(ctx.out(), "({}, {})", point.x, point.y);
+  }
+};
+
+class FieldTest : public ::testing::Test {
+ public:
+  struct FakeLogger {
+    template <typename... Args>
+    void log(Level lvl, std::string_view format, const Args &... args) {
+      Event event("logger", Sink::ThreadInfoType::NONE, lvl, format, args...);
+      last_message = event.message();
+      last_fields = text(event.fields());
+    }
+    static Level level() {
+      return Level::INFO;
+    }
+    std::string last_message{};
+    std::string last_fields{};
+  };
+
+  static std::string text(const Fields &fields) {
+    std::string result(Fields::maxTextSize(fields.data().size()), '\0');
+    char *ptr = result.data();
+    fields.putText(ptr);
+    result.resize(ptr - result.data());
+    return result;
+  }
+};
+
+/**
+ * @given fields of different types
+ * @when they are encoded and decoded back
+ * @then each field keeps its key, type and value
+ */
+TEST_F(FieldTest, RoundTrip) {
+  std::array<char, 256> buffer{};
+  char *ptr = buffer.data();
+  const char *end = buffer.data() + buffer.size();
+  const std::string str = "string";
+  Fields::put(ptr, end, kv("int", -42));
+  Fields::put(ptr, end, kv("uint", uint16_t{42}));
+  Fields::put(ptr, end, kv("double", 0.5));
+  Fields::put(ptr, end, kv("bool", true));
+  Fields::put(ptr, end, kv("view", str));
+  Fields::put(ptr, end, kv("temp", std::string("temporary")));
+  Fields::put(ptr, end, kv("point", Point{1, 2}));
+
+  std::vector<Fields::View> fields;
+  Fields({buffer.data(), static_cast<size_t>(ptr - buffer.data())})
+      .forEach([&](const Fields::View &field) { fields.push_back(field); });
+  ASSERT_EQ(fields.size(), 7);
+
+  EXPECT_EQ(fields[0].key, "int");
+  EXPECT_EQ(fields[0].type, FieldType::INT);
+  EXPECT_EQ(fields[0].int_value, -42);
+  EXPECT_EQ(fields[1].type, FieldType::UINT);
+  EXPECT_EQ(fields[1].uint_value, 42);
+  EXPECT_EQ(fields[2].type, FieldType::DOUBLE);
+  EXPECT_EQ(fields[2].double_value, 0.5);
+  EXPECT_EQ(fields[3].type, FieldType::BOOL);
+  EXPECT_TRUE(fields[3].bool_value);
+  EXPECT_EQ(fields[4].type, FieldType::STRING);
+  EXPECT_EQ(fields[4].string_value, "string");
+  EXPECT_EQ(fields[5].string_value, "temporary");
+  // Value of other type is formatted
+  EXPECT_EQ(fields[6].key, "point");
+  EXPECT_EQ(fields[6].type, FieldType::STRING);
+  EXPECT_EQ(fields[6].string_value, "(1, 2)");
+}
+
+/**
+ * @given buffer too small for all fields
+ * @when fields are encoded into it
+ * @then string is cut, and field not fitting is skipped
+ */
+TEST_F(FieldTest, Overflow) {
+  std::array<char, 16> buffer{};
+  char *ptr = buffer.data();
+  const char *end = buffer.data() + buffer.size();
+  Fields::put(ptr, end, kv("s", "long string value"));
+  Fields::put(ptr, end, kv("n", 1));
+  EXPECT_LE(ptr, end);
+
+  Fields fields({buffer.data(), static_cast<size_t>(ptr - buffer.data())});
+  EXPECT_EQ(text(fields), R"( s="long string ")");
+}
+
+/**
+ * @given event made with message arguments mixed with fields
+ * @when it's rendered as text
+ * @then fields are not used by format and follow message as key=value
+ */
+TEST_F(FieldTest, Event) {
+  Event event("logger", Sink::ThreadInfoType::NONE, Level::INFO,
+              "imported block #{} of {}", kv("number", 100u), 100, kv("ok", 1),
+              "peer", kv("hash", "0xabc"), kv("note", "a \"b\" = c"),
+              kv("empty", ""), kv("ratio", 1.5));
+  EXPECT_EQ(event.message(), "imported block #100 of peer");
+  EXPECT_EQ(text(event.fields()),
+            R"( number=100 ok=1 hash=0xabc note="a \"b\" = c" empty="")"
+            " ratio=1.5");
+
+  Event copy(event.timestamp(), 0, {}, "logger", Level::INFO,
+             event.message(), event.fields().data());
+  EXPECT_EQ(text(copy.fields()), text(event.fields()));
+}
+
+/**
+ * @given logger with level INFO
+ * @when event with fields is logged by macro at level DEBUG and INFO
+ * @then value of field is evaluated only when event is logged
+ */
+TEST_F(FieldTest, LazyEvaluation) {
+  auto log = std::make_shared<FakeLogger>();
+  int evaluated = 0;
+  auto value = [&] { return ++evaluated; };
+
+  SL_DEBUG(log, "debug", kv("value", value()));
+  EXPECT_EQ(evaluated, 0);
+  EXPECT_TRUE(log->last_message.empty());
+
+  SL_INFO(log, "info {}", "message", kv("value", value()));
+  EXPECT_EQ(evaluated, 1);
+  EXPECT_EQ(log->last_message, "info message");
+  EXPECT_EQ(log->last_fields, " value=1");
+}
+
+/**
+ * @given message longer than event can keep
+ * @when event is made with fields and without them
+ * @then fields are kept, and message takes the rest of buffer shared with
+ * fields
+ */
+TEST_F(FieldTest, LongMessage) {
+  const std::string message(5000, 'x');
+
+  Event plain("logger", Sink::ThreadInfoType::NONE, Level::INFO, message);
+  const auto max_size = plain.message().size();
+  EXPECT_LT(max_size, message.size());
+
+  Event with_fields("logger", Sink::ThreadInfoType::NONE, Level::INFO,
+                    message, kv("number", 100));
+  EXPECT_EQ(text(with_fields.fields()), " number=100");
+  EXPECT_EQ(with_fields.message().size(),
+            max_size - with_fields.fields().data().size());
+}
@@ -0,0 +1,162 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+class ForkTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    dir_ = filename.data();
+    std::filesystem::create_directories(dir_);
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(dir_);
+  }
+
+  /**
+   * @returns number of occurrences of {@param text} in file {@param name}
+   */
+  size_t count(const std::string &name, const std::string &text) {
+    std::ifstream file(dir_ / name);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    const auto content = stream.str();
+    size_t n = 0;
+    for (auto pos = content.find(text); pos != std::string::npos;
+         pos = content.find(text, pos + 1)) {
+      ++n;
+    }
+    return n;
+  }
+
+  std::filesystem::path dir_;
+};
+
+/**
+ * @given system with file sinks of each fork policy and huge latency, and
+ * events queued before fork
+ * @when process forks, and child logs events and exits
+ * @then child doesn't hang; queued events are written once (by parent);
+ * sink with 'restart' policy writes into the same file, one with 'reopen'
+ * policy reopens file by path, one with 'disable' policy drops events
+ */
+TEST_F(ForkTest, Policies) {
+  std::string config = "sinks:\n";
+  for (auto policy : {"restart", "reopen", "disable"}) {
+    config += std::string("  - name: ") + policy + "\n    type: file\n"
+            + "    path: " + (dir_ / policy).string() + ".log\n"
+            + "    latency: 1000000\n    at_fork: " + policy + "\n";
+  }
+  config += "groups:\n  - name: main\n    sink: restart\n    level: info\n";
+  auto system = std::make_unique<LoggingSystem>(
+      std::make_shared<ConfiguratorFromYAML>(config));
+  auto result = system->configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+
+  std::vector<std::shared_ptr<Logger>> loggers;
+  for (auto policy : {"restart", "reopen", "disable"}) {
+    loggers.push_back(system->getLogger(policy, "main", policy));
+    loggers.back()->info("before fork");
+  }
+  // File is moved away, as it's done by external rotation
+  std::filesystem::rename(dir_ / "reopen.log", dir_ / "reopen.log.1");
+
+  auto pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    ::alarm(10);  // hung child fails test
+    for (const auto &logger : loggers) {
+      logger->info("in child");
+    }
+    loggers.clear();
+    system.reset();
+    ::_exit(0);
+  }
+
+  int status = 0;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+
+  loggers.front()->info("after fork");
+  loggers.clear();
+  system.reset();
+
+  EXPECT_EQ(count("restart.log", "before fork"), 1);
+  EXPECT_EQ(count("restart.log", "in child"), 1);
+  EXPECT_EQ(count("restart.log", "after fork"), 1);
+
+  EXPECT_EQ(count("reopen.log.1", "before fork"), 1);
+  EXPECT_EQ(count("reopen.log.1", "in child"), 0);
+  EXPECT_EQ(count("reopen.log", "in child"), 1);
+
+  EXPECT_EQ(count("disable.log", "before fork"), 1);
+  EXPECT_EQ(count("disable.log", "in child"), 0);
+}
+
+/**
+ * @given logger whose sink is switched by other thread all the time, so
+ * sinks are retired and reclaimed concurrently with fork
+ * @when process forks repeatedly, and child switches sink too
+ * @then child never hangs on list of retired objects
+ */
+TEST_F(ForkTest, SwitchSinksConcurrently) {
+  std::string config = "sinks:\n";
+  for (auto name : {"first", "second"}) {
+    config += std::string("  - name: ") + name + "\n    type: file\n"
+            + "    path: " + (dir_ / name).string() + ".log\n";
+  }
+  config += "groups:\n  - name: main\n    sink: first\n    level: info\n";
+  auto system = std::make_unique<LoggingSystem>(
+      std::make_shared<ConfiguratorFromYAML>(config));
+  auto result = system->configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+
+  auto logger = system->getLogger("switching", "main");
+  auto first = system->getSink("first");
+  auto second = system->getSink("second");
+
+  std::atomic_bool stop = false;
+  std::thread switcher([&] {
+    while (!stop.load()) {
+      logger->setSink(second);
+      logger->setSink(first);
+    }
+  });
+
+  for (auto i = 0; i < 20; ++i) {
+    auto pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      ::alarm(10);  // hung child fails test
+      logger->setSink(second);
+      logger->info("in child");
+      ::_exit(0);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+  }
+
+  stop = true;
+  switcher.join();
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "soralog/impl/json_escape.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+class JsonEscapeTest : public ::testing::TestWithParam<json::Isa> {
+ public:
+  static std::string escape(std::string_view str, json::Isa isa) {
+    std::vector<char> buffer(json::maxEscapedSize(str.size()));
+    auto end = json::escape(buffer.data(), str, isa);
+    return {buffer.data(), static_cast<size_t>(end - buffer.data())};
+  }
+};
+
+/**
+ * @given strings with characters needing escape at different positions
+ * @when they are escaped
+ * @then result is valid content of JSON string
+ */
+TEST_P(JsonEscapeTest, Known) {
+  const auto isa = GetParam();
+  EXPECT_EQ(escape("", isa), "");
+  EXPECT_EQ(escape("plain text", isa), "plain text");
+  EXPECT_EQ(escape("\"\\\n\r\t\b\f", isa), R"(\"\\\n\r\t\b\f)");
+  EXPECT_EQ(escape(std::string_view("\x00\x1f\x7f", 3), isa),
+            "\\u0000\\u001f\x7f");
+  EXPECT_EQ(escape("UTF-8: \xd0\x96", isa), "UTF-8: \xd0\x96");
+
+  // Special characters on borders of vectors
+  const std::string block(31, 'a');
+  EXPECT_EQ(escape(block + "\"" + block + "\n" + block, isa),
+            block + "\\\"" + block + "\\n" + block);
+  EXPECT_EQ(escape(std::string(64, '"'), isa), [] {
+    std::string expected;
+    for (auto i = 0; i < 64; ++i) {
+      expected += "\\\"";
+    }
+    return expected;
+  }());
+}
+
+/**
+ * @given random strings
+ * @when they are escaped by vectorized code
+ * @then result is the same as scalar one
+ */
+TEST_P(JsonEscapeTest, SameAsScalar) {
+  std::mt19937 rng(42);  // NOLINT
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<size_t> length(0, 200);
+  for (auto i = 0; i < 1000; ++i) {
+    std::string str(length(rng), '\0');
+    for (auto &c : str) {
+      // Mostly printable, sometimes special
+      auto b = byte(rng);
+      if (b < 32) {
+        c = static_cast<char>(b);
+      } else if (b < 40) {
+        c = (b % 2 == 0) ? '"' : '\\';
+      } else {
+        c = static_cast<char>(b < 128 ? 'a' + b % 26 : b);
+      }
+    }
+    EXPECT_EQ(escape(str, GetParam()), escape(str, json::Isa::SCALAR));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Isa, JsonEscapeTest,
+                         Values(json::Isa::SCALAR, json::Isa::SSE2,
+                                json::Isa::AVX2));
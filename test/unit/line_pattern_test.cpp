@@ -0,0 +1,191 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <fmt/chrono.h>
+
+#include "soralog/impl/line_pattern.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class LinePatternTest : public ::testing::Test {
+ public:
+  static std::string render(LinePattern &pattern, const Event &event) {
+    std::vector<char> buffer(pattern.maxSize());
+    char *ptr = buffer.data();
+    pattern.render(ptr, event);
+    EXPECT_LE(ptr - buffer.data(), pattern.maxSize());
+    return {buffer.data(), static_cast<size_t>(ptr - buffer.data())};
+  }
+
+  const std::chrono::system_clock::time_point time_ =
+      std::chrono::system_clock::time_point(1700000000s + 123456us);
+  const std::tm tm_ = fmt::localtime(std::time_t{1700000000});
+};
+
+/**
+ * @given default patterns for different thread info types
+ * @when event is rendered
+ * @then line has date, time, thread, level, name and message separated by
+ * couple of spaces
+ */
+TEST_F(LinePatternTest, Default) {
+  Event event(time_, 7, "worker", "logger", Level::INFO, "message",
+              std::string_view("\x02\x01n\x07", 4));
+  const auto datetime =
+      fmt::format("{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}.123456",
+                  tm_.tm_year % 100, tm_.tm_mon + 1, tm_.tm_mday,
+                  tm_.tm_hour, tm_.tm_min, tm_.tm_sec);
+
+  LinePattern none(LinePattern::defaultPattern(Sink::ThreadInfoType::NONE),
+                   Sink::ThreadInfoType::NONE, false);
+  EXPECT_EQ(render(none, event),
+            datetime + "  Info      logger  message n=7\n");
+
+  LinePattern id(LinePattern::defaultPattern(Sink::ThreadInfoType::ID),
+                 Sink::ThreadInfoType::ID, false);
+  EXPECT_EQ(render(id, event),
+            datetime + "  T:7       Info      logger  message n=7\n");
+
+  LinePattern name(LinePattern::defaultPattern(Sink::ThreadInfoType::NAME),
+                   Sink::ThreadInfoType::NAME, false);
+  EXPECT_EQ(render(name, event),
+            datetime + "  worker           Info      logger  message n=7\n");
+}
+
+/**
+ * @given custom pattern
+ * @when events of different seconds are rendered
+ * @then each line follows pattern, and date is updated
+ */
+TEST_F(LinePatternTest, Custom) {
+  LinePattern pattern("%Y-%m-%dT%H:%M:%S.%e %L 100%% [%t] %n: %v",
+                      Sink::ThreadInfoType::NAME, false);
+
+  for (auto time : {time_, time_ + 3600s}) {
+    const auto tm = fmt::localtime(std::chrono::system_clock::to_time_t(time));
+    Event event(time, 0, "worker", "logger", Level::WARN, "message");
+    EXPECT_EQ(render(pattern, event),
+              fmt::format("{:0>4}-{:0>2}-{:0>2}T{:0>2}:{:0>2}:{:0>2}.123 W "
+                          "100% [worker         ] logger: message\n",
+                          tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                          tm.tm_hour, tm.tm_min, tm.tm_sec));
+  }
+}
+
+/**
+ * @given pattern with color
+ * @when event is rendered
+ * @then level, name and message are styled
+ */
+TEST_F(LinePatternTest, Color) {
+  LinePattern pattern("%l %n %v", Sink::ThreadInfoType::NONE, true);
+  Event event(time_, 0, {}, "logger", Level::ERROR_, "message");
+  const auto line = render(pattern, event);
+  EXPECT_NE(line.find("\x1b[1mlogger\x1b[0m"), std::string::npos) << line;
+  EXPECT_NE(line.find("\x1b[1mmessage\x1b[0m\n"), std::string::npos) << line;
+  EXPECT_EQ(line.substr(0, 2), "\x1b[");
+}
+
+/**
+ * @given malformed patterns
+ * @when they are compiled
+ * @then exception is thrown
+ */
+TEST_F(LinePatternTest, Malformed) {
+  EXPECT_THROW(LinePattern("%v %", Sink::ThreadInfoType::NONE, false),
+               std::invalid_argument);
+  EXPECT_THROW(LinePattern("%q", Sink::ThreadInfoType::NONE, false),
+               std::invalid_argument);
+  EXPECT_THROW(
+      LinePattern(std::string(2000, 'x'), Sink::ThreadInfoType::NONE, false),
+      std::invalid_argument);
+}
+
+/**
+ * @given events with short and long messages
+ * @when they are rendered into iovec
+ * @then long message is referenced in place, and joined parts are the same
+ * as line rendered by copying
+ */
+TEST_F(LinePatternTest, Gathered) {
+  LinePattern pattern(LinePattern::defaultPattern(Sink::ThreadInfoType::ID),
+                      Sink::ThreadInfoType::ID, false);
+  const std::string long_message(LinePattern::min_referenced_message_size,
+                                 'x');
+  Event short_event(time_, 1, {}, "logger", Level::INFO, "short");
+  Event long_event(time_, 2, {}, "logger", Level::INFO, long_message,
+                   std::string_view("\x02\x01n\x07", 4));
+
+  std::vector<char> scratch(pattern.maxSize() * 2);
+  char *ptr = scratch.data();
+  std::vector<iovec> iov;
+  EXPECT_FALSE(pattern.render(ptr, short_event, iov));
+  EXPECT_TRUE(pattern.render(ptr, long_event, iov));
+
+  // Short line is joined with header of long one
+  ASSERT_EQ(iov.size(), 3);
+  EXPECT_EQ(iov[1].iov_base, long_event.message().data());
+
+  std::string gathered;
+  for (const auto &item : iov) {
+    gathered.append(static_cast<const char *>(item.iov_base), item.iov_len);
+  }
+  EXPECT_EQ(gathered,
+            render(pattern, short_event) + render(pattern, long_event));
+}
+
+/**
+ * @given patterns in ISO 8601 format with UTC and with local time
+ * @when event is rendered
+ * @then time is rendered with offset from UTC ("Z" for UTC)
+ */
+TEST_F(LinePatternTest, Iso8601) {
+  Event event(time_, 12345678, {}, "logger", Level::DEBUG, "message");
+
+  LinePattern utc("%FT%T.%f%z [%t] %l|", Sink::ThreadInfoType::ID, false,
+                  true);
+  EXPECT_EQ(render(utc, event),
+            "2023-11-14T22:13:20.123456Z [T:12345678] Debug   |\n");
+
+  LinePattern local("%FT%T%z", Sink::ThreadInfoType::NONE, false);
+  const auto offset = tm_.tm_gmtoff / 60;
+  EXPECT_EQ(render(local, event),
+            fmt::format("{:0>4}-{:0>2}-{:0>2}T{:0>2}:{:0>2}:{:0>2}{}{:0>2}:"
+                        "{:0>2}\n",
+                        tm_.tm_year + 1900, tm_.tm_mon + 1, tm_.tm_mday,
+                        tm_.tm_hour, tm_.tm_min, tm_.tm_sec,
+                        offset < 0 ? '-' : '+', std::abs(offset) / 60,
+                        std::abs(offset) % 60));
+}
+
+/**
+ * @given patterns in local time and in UTC
+ * @when events of different seconds (and years) are rendered as usual and
+ * in signal handler way
+ * @then lines are the same, since UTC offset of local time is taken from
+ * recent usual rendering
+ */
+TEST_F(LinePatternTest, RenderInSignal) {
+  for (bool utc : {false, true}) {
+    LinePattern pattern("%F %T.%f%z %l %n: %v", Sink::ThreadInfoType::NONE,
+                        false, utc);
+    LinePattern in_signal("%F %T.%f%z %l %n: %v", Sink::ThreadInfoType::NONE,
+                          false, utc);
+    for (auto time : {time_, time_ + 86400s * 45 + 1s, time_ - 86400s * 400}) {
+      Event event(time, 0, "", "logger", Level::ERROR_, "message");
+      const auto expected = render(pattern, event);
+      std::vector<char> buffer(in_signal.maxSize());
+      char *ptr = buffer.data();
+      in_signal.renderInSignal(ptr, event);
+      EXPECT_EQ(std::string(buffer.data(), ptr), expected);
+    }
+  }
+}
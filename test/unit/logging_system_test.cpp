@@ -5,15 +5,54 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include <mock/configurator_mock.hpp>
 #include <mock/sink_mock.hpp>
 #include <soralog/group.hpp>
 #include <soralog/logger.hpp>
 #include <soralog/logging_system.hpp>
+#include <soralog/macro.hpp>
 
 using namespace soralog;
 using namespace testing;
 
+namespace {
+
+  /// Sink which drops events and counts its existing instances
+  class CountedSink final : public Sink {
+   public:
+    static inline std::atomic_int alive = 0;
+
+    explicit CountedSink(std::string name)
+        : Sink(std::move(name), ThreadInfoType::NONE, 32, sizeof(Event) * 32,
+               0) {
+      ++alive;
+    }
+    ~CountedSink() override {
+      flush();
+      --alive;
+    }
+
+    void flush() noexcept override {
+      std::lock_guard lock(mutex_);
+      while (events_.size() > 0) {
+        std::ignore = events_.get();
+      }
+    }
+    void async_flush() noexcept override {
+      flush();
+    }
+    void rotate() noexcept override {}
+
+   private:
+    std::mutex mutex_;
+  };
+
+}  // namespace
+
 class LoggingSystemTest : public ::testing::Test {
  public:
   void SetUp() override {
@@ -1174,3 +1213,146 @@ TEST_F(LoggingSystemTest, ChangeGroupOfLogger) {
   EXPECT_TRUE(log2->level() == Level::CRITICAL);
   EXPECT_TRUE(log2->isLevelOverridden());
 }
+
+TEST_F(LoggingSystemTest, ConcurrentGetLogger) {
+  configure();
+
+  constexpr size_t threads_count = 8;
+  constexpr size_t loggers_count = 100;
+  std::vector<std::vector<std::shared_ptr<Logger>>> loggers(threads_count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threads_count; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < loggers_count; ++i) {
+        loggers[t].push_back(
+            system_->getLogger("logger" + std::to_string(i), "second"));
+        EXPECT_EQ(system_->getGroup(std::string_view("first"))->name(),
+                  "first");
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Each name gets the only logger
+  for (size_t t = 1; t < threads_count; ++t) {
+    EXPECT_EQ(loggers[t], loggers[0]);
+  }
+}
+
+TEST_F(LoggingSystemTest, ExpiredLogger) {
+  configure();
+
+  std::weak_ptr<Logger> weak_logger =
+      system_->getLogger("temporary", "first");
+  EXPECT_TRUE(weak_logger.expired());
+
+  // Expired entry doesn't prevent making new logger with the same name
+  auto logger = system_->getLogger("temporary", "second");
+  EXPECT_EQ(logger->group()->name(), "second");
+  EXPECT_EQ(system_->getLogger("temporary", "first"), logger);
+
+  EXPECT_FALSE(system_->setLevelOfLogger("absent", Level::INFO));
+  EXPECT_TRUE(system_->setLevelOfLogger("temporary", Level::INFO));
+  EXPECT_EQ(logger->level(), Level::INFO);
+}
+
+TEST_F(LoggingSystemTest, LoggerHandle) {
+  configure();
+
+  auto handle = system_->getLoggerHandle("handled", "second");
+  ASSERT_TRUE(handle);
+  EXPECT_EQ(handle->name(), "handled");
+
+  // Logger is kept by system, though nobody else owns it
+  std::weak_ptr<Logger> logger = system_->getLogger("handled", "first");
+  EXPECT_FALSE(logger.expired());
+  EXPECT_EQ(handle.get(), logger.lock().get());
+  EXPECT_EQ(system_->makeHandle(logger.lock()), handle);
+
+  // Copy refers the same logger, and follows changes of its group
+  auto copy = handle;
+  EXPECT_TRUE(system_->setLevelOfGroup("second", Level::INFO));
+  EXPECT_EQ(copy->level(), Level::INFO);
+
+  // Macros accept handle; arguments are evaluated for passed level only
+  int evaluated = 0;
+  auto arg = [&] { return ++evaluated; };
+  SL_VERBOSE(copy, "value {}", arg());
+  EXPECT_EQ(evaluated, 0);
+  SL_INFO(copy, "value {}", arg());
+  EXPECT_EQ(evaluated, 1);
+}
+
+TEST_F(LoggingSystemTest, Transaction) {
+  configure();
+
+  auto logger = system_->getLogger("logger", "third");
+  EXPECT_TRUE(system_->resetLevelOfGroup("third"));
+  EXPECT_EQ(logger->level(), Level::DEBUG);
+
+  // Changes are propagated to subgroups and loggers after all edits
+  system_->transaction([&] {
+    EXPECT_TRUE(system_->setLevelOfGroup("first", Level::INFO));
+    EXPECT_TRUE(system_->resetLevelOfGroup("second"));
+    EXPECT_EQ(logger->level(), Level::DEBUG);
+  });
+  EXPECT_EQ(system_->getGroup("second")->level(), Level::INFO);
+  EXPECT_EQ(system_->getGroup("third")->level(), Level::INFO);
+  EXPECT_EQ(logger->level(), Level::INFO);
+
+  // Edits done before exception are propagated anyway
+  EXPECT_THROW(system_->transaction([&] {
+    system_->setLevelOfGroup("first", Level::WARN);
+    throw std::runtime_error("interrupted");
+  }),
+               std::runtime_error);
+  EXPECT_EQ(logger->level(), Level::WARN);
+}
+
+TEST_F(LoggingSystemTest, DirectlyMovedLogger) {
+  configure();
+
+  // Logger moved to other group by itself gets changes of that group
+  auto logger = system_->getLogger("logger", "first");
+  logger->setGroup("third");
+  EXPECT_TRUE(system_->resetLevelOfGroup("third"));
+  EXPECT_EQ(logger->level(), Level::DEBUG);
+
+  // Logger left group doesn't get its changes anymore
+  EXPECT_TRUE(system_->setLevelOfGroup("first", Level::ERROR_));
+  EXPECT_EQ(logger->level(), Level::DEBUG);
+}
+
+TEST_F(LoggingSystemTest, ReconfigureWhileLogging) {
+  configure();
+
+  auto logger = system_->getLogger("logger", "first");
+  logger->setSink(std::make_shared<CountedSink>("initial"));
+
+  // Sink and level are replaced while other threads log through them
+  std::atomic_bool stop = false;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&] {
+      while (!stop) {
+        logger->info("event {}", 1);
+        logger->flush();
+      }
+    });
+  }
+  for (int i = 0; i < 1000; ++i) {
+    logger->setSink(std::make_shared<CountedSink>("sink" + std::to_string(i)));
+    logger->setLevel(i % 2 == 0 ? Level::OFF : Level::INFO);
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Replaced sinks are released once nobody logs into them
+  hazard::reclaim();
+  EXPECT_EQ(CountedSink::alive, 1);
+  logger.reset();
+}
@@ -75,7 +75,7 @@ TEST_F(MacrosTest, NoArg) {
 
   fmt = "Error: no arg";
   SL_ERROR(logger(), fmt);
-  EXPECT_TRUE(logger_->last_level == Level::ERROR);
+  EXPECT_TRUE(logger_->last_level == Level::ERROR_);
   EXPECT_TRUE(logger_->last_message == fmt);
 
   fmt = "Critical: no arg";
@@ -112,7 +112,7 @@ TEST_F(MacrosTest, OneArg) {
 
   fmt = "Error: one arg: {}";
   SL_ERROR(logger(), fmt, "string");
-  EXPECT_TRUE(logger_->last_level == Level::ERROR);
+  EXPECT_TRUE(logger_->last_level == Level::ERROR_);
   EXPECT_TRUE(logger_->last_message == "Error: one arg: string");
 
   fmt = "Critical: one arg: {}";
@@ -122,37 +122,37 @@ TEST_F(MacrosTest, OneArg) {
 }
 
 TEST_F(MacrosTest, TwoArg) {
-  std::string fmt = "Trace: two args: {} and {}";
+  std::string fmt = "Trace: two args: {} and {:.1f}";
   SL_TRACE(logger(), fmt, 1, 2.0);
   EXPECT_TRUE(logger_->last_level == Level::TRACE);
   EXPECT_TRUE(logger_->last_message == "Trace: two args: 1 and 2.0");
 
-  fmt = "Debug: two args: {} and {}";
+  fmt = "Debug: two args: {} and {:.1f}";
   SL_DEBUG(logger(), fmt, 1, 2.0);
   EXPECT_TRUE(logger_->last_level == Level::DEBUG);
   EXPECT_TRUE(logger_->last_message == "Debug: two args: 1 and 2.0");
 
-  fmt = "Verbose: two args: {} and {}";
+  fmt = "Verbose: two args: {} and {:.1f}";
   SL_VERBOSE(logger(), fmt, 1, 2.0);
   EXPECT_TRUE(logger_->last_level == Level::VERBOSE);
   EXPECT_TRUE(logger_->last_message == "Verbose: two args: 1 and 2.0");
 
-  fmt = "Info: two args: {} and {}";
+  fmt = "Info: two args: {} and {:.1f}";
   SL_INFO(logger(), fmt, 1, 2.0);
   EXPECT_TRUE(logger_->last_level == Level::INFO);
   EXPECT_TRUE(logger_->last_message == "Info: two args: 1 and 2.0");
 
-  fmt = "Warning: two args: {} and {}";
+  fmt = "Warning: two args: {} and {:.1f}";
   SL_WARN(logger(), fmt, 1, 2.0);
   EXPECT_TRUE(logger_->last_level == Level::WARN);
   EXPECT_TRUE(logger_->last_message == "Warning: two args: 1 and 2.0");
 
-  fmt = "Error: two args: {} and {}";
+  fmt = "Error: two args: {} and {:.1f}";
   SL_ERROR(logger(), fmt, 1, 2.0);
-  EXPECT_TRUE(logger_->last_level == Level::ERROR);
+  EXPECT_TRUE(logger_->last_level == Level::ERROR_);
   EXPECT_TRUE(logger_->last_message == "Error: two args: 1 and 2.0");
 
-  fmt = "Critical: two args: {} and {}";
+  fmt = "Critical: two args: {} and {:.1f}";
   SL_CRITICAL(logger(), fmt, 1, 2.0);
   EXPECT_TRUE(logger_->last_level == Level::CRITICAL);
   EXPECT_TRUE(logger_->last_message == "Critical: two args: 1 and 2.0");
@@ -187,7 +187,7 @@ TEST_F(MacrosTest, TwentyArg) {
 
   fmt = "Error: twenty args: {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}";
   SL_ERROR(logger(), fmt, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20);
-  EXPECT_TRUE(logger_->last_level == Level::ERROR);
+  EXPECT_TRUE(logger_->last_level == Level::ERROR_);
   EXPECT_TRUE(logger_->last_message == "Error: twenty args: 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20");
 
   fmt = "Critical: twenty args: {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}, {}";
@@ -225,8 +225,8 @@ TEST_F(MacrosTest, CustomLevel) {
   EXPECT_TRUE(logger_->last_level == Level::WARN);
   EXPECT_TRUE(logger_->last_message == "Custom: warning");
 
-  SL_LOG(logger(), calculatedLevel(Level::ERROR), fmt, "error");
-  EXPECT_TRUE(logger_->last_level == Level::ERROR);
+  SL_LOG(logger(), calculatedLevel(Level::ERROR_), fmt, "error");
+  EXPECT_TRUE(logger_->last_level == Level::ERROR_);
   EXPECT_TRUE(logger_->last_message == "Custom: error");
 
   // clang-format off
@@ -0,0 +1,68 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "soralog/sharded_map.hpp"
+
+using namespace soralog;
+
+/**
+ * @given map of named values
+ * @when entries are assigned, found by string_view and erased
+ * @then absent entry is returned as default value, and previous value is
+ * returned on reassignment
+ */
+TEST(ShardedMapTest, Basic) {
+  ShardedMap<std::shared_ptr<int>> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find("one"), nullptr);
+
+  auto one = std::make_shared<int>(1);
+  EXPECT_EQ(map.assign("one", one), nullptr);
+  EXPECT_FALSE(map.empty());
+  const std::string key = "one";
+  EXPECT_EQ(map.find(std::string_view(key)), one);
+
+  auto other = std::make_shared<int>(2);
+  EXPECT_EQ(map.assign("one", other), one);
+  EXPECT_EQ(map.find("one"), other);
+
+  EXPECT_TRUE(map.erase("one"));
+  EXPECT_FALSE(map.erase("one"));
+  EXPECT_TRUE(map.empty());
+}
+
+/**
+ * @given map with expired weak pointers in one shard
+ * @when it's swept by few entries several times
+ * @then all expired entries are removed, and alive ones are kept
+ */
+TEST(ShardedMapTest, Sweep) {
+  ShardedMap<std::weak_ptr<int>, 1> map;
+  auto alive = std::make_shared<int>(0);
+  for (int i = 0; i < 10; ++i) {
+    map.assign("expired" + std::to_string(i), std::make_shared<int>(i));
+  }
+  map.assign("alive", alive);
+
+  auto expired = [](const auto &value) { return value.expired(); };
+  for (int i = 0; i < 5; ++i) {
+    map.sweep("any", 2, expired);
+  }
+  // Cursor has wrapped around, and alive entry is visited too
+  map.sweep("any", 2, expired);
+
+  size_t count = 0;
+  map.forEach([&](const std::string &key, const auto &value) {
+    EXPECT_EQ(key, "alive");
+    ++count;
+  });
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(map.find("alive").lock(), alive);
+}
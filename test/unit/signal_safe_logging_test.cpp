@@ -0,0 +1,196 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace {
+  Logger *signal_logger = nullptr;
+  bool logged_from_signal = false;
+
+  void logOnSignal(int signal) {
+    logged_from_signal = signal_logger->logFromSignal(
+        Level::WARN, "signal {} value {} max {}", signal, -42, UINT64_MAX);
+  }
+
+  void rotateOnSignal(int /*signal*/) {
+    Sink::requestRotation();
+  }
+}  // namespace
+
+class SignalSafeLoggingTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    dir_ = filename.data();
+    std::filesystem::create_directories(dir_);
+    path_ = dir_ / "signal.log";
+  }
+  void TearDown() override {
+    signal_logger = nullptr;
+    std::filesystem::remove_all(dir_);
+  }
+
+  std::shared_ptr<LoggingSystem> createSystem(size_t capacity,
+                                              size_t latency) {
+    auto system =
+        std::make_shared<LoggingSystem>(std::make_shared<ConfiguratorFromYAML>(
+            std::string(R"(
+sinks:
+  - name: file
+    type: file
+    path: )") + path_.string()
+            + "\n    capacity: " + std::to_string(capacity)
+            + "\n    latency: " + std::to_string(latency) + R"(
+groups:
+  - name: main
+    sink: file
+    level: info
+)"));
+    auto result = system->configure();
+    EXPECT_FALSE(result.has_error) << result.message;
+    return system;
+  }
+
+  static std::string read(const std::filesystem::path &path) {
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+  }
+
+  /**
+   * Waits till file {@param path} contains {@param text}
+   */
+  static bool waitFor(const std::filesystem::path &path,
+                      std::string_view text) {
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (std::chrono::steady_clock::now() < deadline) {
+      if (read(path).find(text) != std::string::npos) {
+        return true;
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+    return false;
+  }
+
+  std::filesystem::path dir_;
+  std::filesystem::path path_;
+};
+
+/**
+ * @given logger writing into file with latency
+ * @when event with integers is logged from signal handler
+ * @then worker writes event with substituted integers
+ */
+TEST_F(SignalSafeLoggingTest, LogFromHandler) {
+  auto system = createSystem(64, 10);
+  auto logger = system->getLogger("signal", "main");
+  logger->prepareForSignal();
+  signal_logger = logger.get();
+
+  std::signal(SIGUSR1, logOnSignal);
+  ASSERT_EQ(std::raise(SIGUSR1), 0);
+  std::signal(SIGUSR1, SIG_DFL);
+  EXPECT_TRUE(logged_from_signal);
+
+  EXPECT_TRUE(waitFor(path_,
+                      fmt::format("signal {} value -42 max {}", SIGUSR1,
+                                  UINT64_MAX)))
+      << read(path_);
+
+  // Level is checked as usual
+  EXPECT_FALSE(logger->logFromSignal(Level::DEBUG, "debug {}", 1));
+}
+
+/**
+ * @given logger whose sink has not got any event yet
+ * @when logger is created, and then prepared for signal handler
+ * @then sink isn't started by creation of logger, and is started by
+ * preparation
+ */
+TEST_F(SignalSafeLoggingTest, PrepareForSignal) {
+  auto system = createSystem(64, 10);
+  auto logger = system->getLogger("signal", "main");
+
+  // Sink is started lazily, so there is nothing to push into yet
+  EXPECT_FALSE(logger->logFromSignal(Level::WARN, "unprepared {}", 1));
+
+  logger->prepareForSignal();
+  EXPECT_TRUE(logger->logFromSignal(Level::WARN, "prepared {}", 2));
+
+  logger->flush();
+  EXPECT_TRUE(waitFor(path_, "prepared 2")) << read(path_);
+  EXPECT_EQ(read(path_).find("unprepared"), std::string::npos);
+}
+
+/**
+ * @given sink with small queue and huge latency
+ * @when more events are pushed from signal context than queue holds
+ * @then excess events are dropped instead of flushing inline
+ */
+TEST_F(SignalSafeLoggingTest, DropWhenQueueIsFull) {
+  auto system = createSystem(4, 1000000);
+  auto sink = system->getSink("file");
+  ASSERT_TRUE(sink);
+  // Sink without loggers is started by the first event
+  sink->prepare();
+
+  size_t pushed = 0;
+  for (auto i = 0; i < 10; ++i) {
+    pushed += sink->pushFromSignal("signal", Level::INFO, "event") ? 1 : 0;
+  }
+  EXPECT_GT(pushed, 0);
+  EXPECT_LT(pushed, 10);
+  EXPECT_TRUE(read(path_).empty());
+
+  sink->flush();
+  EXPECT_TRUE(waitFor(path_, "event"));
+}
+
+/**
+ * @given logger writing into file with latency
+ * @when file is moved away, and rotation is requested from signal handler
+ * @then sink reopens file at original path on its next flush
+ */
+TEST_F(SignalSafeLoggingTest, RotateFromHandler) {
+  auto system = createSystem(64, 10);
+  auto logger = system->getLogger("signal", "main");
+
+  logger->info("before rotation");
+  ASSERT_TRUE(waitFor(path_, "before rotation"));
+
+  auto moved = dir_ / "signal.log.1";
+  std::filesystem::rename(path_, moved);
+
+  std::signal(SIGUSR2, rotateOnSignal);
+  ASSERT_EQ(std::raise(SIGUSR2), 0);
+  std::signal(SIGUSR2, SIG_DFL);
+
+  // File is reopened by worker on its next flush
+  auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (!std::filesystem::exists(path_)
+         && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  ASSERT_TRUE(std::filesystem::exists(path_));
+
+  logger->info("after rotation");
+  EXPECT_TRUE(waitFor(path_, "after rotation")) << read(moved);
+  EXPECT_EQ(read(moved).find("after rotation"), std::string::npos);
+}
@@ -0,0 +1,210 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "soralog/group.hpp"
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+namespace {
+
+  /// Sink which keeps events till flush() moves them into list of lines
+  class CollectingSink final : public Sink {
+   public:
+    explicit CollectingSink(std::string name)
+        : Sink(std::move(name), ThreadInfoType::NONE, 16,
+               sizeof(Event) * 16, 1000000) {}
+
+    void flush() noexcept override {
+      while (auto node = events_.get()) {
+        lines.emplace_back(std::string(node->name()) + ": "
+                           + std::string(node->message()));
+      }
+    }
+    void async_flush() noexcept override {}
+    void rotate() noexcept override {}
+
+    size_t queued() const noexcept {
+      return events_.size();
+    }
+
+    std::vector<std::string> lines;
+  };
+
+}  // namespace
+
+/**
+ * @given globs
+ * @when they are matched with names
+ * @then '*' matches any sequence, and '?' matches one char
+ */
+TEST(SinkFilterTest, Glob) {
+  EXPECT_TRUE(SinkFilter::matchGlob("network.*", "network.peer"));
+  EXPECT_TRUE(SinkFilter::matchGlob("network.*", "network."));
+  EXPECT_FALSE(SinkFilter::matchGlob("network.*", "network"));
+  EXPECT_TRUE(SinkFilter::matchGlob("*", ""));
+  EXPECT_TRUE(SinkFilter::matchGlob("*.peer", "network.sync.peer"));
+  EXPECT_TRUE(SinkFilter::matchGlob("a*b*c", "axxbyybzzc"));
+  EXPECT_FALSE(SinkFilter::matchGlob("a*b*c", "axxbyybzz"));
+  EXPECT_TRUE(SinkFilter::matchGlob("log?", "log1"));
+  EXPECT_FALSE(SinkFilter::matchGlob("log?", "log"));
+  EXPECT_FALSE(SinkFilter::matchGlob("", "log"));
+}
+
+/**
+ * @given filter with rules for different loggers and groups
+ * @when rules are selected for loggers
+ * @then selection has max level of matching rules, and message is checked
+ * only where rule without message checks doesn't accept event
+ */
+TEST(SinkFilterTest, Select) {
+  SinkFilter filter({
+      {Level::WARN, {"network.*"}, {}, {}, {}},
+      {Level::DEBUG, {}, {"consensus"}, {"block"}, {}},
+  });
+
+  auto network = filter.select("network.peer", {"main"});
+  EXPECT_TRUE(network.mightAccept(Level::WARN));
+  EXPECT_FALSE(network.mightAccept(Level::INFO));
+  EXPECT_FALSE(network.needsMessage(Level::ERROR_));
+
+  // Group matches parent of group of logger too
+  auto babe = filter.select("babe", {"babe", "consensus", "main"});
+  EXPECT_TRUE(babe.mightAccept(Level::DEBUG));
+  EXPECT_FALSE(babe.mightAccept(Level::TRACE));
+  EXPECT_TRUE(babe.needsMessage(Level::CRITICAL));
+  EXPECT_TRUE(filter.acceptsMessage(babe, Level::INFO, "imported block"));
+  EXPECT_FALSE(filter.acceptsMessage(babe, Level::INFO, "imported header"));
+
+  auto other = filter.select("other", {"main"});
+  EXPECT_FALSE(other.mightAccept(Level::CRITICAL));
+
+  EXPECT_THROW(SinkFilter(std::vector<SinkFilter::Rule>{}),
+               std::invalid_argument);
+  EXPECT_THROW(SinkFilter({{Level::INFO, {}, {}, {}, "("}}),
+               std::invalid_argument);
+}
+
+/**
+ * @given sink with filter checking level and message
+ * @when events are pushed
+ * @then only accepted events are queued, so rejected ones don't take place
+ * in queue
+ */
+TEST(SinkFilterTest, Push) {
+  CollectingSink sink("sink");
+  sink.setFilter(std::make_shared<SinkFilter>(std::vector<SinkFilter::Rule>{
+      {Level::INFO, {}, {}, {}, R"(#\d+$)"},
+      {Level::ERROR_, {}, {}, {}, {}},
+  }));
+
+  for (int i = 0; i < 100; ++i) {
+    sink.push("log", Level::DEBUG, "debug #{}", i);
+    sink.push("log", Level::INFO, "info #{} ", i);
+  }
+  EXPECT_EQ(sink.queued(), 0);
+
+  sink.push("log", Level::INFO, "info #{}", 1);
+  sink.push("log", Level::ERROR_, "error {}", 2);
+  sink.relay("log", std::chrono::system_clock::now(), 0, {}, Level::INFO,
+             "relayed #3");
+  sink.relay("log", std::chrono::system_clock::now(), 0, {}, Level::INFO,
+             "relayed");
+  EXPECT_EQ(sink.queued(), 3);
+
+  sink.flush();
+  EXPECT_EQ(sink.lines,
+            (std::vector<std::string>{
+                "log: info #1", "log: error 2", "log: relayed #3"}));
+}
+
+/**
+ * @given sink with filter defined in YAML and shared by couple of groups
+ * @when loggers of different groups log events
+ * @then sink gets only events accepted by filter
+ */
+TEST(SinkFilterTest, Yaml) {
+  auto system =
+      std::make_shared<LoggingSystem>(std::make_shared<ConfiguratorFromYAML>(
+          std::string(R"(
+sinks:
+  - name: shared
+    type: console
+    filter:
+      - level: warning
+        logger: network.*
+      - level: info
+        group: consensus
+        contains: [imported, block]
+groups:
+  - name: main
+    sink: shared
+    level: trace
+    children:
+      - name: network
+      - name: consensus
+        children:
+          - name: babe
+)")));
+  auto result = system->configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+
+  auto sink = std::make_shared<CollectingSink>("shared");
+  sink->setFilter(system->getSink("shared")->filter());
+  ASSERT_TRUE(sink->filter());
+
+  auto peer = system->getLogger("network.peer", "network");
+  auto babe = system->getLogger("babe", "babe");
+  auto main = system->getLogger("main", "main");
+  for (const auto &logger : {peer, babe, main}) {
+    logger->setSink(sink);
+  }
+
+  peer->info("connected");
+  peer->warn("disconnected");
+  babe->debug("imported block #1");
+  babe->info("imported block #2");
+  babe->info("imported header #3");
+  main->critical("started");
+  sink->flush();
+  EXPECT_EQ(sink->lines,
+            (std::vector<std::string>{"network.peer: disconnected",
+                                      "babe: imported block #2"}));
+}
+
+/**
+ * @given malformed filters
+ * @when system is configured
+ * @then errors are reported
+ */
+TEST(SinkFilterTest, Malformed) {
+  for (auto filter : {"[{level: loud}]", "{regex: \"(\"}", "{name: x}",
+                      "[plain]"}) {
+    LoggingSystem system(std::make_shared<ConfiguratorFromYAML>(
+        std::string(R"(
+sinks:
+  - name: console
+    type: console
+    filter: )") + filter + R"(
+groups:
+  - name: main
+    sink: console
+    level: info
+)"));
+    auto result = system.configure();
+    EXPECT_TRUE(result.has_error) << filter;
+    EXPECT_NE(result.message.find("in 'filter' of sink 'console'"),
+              std::string::npos)
+        << result.message;
+  }
+}
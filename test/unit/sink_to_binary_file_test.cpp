@@ -0,0 +1,179 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "soralog/impl/binary_log_reader.hpp"
+#include "soralog/impl/sink_to_binary_file.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class SinkToBinaryFileTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    path_ = std::filesystem::temp_directory_path();
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    path_ /= std::string(filename.data()) + ".bin";
+  }
+  void TearDown() override {
+    std::remove(path_.native().data());
+  }
+
+  std::shared_ptr<SinkToBinaryFile> createSink(
+      std::chrono::milliseconds latency) {
+    return std::make_shared<SinkToBinaryFile>(
+        "binary", path_,
+        Sink::ThreadInfoType::NAME,  // record thread info
+        4,                           // capacity: 4 events
+        16384,                       // buffers size: 16 Kb
+        latency.count());
+  }
+
+  /**
+   * Writes {@param count} events through sink with {@param latency}
+   */
+  void writeEvents(int count, std::chrono::milliseconds latency = 0ms) {
+    auto sink = createSink(latency);
+    for (int i = 1; i <= count; ++i) {
+      sink->push(i % 2 ? "odd" : "even", i % 2 ? Level::INFO : Level::DEBUG,
+                 "message #{}", i);
+    }
+    sink->flush();
+  }
+
+ protected:
+  std::filesystem::path path_;
+};
+
+/**
+ * @given Binary file written by sink
+ * @when Read it by reader
+ * @then All events are decoded with their properties
+ */
+TEST_F(SinkToBinaryFileTest, WriteAndRead) {
+  util::setThreadName("TestThread");
+  auto before = std::chrono::system_clock::now();
+  writeEvents(100, 20ms);
+  auto after = std::chrono::system_clock::now();
+
+  BinaryLogReader reader(path_);
+  int count = 0;
+  auto prev_time = before - 1us;
+  while (auto event = reader.next()) {
+    ++count;
+    EXPECT_EQ(event->message, fmt::format("message #{}", count));
+    EXPECT_EQ(event->name, count % 2 ? "odd" : "even");
+    EXPECT_EQ(event->level, count % 2 ? Level::INFO : Level::DEBUG);
+    EXPECT_EQ(event->thread_name, "TestThread");
+    EXPECT_EQ(event->thread_number, util::getThreadNumber());
+    EXPECT_GE(event->timestamp, prev_time);
+    EXPECT_LE(event->timestamp, after);
+    prev_time = event->timestamp - 1us;  // precision is microseconds
+  }
+  EXPECT_EQ(count, 100);
+  EXPECT_EQ(reader.status(), BinaryLogReader::Status::END);
+}
+
+/**
+ * @given Binary file written by several sessions
+ * @when Read it by reader
+ * @then Events of all sessions are decoded
+ */
+TEST_F(SinkToBinaryFileTest, SeveralSessions) {
+  writeEvents(10);
+  writeEvents(10);
+
+  BinaryLogReader reader(path_);
+  int count = 0;
+  while (auto event = reader.next()) {
+    ++count;
+    EXPECT_EQ(event->message, fmt::format("message #{}", (count - 1) % 10 + 1));
+  }
+  EXPECT_EQ(count, 20);
+  EXPECT_EQ(reader.status(), BinaryLogReader::Status::END);
+}
+
+/**
+ * @given Binary file which last record is torn
+ * @when Read it by reader
+ * @then All events except last are decoded, and status reports torn record
+ */
+TEST_F(SinkToBinaryFileTest, TornLastRecord) {
+  writeEvents(10);
+  auto size = std::filesystem::file_size(path_);
+
+  for (size_t cut : {1, 3, 7}) {
+    std::filesystem::resize_file(path_, size - cut);
+
+    BinaryLogReader reader(path_);
+    int count = 0;
+    while (auto event = reader.next()) {
+      ++count;
+    }
+    EXPECT_EQ(count, 9);
+    EXPECT_EQ(reader.status(), BinaryLogReader::Status::TORN);
+  }
+}
+
+/**
+ * @given Binary file which record in the middle is damaged
+ * @when Read it by reader
+ * @then Events before damaged record are decoded, and status reports
+ * corruption
+ */
+TEST_F(SinkToBinaryFileTest, CorruptedRecord) {
+  writeEvents(10);
+  auto size = std::filesystem::file_size(path_);
+  {
+    std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(size / 2);
+    file.put('\xff');
+  }
+
+  BinaryLogReader reader(path_);
+  int count = 0;
+  while (auto event = reader.next()) {
+    ++count;
+  }
+  EXPECT_LT(count, 10);
+  EXPECT_EQ(reader.status(), BinaryLogReader::Status::CORRUPTED);
+}
+
+/**
+ * @given Binary file with events having fields
+ * @when Read it by reader
+ * @then Fields are decoded as they were encoded
+ */
+TEST_F(SinkToBinaryFileTest, Fields) {
+  {
+    auto sink = createSink(0ms);
+    sink->push("logger", Level::INFO, "no fields");
+    sink->push("logger", Level::INFO, "block #{}", kv("number", 42u), 42,
+               kv("hash", "0xabc"));
+  }
+
+  BinaryLogReader reader(path_);
+  auto event = reader.next();
+  ASSERT_TRUE(event);
+  EXPECT_TRUE(event->fields.empty());
+
+  event = reader.next();
+  ASSERT_TRUE(event);
+  EXPECT_EQ(event->message, "block #42");
+  std::vector<std::string> fields;
+  Fields(event->fields).forEach([&](const Fields::View &field) {
+    fields.emplace_back(field.type == FieldType::UINT
+                            ? fmt::format("{}={}", field.key, field.uint_value)
+                            : fmt::format("{}={}", field.key,
+                                          field.string_value));
+  });
+  EXPECT_EQ(fields, (std::vector<std::string>{"number=42", "hash=0xabc"}));
+  EXPECT_FALSE(reader.next());
+}
@@ -0,0 +1,162 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <fstream>
+
+#include "soralog/impl/shm_ring.hpp"
+#include "soralog/impl/sink_to_crash_ring.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class SinkToCrashRingTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    dir_ = filename.data();
+    std::filesystem::create_directories(dir_);
+    path_ = dir_ / "node.ring";
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(dir_);
+  }
+
+  std::shared_ptr<SinkToCrashRing> createSink(size_t ring_size = 1 << 20) {
+    return std::make_shared<SinkToCrashRing>("crash", path_, ring_size,
+                                             Sink::ThreadInfoType::NAME);
+  }
+
+  /**
+   * @returns events kept in ring at {@param offset} of file {@param path}
+   */
+  static std::vector<std::string> extract(const std::filesystem::path &path,
+                                          uint64_t offset = 0) {
+    std::vector<std::string> messages;
+    auto ring = ShmRing::inspect(path, offset);
+    EXPECT_TRUE(ring != nullptr);
+    if (ring) {
+      std::vector<ShmRing::Record> records;
+      ring->read(records);
+      for (const auto &record : records) {
+        messages.emplace_back(record.message);
+      }
+      EXPECT_EQ(ring->corrupted(), 0);
+    }
+    return messages;
+  }
+
+ protected:
+  std::filesystem::path dir_;
+  std::filesystem::path path_;
+};
+
+/**
+ * @given Crash ring sink
+ * @when Push events
+ * @then Ring file has them immediately, without flushing
+ */
+TEST_F(SinkToCrashRingTest, WriteAndInspect) {
+  auto sink = createSink();
+  ASSERT_EQ(sink->path(), path_);
+
+  for (int i = 0; i < 10; ++i) {
+    sink->push("logger", Level::WARN, "message #{}", i);
+  }
+
+  auto messages = extract(path_);
+  ASSERT_EQ(messages.size(), 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(messages[i], fmt::format("message #{}", i));
+  }
+}
+
+/**
+ * @given Crash ring sink with small ring
+ * @when Push much more events than ring can hold
+ * @then Ring keeps the newest events in order
+ */
+TEST_F(SinkToCrashRingTest, OverwriteOldest) {
+  auto sink = createSink(4096);
+  const int n = 10000;
+  for (int i = 0; i < n; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+
+  auto messages = extract(path_);
+  ASSERT_GT(messages.size(), 10);
+  ASSERT_LT(messages.size(), n);
+  auto expected = n - static_cast<int>(messages.size());
+  for (const auto &message : messages) {
+    EXPECT_EQ(message, fmt::format("message #{}", expected++));
+  }
+}
+
+/**
+ * @given Process with crash ring sink
+ * @when Process is killed by signal
+ * @then Events are extracted from ring file, and the next run keeps it as
+ * previous ring
+ */
+TEST_F(SinkToCrashRingTest, SurvivesCrash) {
+  auto pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    auto sink = createSink();
+    for (int i = 0; i < 100; ++i) {
+      sink->push("logger", Level::INFO, "message #{}", i);
+    }
+    ::kill(::getpid(), SIGKILL);
+  }
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  ASSERT_TRUE(WIFSIGNALED(status));
+
+  auto messages = extract(path_);
+  ASSERT_EQ(messages.size(), 100);
+  EXPECT_EQ(messages.back(), "message #99");
+
+  auto sink = createSink();
+  auto previous_path = path_;
+  previous_path += SinkToCrashRing::previous_suffix;
+  EXPECT_EQ(extract(previous_path).size(), 100);
+  EXPECT_TRUE(extract(path_).empty());
+}
+
+/**
+ * @given File containing ring among other data (like core dump does)
+ * @when Inspect ring at its offset
+ * @then Events are extracted
+ */
+TEST_F(SinkToCrashRingTest, RingInsideOtherFile) {
+  {
+    auto sink = createSink(8192);
+    for (int i = 0; i < 10; ++i) {
+      sink->push("logger", Level::INFO, "message #{}", i);
+    }
+  }
+
+  auto core_path = dir_ / "core";
+  {
+    std::ofstream out(core_path, std::ios::binary);
+    std::string garbage(ShmRing::header_area_size * 3, '\xAB');
+    out << garbage;
+    std::ifstream in(path_, std::ios::binary);
+    out << in.rdbuf();
+    out << garbage;
+  }
+
+  EXPECT_EQ(ShmRing::inspect(core_path), nullptr);
+  auto messages = extract(core_path, ShmRing::header_area_size * 3);
+  ASSERT_EQ(messages.size(), 10);
+  EXPECT_EQ(messages.front(), "message #0");
+}
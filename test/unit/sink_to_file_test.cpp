@@ -5,6 +5,10 @@
 
 #include <gtest/gtest.h>
 
+#include <fstream>
+
+#include <zlib.h>
+
 #include "soralog/impl/sink_to_file.hpp"
 
 using namespace soralog;
@@ -38,19 +42,56 @@ class SinkToFileTest : public ::testing::Test {
   }
   void TearDown() override {
     std::remove(path_.native().data());
+    for (const auto &segment : segments()) {
+      std::filesystem::remove(segment);
+    }
   }
 
-  std::shared_ptr<FakeLogger> createLogger(std::chrono::milliseconds latency) {
+  std::shared_ptr<FakeLogger> createLogger(
+      std::chrono::milliseconds latency,
+      std::optional<SinkToFile::RotationPolicy> rotation = {},
+      std::optional<SinkToFile::Compression> compression = {}) {
     auto sink = std::make_shared<SinkToFile>(
         "file", path_,
         Sink::ThreadInfoType::NONE,  // ignore thread info
         4,                           // capacity: 4 events
         16384,                       // buffers size: 16 Kb
-        latency.count());
+        latency.count(), rotation, compression);
     return std::make_shared<FakeLogger>(std::move(sink));
   }
 
- private:
+  /**
+   * @returns decompressed content of gzip-file {@param path}, which is
+   * readable before first broken or truncated member
+   */
+  static std::string readGzip(const std::filesystem::path &path) {
+    gzFile in = gzopen(path.c_str(), "rb");
+    std::string content;
+    std::array<char, 4096> buff{};
+    int size;
+    while ((size = gzread(in, buff.data(), buff.size())) > 0) {
+      content.append(buff.data(), size);
+    }
+    gzclose(in);
+    return content;
+  }
+
+  /**
+   * @returns paths of rotated segments of log-file
+   */
+  std::vector<std::filesystem::path> segments() const {
+    std::vector<std::filesystem::path> result;
+    auto prefix = path_.filename().string() + ".";
+    for (const auto &entry :
+         std::filesystem::directory_iterator(path_.parent_path())) {
+      if (entry.path().filename().string().rfind(prefix, 0) == 0) {
+        result.emplace_back(entry.path());
+      }
+    }
+    return result;
+  }
+
+ protected:
   std::filesystem::path path_;
 };
 
@@ -67,3 +108,350 @@ TEST_F(SinkToFileTest, Logging) {
   }
   logger->flush();
 }
+
+/**
+ * @given Sink with size-based rotation and retention limit of files
+ * @when Push messages enough for several rotations
+ * @then No more than limited number of segments are kept, and each of them
+ * is not less than rotation size
+ */
+TEST_F(SinkToFileTest, RotationBySizeWithRetention) {
+  SinkToFile::RotationPolicy rotation;
+  rotation.max_size = 1024;
+  rotation.max_files = 3;
+
+  auto logger = createLogger(0ms, rotation);
+  for (int i = 1; i <= 200; ++i) {
+    logger->debug("message: {}", i);
+  }
+  logger->flush();
+  SegmentArchiver::instance()->wait();
+
+  auto files = segments();
+  EXPECT_EQ(files.size(), 3);
+  for (const auto &segment : files) {
+    EXPECT_GE(std::filesystem::file_size(segment), rotation.max_size);
+  }
+  EXPECT_LT(std::filesystem::file_size(path_), rotation.max_size);
+
+  // The newest segments are kept
+  std::ifstream last_segment(path_.string() + ".1");
+  EXPECT_FALSE(last_segment.is_open());
+}
+
+/**
+ * @given Numbered segments of log-file, and other files with names starting
+ * with name of log-file
+ * @when Retention is applied
+ * @then Segments with the greatest numbers are kept, and other files are not
+ * touched
+ */
+TEST_F(SinkToFileTest, RetentionKeepsUnrelatedFiles) {
+  for (int i = 1; i <= 10; ++i) {
+    std::ofstream(path_.string() + "." + std::to_string(i)) << i;
+  }
+  for (auto suffix : {".json", ".prev", ".3.tmp", ".20240101-000000x"}) {
+    std::ofstream(path_.string() + suffix) << suffix;
+  }
+
+  SegmentArchiver::applyRetention(path_, 3, 0);
+
+  for (int i = 1; i <= 10; ++i) {
+    EXPECT_EQ(std::filesystem::exists(path_.string() + "."
+                                      + std::to_string(i)),
+              i >= 8)
+        << i;
+  }
+  for (auto suffix : {".json", ".prev", ".3.tmp", ".20240101-000000x"}) {
+    EXPECT_TRUE(std::filesystem::exists(path_.string() + suffix)) << suffix;
+  }
+}
+
+/**
+ * @given Names of files
+ * @when They are parsed as names of segments of log-file 'app.log'
+ * @then Numbered and timestamped segments are recognized and ordered by
+ * number or time; other names are rejected
+ */
+TEST_F(SinkToFileTest, ParseSegmentName) {
+  auto parse = [](std::string_view name) {
+    return SegmentArchiver::parseSegmentName(name, "app.log");
+  };
+  ASSERT_TRUE(parse("app.log.9"));
+  ASSERT_TRUE(parse("app.log.10.gz"));
+  EXPECT_LT(*parse("app.log.9"), *parse("app.log.10.gz"));
+  ASSERT_TRUE(parse("app.log.20240101-235959"));
+  ASSERT_TRUE(parse("app.log.20240101-235959-2.gz"));
+  ASSERT_TRUE(parse("app.log.20240102-000000"));
+  EXPECT_TRUE(parse("app.log.20240101-235959")->timestamped);
+  EXPECT_LT(*parse("app.log.20240101-235959"),
+            *parse("app.log.20240101-235959-2.gz"));
+  EXPECT_LT(*parse("app.log.20240101-235959-2.gz"),
+            *parse("app.log.20240102-000000"));
+  for (auto name : {"app.log", "app.log.", "app.log.json", "app.log.prev",
+                    "app.log.1.tmp", "app.log.gz", "app.log.1-2",
+                    "app.log.20240101-2359", "app.log.20240101-235959-",
+                    "app.logs.1", "other.log.1"}) {
+    EXPECT_FALSE(parse(name)) << name;
+  }
+}
+
+/**
+ * @given Sink with size-based rotation and compression of segments
+ * @when Push messages enough for rotation
+ * @then Segment is replaced by its gzipped version with the same content
+ */
+TEST_F(SinkToFileTest, RotationWithCompression) {
+  SinkToFile::RotationPolicy rotation;
+  rotation.max_size = 1024;
+  rotation.compress = true;
+
+  auto logger = createLogger(0ms, rotation);
+  for (int i = 1; i <= 30; ++i) {
+    logger->debug("message: {:0>40}", i);
+  }
+  logger->flush();
+  SegmentArchiver::instance()->wait();
+
+  auto segment = path_.string() + ".1";
+  EXPECT_FALSE(std::filesystem::exists(segment));
+  ASSERT_TRUE(std::filesystem::exists(segment + ".gz"));
+
+  gzFile in = gzopen((segment + ".gz").c_str(), "rb");
+  ASSERT_NE(in, nullptr);
+  std::string content(4096, '\0');
+  content.resize(gzread(in, content.data(), content.size()));
+  gzclose(in);
+
+  EXPECT_GE(content.size(), rotation.max_size);
+  EXPECT_NE(content.find(fmt::format("message: {:0>40}\n", 1)),
+            std::string::npos);
+}
+
+/**
+ * @given Sink with timestamp-named rotation by interval
+ * @when Push messages before and after interval is elapsed
+ * @then Exactly one segment named by timestamp is produced
+ */
+TEST_F(SinkToFileTest, RotationByInterval) {
+  SinkToFile::RotationPolicy rotation;
+  rotation.interval = 1s;
+  rotation.naming = SinkToFile::RotationPolicy::Naming::TIMESTAMPED;
+
+  auto logger = createLogger(0ms, rotation);
+  logger->debug("before");
+  std::this_thread::sleep_for(1100ms);
+  logger->debug("after");
+  logger->flush();
+
+  auto files = segments();
+  ASSERT_EQ(files.size(), 1);
+  EXPECT_EQ(files[0].filename().string().size(),
+            path_.filename().string().size() + 16);  // ".YYYYMMDD-hhmmss"
+}
+
+/**
+ * @given Sink with streaming gzip compression
+ * @when Push messages, each flushed as separate frame
+ * @then File is valid multi-member gzip with all messages
+ */
+TEST_F(SinkToFileTest, StreamCompression) {
+  SinkToFile::Compression compression;
+  compression.codec = SinkToFile::Compression::Codec::GZIP;
+  compression.level = 9;
+
+  {
+    auto logger = createLogger(0ms, {}, compression);
+    for (int i = 1; i <= 10; ++i) {
+      logger->debug("message: {}", i);
+    }
+    logger->flush();
+  }
+
+  auto content = readGzip(path_);
+  for (int i = 1; i <= 10; ++i) {
+    EXPECT_NE(content.find(fmt::format("message: {}\n", i)),
+              std::string::npos);
+  }
+}
+
+/**
+ * @given File written by sink with streaming compression
+ * @when Last frame is torn (e.g. by crash)
+ * @then All previous frames are still decodable
+ */
+TEST_F(SinkToFileTest, StreamCompressionTornFrame) {
+  SinkToFile::Compression compression;
+  compression.codec = SinkToFile::Compression::Codec::GZIP;
+
+  {
+    auto logger = createLogger(0ms, {}, compression);
+    for (int i = 1; i <= 10; ++i) {
+      logger->debug("message: {}", i);
+    }
+    logger->flush();
+  }
+
+  std::filesystem::resize_file(path_, std::filesystem::file_size(path_) - 5);
+
+  auto content = readGzip(path_);
+  for (int i = 1; i <= 9; ++i) {
+    EXPECT_NE(content.find(fmt::format("message: {}\n", i)),
+              std::string::npos);
+  }
+}
+
+/**
+ * @given Sink with JSON layout
+ * @when Push messages with characters needing escape
+ * @then Each event is line of JSON object with escaped strings
+ */
+TEST_F(SinkToFileTest, JsonLayout) {
+  const std::string long_text(100, 'x');
+  {
+    SinkToFile sink("file", path_, Sink::ThreadInfoType::ID, 4, 16384, 0, {},
+                    {}, SinkToFile::Layout::JSON);
+    sink.push("logger", Level::WARN, "plain");
+    sink.push("lo\"gger", Level::DEBUG, "quote \" backslash \\ tab \t end");
+    sink.push("logger", Level::INFO, "{}\n{}\x01{}", long_text, long_text,
+              long_text);
+  }
+
+  std::ifstream in(path_);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(in, line);) {
+    lines.emplace_back(std::move(line));
+  }
+  ASSERT_EQ(lines.size(), 3);
+
+  // Timestamp is UTC in ISO 8601: "YYYY-MM-DDThh:mm:ss.uuuuuuZ"
+  const std::string prefix = R"({"timestamp":")";
+  const size_t tail = prefix.size() + 28;
+  for (const auto &line : lines) {
+    ASSERT_GT(line.size(), tail);
+    EXPECT_EQ(line.substr(0, prefix.size()), prefix);
+    EXPECT_EQ(line[prefix.size() + 10], 'T');
+    EXPECT_EQ(line.substr(tail - 2, 2), "Z\"");
+  }
+
+  const auto thread =
+      fmt::format(R"(,"thread":{},)", soralog::util::getThreadNumber());
+  EXPECT_EQ(lines[0].substr(tail),
+            R"(,"level":"Warning")" + thread
+                + R"("logger":"logger","message":"plain"})");
+  EXPECT_EQ(lines[1].substr(tail),
+            R"(,"level":"Debug")" + thread
+                + R"("logger":"lo\"gger",)"
+                  R"("message":"quote \" backslash \\ tab \t end"})");
+  EXPECT_EQ(lines[2].substr(tail),
+            R"(,"level":"Info")" + thread + R"("logger":"logger","message":")"
+                + long_text + R"(\n)" + long_text + R"(\u0001)" + long_text
+                + R"("})");
+}
+
+/**
+ * @given Sinks with text and JSON layouts
+ * @when Push message with fields
+ * @then Fields follow message as key=value in text, and as typed members
+ * of object in JSON
+ */
+TEST_F(SinkToFileTest, Fields) {
+  auto json_path = path_;
+  json_path += ".json";
+  {
+    SinkToFile text("text", path_, Sink::ThreadInfoType::NONE, 4, 16384, 0);
+    SinkToFile json("json", json_path, Sink::ThreadInfoType::NONE, 4, 16384,
+                    0, {}, {}, SinkToFile::Layout::JSON);
+    for (auto *sink : {&text, &json}) {
+      sink->push("logger", Level::INFO, "block #{}", kv("hash", "a\"b"), 7,
+                 kv("size", -1), kv("ok", true), kv("ratio", 0.25));
+    }
+  }
+
+  std::ifstream text_in(path_);
+  std::string line;
+  ASSERT_TRUE(std::getline(text_in, line));
+  EXPECT_NE(line.find(R"(block #7 hash="a\"b" size=-1 ok=true ratio=0.25)"),
+            std::string::npos)
+      << line;
+
+  std::ifstream json_in(json_path);
+  ASSERT_TRUE(std::getline(json_in, line));
+  std::filesystem::remove(json_path);
+  EXPECT_NE(line.find(R"("message":"block #7","hash":"a\"b","size":-1,)"
+                      R"("ok":true,"ratio":0.25})"),
+            std::string::npos)
+      << line;
+}
+
+/**
+ * @given Sink with custom pattern
+ * @when Push message
+ * @then Line is rendered by pattern
+ */
+TEST_F(SinkToFileTest, Pattern) {
+  {
+    SinkToFile sink("file", path_, Sink::ThreadInfoType::NONE, 4, 16384, 0,
+                    {}, {}, {}, "[%L] %n: %v");
+    sink.push("logger", Level::WARN, "message #{}", 1);
+  }
+  std::ifstream in(path_);
+  std::string line;
+  ASSERT_TRUE(std::getline(in, line));
+  EXPECT_EQ(line, "[W] logger: message #1");
+}
+
+/**
+ * @given Sink in zero-copy mode with small queue
+ * @when Push short and long messages
+ * @then File has the same lines as written by copying
+ */
+TEST_F(SinkToFileTest, ZeroCopy) {
+  auto copy_path = path_;
+  copy_path += ".copy";
+  const std::string long_text(1000, 'x');
+  {
+    SinkToFile zero_copy("zero-copy", path_, Sink::ThreadInfoType::NONE, 4,
+                         16384, 0, {}, {}, {}, "%n %v", true);
+    SinkToFile copy("copy", copy_path, Sink::ThreadInfoType::NONE, 4, 16384,
+                    0, {}, {}, {}, "%n %v");
+    for (auto *sink : {&zero_copy, &copy}) {
+      for (auto i = 0; i < 20; ++i) {
+        sink->push("logger", Level::INFO, "#{} {}", i,
+                   i % 3 == 0 ? long_text : "short");
+      }
+    }
+  }
+
+  auto read = [](const std::filesystem::path &path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  };
+  const auto content = read(path_);
+  EXPECT_EQ(content, read(copy_path));
+  EXPECT_NE(content.find("logger #18 " + long_text + "\n"), std::string::npos);
+  std::filesystem::remove(copy_path);
+}
+
+/**
+ * @given Sink with latency
+ * @when Nothing is pushed, then one event is pushed
+ * @then File is neither created nor written till the first event, and is
+ * written after it
+ */
+TEST_F(SinkToFileTest, LazyStart) {
+  {
+    SinkToFile sink("lazy", path_, Sink::ThreadInfoType::NONE, 4, 16384,
+                    1000000);
+    sink.flush();
+    sink.rotate();
+    EXPECT_FALSE(std::filesystem::exists(path_));
+    EXPECT_EQ(sink.queueStats().capacity, 4);
+
+    sink.push("logger", Level::INFO, "first");
+    EXPECT_TRUE(std::filesystem::exists(path_));
+  }
+  std::ifstream in(path_);
+  const std::string content(std::istreambuf_iterator<char>(in), {});
+  EXPECT_NE(content.find("first"), std::string::npos);
+}
@@ -0,0 +1,274 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <mutex>
+
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/impl/sink_to_flight_recorder.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+/**
+ * Sink keeping messages of events in memory
+ */
+class CaptureSink final : public Sink {
+ public:
+  explicit CaptureSink(std::string name)
+      : Sink(std::move(name), ThreadInfoType::NONE, 1024, 1 << 20, 0) {}
+
+  void flush() noexcept override {
+    std::lock_guard guard(mutex_);
+    while (auto node = events_.get()) {
+      messages_.emplace_back(std::string(node->message()));
+      levels_.emplace_back(node->level());
+      size_ -= node->message().size();
+    }
+  }
+
+  void rotate() noexcept override {}
+
+  std::vector<std::string> messages() {
+    std::lock_guard guard(mutex_);
+    return messages_;
+  }
+
+  std::vector<Level> levels() {
+    std::lock_guard guard(mutex_);
+    return levels_;
+  }
+
+ protected:
+  void async_flush() noexcept override {
+    flush();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::string> messages_;
+  std::vector<Level> levels_;
+};
+
+class SinkToFlightRecorderTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    dump_ = std::make_shared<CaptureSink>("dump");
+    forward_ = std::make_shared<CaptureSink>("forward");
+  }
+
+  std::shared_ptr<SinkToFlightRecorder> createRecorder(
+      size_t memory_size = 1 << 20, size_t latency = 0) {
+    return std::make_shared<SinkToFlightRecorder>(
+        "recorder", memory_size, dump_, forward_, Level::WARN,
+        Sink::ThreadInfoType::NONE,
+        1024,     // capacity
+        1 << 20,  // buffer size
+        latency);
+  }
+
+  /**
+   * Waits till recorder with latency does {@param dumps} dumps
+   */
+  static void waitDumps(const SinkToFlightRecorder &recorder, size_t dumps) {
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (recorder.dumps() < dumps
+           && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+
+  std::shared_ptr<CaptureSink> dump_;
+  std::shared_ptr<CaptureSink> forward_;
+};
+
+/**
+ * @given flight recorder
+ * @when events are pushed, and then dump is requested
+ * @then dump sink gets header and all events in original order
+ */
+TEST_F(SinkToFlightRecorderTest, DumpByRequest) {
+  auto recorder = createRecorder();
+
+  for (auto i = 0; i < 10; ++i) {
+    recorder->push("log", Level::DEBUG, "message #{}", i);
+  }
+  EXPECT_TRUE(dump_->messages().empty());
+
+  recorder->dump();
+
+  auto messages = dump_->messages();
+  ASSERT_EQ(messages.size(), 11);
+  EXPECT_NE(messages[0].find("10 events"), std::string::npos) << messages[0];
+  for (auto i = 0; i < 10; ++i) {
+    EXPECT_EQ(messages[i + 1], fmt::format("message #{}", i));
+  }
+  EXPECT_EQ(dump_->levels()[1], Level::DEBUG);
+  EXPECT_EQ(recorder->dumps(), 1);
+
+  // Dumped events are forgotten
+  recorder->dump();
+  EXPECT_EQ(dump_->messages().size(), 12);
+}
+
+/**
+ * @given flight recorder with small memory
+ * @when much more events are pushed than fit into memory
+ * @then dump contains only the newest events
+ */
+TEST_F(SinkToFlightRecorderTest, OverwriteOldest) {
+  auto recorder = createRecorder(0);  // minimal size
+
+  const std::string payload(200, 'x');
+  const auto n = 10000;
+  for (auto i = 0; i < n; ++i) {
+    recorder->push("log", Level::TRACE, "{} {}", i, payload);
+  }
+  recorder->dump();
+
+  auto messages = dump_->messages();
+  ASSERT_GT(messages.size(), 2);
+  EXPECT_LT(messages.size(), n / 2);
+
+  // Kept events are contiguous and end with the newest one
+  auto expected = n - static_cast<int>(messages.size() - 1);
+  for (size_t i = 1; i < messages.size(); ++i, ++expected) {
+    EXPECT_EQ(messages[i], fmt::format("{} {}", expected, payload));
+  }
+}
+
+/**
+ * @given flight recorder with forward sink
+ * @when events of different levels are pushed
+ * @then only warnings and more severe are forwarded immediately, and
+ * critical event triggers dump of all events
+ */
+TEST_F(SinkToFlightRecorderTest, ForwardAndDumpOnCritical) {
+  auto recorder = createRecorder();
+
+  recorder->push("log", Level::DEBUG, "debug");
+  recorder->push("log", Level::WARN, "warn");
+  recorder->push("log", Level::VERBOSE, "verbose");
+  EXPECT_EQ(forward_->messages(), std::vector<std::string>{"warn"});
+  EXPECT_TRUE(dump_->messages().empty());
+
+  recorder->push("log", Level::CRITICAL, "critical");
+  EXPECT_EQ(forward_->messages(),
+            (std::vector<std::string>{"warn", "critical"}));
+
+  auto messages = dump_->messages();
+  ASSERT_EQ(messages.size(), 5);
+  EXPECT_EQ(messages[1], "debug");
+  EXPECT_EQ(messages[4], "critical");
+}
+
+/**
+ * @given flight recorder with worker, which dumps on signal
+ * @when signal is raised
+ * @then worker dumps events
+ */
+TEST_F(SinkToFlightRecorderTest, DumpOnSignal) {
+  auto recorder = createRecorder(1 << 20, 10);
+  ASSERT_TRUE(SinkToFlightRecorder::dumpOnSignal(SIGUSR2));
+
+  recorder->push("log", Level::INFO, "before signal");
+  std::this_thread::sleep_for(50ms);
+  EXPECT_EQ(recorder->dumps(), 0);
+
+  ASSERT_EQ(std::raise(SIGUSR2), 0);
+  waitDumps(*recorder, 1);
+
+  auto messages = dump_->messages();
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_NE(messages[0].find("signal"), std::string::npos) << messages[0];
+  EXPECT_EQ(messages[1], "before signal");
+
+  std::signal(SIGUSR2, SIG_DFL);
+}
+
+/**
+ * @given configuration with recorder, which dumps into console sink and
+ * forwards warnings into it
+ * @when logger of verbose group logs and dump is requested
+ * @then recorder is created from config and dumps on request
+ */
+TEST_F(SinkToFlightRecorderTest, Yaml) {
+  auto system =
+      std::make_shared<LoggingSystem>(std::make_shared<ConfiguratorFromYAML>(
+          std::string(R"(
+sinks:
+  - name: regular
+    type: console
+  - name: recorder
+    type: recorder
+    memory_size: 1048576
+    dump_sink: regular
+    forward_sink: regular
+    forward_level: warning
+    latency: 0
+groups:
+  - name: main
+    sink: recorder
+    level: trace
+)")));
+  auto result = system->configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+  EXPECT_FALSE(result.has_warning) << result.message;
+
+  auto recorder = std::dynamic_pointer_cast<SinkToFlightRecorder>(
+      system->getSink("recorder"));
+  ASSERT_TRUE(recorder);
+
+  auto logger = system->getLogger("test", "main");
+  logger->trace("trace");
+  logger->warn("warning");
+  recorder->dump();
+  EXPECT_EQ(recorder->dumps(), 1);
+}
+
+/**
+ * @given flight recorder dumping into sink with filter limited by group
+ * @when loggers of different groups log events, and dump is requested
+ * @then dump sink gets events of logger of that group only, i.e. rules of
+ * its filter are selected by group of origin logger
+ */
+TEST_F(SinkToFlightRecorderTest, GroupFilterOfDumpSink) {
+  auto system =
+      std::make_shared<LoggingSystem>(std::make_shared<ConfiguratorFromYAML>(
+          std::string(R"(
+sinks:
+  - name: console
+    type: console
+groups:
+  - name: main
+    sink: console
+    level: trace
+    children:
+      - name: network
+)")));
+  auto result = system->configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+
+  dump_->setFilter(std::make_shared<SinkFilter>(
+      std::vector<SinkFilter::Rule>{{Level::TRACE, {}, {"network"}, {}, {}}}));
+  auto recorder = createRecorder();
+
+  auto peer = system->getLogger("peer", "network");
+  auto main = system->getLogger("main", "main");
+  for (const auto &logger : {peer, main}) {
+    logger->setSink(recorder);
+  }
+
+  peer->debug("from network");
+  main->debug("from main");
+  recorder->dump();
+
+  EXPECT_EQ(dump_->messages(), std::vector<std::string>{"from network"});
+}
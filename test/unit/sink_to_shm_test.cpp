@@ -0,0 +1,247 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/impl/shm_collector.hpp"
+#include "soralog/impl/shm_ring.hpp"
+#include "soralog/impl/sink_to_shm.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class SinkToShmTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    dir_ = filename.data();
+    std::filesystem::create_directories(dir_);
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(dir_);
+  }
+
+  std::shared_ptr<SinkToShm> createSink(size_t ring_size = 1 << 20) {
+    return std::make_shared<SinkToShm>("shm", "test", dir_, ring_size,
+                                       Sink::ThreadInfoType::NAME,
+                                       1024,     // capacity
+                                       1 << 20,  // buffer size
+                                       0);       // latency: synchronous
+  }
+
+  /**
+   * @returns logging system writing all events into file {@param path}
+   */
+  static std::shared_ptr<LoggingSystem> createSystem(
+      const std::filesystem::path &path) {
+    auto system =
+        std::make_shared<LoggingSystem>(std::make_shared<ConfiguratorFromYAML>(
+            std::string(R"(
+sinks:
+  - name: file
+    type: file
+    path: )") + path.string()
+            + R"(
+    thread: name
+    latency: 0
+groups:
+  - name: main
+    sink: file
+    level: trace
+)"));
+    auto result = system->configure();
+    EXPECT_FALSE(result.has_error) << result.message;
+    return system;
+  }
+
+  static std::vector<std::string> readLines(const std::filesystem::path &path) {
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) {
+      lines.emplace_back(std::move(line));
+    }
+    return lines;
+  }
+
+  size_t countRings() const {
+    size_t count = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(dir_)) {
+      count += entry.path().extension() == ".ring";
+    }
+    return count;
+  }
+
+ protected:
+  std::filesystem::path dir_;
+};
+
+/**
+ * @given Shared memory sink
+ * @when Push events
+ * @then Consumer reads them from ring with all properties
+ */
+TEST_F(SinkToShmTest, WriteAndRead) {
+  util::setThreadName("Producer");
+  auto sink = createSink();
+  ASSERT_FALSE(sink->path().empty());
+
+  auto before = std::chrono::system_clock::now() - 1us;
+  for (int i = 0; i < 10; ++i) {
+    sink->push("logger", Level::WARN, "message #{}", i);
+  }
+
+  auto ring = ShmRing::attach(sink->path());
+  ASSERT_TRUE(ring != nullptr);
+  EXPECT_EQ(ring->pid(), ::getpid());
+
+  std::vector<ShmRing::Record> records;
+  ASSERT_EQ(ring->read(records), 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(records[i].name, "logger");
+    EXPECT_EQ(records[i].level, Level::WARN);
+    EXPECT_EQ(records[i].message, fmt::format("message #{}", i));
+    EXPECT_EQ(records[i].thread_name, "Producer");
+    EXPECT_EQ(records[i].thread_number, util::getThreadNumber());
+    EXPECT_GE(records[i].timestamp, before);
+  }
+  ring->release();
+  EXPECT_FALSE(ring->isAbandoned());
+
+  sink.reset();
+  EXPECT_TRUE(ring->isAbandoned());
+}
+
+/**
+ * @given Shared memory sink with small ring
+ * @when Push and consume events by turns many times
+ * @then Ring wraps around, and all events are read in order
+ */
+TEST_F(SinkToShmTest, WrapAround) {
+  auto sink = createSink(8192);
+  auto ring = ShmRing::attach(sink->path());
+  ASSERT_TRUE(ring != nullptr);
+
+  int next = 0;
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 37; ++i) {
+      sink->push("logger", Level::INFO, "message #{}", round * 37 + i);
+    }
+    std::vector<ShmRing::Record> records;
+    ring->read(records);
+    for (const auto &record : records) {
+      EXPECT_EQ(record.message, fmt::format("message #{}", next++));
+    }
+    ring->release();
+  }
+  EXPECT_EQ(next, 3700);
+  EXPECT_EQ(sink->dropped(), 0);
+  EXPECT_EQ(ring->corrupted(), 0);
+}
+
+/**
+ * @given Shared memory sink with small ring which is not drained
+ * @when Push more events than ring can hold
+ * @then Excess events are dropped without blocking and counted
+ */
+TEST_F(SinkToShmTest, Overflow) {
+  auto sink = createSink(4096);
+  for (int i = 0; i < 1000; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+
+  auto ring = ShmRing::attach(sink->path());
+  std::vector<ShmRing::Record> records;
+  ring->read(records);
+  EXPECT_GT(sink->dropped(), 0);
+  EXPECT_EQ(records.size() + sink->dropped(), 1000);
+}
+
+/**
+ * @given Two producers writing events by turns
+ * @when Collector drains them
+ * @then Events are written by configured sink merged in order of time, and
+ * rings of finished producers are removed
+ */
+TEST_F(SinkToShmTest, CollectorMergesProducers) {
+  auto log_path = dir_ / "collected.log";
+  {
+    auto system = createSystem(log_path);
+    ShmCollector collector(*system, dir_, "test");
+
+    auto sink1 = createSink();
+    auto sink2 = createSink();
+    for (int i = 0; i < 20; ++i) {
+      (i % 2 ? sink1 : sink2)->push("main", Level::INFO, "message #{}", i);
+    }
+
+    EXPECT_EQ(collector.poll(true), 20);
+    EXPECT_EQ(collector.rings(), 2);
+
+    sink1.reset();
+    sink2.reset();
+    EXPECT_EQ(collector.poll(true), 0);
+    EXPECT_EQ(collector.rings(), 0);
+    EXPECT_EQ(countRings(), 0);
+  }
+
+  auto lines = readLines(log_path);
+  ASSERT_EQ(lines.size(), 20);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_NE(lines[i].find(fmt::format("main  message #{}", i)),
+              std::string::npos)
+        << lines[i];
+  }
+}
+
+/**
+ * @given Producer process which died in the middle of writing of record
+ * @when Collector drains its ring
+ * @then All completed records are collected, and ring is removed
+ */
+TEST_F(SinkToShmTest, ProducerDiedMidRecord) {
+  auto ring_path = dir_ / "test.crashed.ring";
+
+  auto pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    auto ring = ShmRing::create(ring_path, 1 << 16);
+    for (int i = 0; i < 5; ++i) {
+      auto message = fmt::format("message #{}", i);
+      Event event(std::chrono::system_clock::now(), 1, "Child", "main",
+                  Level::INFO, message);
+      ring->put(event);
+    }
+    ring->publish();
+
+    // Next record is being written but is not published
+    Event event(std::chrono::system_clock::now(), 1, "Child", "main",
+                Level::INFO, "torn");
+    ring->put(event);
+    ::_exit(0);  // without closing of ring
+  }
+  ::waitpid(pid, nullptr, 0);
+
+  auto log_path = dir_ / "collected.log";
+  {
+    auto system = createSystem(log_path);
+    ShmCollector collector(*system, dir_, "test");
+
+    EXPECT_EQ(collector.poll(true), 5);
+    EXPECT_EQ(collector.rings(), 0);
+    EXPECT_FALSE(std::filesystem::exists(ring_path));
+  }
+
+  auto lines = readLines(log_path);
+  ASSERT_EQ(lines.size(), 5);
+  EXPECT_NE(lines[0].find("Child"), std::string::npos) << lines[0];
+}
@@ -0,0 +1,335 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "soralog/impl/sink_to_socket.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+/**
+ * Loopback collector: accepts connections and collects messages of records
+ */
+class Collector {
+ public:
+  ~Collector() {
+    stop();
+  }
+
+  /**
+   * Starts listening of TCP {@param port} on loopback (any free port if 0)
+   * @returns port
+   */
+  uint16_t listenTcp(uint16_t port = 0) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    listener_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    EXPECT_EQ(
+        ::bind(listener_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+        0);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listener_, reinterpret_cast<sockaddr *>(&addr), &len);
+    start();
+    return ntohs(addr.sin_port);
+  }
+
+  /**
+   * Starts listening of Unix socket {@param path}
+   */
+  void listenUnix(const std::string &path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_EQ(
+        ::bind(listener_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+        0);
+    start();
+  }
+
+  /**
+   * Closes listener and all connections
+   */
+  void stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    stop_ = false;
+  }
+
+  /**
+   * Waits till {@param count} messages are received, not longer than
+   * {@param timeout}
+   * @returns received messages
+   */
+  std::vector<std::string> wait(size_t count,
+                                std::chrono::milliseconds timeout = 5s) {
+    std::unique_lock lock(mutex_);
+    condvar_.wait_for(lock, timeout,
+                      [&] { return messages_.size() >= count; });
+    return messages_;
+  }
+
+  size_t connections() const {
+    return connections_;
+  }
+
+ private:
+  void start() {
+    EXPECT_EQ(::listen(listener_, 4), 0);
+    thread_ = std::thread([this] { run(); });
+  }
+
+  void run() {
+    std::vector<pollfd> fds{{listener_, POLLIN, 0}};
+    std::vector<std::string> data{{}};
+    std::array<char, 1 << 16> buff{};
+
+    while (!stop_) {
+      if (::poll(fds.data(), fds.size(), 10) <= 0) {
+        continue;
+      }
+      if (fds[0].revents & POLLIN) {
+        fds.push_back({::accept(listener_, nullptr, nullptr), POLLIN, 0});
+        data.emplace_back();
+        ++connections_;
+      }
+      for (size_t i = 1; i < fds.size(); ++i) {
+        if (!(fds[i].revents & (POLLIN | POLLHUP))) {
+          continue;
+        }
+        auto size = ::recv(fds[i].fd, buff.data(), buff.size(), 0);
+        if (size <= 0) {
+          // Torn record of closed connection is discarded
+          ::close(fds[i].fd);
+          fds.erase(fds.begin() + i);
+          data.erase(data.begin() + i);
+          --i;
+          continue;
+        }
+        auto &stream = data[i];
+        stream.append(buff.data(), size);
+        size_t pos = 0;
+        std::lock_guard lock(mutex_);
+        while (stream.size() - pos >= 4) {
+          uint32_t len = 0;
+          for (size_t k = 0; k < 4; ++k) {
+            len = (len << 8) | static_cast<uint8_t>(stream[pos + k]);
+          }
+          if (stream.size() - pos - 4 < len) {
+            break;
+          }
+          messages_.emplace_back(stream.substr(pos + 4, len));
+          pos += 4 + len;
+        }
+        stream.erase(0, pos);
+        condvar_.notify_all();
+      }
+    }
+
+    for (auto &fd : fds) {
+      ::close(fd.fd);
+    }
+    listener_ = -1;
+  }
+
+  int listener_ = -1;
+  std::thread thread_;
+  std::atomic_bool stop_ = false;
+  std::atomic_size_t connections_ = 0;
+  std::mutex mutex_;
+  std::condition_variable condvar_;
+  std::vector<std::string> messages_;
+};
+
+class SinkToSocketTest : public ::testing::Test {
+ public:
+  std::shared_ptr<SinkToSocket> createSink(
+      const std::string &address, std::optional<size_t> budget = {},
+      std::optional<SinkToSocket::DropPolicy> drop_policy = {}) {
+    return std::make_shared<SinkToSocket>("socket", address, budget,
+                                          drop_policy,
+                                          Sink::ThreadInfoType::NONE,
+                                          1024,     // capacity
+                                          1 << 20,  // buffer size
+                                          10);      // latency
+  }
+
+  /**
+   * @returns number of message of record {@param record}
+   */
+  static int number(const std::string &record) {
+    auto pos = record.rfind('#');
+    return pos == std::string::npos ? -1 : std::stoi(record.substr(pos + 1));
+  }
+
+  /**
+   * @returns address of TCP port which nobody listens now
+   */
+  static uint16_t freePort() {
+    Collector probe;
+    auto port = probe.listenTcp();
+    probe.stop();
+    return port;
+  }
+};
+
+/**
+ * @given Socket sink connected to collector
+ * @when Push a lot of events
+ * @then All of them are received in order
+ */
+TEST_F(SinkToSocketTest, Throughput) {
+  Collector collector;
+  auto port = collector.listenTcp();
+
+  constexpr int total = 100000;
+  {
+    auto sink = createSink("127.0.0.1:" + std::to_string(port));
+    for (int i = 0; i < total; ++i) {
+      sink->push("logger", Level::INFO, "message #{}", i);
+    }
+  }
+
+  auto messages = collector.wait(total);
+  ASSERT_EQ(messages.size(), total);
+  for (int i = 0; i < total; ++i) {
+    ASSERT_EQ(number(messages[i]), i);
+  }
+  EXPECT_NE(messages[0].find("Info      logger  message #0"),
+            std::string::npos)
+      << messages[0];
+}
+
+/**
+ * @given Socket sink connected to Unix socket of collector
+ * @when Push events
+ * @then They are received
+ */
+TEST_F(SinkToSocketTest, UnixSocket) {
+  std::array<char, L_tmpnam> filename{};
+  ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+  std::string path = std::string(filename.data()) + ".sock";
+
+  Collector collector;
+  collector.listenUnix(path);
+  {
+    auto sink = createSink(path);
+    for (int i = 0; i < 10; ++i) {
+      sink->push("logger", Level::INFO, "message #{}", i);
+    }
+  }
+  EXPECT_EQ(collector.wait(10).size(), 10);
+  std::remove(path.c_str());
+}
+
+/**
+ * @given Socket sink connected to collector
+ * @when Collector is restarted
+ * @then Sink reconnects, and events pushed meanwhile are delivered
+ */
+TEST_F(SinkToSocketTest, Reconnect) {
+  Collector collector;
+  auto port = collector.listenTcp();
+  auto sink = createSink("127.0.0.1:" + std::to_string(port));
+
+  for (int i = 0; i < 10; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  ASSERT_EQ(collector.wait(10).size(), 10);
+
+  collector.stop();
+  std::this_thread::sleep_for(50ms);
+
+  for (int i = 10; i < 20; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  std::this_thread::sleep_for(300ms);
+  EXPECT_FALSE(sink->connected());
+
+  collector.listenTcp(port);
+  for (int i = 20; i < 30; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+
+  auto messages = collector.wait(30);
+  ASSERT_EQ(messages.size(), 30);
+  for (int i = 0; i < 30; ++i) {
+    EXPECT_EQ(number(messages[i]), i);
+  }
+  EXPECT_EQ(collector.connections(), 2);
+  EXPECT_EQ(sink->dropped(), 0);
+}
+
+/**
+ * @given Socket sink with small budget and collector which is not started
+ * @when Push more events than budget allows, then start collector
+ * @then Oldest events are delivered, the newest ones are dropped
+ */
+TEST_F(SinkToSocketTest, BudgetDropNewest) {
+  auto port = freePort();
+  auto sink = createSink("127.0.0.1:" + std::to_string(port), 4096,
+                         SinkToSocket::DropPolicy::NEWEST);
+
+  constexpr int total = 1000;
+  for (int i = 0; i < total; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  std::this_thread::sleep_for(100ms);  // let worker to process all events
+
+  Collector collector;
+  collector.listenTcp(port);
+  auto dropped = sink->dropped();
+  ASSERT_GT(dropped, 0);
+  auto messages = collector.wait(total - dropped);
+  ASSERT_EQ(messages.size(), total - dropped);
+  for (size_t i = 0; i < messages.size(); ++i) {
+    EXPECT_EQ(number(messages[i]), i);
+  }
+}
+
+/**
+ * @given Socket sink with small budget and collector which is not started
+ * @when Push more events than budget allows, then start collector
+ * @then Newest events are delivered, the oldest ones are dropped
+ */
+TEST_F(SinkToSocketTest, BudgetDropOldest) {
+  auto port = freePort();
+  auto sink = createSink("127.0.0.1:" + std::to_string(port), 4096,
+                         SinkToSocket::DropPolicy::OLDEST);
+
+  constexpr int total = 1000;
+  for (int i = 0; i < total; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  std::this_thread::sleep_for(100ms);  // let worker to process all events
+
+  Collector collector;
+  collector.listenTcp(port);
+  auto dropped = sink->dropped();
+  ASSERT_GT(dropped, 0);
+  auto messages = collector.wait(total - dropped);
+  ASSERT_EQ(messages.size(), total - dropped);
+  for (size_t i = 0; i < messages.size(); ++i) {
+    EXPECT_EQ(number(messages[i]), dropped + i);
+  }
+}
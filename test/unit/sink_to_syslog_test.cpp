@@ -0,0 +1,181 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <regex>
+
+#include "soralog/impl/sink_to_syslog.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class SinkToSyslogTest : public ::testing::Test {
+ public:
+  void TearDown() override {
+    if (socket_ >= 0) {
+      ::close(socket_);
+    }
+    if (!path_.empty()) {
+      std::remove(path_.c_str());
+    }
+  }
+
+  /**
+   * Binds receiving Unix datagram socket
+   * @returns address for sink
+   */
+  std::string bindUnix() {
+    std::array<char, L_tmpnam> filename{};
+    EXPECT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    path_ = std::string(filename.data()) + ".sock";
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+    socket_ = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    EXPECT_EQ(
+        ::bind(socket_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+        0);
+    return path_;
+  }
+
+  /**
+   * Binds receiving UDP socket on loopback
+   * @returns address for sink
+   */
+  std::string bindUdp() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socket_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    EXPECT_EQ(
+        ::bind(socket_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+        0);
+    socklen_t len = sizeof(addr);
+    ::getsockname(socket_, reinterpret_cast<sockaddr *>(&addr), &len);
+    return "127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+  }
+
+  /**
+   * @returns received datagrams (waits for first one not longer than
+   * {@param timeout})
+   */
+  std::vector<std::string> receive(std::chrono::milliseconds timeout = 1s) {
+    std::vector<std::string> result;
+    timeval tv{static_cast<time_t>(timeout / 1s),
+               static_cast<suseconds_t>(timeout % 1s / 1us)};
+    ::setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::array<char, 8192> buff{};
+    while (true) {
+      auto size = ::recv(socket_, buff.data(), buff.size(),
+                         result.empty() ? 0 : MSG_DONTWAIT);
+      if (size < 0) {
+        break;
+      }
+      result.emplace_back(buff.data(), size);
+    }
+    return result;
+  }
+
+ protected:
+  std::string path_;
+  int socket_ = -1;
+};
+
+/**
+ * @given Syslog sink connected to Unix datagram socket
+ * @when Push events
+ * @then RFC 5424 messages are received
+ */
+TEST_F(SinkToSyslogTest, UnixSocket) {
+  auto address = bindUnix();
+  {
+    auto sink = std::make_shared<SinkToSyslog>(
+        "syslog", address, SinkToSyslog::Facility::LOCAL3, "test-app",
+        Sink::ThreadInfoType::NONE, 16, 65536, 10);
+    sink->push("logger", Level::ERROR_, "message #{}", 1);
+    sink->push("other logger", Level::DEBUG, "message #{}", 2);
+    sink->flush();
+  }
+
+  auto messages = receive();
+  ASSERT_EQ(messages.size(), 2);
+
+  // <local3*8+err> VERSION TIMESTAMP HOSTNAME APP-NAME PROCID MSGID SD MSG
+  std::regex re(
+      R"(<(\d+)>1 \d{4}-\d\d-\d\dT\d\d:\d\d:\d\d\.\d{6}Z \S+ (\S+) (\d+) (\S+) - (.*))");
+  std::smatch match;
+  ASSERT_TRUE(std::regex_match(messages[0], match, re)) << messages[0];
+  EXPECT_EQ(match[1], std::to_string(19 * 8 + 3));
+  EXPECT_EQ(match[2], "test-app");
+  EXPECT_EQ(match[3], std::to_string(::getpid()));
+  EXPECT_EQ(match[4], "logger");
+  EXPECT_EQ(match[5], "message #1");
+
+  ASSERT_TRUE(std::regex_match(messages[1], match, re)) << messages[1];
+  EXPECT_EQ(match[1], std::to_string(19 * 8 + 7));
+  EXPECT_EQ(match[4], "other_logger");
+  EXPECT_EQ(match[5], "message #2");
+}
+
+/**
+ * @given Syslog sink connected to UDP socket
+ * @when Push events by batch
+ * @then All messages are received
+ */
+TEST_F(SinkToSyslogTest, Udp) {
+  auto address = bindUdp();
+  {
+    auto sink = std::make_shared<SinkToSyslog>(
+        "syslog", address, std::nullopt, std::nullopt,
+        Sink::ThreadInfoType::ID, 128, 1 << 20, 10);
+    for (int i = 0; i < 100; ++i) {
+      sink->push("logger", Level::INFO, "message #{}", i);
+    }
+    sink->flush();
+  }
+
+  auto messages = receive();
+  ASSERT_EQ(messages.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(messages[i].substr(0, 5), "<14>1");  // user.info
+    auto tail = fmt::format("[T:{}] message #{}", util::getThreadNumber(), i);
+    EXPECT_EQ(messages[i].substr(messages[i].size() - tail.size()), tail);
+  }
+}
+
+/**
+ * @given Syslog sink connected to receiver which does not read
+ * @when Push more events than socket can hold
+ * @then Pushing is not blocked, and excess records are counted as dropped
+ */
+TEST_F(SinkToSyslogTest, ReceiverDoesNotKeepUp) {
+  auto address = bindUnix();
+  constexpr size_t total = 1000;
+
+  size_t dropped = 0;
+  {
+    auto sink = std::make_shared<SinkToSyslog>(
+        "syslog", address, std::nullopt, std::nullopt,
+        Sink::ThreadInfoType::NONE, 16, 65536, 0);
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < total; ++i) {
+      sink->push("logger", Level::INFO, "message #{}", i);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, 1s);
+    dropped = sink->dropped();
+  }
+
+  auto messages = receive();
+  EXPECT_GT(dropped, 0);
+  EXPECT_EQ(messages.size() + dropped, total);
+}
@@ -0,0 +1,142 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+
+#include "soralog/impl/configurator_from_yaml.hpp"
+#include "soralog/logger.hpp"
+#include "soralog/logging_system.hpp"
+#include "soralog/worker_placement.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class WorkerPlacementTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::array<char, L_tmpnam> filename{};
+    ASSERT_TRUE(std::tmpnam(filename.data()) != nullptr);
+    path_ = filename.data();
+  }
+  void TearDown() override {
+    std::filesystem::remove(path_);
+  }
+
+  /**
+   * @returns id of thread named {@param name}, or 0 if there is no such
+   * thread in process
+   */
+  static pid_t findThread(const std::string &name) {
+    for (const auto &entry :
+         std::filesystem::directory_iterator("/proc/self/task")) {
+      std::ifstream file(entry.path() / "comm");
+      std::string comm;
+      if (std::getline(file, comm) && comm == name) {
+        return std::stoi(entry.path().filename().string());
+      }
+    }
+    return 0;
+  }
+
+  std::filesystem::path path_;
+};
+
+/**
+ * @given lists of CPUs
+ * @when they are parsed
+ * @then ranges are expanded; malformed lists are rejected
+ */
+TEST_F(WorkerPlacementTest, ParseCpuList) {
+  using Cpus = std::vector<unsigned>;
+  EXPECT_EQ(WorkerPlacement::parseCpuList("3"), Cpus({3}));
+  EXPECT_EQ(WorkerPlacement::parseCpuList("0-3,8,10-11"),
+            Cpus({0, 1, 2, 3, 8, 10, 11}));
+  for (auto list : {"", "1,", "-1", "3-1", "a", "1-2-3", "0-99999"}) {
+    EXPECT_FALSE(WorkerPlacement::parseCpuList(list)) << list;
+  }
+}
+
+/**
+ * @given file sink with placement of worker in config
+ * @when sink gets event, so its worker is started
+ * @then worker runs on configured CPU with configured policy and niceness;
+ * malformed placement is reported as warning
+ */
+TEST_F(WorkerPlacementTest, ConfiguredWorker) {
+  const std::string config = "sinks:\n"
+                             "  - name: placed\n"
+                             "    type: file\n"
+                             "    path: " + path_.string() + "\n"
+                             "    worker:\n"
+                             "      cpus: [0]\n"
+                             "      policy: batch\n"
+                             "      nice: 5\n"
+                             "groups:\n"
+                             "  - name: main\n"
+                             "    sink: placed\n"
+                             "    level: info\n";
+  LoggingSystem system(std::make_shared<ConfiguratorFromYAML>(config));
+  auto result = system.configure();
+  ASSERT_FALSE(result.has_error) << result.message;
+  ASSERT_FALSE(result.has_warning) << result.message;
+
+  auto sink = system.getSink("placed");
+  ASSERT_TRUE(sink);
+  EXPECT_EQ(sink->workerPlacement().cpus, std::vector<unsigned>{0});
+  EXPECT_EQ(sink->workerPlacement().policy, WorkerPlacement::Policy::BATCH);
+
+  auto logger = system.getLogger("logger", "main");
+  logger->info("event");
+
+  // Worker applies placement once it wakes up
+  pid_t worker = 0;
+  for (auto i = 0; i < 100; ++i) {
+    worker = findThread("log:placed");
+    if (worker != 0 && ::sched_getscheduler(worker) == SCHED_BATCH
+        && ::getpriority(PRIO_PROCESS, static_cast<id_t>(worker)) == 5) {
+      break;
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_NE(worker, 0);
+  EXPECT_EQ(::sched_getscheduler(worker), SCHED_BATCH);
+  EXPECT_EQ(::getpriority(PRIO_PROCESS, static_cast<id_t>(worker)), 5);
+  cpu_set_t cpus;
+  ASSERT_EQ(::sched_getaffinity(worker, sizeof(cpus), &cpus), 0);
+  EXPECT_EQ(CPU_COUNT(&cpus), 1);
+  EXPECT_TRUE(CPU_ISSET(0, &cpus));
+
+  const std::string malformed = "sinks:\n"
+                                "  - name: placed\n"
+                                "    type: file\n"
+                                "    path: " + path_.string() + "\n"
+                                "    worker:\n"
+                                "      cpus: 3-1\n"
+                                "      policy: fifo\n"
+                                "      nice: 40\n"
+                                "      node: 1\n"
+                                "groups:\n"
+                                "  - name: main\n"
+                                "    sink: placed\n"
+                                "    level: info\n";
+  LoggingSystem other(std::make_shared<ConfiguratorFromYAML>(malformed));
+  result = other.configure();
+  EXPECT_FALSE(result.has_error) << result.message;
+  EXPECT_TRUE(result.has_warning);
+  for (auto property : {"worker.cpus", "worker.policy", "worker.nice",
+                        "worker of sink 'placed': node"}) {
+    EXPECT_NE(result.message.find(property), std::string::npos)
+        << result.message;
+  }
+}
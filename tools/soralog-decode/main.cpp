@@ -0,0 +1,262 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * soralog-decode
+ * Renders files written by binary sink into text layout of file sink
+ */
+
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include <soralog/field.hpp>
+#include <soralog/impl/binary_log_reader.hpp>
+
+using namespace soralog;
+using namespace std::chrono_literals;
+
+namespace {
+
+  enum class ThreadInfo { AUTO, NONE, ID, NAME };
+
+  struct Options {
+    std::optional<std::chrono::system_clock::time_point> from;
+    std::optional<std::chrono::system_clock::time_point> to;
+    Level level = Level::TRACE;
+    std::vector<std::string> loggers;
+    ThreadInfo thread = ThreadInfo::AUTO;
+    std::vector<std::string> files;
+  };
+
+  void usage(std::ostream &out) {
+    out << "Usage: soralog-decode [options] FILE...\n"
+           "Renders binary log files into text.\n"
+           "\n"
+           "Options:\n"
+           "  --from TIME      skip events earlier than TIME\n"
+           "  --to TIME        skip events later than TIME\n"
+           "                   TIME is seconds since epoch, or local time\n"
+           "                   as 'YYYY-MM-DD hh:mm:ss' (or with 'T')\n"
+           "  --level LEVEL    show only events of LEVEL or more severe:\n"
+           "                   critical, error, warning, info, verbose,\n"
+           "                   debug, trace\n"
+           "  --logger NAME    show only events of logger NAME; trailing '*'\n"
+           "                   matches any suffix. Might be repeated\n"
+           "  --thread MODE    thread info: none, id, name\n"
+           "                   (default: as recorded)\n"
+           "  --help           show this help\n";
+  }
+
+  std::optional<std::chrono::system_clock::time_point> parse_time(
+      const std::string &str) {
+    char *end = nullptr;
+    auto seconds = std::strtod(str.c_str(), &end);
+    if (end != str.c_str() && *end == '\0') {
+      return std::chrono::system_clock::time_point(
+          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+              std::chrono::duration<double>(seconds)));
+    }
+
+    std::tm tm{};
+    const char *rest = ::strptime(str.c_str(), "%Y-%m-%d %H:%M:%S", &tm);
+    if (rest == nullptr) {
+      rest = ::strptime(str.c_str(), "%Y-%m-%dT%H:%M:%S", &tm);
+    }
+    if (rest == nullptr || *rest != '\0') {
+      return std::nullopt;
+    }
+    tm.tm_isdst = -1;
+    return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+  }
+
+  bool match_logger(const std::vector<std::string> &patterns,
+                    std::string_view name) {
+    if (patterns.empty()) {
+      return true;
+    }
+    for (std::string_view pattern : patterns) {
+      if (!pattern.empty() && pattern.back() == '*') {
+        pattern.remove_suffix(1);
+        if (name.substr(0, pattern.size()) == pattern) {
+          return true;
+        }
+      } else if (name == pattern) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Renders {@param event} in the same layout as SinkToFile does
+   */
+  void render(fmt::memory_buffer &out, const BinaryLogReader::Event &event,
+              ThreadInfo thread) {
+    const auto time = event.timestamp.time_since_epoch();
+    const auto sec = time / 1s;
+    const auto usec = time % 1s / 1us;
+    auto tm = fmt::localtime(static_cast<std::time_t>(sec));
+
+    fmt::format_to(std::back_inserter(out),
+                   "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}.{:0>6}  ",
+                   tm.tm_year % 100, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+                   tm.tm_min, tm.tm_sec, usec);
+
+    if (thread == ThreadInfo::AUTO && event.thread_number != 0) {
+      thread = event.thread_name.empty() ? ThreadInfo::ID : ThreadInfo::NAME;
+    }
+    switch (thread) {
+      case ThreadInfo::NAME:
+        fmt::format_to(std::back_inserter(out), "{:<15}  ",
+                       event.thread_name.substr(0, 15));
+        break;
+      case ThreadInfo::ID:
+        fmt::format_to(std::back_inserter(out), "T:{:<6}  ",
+                       event.thread_number);
+        break;
+      default:
+        break;
+    }
+
+    fmt::format_to(std::back_inserter(out), "{:<8}  {}  {}",
+                   levelToStr(event.level), event.name, event.message);
+
+    if (!event.fields.empty()) {
+      std::string fields(Fields::maxTextSize(event.fields.size()), '\0');
+      char *ptr = fields.data();
+      Fields(event.fields).putText(ptr);
+      out.append(fields.data(), ptr);
+    }
+    out.push_back('\n');
+  }
+
+  const char *status_to_str(BinaryLogReader::Status status) {
+    switch (status) {
+      case BinaryLogReader::Status::OK:
+      case BinaryLogReader::Status::END:
+        return "ok";
+      case BinaryLogReader::Status::TORN:
+        return "last record is torn";
+      case BinaryLogReader::Status::CORRUPTED:
+        return "file is corrupted";
+      case BinaryLogReader::Status::BAD_HEADER:
+        return "not a binary log or unsupported version";
+      case BinaryLogReader::Status::NOT_OPENED:
+        return "can't open file";
+    }
+    return "unknown";
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];  // NOLINT
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        std::cerr << "Option " << arg << " requires value\n";
+        exit(EXIT_FAILURE);
+      }
+      return argv[++i];  // NOLINT
+    };
+
+    if (arg == "--help" || arg == "-h") {
+      usage(std::cout);
+      return EXIT_SUCCESS;
+    }
+    if (arg == "--from" || arg == "--to") {
+      auto str = value();
+      auto time = parse_time(str);
+      if (!time) {
+        std::cerr << "Invalid time: " << str << "\n";
+        return EXIT_FAILURE;
+      }
+      (arg == "--from" ? options.from : options.to) = time;
+    } else if (arg == "--level") {
+      auto str = value();
+      auto level = levelFromStr(str);
+      if (!level) {
+        std::cerr << "Invalid level: " << str << "\n";
+        return EXIT_FAILURE;
+      }
+      options.level = *level;
+    } else if (arg == "--logger") {
+      options.loggers.emplace_back(value());
+    } else if (arg == "--thread") {
+      auto str = value();
+      if (str == "none") {
+        options.thread = ThreadInfo::NONE;
+      } else if (str == "id") {
+        options.thread = ThreadInfo::ID;
+      } else if (str == "name") {
+        options.thread = ThreadInfo::NAME;
+      } else {
+        std::cerr << "Invalid thread mode: " << str << "\n";
+        return EXIT_FAILURE;
+      }
+    } else if (!arg.empty() && arg[0] == '-') {
+      std::cerr << "Unknown option: " << arg << "\n";
+      usage(std::cerr);
+      return EXIT_FAILURE;
+    } else {
+      options.files.emplace_back(std::move(arg));
+    }
+  }
+
+  if (options.files.empty()) {
+    usage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+  fmt::memory_buffer out;
+
+  for (const auto &file : options.files) {
+    BinaryLogReader reader(file);
+
+    while (auto event = reader.next()) {
+      if (event->level > options.level
+          || (options.from && event->timestamp < *options.from)
+          || (options.to && event->timestamp > *options.to)
+          || !match_logger(options.loggers, event->name)) {
+        continue;
+      }
+      render(out, *event, options.thread);
+      if (out.size() > (1u << 16)) {
+        std::cout.write(out.data(), out.size());
+        out.clear();
+      }
+    }
+    std::cout.write(out.data(), out.size());
+    out.clear();
+
+    switch (reader.status()) {
+      case BinaryLogReader::Status::END:
+        break;
+      case BinaryLogReader::Status::TORN:
+        // Expected after crash of writer: everything before is decoded
+        std::cerr << file << ": " << status_to_str(reader.status())
+                  << " at offset " << reader.offset() << "; ignored\n";
+        break;
+      default:
+        std::cerr << file << ": " << status_to_str(reader.status())
+                  << " at offset " << reader.offset() << "\n";
+        result = EXIT_FAILURE;
+        break;
+    }
+  }
+
+  std::cout.flush();
+  return result;
+}
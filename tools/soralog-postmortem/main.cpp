@@ -0,0 +1,229 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * soralog-postmortem
+ * Extracts events kept by crash ring sink from ring file, or from core dump
+ * of process, and renders them into text layout of file sink
+ */
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include <soralog/impl/shm_ring.hpp>
+
+using namespace soralog;
+using namespace std::chrono_literals;
+
+namespace {
+
+  enum class ThreadInfo { AUTO, NONE, ID, NAME };
+
+  struct Options {
+    Level level = Level::TRACE;
+    ThreadInfo thread = ThreadInfo::AUTO;
+    std::vector<std::string> files;
+  };
+
+  void usage(std::ostream &out) {
+    out << "Usage: soralog-postmortem [options] FILE...\n"
+           "Renders events kept in crash ring. FILE is ring file, or core\n"
+           "dump of process which has had crash ring.\n"
+           "\n"
+           "Options:\n"
+           "  --level LEVEL    show only events of LEVEL or more severe:\n"
+           "                   critical, error, warning, info, verbose,\n"
+           "                   debug, trace\n"
+           "  --thread MODE    thread info: none, id, name\n"
+           "                   (default: as recorded)\n"
+           "  --help           show this help\n";
+  }
+
+  /**
+   * Renders {@param event} in the same layout as SinkToFile does
+   */
+  void render(fmt::memory_buffer &out, const ShmRing::Record &event,
+              ThreadInfo thread) {
+    const auto time = event.timestamp.time_since_epoch();
+    const auto sec = time / 1s;
+    const auto usec = time % 1s / 1us;
+    auto tm = fmt::localtime(static_cast<std::time_t>(sec));
+
+    fmt::format_to(std::back_inserter(out),
+                   "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}.{:0>6}  ",
+                   tm.tm_year % 100, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+                   tm.tm_min, tm.tm_sec, usec);
+
+    if (thread == ThreadInfo::AUTO && event.thread_number != 0) {
+      thread = event.thread_name.empty() ? ThreadInfo::ID : ThreadInfo::NAME;
+    }
+    switch (thread) {
+      case ThreadInfo::NAME:
+        fmt::format_to(std::back_inserter(out), "{:<15}  ",
+                       event.thread_name.substr(0, 15));
+        break;
+      case ThreadInfo::ID:
+        fmt::format_to(std::back_inserter(out), "T:{:<6}  ",
+                       event.thread_number);
+        break;
+      default:
+        break;
+    }
+
+    fmt::format_to(std::back_inserter(out), "{:<8}  {}  {}",
+                   levelToStr(event.level), event.name, event.message);
+
+    if (!event.fields.empty()) {
+      std::string fields(Fields::maxTextSize(event.fields.size()), '\0');
+      char *ptr = fields.data();
+      Fields(event.fields).putText(ptr);
+      out.append(fields.data(), ptr);
+    }
+    out.push_back('\n');
+  }
+
+  /**
+   * @returns offsets of possible rings in core dump {@param path}. Segments
+   * of memory are page-aligned in core, so only beginnings of pages are
+   * checked for magic of ring
+   */
+  std::vector<uint64_t> find_rings(const std::string &path) {
+    constexpr std::string_view magic = "SORALOGR";
+    constexpr size_t page = 4096;
+
+    std::vector<uint64_t> offsets;
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> chunk(page * 256);
+    uint64_t offset = 0;
+    while (in) {
+      in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+      const auto size = static_cast<size_t>(in.gcount());
+      for (size_t i = 0; i + magic.size() <= size; i += page) {
+        if (std::string_view(chunk.data() + i, magic.size()) == magic) {
+          offsets.push_back(offset + i);
+        }
+      }
+      offset += size;
+    }
+    return offsets;
+  }
+
+  /**
+   * Renders events of {@param ring} into stdout
+   */
+  void extract(ShmRing &ring, uint64_t offset, const std::string &file,
+               const Options &options) {
+    std::vector<ShmRing::Record> records;
+    ring.read(records);
+
+    std::cerr << file << ": ring of process " << ring.pid();
+    if (offset != 0) {
+      std::cerr << " at offset " << offset;
+    }
+    std::cerr << ": " << records.size() << " events";
+    if (ring.corrupted() != 0) {
+      std::cerr << ", " << ring.corrupted() << " broken records skipped";
+    }
+    std::cerr << "\n";
+
+    fmt::memory_buffer out;
+    for (const auto &record : records) {
+      if (record.level > options.level) {
+        continue;
+      }
+      render(out, record, options.thread);
+      if (out.size() > (1u << 16)) {
+        std::cout.write(out.data(), out.size());
+        out.clear();
+      }
+    }
+    std::cout.write(out.data(), out.size());
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];  // NOLINT
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        std::cerr << "Option " << arg << " requires value\n";
+        exit(EXIT_FAILURE);
+      }
+      return argv[++i];  // NOLINT
+    };
+
+    if (arg == "--help" || arg == "-h") {
+      usage(std::cout);
+      return EXIT_SUCCESS;
+    }
+    if (arg == "--level") {
+      auto str = value();
+      auto level = levelFromStr(str);
+      if (!level) {
+        std::cerr << "Invalid level: " << str << "\n";
+        return EXIT_FAILURE;
+      }
+      options.level = *level;
+    } else if (arg == "--thread") {
+      auto str = value();
+      if (str == "none") {
+        options.thread = ThreadInfo::NONE;
+      } else if (str == "id") {
+        options.thread = ThreadInfo::ID;
+      } else if (str == "name") {
+        options.thread = ThreadInfo::NAME;
+      } else {
+        std::cerr << "Invalid thread mode: " << str << "\n";
+        return EXIT_FAILURE;
+      }
+    } else if (!arg.empty() && arg[0] == '-') {
+      std::cerr << "Unknown option: " << arg << "\n";
+      usage(std::cerr);
+      return EXIT_FAILURE;
+    } else {
+      options.files.emplace_back(std::move(arg));
+    }
+  }
+
+  if (options.files.empty()) {
+    usage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+
+  for (const auto &file : options.files) {
+    // Ring file itself
+    if (auto ring = ShmRing::inspect(file)) {
+      extract(*ring, 0, file, options);
+      continue;
+    }
+
+    // Core dump containing rings
+    size_t found = 0;
+    for (auto offset : find_rings(file)) {
+      if (auto ring = ShmRing::inspect(file, offset)) {
+        extract(*ring, offset, file, options);
+        ++found;
+      }
+    }
+    if (found == 0) {
+      std::cerr << file << ": no crash ring found\n";
+      result = EXIT_FAILURE;
+    }
+  }
+
+  std::cout.flush();
+  return result;
+}
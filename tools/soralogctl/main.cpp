@@ -0,0 +1,176 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * soralogctl
+ * Sends commands to control socket of running process (see ControlServer)
+ * and prints replies
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+  void usage(std::ostream &out) {
+    out << "Usage: soralogctl --socket PATH [COMMAND [ARGS...]]\n"
+           "Sends COMMAND to control socket of logging system; without "
+           "COMMAND sends\ncommands read from stdin line by line. Exit status "
+           "is non-zero if any command\nfails.\n"
+           "\n"
+           "Commands:\n"
+           "  help                           list of commands\n"
+           "  groups                         groups with parent, level and "
+           "sink\n"
+           "  loggers                        loggers with group, level and "
+           "sink\n"
+           "  sinks                          sinks with statistics of queue\n"
+           "  level group|logger NAME LEVEL  set level ('reset' to inherit)\n"
+           "  flush [SINK]                   write queued events of sink "
+           "(all)\n"
+           "  rotate [SINK]                  reopen file of sink (all)\n";
+  }
+
+  /// Connection to control socket, which reads reply line by line
+  class Connection {
+   public:
+    explicit Connection(int fd) : fd_(fd) {}
+
+    bool send(std::string line) {
+      line += '\n';
+      std::string_view data = line;
+      while (!data.empty()) {
+        auto n = ::write(fd_, data.data(), data.size());
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          return false;
+        }
+        data.remove_prefix(n);
+      }
+      return true;
+    }
+
+    bool readLine(std::string &line) {
+      for (;;) {
+        if (auto end = buffer_.find('\n'); end != std::string::npos) {
+          line = buffer_.substr(0, end);
+          buffer_.erase(0, end + 1);
+          return true;
+        }
+        char chunk[1024];
+        auto n = ::read(fd_, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          return false;
+        }
+        buffer_.append(chunk, n);
+      }
+    }
+
+   private:
+    int fd_;
+    std::string buffer_;
+  };
+
+  /**
+   * Sends {@param command} and prints reply
+   * @returns true if command succeeded
+   */
+  bool run(Connection &connection, const std::string &command) {
+    if (!connection.send(command)) {
+      std::cerr << "Can't send command: " << std::strerror(errno) << "\n";
+      return false;
+    }
+    std::string line;
+    while (connection.readLine(line)) {
+      if (line == "OK") {
+        return true;
+      }
+      if (line.compare(0, 6, "ERROR ") == 0) {
+        std::cerr << line.substr(6) << "\n";
+        return false;
+      }
+      std::cout << line << "\n";
+    }
+    std::cerr << "Connection is closed\n";
+    return false;
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::string path;
+  std::string command;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];  // NOLINT
+    if (command.empty() && (arg == "--help" || arg == "-h")) {
+      usage(std::cout);
+      return EXIT_SUCCESS;
+    }
+    if (command.empty() && arg == "--socket") {
+      if (i + 1 >= argc) {
+        std::cerr << "Option " << arg << " requires value\n";
+        return EXIT_FAILURE;
+      }
+      path = argv[++i];  // NOLINT
+    } else {
+      command += (command.empty() ? "" : " ") + arg;
+    }
+  }
+
+  if (path.empty()) {
+    usage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Path of socket is too long: " << path << "\n";
+    return EXIT_FAILURE;
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path));
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0
+      || ::connect(fd, reinterpret_cast<sockaddr *>(&address),
+                   sizeof(address))
+          != 0) {
+    std::cerr << "Can't connect to " << path << ": " << std::strerror(errno)
+              << "\n";
+    return EXIT_FAILURE;
+  }
+  // Closed connection is reported by failed write
+  std::signal(SIGPIPE, SIG_IGN);
+  Connection connection(fd);
+
+  bool ok = true;
+  if (!command.empty()) {
+    ok = run(connection, command);
+  } else {
+    for (std::string line; std::getline(std::cin, line);) {
+      if (line.find_first_not_of(" \t\r") == std::string::npos) {
+        continue;
+      }
+      ok = run(connection, line) && ok;
+    }
+  }
+
+  ::close(fd);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright Soramitsu Co., Ltd. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * soralogd
+ * Collects events which processes put into shared-memory rings (sink of
+ * type 'shm') and writes them by sinks configured by YAML file
+ */
+
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <soralog/impl/configurator_from_yaml.hpp>
+#include <soralog/impl/shm_collector.hpp>
+#include <soralog/impl/sink_to_shm.hpp>
+
+using namespace soralog;
+using namespace std::chrono_literals;
+
+namespace {
+
+  volatile std::sig_atomic_t stop = 0;
+
+  void usage(std::ostream &out) {
+    out << "Usage: soralogd [options] --config FILE\n"
+           "Collects events of processes logging by sink of type 'shm', and "
+           "writes them\nby sinks configured in FILE.\n"
+           "\n"
+           "Options:\n"
+           "  --config FILE    YAML config of sinks and groups\n"
+           "  --channel NAME   channel to collect (default: soralog)\n"
+           "  --dir DIR        directory of rings (default: /dev/shm)\n"
+           "  --interval MS    polling interval in milliseconds (default: 10)\n"
+           "  --help           show this help\n";
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::string config;
+  std::string channel(SinkToShm::default_channel);
+  std::string directory(SinkToShm::default_directory);
+  auto interval = 10ms;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];  // NOLINT
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        std::cerr << "Option " << arg << " requires value\n";
+        exit(EXIT_FAILURE);
+      }
+      return argv[++i];  // NOLINT
+    };
+
+    if (arg == "--help" || arg == "-h") {
+      usage(std::cout);
+      return EXIT_SUCCESS;
+    }
+    if (arg == "--config") {
+      config = value();
+    } else if (arg == "--channel") {
+      channel = value();
+    } else if (arg == "--dir") {
+      directory = value();
+    } else if (arg == "--interval") {
+      auto str = value();
+      char *end = nullptr;
+      auto ms = std::strtol(str.c_str(), &end, 10);
+      if (end == str.c_str() || *end != '\0' || ms <= 0) {
+        std::cerr << "Invalid interval: " << str << "\n";
+        return EXIT_FAILURE;
+      }
+      interval = std::chrono::milliseconds(ms);
+    } else {
+      std::cerr << "Unknown option: " << arg << "\n";
+      usage(std::cerr);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (config.empty()) {
+    usage(std::cerr);
+    return EXIT_FAILURE;
+  }
+
+  LoggingSystem system(std::make_shared<ConfiguratorFromYAML>(
+      std::filesystem::path(config)));
+  auto result = system.configure();
+  if (!result.message.empty()) {
+    std::cerr << result.message << std::endl;
+  }
+  if (result.has_error) {
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, [](int) { stop = 1; });
+  std::signal(SIGTERM, [](int) { stop = 1; });
+
+  ShmCollector collector(system, directory, channel);
+  while (stop == 0) {
+    if (collector.poll() == 0) {
+      std::this_thread::sleep_for(interval);
+    }
+  }
+
+  // Drain what is left
+  collector.poll(true);
+  return EXIT_SUCCESS;
+}